@@ -0,0 +1,65 @@
+// Cheapest, fastest and filtered searches for every ordered pair of ports
+// in data/, the workload the container changes were measured with. The
+// checksums add up costs and times so two builds can be compared for
+// identical answers.
+//   bench/run.sh allPairsBench
+#include <string>
+#include "benchUtil.h"
+#include "../headers/Graph.hpp"
+#include "../headers/pathFinding.h"
+#include "../headers/routeFilter.hpp"
+#include "../headers/arena.h"
+
+int main() {
+    Graph graph;
+    graph.addPorts("data/PortCharges.txt");
+    graph.addRoutes("data/Routes.txt");
+    int n = graph.size;
+    std::printf("All %d x %d pairs of data/, best of 5\n", n, n - 1);
+
+    long long sum = 0;
+    double ms = Bench::bestOf(5, [&]() {
+        sum = 0;
+        for (int a = 0; a < n; a++) {
+            for (int b = 0; b < n; b++) {
+                if (a == b) continue;
+                PathFinding::PathResult* r = PathFinding::findCheapestPath(graph, a, b);
+                if (r->found) sum += r->totalCost;
+                delete r;
+            }
+        }
+    });
+    Bench::row("findCheapestPath", ms, sum);
+
+    ms = Bench::bestOf(5, [&]() {
+        sum = 0;
+        for (int a = 0; a < n; a++) {
+            for (int b = 0; b < n; b++) {
+                if (a == b) continue;
+                PathFinding::PathResult* r = PathFinding::findShortestTimePath(graph, a, b);
+                if (r->found) sum += r->totalTime;
+                delete r;
+            }
+        }
+    });
+    Bench::row("findShortestTimePath", ms, sum);
+
+    // No preferences, so every leg passes and the enumeration does the most work
+    Vector<int> ports;
+    Vector<std::string> companies;
+    Arena arena("bench");
+    ms = Bench::bestOf(5, [&]() {
+        sum = 0;
+        for (int a = 0; a < n; a++) {
+            for (int b = 0; b < n; b++) {
+                if (a == b) continue;
+                Vector<PathFinding::PathResult*> paths =
+                    RouteFilter::findFilteredRoutes(graph, a, b, ports, companies, arena);
+                for (PathFinding::PathResult* p : paths) sum += p->totalCost;
+                arena.reset();
+            }
+        }
+    });
+    Bench::row("findFilteredRoutes", ms, sum);
+    return 0;
+}
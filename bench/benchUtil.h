@@ -0,0 +1,40 @@
+#ifndef BENCHUTIL_H
+#define BENCHUTIL_H
+
+#include <chrono>
+#include <cstdio>
+
+// Timing for the programs in bench/. Each measurement is repeated and the
+// fastest run is kept, which is the least disturbed by the rest of the box.
+class Bench {
+public:
+    // Fastest of runs calls to body, in milliseconds
+    template <typename Body>
+    static double bestOf(int runs, Body body) {
+        double best = 0;
+        for (int r = 0; r < runs; r++) {
+            auto start = std::chrono::steady_clock::now();
+            body();
+            double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+            if (r == 0 || ms < best) best = ms;
+        }
+        return best;
+    }
+
+    // Tells the compiler value may be read or changed here, so work on it
+    // is neither dropped nor moved outside the timed body
+    template <typename T>
+    static void keep(T& value) {
+        asm volatile("" : : "g"(&value) : "memory");
+    }
+
+    static void row(const char* name, double ms, long long checksum) {
+        std::printf("  %-40s %10.3f ms   (checksum %lld)\n", name, ms, checksum);
+    }
+
+    static void row(const char* name, double ms) {
+        std::printf("  %-40s %10.3f ms\n", name, ms);
+    }
+};
+
+#endif
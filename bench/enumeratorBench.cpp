@@ -0,0 +1,108 @@
+// PathEnumerator (headers/pathEnumerator.h) asked for the 15 cheapest
+// itineraries, once without a limit (every partial path expanded, results
+// capped by the budget only) and once with limit 15 (cutoff and dominance
+// pruning), on data/ and on a generated 30 x 30 grid of ports with
+// sailings between neighbours every six hours, whose many equal-cost
+// paths give the dominance test the most labels to scan. The checksums
+// sum the costs returned and must agree between the two modes.
+//   bench/run.sh enumeratorBench
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include "benchUtil.h"
+#include "../headers/Graph.hpp"
+#include "../headers/pathEnumerator.h"
+#include "../headers/arena.h"
+
+static const int K = 15;
+
+struct Totals {
+    long long cost;
+    long long expanded;
+};
+
+static Totals enumerate(const Graph& graph, const Vector<int>& pairs, int limit) {
+    Totals t = { 0, 0 };
+    Arena arena("bench");
+    for (int i = 0; i + 1 < pairs.size(); i += 2) {
+        PathEnumerator<> enumerator(graph, pairs[i], pairs[i + 1], PathFinding::AllowAll(), "", 1, limit);
+        Vector<PathFinding::PathResult*> out;
+        enumerator.run(SearchBudget(K), arena, out);
+        for (PathFinding::PathResult* p : out) t.cost += p->totalCost;
+        t.expanded += enumerator.getExpanded();
+        arena.reset();
+    }
+    return t;
+}
+
+static void compare(const char* name, const Graph& graph, const Vector<int>& pairs, int runs) {
+    int queries = pairs.size() / 2;
+    std::printf("%s, %d queries, best of %d\n", name, queries, runs);
+    const int limits[] = { 0, K };
+    const char* labels[] = { "no limit", "limit 15" };
+    for (int m = 0; m < 2; m++) {
+        Totals t;
+        double ms = Bench::bestOf(runs, [&]() { t = enumerate(graph, pairs, limits[m]); });
+        std::printf("  %-12s %9.3f ms/query   expanded %8lld   (checksum %lld)\n", labels[m], ms / queries,
+                    t.expanded, t.cost);
+    }
+}
+
+// 30 x 30 ports, sailings both ways between grid neighbours at 00, 06, 12
+// and 18 o'clock for ten days, four hours each and all at the same cost
+static void writeGrid(const std::string& portsFile, const std::string& routesFile) {
+    const int side = 30;
+    std::ofstream ports(portsFile);
+    for (int r = 0; r < side; r++) {
+        for (int c = 0; c < side; c++) ports << "G" << r << "_" << c << " " << 100 + (r * 37 + c * 11) % 400 << "\n";
+    }
+    std::ofstream routes(routesFile);
+    const char* departs[] = { "00:00", "06:00", "12:00", "18:00" };
+    const char* arrives[] = { "04:00", "10:00", "16:00", "22:00" };
+    for (int r = 0; r < side; r++) {
+        for (int c = 0; c < side; c++) {
+            const int dr[] = { 0, 1, 0, -1 };
+            const int dc[] = { 1, 0, -1, 0 };
+            for (int d = 0; d < 4; d++) {
+                int r2 = r + dr[d], c2 = c + dc[d];
+                if (r2 < 0 || c2 < 0 || r2 >= side || c2 >= side) continue;
+                for (int day = 1; day <= 10; day++) {
+                    for (int s = 0; s < 4; s++) {
+                        routes << "G" << r << "_" << c << " G" << r2 << "_" << c2 << " " << day << "/12/2024 "
+                               << departs[s] << " " << arrives[s] << " 1000 Grid\n";
+                    }
+                }
+            }
+        }
+    }
+}
+
+int main() {
+    Graph data;
+    data.addPorts("data/PortCharges.txt");
+    data.addRoutes("data/Routes.txt");
+    Vector<int> pairs;
+    for (int a = 0; a < data.size; a++) {
+        for (int b = 0; b < data.size; b++) {
+            if (a == b) continue;
+            pairs.push_back(a);
+            pairs.push_back(b);
+        }
+    }
+    compare("data/", data, pairs, 3);
+
+    writeGrid("bench/bin/grid_ports.txt", "bench/bin/grid_routes.txt");
+    Graph grid;
+    grid.addPorts("bench/bin/grid_ports.txt");
+    grid.addRoutes("bench/bin/grid_routes.txt");
+    // Ports four to seven steps apart across the grid
+    pairs.clear();
+    for (int q = 0; q < 12; q++) {
+        int r = (q * 7) % 24, c = (q * 11) % 24;
+        int steps = 4 + q % 4;
+        pairs.push_back(grid.findPort("G" + std::to_string(r) + "_" + std::to_string(c)));
+        pairs.push_back(grid.findPort("G" + std::to_string(r + steps / 2) + "_" + std::to_string(c + steps - steps / 2)));
+    }
+    compare("30 x 30 grid", grid, pairs, 3);
+    return 0;
+}
@@ -0,0 +1,165 @@
+// The lookups moved onto HashMap/HashSet (headers/hashMap.h), each timed
+// as the linear Vector scan it replaced and as the hash lookup it is now,
+// on the names and dates of data/. Checksums match within each pair.
+//   bench/run.sh hashMapBench
+#include <string>
+#include "benchUtil.h"
+#include "../headers/Graph.hpp"
+#include "../headers/hashMap.h"
+
+static int scanFind(const Vector<std::string>& list, const std::string& key) {
+    for (int i = 0; i < list.size(); i++) {
+        if (list[i] == key) return i;
+    }
+    return -1;
+}
+
+int main() {
+    Graph graph;
+    graph.addPorts("data/PortCharges.txt");
+    graph.addRoutes("data/Routes.txt");
+    int n = graph.size;
+
+    // Every leg's endpoints, companies and dates, in timetable order
+    Vector<std::string> legTo, legCompany, legDate;
+    for (int i = 0; i < n; i++) {
+        for (const Route& route : graph.vertices[i].routes) {
+            legTo.push_back(route.dest.name);
+            legCompany.push_back(route.company);
+            legDate.push_back(route.date);
+        }
+    }
+    std::printf("%d ports, %d legs in data/, best of 5\n", n, legTo.size());
+    const int ROUNDS = 200;
+
+    // Graph::findPort: once per edge relaxation in every search
+    Vector<std::string> portNames;
+    for (int i = 0; i < n; i++) portNames.push_back(graph.vertices[i].port.name);
+    long long sum = 0;
+    double ms = Bench::bestOf(5, [&]() {
+        sum = 0;
+        for (int r = 0; r < ROUNDS; r++) {
+            for (int i = 0; i < legTo.size(); i++) sum += scanFind(portNames, legTo[i]);
+        }
+    });
+    Bench::row("findPort, linear scan", ms, sum);
+    ms = Bench::bestOf(5, [&]() {
+        sum = 0;
+        for (int r = 0; r < ROUNDS; r++) {
+            for (int i = 0; i < legTo.size(); i++) sum += graph.findPort(legTo[i]);
+        }
+    });
+    Bench::row("findPort, HashMap", ms, sum);
+
+    // RouteFilter::getAllCompanies: first-seen dedup over every leg
+    ms = Bench::bestOf(5, [&]() {
+        sum = 0;
+        for (int r = 0; r < ROUNDS; r++) {
+            Vector<std::string> list;
+            for (int i = 0; i < legCompany.size(); i++) {
+                if (scanFind(list, legCompany[i]) < 0) list.push_back(legCompany[i]);
+            }
+            sum += list.size();
+        }
+    });
+    Bench::row("getAllCompanies, linear scan", ms, sum);
+    ms = Bench::bestOf(5, [&]() {
+        sum = 0;
+        for (int r = 0; r < ROUNDS; r++) {
+            Vector<std::string> list;
+            HashSet<std::string> seen;
+            for (int i = 0; i < legCompany.size(); i++) {
+                if (seen.insert(legCompany[i])) list.push_back(legCompany[i]);
+            }
+            sum += list.size();
+        }
+    });
+    Bench::row("getAllCompanies, HashSet", ms, sum);
+
+    // findAllPathsWithPreferences: per-edge company and port checks against
+    // the user's picks (here half of each)
+    Vector<std::string> pickedCompanies, pickedPorts;
+    {
+        HashSet<std::string> seen;
+        for (int i = 0; i < legCompany.size(); i++) {
+            if (seen.insert(legCompany[i]) && seen.size() % 2 == 0) pickedCompanies.push_back(legCompany[i]);
+        }
+        for (int i = 0; i < n; i += 2) pickedPorts.push_back(portNames[i]);
+    }
+    ms = Bench::bestOf(5, [&]() {
+        sum = 0;
+        for (int r = 0; r < ROUNDS; r++) {
+            for (int i = 0; i < legTo.size(); i++) {
+                if (scanFind(pickedCompanies, legCompany[i]) >= 0 && scanFind(pickedPorts, legTo[i]) >= 0) sum++;
+            }
+        }
+    });
+    Bench::row("preference check, linear scan", ms, sum);
+    HashSet<std::string> companySet, portSet;
+    for (const std::string& c : pickedCompanies) companySet.insert(c);
+    for (const std::string& p : pickedPorts) portSet.insert(p);
+    ms = Bench::bestOf(5, [&]() {
+        sum = 0;
+        for (int r = 0; r < ROUNDS; r++) {
+            for (int i = 0; i < legTo.size(); i++) {
+                if (companySet.contains(legCompany[i]) && portSet.contains(legTo[i])) sum++;
+            }
+        }
+    });
+    Bench::row("preference check, HashSet", ms, sum);
+
+    // BookingMenu::updateAvailableDates: distinct dates over the legs
+    ms = Bench::bestOf(5, [&]() {
+        sum = 0;
+        for (int r = 0; r < ROUNDS; r++) {
+            Vector<std::string> dates;
+            for (int i = 0; i < legDate.size(); i++) {
+                if (scanFind(dates, legDate[i]) < 0) dates.push_back(legDate[i]);
+            }
+            sum += dates.size();
+        }
+    });
+    Bench::row("available dates, linear scan", ms, sum);
+    ms = Bench::bestOf(5, [&]() {
+        sum = 0;
+        for (int r = 0; r < ROUNDS; r++) {
+            Vector<std::string> dates;
+            HashSet<std::string> seen;
+            for (int i = 0; i < legDate.size(); i++) {
+                if (seen.insert(legDate[i])) dates.push_back(legDate[i]);
+            }
+            sum += dates.size();
+        }
+    });
+    Bench::row("available dates, HashSet", ms, sum);
+
+    // Connected-path dedup: keys like "3,17,22," for the paths listed so
+    // far, a page of 200 with every tenth one repeated
+    Vector<std::string> keys;
+    for (int i = 0; i < 200; i++) {
+        int k = (i % 10 == 9) ? i - 5 : i;
+        keys.push_back(std::to_string(k % n) + "," + std::to_string((k * 7) % n) + "," +
+                       std::to_string((k * 13) % n) + "," + std::to_string(k) + ",");
+    }
+    ms = Bench::bestOf(5, [&]() {
+        sum = 0;
+        for (int r = 0; r < ROUNDS; r++) {
+            Vector<std::string> seen;
+            for (int i = 0; i < keys.size(); i++) {
+                if (scanFind(seen, keys[i]) < 0) seen.push_back(keys[i]);
+            }
+            sum += seen.size();
+        }
+    });
+    Bench::row("path-key dedup, linear scan", ms, sum);
+    ms = Bench::bestOf(5, [&]() {
+        sum = 0;
+        for (int r = 0; r < ROUNDS; r++) {
+            HashSet<std::string> seen;
+            for (int i = 0; i < keys.size(); i++) seen.insert(keys[i]);
+            sum += seen.size();
+        }
+    });
+    Bench::row("path-key dedup, HashSet", ms, sum);
+    return 0;
+}
@@ -0,0 +1,76 @@
+// Goal-directed search on data/: plain Dijkstra, A* on the exact static
+// bounds of LowerBounds (one reverse search per destination), and A* on
+// the ALT landmark tables (headers/landmarks.h), for every ordered pair.
+// The settled column counts ports expanded; the costs and times summed in
+// the checksums must agree across the three.
+//   bench/run.sh landmarksBench
+#include <cstdio>
+#include "benchUtil.h"
+#include "../headers/Graph.hpp"
+#include "../headers/pathFinding.h"
+#include "../headers/lowerBounds.h"
+#include "../headers/landmarks.h"
+
+struct Totals {
+    long long answer;
+    long long settled;
+};
+
+// Cheapest and fastest for every pair, bounds from heuristicFor(b)
+template <typename HeuristicFor>
+static Totals allPairs(const Graph& graph, HeuristicFor heuristicFor) {
+    Totals t = { 0, 0 };
+    for (int a = 0; a < graph.size; a++) {
+        for (int b = 0; b < graph.size; b++) {
+            if (a == b) continue;
+            auto heuristic = heuristicFor(a, b);
+            PathFinding::PathResult* r = PathFinding::findCheapestPath(
+                graph, a, b, PathFinding::AllowAll(), heuristic);
+            if (r->found) t.answer += r->totalCost;
+            t.settled += r->nodesSettled;
+            delete r;
+            r = PathFinding::findShortestTimePath(graph, a, b, PathFinding::AllowAll(), heuristic);
+            if (r->found) t.answer += r->totalTime;
+            t.settled += r->nodesSettled;
+            delete r;
+        }
+    }
+    return t;
+}
+
+static void row(const char* name, double ms, const Totals& t) {
+    std::printf("  %-40s %10.3f ms   settled %7lld   (checksum %lld)\n", name, ms, t.settled, t.answer);
+}
+
+int main() {
+    Graph graph;
+    graph.addPorts("data/PortCharges.txt");
+    graph.addRoutes("data/Routes.txt");
+    int n = graph.size;
+    std::printf("Cheapest + fastest for all %d x %d pairs of data/, best of 5\n", n, n - 1);
+
+    Totals t;
+    double ms = Bench::bestOf(5, [&]() {
+        t = allPairs(graph, [](int, int) { return PathFinding::NoHeuristic(); });
+    });
+    row("Dijkstra", ms, t);
+
+    // First pass computes the bounds of every destination, later passes reuse them
+    ms = Bench::bestOf(1, [&]() {
+        t = allPairs(graph, [&](int, int b) { return BoundsHeuristic(LowerBounds::forDestination(graph, b)); });
+    });
+    row("A*, static bounds (computing them)", ms, t);
+    ms = Bench::bestOf(5, [&]() {
+        t = allPairs(graph, [&](int, int b) { return BoundsHeuristic(LowerBounds::forDestination(graph, b)); });
+    });
+    row("A*, static bounds (cached)", ms, t);
+
+    LandmarkTables tables;
+    ms = Bench::bestOf(5, [&]() { Landmarks::build(graph, Landmarks::DEFAULT_COUNT, tables); });
+    Bench::row("Landmarks::build, 4 landmarks", ms);
+    ms = Bench::bestOf(5, [&]() {
+        t = allPairs(graph, [&](int a, int b) { return LandmarkHeuristic(tables, a, b); });
+    });
+    row("A*, ALT landmarks", ms, t);
+    return 0;
+}
@@ -0,0 +1,253 @@
+// LinkedList building, walking and reuse (headers/linkedList.h,
+// headers/nodePool.h), each next to the list as it was before the node
+// pool: one new per node, kept below as NodeList. Besides plain ints it
+// rebuilds the PathResults of every data/ pair from PathStep chains, as
+// PathFinding::buildResult does, and walks every port's routes once a
+// frame, as the booking menu does listing dates.
+//   bench/run.sh listBench
+#include "benchUtil.h"
+#include "../headers/Graph.hpp"
+#include "../headers/pathFinding.h"
+#include "../headers/linkedList.h"
+#include "../headers/vector.h"
+
+// headers/linkedList.h before the node pool
+template <typename T>
+class NodeList {
+public:
+    struct Node {
+        T data;
+        Node* next;
+        Node(T val) : data(val), next(nullptr) {}
+    };
+
+    Node* head;
+    Node* tail;
+    int size;
+
+    NodeList() : head(nullptr), tail(nullptr), size(0) {}
+    ~NodeList() { clear(); }
+
+    void insertEnd(T val) {
+        Node* newNode = new Node(val);
+        if (!head) head = tail = newNode;
+        else { tail->next = newNode; tail = newNode; }
+        size++;
+    }
+
+    void insertFront(T val) {
+        Node* newNode = new Node(val);
+        if (!head) head = tail = newNode;
+        else { newNode->next = head; head = newNode; }
+        size++;
+    }
+
+    int getSize() const { return size; }
+
+    void clear() {
+        Node* current = head;
+        while (current) {
+            Node* tmp = current;
+            current = current->next;
+            delete tmp;
+        }
+        head = tail = nullptr;
+        size = 0;
+    }
+};
+
+// The two lists a PathResult holds
+template <template <typename> class List>
+struct Result {
+    List<int> path;
+    List<Route> routes;
+};
+
+static void listRows(const char* what, double baseline, long long baselineSum, double pooled, long long sum) {
+    char name[64];
+    std::snprintf(name, sizeof(name), "%s, node per new", what);
+    Bench::row(name, baseline, baselineSum);
+    std::snprintf(name, sizeof(name), "%s, pooled", what);
+    Bench::row(name, pooled, sum);
+}
+
+template <template <typename> class List>
+static long long smallLists(int lists) {
+    long long sum = 0;
+    for (int i = 0; i < lists; i++) {
+        List<int> list;
+        for (int k = 0; k < 4; k++) list.insertFront(k);
+        sum += list.getSize();
+    }
+    return sum;
+}
+
+template <template <typename> class List>
+static long long freshList(int length) {
+    List<int> fresh;
+    for (int i = 0; i < length; i++) fresh.insertEnd(i);
+    return fresh.getSize();
+}
+
+template <template <typename> class List>
+static long long walk(List<int>& list) {
+    Bench::keep(list);
+    long long sum = 0;
+    for (const typename List<int>::Node* node = list.head; node; node = node->next) sum += node->data;
+    return sum;
+}
+
+// Rebuilds a result for every chain, front to back along prev as
+// buildResult does, and frees them all again
+static long long rebuildBaseline(const Vector<const PathFinding::PathStep*>& chains) {
+    long long sum = 0;
+    Vector<Result<NodeList>*> results;
+    for (const PathFinding::PathStep* last : chains) {
+        Result<NodeList>* result = new Result<NodeList>();
+        for (const PathFinding::PathStep* step = last; step; step = step->prev) {
+            result->path.insertFront(step->port);
+            if (step->route) result->routes.insertFront(*step->route);
+        }
+        sum += result->path.getSize() + result->routes.getSize();
+        results.push_back(result);
+    }
+    for (Result<NodeList>* result : results) delete result;
+    return sum;
+}
+
+static long long rebuildPooled(const Vector<const PathFinding::PathStep*>& chains) {
+    long long sum = 0;
+    Vector<Result<LinkedList>*> results;
+    for (const PathFinding::PathStep* last : chains) {
+        Result<LinkedList>* result = new Result<LinkedList>();
+        result->path.reserve(last->stops);
+        result->routes.reserve(last->stops - 1);
+        for (const PathFinding::PathStep* step = last; step; step = step->prev) {
+            result->path.insertFront(step->port);
+            if (step->route) result->routes.insertFront(*step->route);
+        }
+        sum += result->path.getSize() + result->routes.getSize();
+        results.push_back(result);
+    }
+    for (Result<LinkedList>* result : results) delete result;
+    return sum;
+}
+
+// Every port's routes, read as the date list reads them, once per frame
+template <template <typename> class List>
+static long long drawFrames(Vector<List<Route>*>& byPort, int frames) {
+    long long sum = 0;
+    for (int frame = 0; frame < frames; frame++) {
+        Bench::keep(byPort);
+        for (const List<Route>* routes : byPort) {
+            for (const typename List<Route>::Node* node = routes->head; node; node = node->next) {
+                sum += node->data.cost + (long long)node->data.date.size();
+            }
+        }
+    }
+    return sum;
+}
+
+// Each port's routes copied into a list of either kind in the order
+// Graph::addRoutes reads them, so the nodes of different ports interleave
+// in memory as they do in the graph
+template <template <typename> class List>
+static void copyRoutes(const Graph& graph, Vector<List<Route>*>& byPort) {
+    Vector<LinkedList<Route>::const_iterator> next;
+    for (int u = 0; u < graph.size; u++) {
+        byPort.push_back(new List<Route>());
+        next.push_back(graph.vertices[u].routes.begin());
+    }
+    for (bool more = true; more;) {
+        more = false;
+        for (int u = 0; u < graph.size; u++) {
+            if (next[u] == graph.vertices[u].routes.end()) continue;
+            byPort[u]->insertEnd(*next[u]);
+            ++next[u];
+            more = true;
+        }
+    }
+}
+
+int main() {
+    const int LISTS = 100000;
+    const int LONG = 200000;
+    const int FRAMES = 1000;
+    std::printf("LinkedList against one new per node, best of 5\n");
+
+    // The PathResult path/route lists: a few nodes each
+    long long oldSum = 0, sum = 0;
+    double baseline = Bench::bestOf(5, [&]() { oldSum = smallLists<NodeList>(LISTS); });
+    double pooled = Bench::bestOf(5, [&]() { sum = smallLists<LinkedList>(LISTS); });
+    listRows("100k int lists of 4", baseline, oldSum, pooled, sum);
+
+    NodeList<int> oldList;
+    LinkedList<int> list;
+    baseline = Bench::bestOf(5, [&]() {
+        oldList.clear();
+        for (int i = 0; i < LONG; i++) oldList.insertEnd(i);
+        oldSum = oldList.getSize();
+    });
+    pooled = Bench::bestOf(5, [&]() {
+        list.clear();
+        for (int i = 0; i < LONG; i++) list.insertEnd(i);
+        sum = list.getSize();
+    });
+    listRows("200k insertEnd, refilling", baseline, oldSum, pooled, sum);
+
+    baseline = Bench::bestOf(5, [&]() { oldSum = freshList<NodeList>(LONG); });
+    pooled = Bench::bestOf(5, [&]() { sum = freshList<LinkedList>(LONG); });
+    listRows("200k insertEnd, new list", baseline, oldSum, pooled, sum);
+
+    baseline = Bench::bestOf(5, [&]() { oldSum = walk<NodeList>(oldList); });
+    pooled = Bench::bestOf(5, [&]() { sum = walk<LinkedList>(list); });
+    listRows("walk 200k ints", baseline, oldSum, pooled, sum);
+
+    Graph graph;
+    graph.addPorts("data/PortCharges.txt");
+    graph.addRoutes("data/Routes.txt");
+
+    // PathStep chains for the cheapest itinerary of every pair, as the
+    // enumerators leave them
+    Vector<PathFinding::PathResult*> found;
+    Vector<PathFinding::PathStep*> steps;
+    Vector<const PathFinding::PathStep*> chains;
+    for (int a = 0; a < graph.size; a++) {
+        for (int b = 0; b < graph.size; b++) {
+            if (a == b) continue;
+            PathFinding::PathResult* result = PathFinding::findCheapestPath(graph, a, b);
+            if (!result->found) {
+                delete result;
+                continue;
+            }
+            found.push_back(result);
+            const PathFinding::PathStep* step = nullptr;
+            LinkedList<Route>::iterator leg = result->routes.begin();
+            for (int port : result->path) {
+                const Route* route = step ? &*leg++ : nullptr;
+                steps.push_back(new PathFinding::PathStep(port, route, step, 0, 0));
+                step = steps.back();
+            }
+            chains.push_back(step);
+        }
+    }
+    baseline = Bench::bestOf(5, [&]() { oldSum = rebuildBaseline(chains); });
+    pooled = Bench::bestOf(5, [&]() { sum = rebuildPooled(chains); });
+    char what[64];
+    std::snprintf(what, sizeof(what), "rebuild %d PathResults", chains.size());
+    listRows(what, baseline, oldSum, pooled, sum);
+
+    Vector<NodeList<Route>*> oldRoutes;
+    Vector<LinkedList<Route>*> routes;
+    copyRoutes(graph, oldRoutes);
+    copyRoutes(graph, routes);
+    baseline = Bench::bestOf(5, [&]() { oldSum = drawFrames(oldRoutes, FRAMES); });
+    pooled = Bench::bestOf(5, [&]() { sum = drawFrames(routes, FRAMES); });
+    listRows("all routes x1000 frames", baseline, oldSum, pooled, sum);
+
+    for (NodeList<Route>* r : oldRoutes) delete r;
+    for (LinkedList<Route>* r : routes) delete r;
+    for (PathFinding::PathStep* s : steps) delete s;
+    for (PathFinding::PathResult* r : found) delete r;
+    return 0;
+}
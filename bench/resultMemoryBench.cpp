@@ -0,0 +1,38 @@
+// Heap held by search results: the cheapest itinerary for every pair of
+// data/ kept alive at once, as the menus keep their result lists. Most of
+// it is the short path/route lists inside each PathResult.
+//   bench/run.sh resultMemoryBench
+#include <malloc.h>
+#include "benchUtil.h"
+#include "../headers/Graph.hpp"
+#include "../headers/pathFinding.h"
+#include "../headers/vector.h"
+
+static long long heapInUse() {
+    return (long long)mallinfo2().uordblks;
+}
+
+int main() {
+    Graph graph;
+    graph.addPorts("data/PortCharges.txt");
+    graph.addRoutes("data/Routes.txt");
+
+    // Warm the search tables so they are not counted with the results
+    delete PathFinding::findCheapestPath(graph, 0, 1);
+
+    long long before = heapInUse();
+    Vector<PathFinding::PathResult*> kept;
+    int legs = 0;
+    for (int a = 0; a < graph.size; a++) {
+        for (int b = 0; b < graph.size; b++) {
+            if (a == b) continue;
+            kept.push_back(PathFinding::findCheapestPath(graph, a, b));
+            legs += kept.back()->routes.getSize();
+        }
+    }
+    long long used = heapInUse() - before;
+    std::printf("%d cheapest results (%d legs): %lld KB of heap\n", kept.size(), legs, used / 1024);
+
+    for (PathFinding::PathResult* result : kept) delete result;
+    return 0;
+}
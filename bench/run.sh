@@ -0,0 +1,17 @@
+#!/bin/sh
+# Builds the benchmarks in bench/ with optimizations and runs them (all of
+# them, or the ones named) from the repository root, since they read
+# data/. Each prints its own table.
+#   bench/run.sh vectorBench
+cd "$(dirname "$0")/.." || exit 1
+mkdir -p bench/bin
+
+if [ $# -eq 0 ]; then
+    set -- $(ls bench/*Bench.cpp | sed 's#bench/##; s#\.cpp$##')
+fi
+
+for name in "$@"; do
+    ${CXX:-g++} -std=c++17 -O2 -DNDEBUG -pthread $CXXFLAGS -o "bench/bin/$name" "bench/$name.cpp" || exit 1
+    echo "== $name"
+    "bench/bin/$name" || exit 1
+done
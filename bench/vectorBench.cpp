@@ -0,0 +1,126 @@
+// Vector growth, copies and moves (headers/vector.h), each next to
+// std::vector doing the same, for ints, strings, nested vectors and the
+// element types the searches keep in them: Routes (data/'s sailings,
+// cycled) and PathSteps.
+//   bench/run.sh vectorBench
+#include <string>
+#include <vector>
+#include "benchUtil.h"
+#include "../headers/Graph.hpp"
+#include "../headers/pathFinding.h"
+#include "../headers/vector.h"
+
+static const int N = 200000;
+
+// A fresh vector of each kind filled with N items make(i) makes
+template <typename T, typename Make>
+static void pushBack(const char* what, Make make) {
+    char name[64];
+    long long sum = 0;
+    double ms = Bench::bestOf(5, [&]() {
+        Vector<T> v;
+        for (int i = 0; i < N; i++) v.push_back(make(i));
+        sum = v.size();
+    });
+    std::snprintf(name, sizeof(name), "Vector push_back %s", what);
+    Bench::row(name, ms, sum);
+
+    ms = Bench::bestOf(5, [&]() {
+        std::vector<T> v;
+        for (int i = 0; i < N; i++) v.push_back(make(i));
+        sum = v.size();
+    });
+    std::snprintf(name, sizeof(name), "std::vector push_back %s", what);
+    Bench::row(name, ms, sum);
+}
+
+template <typename T, typename Make>
+static void copy(const char* what, Make make) {
+    char name[64];
+    long long sum = 0;
+    Vector<T> source;
+    std::vector<T> stdSource;
+    for (int i = 0; i < N; i++) {
+        source.push_back(make(i));
+        stdSource.push_back(make(i));
+    }
+    double ms = Bench::bestOf(5, [&]() {
+        Vector<T> c(source);
+        sum = c.size();
+    });
+    std::snprintf(name, sizeof(name), "Vector copy %s", what);
+    Bench::row(name, ms, sum);
+
+    ms = Bench::bestOf(5, [&]() {
+        std::vector<T> c(stdSource);
+        sum = c.size();
+    });
+    std::snprintf(name, sizeof(name), "std::vector copy %s", what);
+    Bench::row(name, ms, sum);
+}
+
+int main() {
+    Graph graph;
+    graph.addPorts("data/PortCharges.txt");
+    graph.addRoutes("data/Routes.txt");
+    Vector<const Route*> routes;
+    for (int u = 0; u < graph.size; u++) {
+        for (const Route& r : graph.vertices[u].routes) routes.push_back(&r);
+    }
+
+    std::printf("Vector and std::vector, %d elements, best of 5\n", N);
+    pushBack<int>("int", [](int i) { return i; });
+    // Growth moves strings instead of copying them into a new T[]
+    pushBack<std::string>("40-char string", [](int i) { return std::string(40, 'a' + i % 26); });
+    pushBack<Route>("Route", [&](int i) { return *routes[i % routes.size()]; });
+    pushBack<PathFinding::PathStep>("PathStep", [&](int i) {
+        return PathFinding::PathStep(i % graph.size, routes[i % routes.size()], nullptr, i, i);
+    });
+
+    // A vector of vectors, as the per-port adjacency tables are built
+    long long sum = 0;
+    double ms = Bench::bestOf(5, [&]() {
+        Vector<Vector<int> > outer;
+        for (int i = 0; i < N / 16; i++) {
+            Vector<int> inner;
+            for (int j = 0; j < 16; j++) inner.push_back(j);
+            outer.push_back(std::move(inner));
+        }
+        sum = outer.size();
+    });
+    Bench::row("Vector push_back Vector<int>(16)", ms, sum);
+    ms = Bench::bestOf(5, [&]() {
+        std::vector<std::vector<int> > outer;
+        for (int i = 0; i < N / 16; i++) {
+            std::vector<int> inner;
+            for (int j = 0; j < 16; j++) inner.push_back(j);
+            outer.push_back(std::move(inner));
+        }
+        sum = outer.size();
+    });
+    Bench::row("std::vector push_back vector<int>(16)", ms, sum);
+
+    copy<std::string>("40-char strings", [](int i) { return std::string(40, 'a' + i % 26); });
+    copy<Route>("Routes", [&](int i) { return *routes[i % routes.size()]; });
+
+    // Reuse after clear() keeps the buffer
+    Vector<int> reused;
+    ms = Bench::bestOf(5, [&]() {
+        for (int round = 0; round < 100; round++) {
+            reused.clear();
+            for (int i = 0; i < N / 100; i++) reused.push_back(i);
+        }
+        sum = reused.size();
+    });
+    Bench::row("Vector clear + refill x100", ms, sum);
+    std::vector<int> stdReused;
+    ms = Bench::bestOf(5, [&]() {
+        for (int round = 0; round < 100; round++) {
+            stdReused.clear();
+            for (int i = 0; i < N / 100; i++) stdReused.push_back(i);
+        }
+        sum = stdReused.size();
+    });
+    Bench::row("std::vector clear + refill x100", ms, sum);
+    return 0;
+}
@@ -4,26 +4,99 @@
 #include <string>
 #include <fstream>
 #include <sstream>
+#include <memory>
 #include "Vertex.hpp"
+#include "service.h"
+#include "derivedTables.h"
+#include "hashMap.h"
+#include "sorting.h"
+#include "vector.h"
 using namespace std;
 
-class Graph {
+// Owned by a shared_ptr when it is a snapshot (timetableSnapshots.h)
+class Graph : public std::enable_shared_from_this<Graph> {
 public:
     Vertex* vertices;
     int size;
 
     Graph();
+    // A copy with the same version, for the next snapshot of a changing
+    // timetable (timetableSnapshots.h). Each port's sailings stay shared
+    // with other until one of the two changes them (RouteList).
+    Graph(const Graph& other);
+    Graph& operator=(const Graph&) = delete;
     ~Graph();
 
     void addPorts(std::string file);
     void addRoutes(std::string file);
-    int findPort(const std::string& name);
+    int findPort(const std::string& name) const;
+
+    // Weekly services, one line each (blank lines and # comments skipped):
+    //   Start Dest Days From To DeptTime ArrTime Cost Company [Except]
+    // Days is "Mon,Thu", "Daily" or seven 0/1 flags from Monday; From and
+    // To bound the dates it runs (D/M/YYYY); Except lists dates it does
+    // not run, comma-separated. Dated routes load as before, alongside.
+    void addServices(std::string file);
+    Vector<Service> services;
+
+    // Bumped whenever ports, routes or services are (re)loaded, so caches of search
+    // results can tell when the timetable changed under them
+    unsigned long long getVersion() const { return version; }
+
+    // Live changes to the timetable, made in place: getVersion stays put
+    // (timetableFeed.h patches the caches instead) and getRevision, which
+    // also counts reloads, moves on. Sailings are named as in the routes
+    // file; a weekly service's run is named by its date.
+    Route* findSailing(int from, const std::string& dest, const std::string& date,
+                       const std::string& deptTime, const std::string& company);
+    Route* addSailing(const Route& route);      // the stored copy; nullptr for unknown ports
+    bool cancelSailing(const Route* route);
+    void delaySailing(Route* route, int minutes);
+    int findServiceRun(int from, const std::string& dest, int day, const std::string& deptTime,
+                       const std::string& company) const;
+    bool cancelServiceRun(int service, int day);
+    unsigned long long getRevision() const { return revision; }
+
+    // Search tables built from this timetable (connections.h and the like)
+    mutable DerivedTables derived;
+
+    // Hash of every port, route and service in load order. Unlike getVersion it is
+    // stable across runs, so files derived from the timetable can be
+    // checked against it.
+    unsigned long long fingerprint() const;
+
+    // Companies are interned to dense ids as routes are loaded, so the
+    // searches can test them with bitsets instead of string compares
+    int findCompany(const std::string& name) const;
+    int getCompanyCount() const { return companyNames.size(); }
+    const std::string& getCompanyName(int id) const { return companyNames[id]; }
+
+private:
+    unsigned long long version;
+    unsigned long long revision;
+    HashMap<std::string, int> portIndex;  // name -> vertex index
+    HashMap<std::string, int> companyIndex;  // name -> company id
+    Vector<std::string> companyNames;  // company id -> name
+
+    int internCompany(const std::string& name);
 };
 
 // Implementation
 Graph::Graph() {
     vertices = nullptr;
     size = 0;
+    version = 0;
+    revision = 0;
+}
+
+Graph::Graph(const Graph& other)
+    : std::enable_shared_from_this<Graph>(), vertices(nullptr), size(other.size), services(other.services), derived(other.derived),
+      version(other.version), revision(other.revision), portIndex(other.portIndex),
+      companyIndex(other.companyIndex), companyNames(other.companyNames) {
+    if (size > 0) {
+        vertices = new Vertex[size];
+        for (int i = 0; i < size; i++) vertices[i] = other.vertices[i];
+    }
 }
 
 Graph::~Graph() {
@@ -39,22 +112,93 @@ void Graph::addPorts(string dest) {
     while (myFile >> portName >> charge) count++;
 
     size = count;
+    delete[] vertices;
     vertices = new Vertex[size];
+    services.clear();
+    version++;
+    revision++;
 
     myFile.clear();
     myFile.seekg(0, ios::beg);
 
+    portIndex.clear();
+    portIndex.reserve(size);
+
     count = 0;
     while (myFile >> portName >> charge) {
+        // First occurrence wins, same as the old linear search
+        if (!portIndex.contains(portName)) portIndex.insert(portName, count);
         vertices[count++].addPort(Port(portName, charge));
     }
     myFile.close();
 }
 
-int Graph::findPort(const string& name) {
-    for (int i = 0; i < size; i++)
-        if (vertices[i].port.name == name) return i;
-    return -1;
+// Called for every edge relaxation in the searches, so it goes through the
+// name index rather than scanning the vertex array
+int Graph::findPort(const string& name) const {
+    const int* index = portIndex.find(name);
+    return index ? *index : -1;
+}
+
+int Graph::findCompany(const string& name) const {
+    const int* id = companyIndex.find(name);
+    return id ? *id : -1;
+}
+
+int Graph::internCompany(const string& name) {
+    int* id = companyIndex.find(name);
+    if (id) return *id;
+    int newId = companyNames.size();
+    companyIndex.insert(name, newId);
+    companyNames.push_back(name);
+    return newId;
+}
+
+static void mixFingerprint(unsigned long long& h, const string& s) {
+    // FNV-1a, with a separator so adjacent fields cannot run together
+    for (unsigned char c : s) {
+        h ^= c;
+        h *= 1099511628211ull;
+    }
+    h ^= 0xff;
+    h *= 1099511628211ull;
+}
+
+static void mixFingerprint(unsigned long long& h, int value) {
+    for (int i = 0; i < 4; i++) {
+        h ^= (unsigned char)(value >> (8 * i));
+        h *= 1099511628211ull;
+    }
+}
+
+unsigned long long Graph::fingerprint() const {
+    unsigned long long h = 1469598103934665603ull;
+    mixFingerprint(h, size);
+    for (int u = 0; u < size; u++) {
+        mixFingerprint(h, vertices[u].port.name);
+        mixFingerprint(h, vertices[u].port.portCharge);
+        for (const Route& route : vertices[u].routes) {
+            mixFingerprint(h, route.dest.name);
+            mixFingerprint(h, route.date);
+            mixFingerprint(h, route.deptTime);
+            mixFingerprint(h, route.arrTime);
+            mixFingerprint(h, route.cost);
+            mixFingerprint(h, route.company);
+        }
+    }
+    for (const Service& service : services) {
+        mixFingerprint(h, service.from);
+        mixFingerprint(h, service.to);
+        mixFingerprint(h, service.weekdays);
+        mixFingerprint(h, service.firstDay);
+        mixFingerprint(h, service.lastDay);
+        for (int i = 0; i < service.exceptions.size(); i++) mixFingerprint(h, service.exceptions[i]);
+        mixFingerprint(h, service.pattern.deptTime);
+        mixFingerprint(h, service.pattern.arrTime);
+        mixFingerprint(h, service.pattern.cost);
+        mixFingerprint(h, service.pattern.company);
+    }
+    return h;
 }
 
 void Graph::addRoutes(string fileName) {
@@ -62,6 +206,9 @@ void Graph::addRoutes(string fileName) {
     string start, dest, date, dept, arr, company;
     int cost;
 
+    version++;
+    revision++;
+
     while (file >> start >> dest >> date >> dept >> arr >> cost >> company) {
         int u = findPort(start);
         int v = findPort(dest);
@@ -76,11 +223,136 @@ void Graph::addRoutes(string fileName) {
         r.arrTime = arr;
         r.cost = cost;
         r.company = company;
+        r.companyId = internCompany(company);
 
-        vertices[u].routes.insertEnd(r);
+        vertices[u].routes.edit().insertEnd(r);
     }
 }
 
-#endif
+void Graph::addServices(string fileName) {
+    ifstream file(fileName);
+    string line;
+
+    version++;
+    revision++;
+
+    while (getline(file, line)) {
+        istringstream fields(line);
+        string start, dest, days, from, to, dept, arr, company, except;
+        int cost;
+        if (!(fields >> start >> dest >> days >> from >> to >> dept >> arr >> cost >> company)) continue;
+        if (start[0] == '#') continue;
+        fields >> except;
+
+        int u = findPort(start);
+        int v = findPort(dest);
+        unsigned char weekdays = Service::parseWeekdays(days);
+        if (u == -1 || v == -1 || weekdays == 0) continue;
 
+        Service service;
+        service.from = u;
+        service.to = v;
+        service.weekdays = weekdays;
+        service.firstDay = TimeUtils::civilDay(from);
+        service.lastDay = TimeUtils::civilDay(to);
+        service.pattern.startPoint = vertices[u].port;
+        service.pattern.dest = vertices[v].port;
+        service.pattern.deptTime = dept;
+        service.pattern.arrTime = arr;
+        service.pattern.cost = cost;
+        service.pattern.company = company;
+        service.pattern.companyId = internCompany(company);
+        service.departureMinute = TimeUtils::timeToMinutes(dept);
+        service.duration = TimeUtils::timeToMinutes(arr) - service.departureMinute;
+        if (service.duration < 0) service.duration += 24 * 60;
 
+        size_t begin = 0;
+        while (begin < except.size()) {
+            size_t end = except.find(',', begin);
+            if (end == string::npos) end = except.size();
+            service.exceptions.push_back(TimeUtils::civilDay(except.substr(begin, end - begin)));
+            begin = end + 1;
+        }
+        Sorting::mergeSort(service.exceptions, [](int a, int b) { return a < b; });
+
+        vertices[u].services.push_back(services.size());
+        services.push_back(std::move(service));
+    }
+}
+
+Route* Graph::findSailing(int from, const string& dest, const string& date, const string& deptTime,
+                          const string& company) {
+    if (from < 0 || from >= size) return nullptr;
+    for (Route& route : vertices[from].routes.edit()) {
+        if (route.dest.name == dest && route.deptTime == deptTime && route.company == company &&
+            TimeUtils::dateToDays(route.date) == TimeUtils::dateToDays(date)) {
+            return &route;
+        }
+    }
+    return nullptr;
+}
+
+Route* Graph::addSailing(const Route& route) {
+    int u = findPort(route.startPoint.name);
+    int v = findPort(route.dest.name);
+    if (u == -1 || v == -1) return nullptr;
+
+    Route r = route;
+    r.startPoint = vertices[u].port;
+    r.dest = vertices[v].port;
+    r.companyId = internCompany(r.company);
+    LinkedList<Route>& routes = vertices[u].routes.edit();
+    routes.insertEnd(r);
+    revision++;
+    return &routes.back();
+}
+
+bool Graph::cancelSailing(const Route* route) {
+    int u = findPort(route->startPoint.name);
+    if (u == -1 || !vertices[u].routes.edit().remove(route)) return false;
+    revision++;
+    return true;
+}
+
+// Both times move by minutes, the date with the departure; the arrival
+// keeps rolling over midnight as before
+void Graph::delaySailing(Route* route, int minutes) {
+    int departure = TimeUtils::timeToMinutes(route->deptTime) + minutes;
+    int days = (departure >= 0) ? departure / (24 * 60) : -((-departure + 24 * 60 - 1) / (24 * 60));
+    departure -= days * 24 * 60;
+    int arrival = (TimeUtils::timeToMinutes(route->arrTime) + minutes) % (24 * 60);
+    if (arrival < 0) arrival += 24 * 60;
+
+    if (days != 0) route->date = TimeUtils::civilDate(TimeUtils::civilDay(route->date) + days);
+    route->deptTime = TimeUtils::minutesToTime(departure);
+    route->arrTime = TimeUtils::minutesToTime(arrival);
+    revision++;
+}
+
+int Graph::findServiceRun(int from, const string& dest, int day, const string& deptTime,
+                          const string& company) const {
+    if (from < 0 || from >= size) return -1;
+    const Vector<int>& leaving = vertices[from].services;
+    for (int i = 0; i < leaving.size(); i++) {
+        const Service& service = services[leaving[i]];
+        if (service.pattern.dest.name == dest && service.pattern.deptTime == deptTime &&
+            service.pattern.company == company && service.runsOn(day)) {
+            return leaving[i];
+        }
+    }
+    return -1;
+}
+
+bool Graph::cancelServiceRun(int service, int day) {
+    if (service < 0 || service >= services.size() || !services[service].runsOn(day)) return false;
+    Vector<int>& exceptions = services[service].exceptions;
+    exceptions.push_back(day);
+    for (int i = exceptions.size() - 1; i > 0 && exceptions[i - 1] > day; i--) {
+        exceptions[i] = exceptions[i - 1];
+        exceptions[i - 1] = day;
+    }
+    revision++;
+    return true;
+}
+
+#endif
@@ -12,6 +12,7 @@ struct Route {
     string arrTime;
     int cost;
     string company;
+    int companyId = -1;  // interned by Graph::addRoutes
 };
 
 #endif
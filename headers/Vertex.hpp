@@ -1,13 +1,47 @@
 #ifndef VERTEX_HPP
 #define VERTEX_HPP
 
+#include <memory>
 #include "Port.hpp"
 #include "Route.h"
 #include "linkedList.h"   // your provided linked list template
+#include "vector.h"
+
+// A port's dated sailings. A copied Vertex (the next snapshot of a
+// changing timetable, timetableSnapshots.h) shares the list with the one
+// it was copied from; edit() gives it a list of its own first, so a
+// snapshot only copies the ports a change touches. The count is only
+// checked by the one writer, and other holders can only let go, so a
+// stale count costs a copy at worst.
+class RouteList {
+public:
+    typedef LinkedList<Route>::const_iterator const_iterator;
+
+    RouteList() : list(std::make_shared<LinkedList<Route> >()) {}
+
+    const_iterator begin() const { return items().begin(); }
+    const_iterator end() const { return items().end(); }
+    int getSize() const { return items().getSize(); }
+    bool isEmpty() const { return items().isEmpty(); }
+
+    bool isShared() const { return list.use_count() > 1; }
+
+    // The list to change
+    LinkedList<Route>& edit() {
+        if (isShared()) list = std::make_shared<LinkedList<Route> >(*list);
+        return *list;
+    }
+
+private:
+    std::shared_ptr<LinkedList<Route> > list;
+
+    const LinkedList<Route>& items() const { return *list; }
+};
 
 struct Vertex {
     Port port;
-    LinkedList<Route> routes;
+    RouteList routes;
+    Vector<int> services;   // weekly services leaving here, indices into Graph::services
 
     int minCost;
     int parentIndex;
@@ -0,0 +1,181 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <utility>
+#include <type_traits>
+#ifdef ARENA_DEBUG
+#include <iostream>
+#endif
+
+// Bump-pointer arena for everything a single query allocates.
+// Objects are carved out of chunks that double in size and are never freed
+// one by one: reset() destroys every object (in reverse creation order) and
+// rewinds the arena for the next query, keeping the largest chunk around.
+// Build with -DARENA_DEBUG to print peak usage each time a query is reset.
+class Arena {
+private:
+    static const size_t DEFAULT_CHUNK_BYTES = 16 * 1024;
+    static const size_t MAX_CHUNK_BYTES = 1024 * 1024;
+
+    struct Chunk {
+        Chunk* next;
+        size_t capacity;
+        size_t used;
+
+        char* data() { return reinterpret_cast<char*>(this + 1); }
+    };
+
+    // Destructor to run on reset for objects that need one
+    struct Finalizer {
+        void (*destroy)(void*);
+        void* object;
+        Finalizer* next;
+    };
+
+    const char* label;
+    size_t firstChunkBytes;
+    Chunk* chunks;          // current chunk first
+    Finalizer* finalizers;  // most recent first
+    size_t bytesUsed;
+    size_t peakBytes;
+    int allocationCount;
+
+    template <typename T>
+    static void destroyObject(void* p) {
+        static_cast<T*>(p)->~T();
+    }
+
+    void addChunk(size_t minBytes) {
+        size_t capacity = chunks ? chunks->capacity * 2 : firstChunkBytes;
+        if (capacity > MAX_CHUNK_BYTES) capacity = MAX_CHUNK_BYTES;
+        if (capacity < minBytes) capacity = minBytes;
+
+        Chunk* chunk = static_cast<Chunk*>(::operator new(sizeof(Chunk) + capacity));
+        chunk->next = chunks;
+        chunk->capacity = capacity;
+        chunk->used = 0;
+        chunks = chunk;
+    }
+
+    static size_t alignedOffset(Chunk* chunk, size_t align) {
+        uintptr_t base = reinterpret_cast<uintptr_t>(chunk->data());
+        uintptr_t next = (base + chunk->used + align - 1) & ~(uintptr_t)(align - 1);
+        return (size_t)(next - base);
+    }
+
+    void runFinalizers() {
+        while (finalizers) {
+            Finalizer* f = finalizers;
+            finalizers = f->next;
+            f->destroy(f->object);
+        }
+    }
+
+    // Not always the current one: a chunk made for one oversized request
+    // is followed by a chunk capped at MAX_CHUNK_BYTES
+    Chunk* largestChunk() const {
+        Chunk* largest = chunks;
+        for (Chunk* c = chunks; c; c = c->next) {
+            if (c->capacity > largest->capacity) largest = c;
+        }
+        return largest;
+    }
+
+    void releaseChunks(Chunk* keep) {
+        Chunk* chunk = chunks;
+        while (chunk) {
+            Chunk* next = chunk->next;
+            if (chunk != keep) ::operator delete(chunk);
+            chunk = next;
+        }
+        chunks = keep;
+        if (keep) {
+            keep->next = nullptr;
+            keep->used = 0;
+        }
+    }
+
+public:
+    explicit Arena(const char* name = "arena", size_t firstChunk = DEFAULT_CHUNK_BYTES)
+        : label(name), firstChunkBytes(firstChunk), chunks(nullptr), finalizers(nullptr),
+          bytesUsed(0), peakBytes(0), allocationCount(0) {}
+
+    ~Arena() {
+        reset();
+        releaseChunks(nullptr);
+    }
+
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    void* allocate(size_t bytes, size_t align = alignof(std::max_align_t)) {
+        if (!chunks) addChunk(bytes + align);
+
+        size_t offset = alignedOffset(chunks, align);
+        if (offset + bytes > chunks->capacity) {
+            addChunk(bytes + align);
+            offset = alignedOffset(chunks, align);
+        }
+
+        void* p = chunks->data() + offset;
+        bytesUsed += (offset - chunks->used) + bytes;
+        if (bytesUsed > peakBytes) peakBytes = bytesUsed;
+        chunks->used = offset + bytes;
+        allocationCount++;
+        return p;
+    }
+
+    // Construct a T in the arena. Its destructor runs on reset().
+    template <typename T, typename... Args>
+    T* create(Args&&... args) {
+        void* mem = allocate(sizeof(T), alignof(T));
+        T* obj = new (mem) T(std::forward<Args>(args)...);
+        if (!std::is_trivially_destructible<T>::value) {
+            Finalizer* f = static_cast<Finalizer*>(allocate(sizeof(Finalizer), alignof(Finalizer)));
+            f->destroy = &destroyObject<T>;
+            f->object = obj;
+            f->next = finalizers;
+            finalizers = f;
+        }
+        return obj;
+    }
+
+    // Uninitialized storage for n trivially destructible values
+    template <typename T>
+    T* allocateArray(int n) {
+        static_assert(std::is_trivially_destructible<T>::value,
+                      "allocateArray is for plain data; use create() for objects");
+        return static_cast<T*>(allocate(sizeof(T) * n, alignof(T)));
+    }
+
+    // End of query: destroy everything and rewind
+    void reset() {
+#ifdef ARENA_DEBUG
+        if (allocationCount > 0) {
+            std::cerr << "[arena] " << label << ": peak " << peakBytes << " bytes, "
+                      << allocationCount << " allocations, "
+                      << getChunkCount() << " chunk(s)" << std::endl;
+        }
+#endif
+        runFinalizers();
+        releaseChunks(largestChunk());
+        bytesUsed = 0;
+        peakBytes = 0;
+        allocationCount = 0;
+    }
+
+    size_t getBytesUsed() const { return bytesUsed; }
+    size_t getPeakBytes() const { return peakBytes; }
+    int getAllocationCount() const { return allocationCount; }
+
+    int getChunkCount() const {
+        int count = 0;
+        for (Chunk* c = chunks; c; c = c->next) count++;
+        return count;
+    }
+};
+
+#endif
@@ -0,0 +1,62 @@
+#ifndef BINARYFILE_H
+#define BINARYFILE_H
+
+#include <fstream>
+#include "Graph.hpp"
+#include "vector.h"
+
+// Helpers for the binary files derived from a timetable (landmark tables,
+// transfer patterns). Every file starts with the same header; the graph
+// fingerprint in it lets a loader reject a file built for another
+// timetable. Values are written as native-endian int32.
+class BinaryFile {
+public:
+    static void writeHeader(std::ofstream& out, unsigned int magic, unsigned int formatVersion,
+                            const Graph& graph, int itemCount) {
+        Header header;
+        header.magic = magic;
+        header.formatVersion = formatVersion;
+        header.fingerprint = graph.fingerprint();
+        header.portCount = graph.size;
+        header.itemCount = itemCount;
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    }
+
+    // False unless the header matches magic/formatVersion and graph.
+    // itemCount is whatever the writer stored (e.g. the landmark count).
+    static bool readHeader(std::ifstream& in, unsigned int magic, unsigned int formatVersion,
+                           const Graph& graph, int& itemCount) {
+        Header header;
+        if (!in.read(reinterpret_cast<char*>(&header), sizeof(header))) return false;
+        if (header.magic != magic || header.formatVersion != formatVersion ||
+            header.portCount != graph.size || header.fingerprint != graph.fingerprint()) {
+            return false;
+        }
+        itemCount = header.itemCount;
+        return true;
+    }
+
+    static void writeInts(std::ofstream& out, const Vector<int>& values) {
+        if (values.size() > 0) {
+            out.write(reinterpret_cast<const char*>(values.begin()), sizeof(int) * values.size());
+        }
+    }
+
+    static bool readInts(std::ifstream& in, Vector<int>& values, int n) {
+        if (n < 0) return false;
+        values.resize(n);
+        if (n == 0) return true;
+        return (bool)in.read(reinterpret_cast<char*>(values.begin()), sizeof(int) * n);
+    }
+
+private:
+    struct Header {
+        unsigned int magic;
+        unsigned int formatVersion;
+        unsigned long long fingerprint;
+        int portCount;
+        int itemCount;
+    };
+};
+
+#endif
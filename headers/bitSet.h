@@ -0,0 +1,111 @@
+#ifndef BITSET_H
+#define BITSET_H
+
+#include <cstddef>
+#include "vector.h"
+
+// Fixed-size set of small integer ids (port indices, company ids) packed
+// 64 per word. Membership is one shift and one AND.
+class BitSet {
+private:
+    Vector<unsigned long long> words;
+    int bitCount;
+
+public:
+    BitSet() : bitCount(0) {}
+
+    explicit BitSet(int bits, bool value = false) : bitCount(0) {
+        resize(bits, value);
+    }
+
+    // Resize to bits, setting every bit to value
+    void resize(int bits, bool value = false) {
+        bitCount = bits < 0 ? 0 : bits;
+        int wordCount = (bitCount + 63) / 64;
+        words.clear();
+        words.reserve(wordCount);
+        for (int i = 0; i < wordCount; i++) {
+            words.push_back(value ? ~0ull : 0ull);
+        }
+        // Keep bits past the end clear so count() stays exact
+        if (value && (bitCount & 63)) {
+            words[wordCount - 1] = (1ull << (bitCount & 63)) - 1;
+        }
+    }
+
+    // Out-of-range ids (e.g. -1 for "unknown") read as not set
+    bool test(int i) const {
+        if ((unsigned)i >= (unsigned)bitCount) return false;
+        return (words[i >> 6] >> (i & 63)) & 1ull;
+    }
+
+    void set(int i) {
+        if ((unsigned)i < (unsigned)bitCount) words[i >> 6] |= 1ull << (i & 63);
+    }
+
+    void reset(int i) {
+        if ((unsigned)i < (unsigned)bitCount) words[i >> 6] &= ~(1ull << (i & 63));
+    }
+
+    void setAll() { resize(bitCount, true); }
+    void clearAll() { resize(bitCount, false); }
+
+    int count() const {
+        int total = 0;
+        for (int i = 0; i < words.size(); i++) total += __builtin_popcountll(words[i]);
+        return total;
+    }
+
+    bool any() const {
+        for (int i = 0; i < words.size(); i++) {
+            if (words[i]) return true;
+        }
+        return false;
+    }
+
+    // Every bit set here is also set in other. Sets may differ in size:
+    // ids past the end of either read as not set.
+    bool isSubsetOf(const BitSet& other) const {
+        for (int i = 0; i < words.size(); i++) {
+            unsigned long long theirs = i < other.words.size() ? other.words[i] : 0ull;
+            if (words[i] & ~theirs) return false;
+        }
+        return true;
+    }
+
+    // Add every bit set in other that fits in this set's size
+    BitSet& operator|=(const BitSet& other) {
+        int common = words.size() < other.words.size() ? words.size() : other.words.size();
+        for (int i = 0; i < common; i++) words[i] |= other.words[i];
+        // Keep bits past the end clear so count() stays exact
+        if (common == words.size() && common > 0 && (bitCount & 63)) {
+            words[common - 1] &= (1ull << (bitCount & 63)) - 1;
+        }
+        return *this;
+    }
+
+    bool operator==(const BitSet& other) const {
+        if (bitCount != other.bitCount) return false;
+        for (int i = 0; i < words.size(); i++) {
+            if (words[i] != other.words[i]) return false;
+        }
+        return true;
+    }
+
+    bool operator!=(const BitSet& other) const { return !(*this == other); }
+
+    // For use in hash keys
+    size_t hash() const {
+        unsigned long long h = 1469598103934665603ull ^ (unsigned long long)bitCount;
+        for (int i = 0; i < words.size(); i++) {
+            h ^= words[i];
+            h *= 1099511628211ull;
+            h ^= h >> 29;
+        }
+        return (size_t)h;
+    }
+
+    int size() const { return bitCount; }
+};
+
+#endif
@@ -44,6 +44,7 @@ struct BoatSimulationMenu {
     // Layover management using data structure
     LayoverInfo currentLayover;  // Current active layover
     Queue<LayoverInfo> layoverQueue;  // Queue to manage upcoming layovers
+    Vector<int> simPorts;  // Port sequence of the route being simulated (indexed per frame)
     
     // Animation speed
     float boatSpeed;  // Units per second
@@ -132,6 +133,7 @@ struct BoatSimulationMenu {
         while (!layoverQueue.isEmpty()) {
             layoverQueue.dequeue();
         }
+        simPorts.clear();
     }
     
     void initializeRoute() {
@@ -155,14 +157,20 @@ struct BoatSimulationMenu {
                     layoverQueue.dequeue();
                 }
                 
+                // Copy the port sequence once so update() can index it every frame
+                simPorts.clear();
+                simPorts.reserve(route.path->path.getSize());
+                for (int portIdx : route.path->path) {
+                    simPorts.push_back(portIdx);
+                }
+                
                 // Pre-populate layover queue with all intermediate ports (layovers)
-                for (int i = 1; i < route.path->path.getSize() - 1; i++) {
-                    int layoverPortIdx = route.path->path.get(i);
-                    layoverQueue.enqueue(LayoverInfo(layoverPortIdx));
+                for (int i = 1; i < simPorts.size() - 1; i++) {
+                    layoverQueue.enqueue(LayoverInfo(simPorts[i]));
                 }
                 
                 // Set boat at origin port
-                int originIdx = route.path->path.get(0);
+                int originIdx = simPorts[0];
                 if (originIdx >= 0 && originIdx < positions.size()) {
                     boatSprite.setPosition(positions[originIdx]);
                 }
@@ -200,14 +208,14 @@ struct BoatSimulationMenu {
         }
         
         // Check if we've reached the end
-        if (currentSegment >= route.path->path.getSize() - 1) {
+        if (currentSegment >= simPorts.size() - 1) {
             isAnimating = false;
             return;
         }
         
         // Get current and next port indices
-        int currentPortIdx = route.path->path.get(currentSegment);
-        int nextPortIdx = route.path->path.get(currentSegment + 1);
+        int currentPortIdx = simPorts[currentSegment];
+        int nextPortIdx = simPorts[currentSegment + 1];
         
         // Get positions
         if (currentPortIdx < 0 || currentPortIdx >= positions.size() ||
@@ -233,7 +241,7 @@ struct BoatSimulationMenu {
             segmentProgress = 1.0f;
             
             // Check if this is a layover (not the last segment)
-            if (currentSegment < route.path->path.getSize() - 2) {
+            if (currentSegment < simPorts.size() - 2) {
                 // This is a layover port - get from queue
                 if (!layoverQueue.isEmpty()) {
                     currentLayover = layoverQueue.dequeue();
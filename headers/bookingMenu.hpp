@@ -2,6 +2,7 @@
 #define BOOKINGMENU_HPP
 
 #include <SFML/Graphics.hpp>
+#include <memory>
 #include <string>
 #include <sstream>
 #include "Graph.hpp"
@@ -9,6 +10,13 @@
 #include "bookingSystem.hpp"
 #include "uiHelpers.hpp"
 #include "vector.h"
+#include "arena.h"
+#include "queryCache.h"
+#include "hashMap.h"
+#include "profileSearch.h"
+#include "searchWorker.h"
+#include "pathEnumerator.h"
+#include "timetableSnapshots.h"
 
 struct BookingMenu {
     // Origin and Destination selection
@@ -37,6 +45,10 @@ struct BookingMenu {
     sf::Text directPathsTxt;
     sf::Text connectedPathsTxt;
     
+    // Pareto options over a window of days starting at departureDate
+    sf::RectangleShape flexibleDatesBtn;
+    sf::Text flexibleDatesTxt;
+    
     // Book button
     sf::RectangleShape bookBtn;
     sf::Text bookBtnTxt;
@@ -69,10 +81,25 @@ struct BookingMenu {
     sf::Text nextBtnTxt;
     sf::Text routeCounterTxt;
     
-    // Available routes
+    // Available routes (owned by queryArena, freed together on the next search)
     Vector<PathFinding::PathResult*> availableRoutes;
+    Arena queryArena{"booking search"};
     int currentRouteIndex;
     bool showingDirectPaths;
+    bool showingProfile;
+    SearchQuery pendingQuery;   // connected paths running on the search worker
+    
+    // Connected paths stream in cheapest first, a page at a time: the
+    // enumerator runs in short slices on the search worker until the page
+    // is full, and Next past the last one asks for another page. Capping
+    // the pages lets the enumerator prune what cannot make the cut.
+    static const int CONNECTED_PAGE = 15;
+    static const int CONNECTED_PAGES = 4;
+    static const int CONNECTED_SLICE_MS = 5;
+    std::shared_ptr<PathEnumerator<> > connectedSearch;
+    TimetableSnapshots::Snapshot connectedGraph;   // the timetable connectedSearch reads
+    HashSet<std::string> connectedKeys;     // paths listed so far
+    int connectedTarget;                    // availableRoutes size that ends the page
     
     // Results display
     sf::RectangleShape resultsArea;
@@ -104,6 +131,8 @@ struct BookingMenu {
           connectedPathsBtn(sf::Vector2f(170.f, 50.f)),
           directPathsTxt(),
           connectedPathsTxt(),
+          flexibleDatesBtn(sf::Vector2f(340.f, 50.f)),
+          flexibleDatesTxt(),
           bookBtn(sf::Vector2f(340.f, 50.f)),
           bookBtnTxt(),
           showSubgraphBtn(sf::Vector2f(340.f, 50.f)),
@@ -122,6 +151,8 @@ struct BookingMenu {
           availableRoutes(),
           currentRouteIndex(-1),
           showingDirectPaths(false),
+          showingProfile(false),
+          connectedTarget(0),
           resultsArea(sf::Vector2f(360.f, 200.f)),
           resultHeader(),
           resultBody(),
@@ -172,6 +203,12 @@ struct BookingMenu {
         connectedPathsTxt.setCharacterSize(15);
         connectedPathsTxt.setFillColor(sf::Color::White);
         
+        flexibleDatesBtn.setFillColor(btnNormal);
+        flexibleDatesTxt.setFont(font);
+        flexibleDatesTxt.setString("Best Options: Next " + std::to_string(ProfileSearch::DEFAULT_WINDOW_DAYS) + " Days");
+        flexibleDatesTxt.setCharacterSize(15);
+        flexibleDatesTxt.setFillColor(sf::Color::White);
+        
         // Setup book button
         bookBtn.setFillColor(btnNormal);
         bookBtnTxt.setFont(font);
@@ -280,6 +317,9 @@ struct BookingMenu {
         showDetailsBtn.setPosition(panelX + 30, startY + 330);
         showDetailsBtnTxt.setPosition(panelX + 70, startY + 345);
         
+        flexibleDatesBtn.setPosition(panelX + 30, startY + 390);
+        flexibleDatesTxt.setPosition(panelX + 50, startY + 405);
+        
         // Route details positions
         float detailsAreaHeight = winH - 120 - 120; // Leave space at top (100) and bottom (120 for back button)
         detailsArea.setSize(sf::Vector2f(360.f, detailsAreaHeight));
@@ -340,34 +380,23 @@ struct BookingMenu {
         }
     }
 
-    void updateAvailableDates(Graph& graph) {
+    void updateAvailableDates(const Graph& graph) {
         availableDates.clear();
-        // Use vector to track unique dates (no built-in structures)
         Vector<std::string> dateList;
+        HashSet<std::string> seenDates;
         
         // If origin and destination are selected, show dates for both direct and connected routes
         if (selectedOriginIndex != -1 && selectedDestIndex != -1) {
             // Check direct routes
             for (int i = 0; i < graph.size; i++) {
                 if (i != selectedOriginIndex) continue;
-                LinkedList<Route>::Node* node = graph.vertices[i].routes.head;
-                while (node != nullptr) {
-                    Route& route = node->data;
+                for (const Route& route : graph.vertices[i].routes) {
                     int destIdx = graph.findPort(route.dest.name);
                     if (destIdx == selectedDestIndex) {
-                        // Check if date already exists
-                        bool exists = false;
-                        for (const std::string& d : dateList) {
-                            if (d == route.date) {
-                                exists = true;
-                                break;
-                            }
-                        }
-                        if (!exists) {
+                        if (seenDates.insert(route.date)) {
                             dateList.push_back(route.date);
                         }
                     }
-                    node = node->next;
                 }
             }
             
@@ -375,58 +404,30 @@ struct BookingMenu {
             // Any connected path will start with one of these routes, so collect all dates
             // from all routes starting at the origin (we already have direct routes above)
             // This is much more efficient than exploring all paths
-            LinkedList<Route>::Node* originRouteNode = graph.vertices[selectedOriginIndex].routes.head;
-            while (originRouteNode != nullptr) {
-                Route& route = originRouteNode->data;
-                // Check if date already exists
-                bool exists = false;
-                for (const std::string& d : dateList) {
-                    if (d == route.date) {
-                        exists = true;
-                        break;
-                    }
-                }
-                if (!exists) {
+            for (const Route& route : graph.vertices[selectedOriginIndex].routes) {
+                if (seenDates.insert(route.date)) {
                     dateList.push_back(route.date);
                 }
-                originRouteNode = originRouteNode->next;
             }
+            addServiceDates(graph, selectedOriginIndex, seenDates, dateList);
         } else {
             // If only origin is selected, show dates from that origin
             if (selectedOriginIndex != -1) {
-                LinkedList<Route>::Node* node = graph.vertices[selectedOriginIndex].routes.head;
-                while (node != nullptr) {
-                    // Check if date already exists
-                    bool exists = false;
-                    for (const std::string& d : dateList) {
-                        if (d == node->data.date) {
-                            exists = true;
-                            break;
-                        }
+                for (const Route& route : graph.vertices[selectedOriginIndex].routes) {
+                    if (seenDates.insert(route.date)) {
+                        dateList.push_back(route.date);
                     }
-                    if (!exists) {
-                        dateList.push_back(node->data.date);
-                    }
-                    node = node->next;
                 }
+                addServiceDates(graph, selectedOriginIndex, seenDates, dateList);
             } else {
                 // Show all dates from all routes
                 for (int i = 0; i < graph.size; i++) {
-                    LinkedList<Route>::Node* node = graph.vertices[i].routes.head;
-                    while (node != nullptr) {
-                        // Check if date already exists
-                        bool exists = false;
-                        for (const std::string& d : dateList) {
-                            if (d == node->data.date) {
-                                exists = true;
-                                break;
-                            }
-                        }
-                        if (!exists) {
-                            dateList.push_back(node->data.date);
+                    for (const Route& route : graph.vertices[i].routes) {
+                        if (seenDates.insert(route.date)) {
+                            dateList.push_back(route.date);
                         }
-                        node = node->next;
                     }
+                    addServiceDates(graph, i, seenDates, dateList);
                 }
             }
         }
@@ -444,7 +445,7 @@ struct BookingMenu {
         }
     }
 
-    bool handleClick(Graph& graph,
+    bool handleClick(const Graph& graph,
                     const sf::Vector2f& mouseGlobal,
                     float panelX,
                     float winH,
@@ -509,6 +510,14 @@ struct BookingMenu {
             }
             return true;
         }
+        else if (flexibleDatesBtn.getGlobalBounds().contains(mouseGlobal)) {
+            if (selectedOriginIndex != -1 && selectedDestIndex != -1 && !departureDate.empty()) {
+                showingRouteDetails = false;
+                findProfilePaths(graph, currentPathResult);
+                updateCurrentPathResult(currentPathResult);
+            }
+            return true;
+        }
         // Handle book button
         else if (bookBtn.getGlobalBounds().contains(mouseGlobal)) {
             if (availableRoutes.size() > 0 && currentRouteIndex >= 0) {
@@ -544,6 +553,7 @@ struct BookingMenu {
                 return true;
             }
             else if (nextRect.contains(mouseGlobal)) {
+                if (currentRouteIndex == availableRoutes.size() - 1) findMoreConnected();
                 navigateNext(currentPathResult, resultTextString);
                 return true;
             }
@@ -552,254 +562,231 @@ struct BookingMenu {
         return false;
     }
 
-    void findDirectPaths(Graph& graph, PathFinding::PathResult*& currentPathResult) {
-        // Clean up old routes (but don't delete if currentPathResult points to them)
-        for (auto* route : availableRoutes) {
-            if (route != currentPathResult) {
-                delete route;
-            }
-        }
+    void findDirectPaths(const Graph& graph, PathFinding::PathResult*& currentPathResult) {
+        SearchWorker::get().cancel(SearchWorker::BOOKING_CONNECTED);
+        connectedSearch.reset();
+        connectedGraph.reset();
+        // Old results (including currentPathResult if it was one) all live in
+        // queryArena, so one reset frees them
         availableRoutes.clear();
-        // Reset currentPathResult if it was in availableRoutes
+        queryArena.reset();
         currentPathResult = nullptr;
         
         showingDirectPaths = true;
+        showingProfile = false;
+        
+        // Results depend on bookings, so booking changes invalidate them
+        SearchQuery query(SearchQuery::BOOKING_DIRECT, selectedOriginIndex, selectedDestIndex, departureDate);
+        if (!SearchCache::lookup(query, graph, queryArena, availableRoutes)) {
+            collectDirectPaths(graph);
+            SearchCache::store(query, graph, availableRoutes, true);
+        }
         
+        currentRouteIndex = -1;
+        if (availableRoutes.size() > 0) {
+            currentRouteIndex = 0;
+        }
+    }
+
+    // Days the weekly services from port run on
+    static void addServiceDates(const Graph& graph, int port, HashSet<std::string>& seenDates,
+                                Vector<std::string>& dateList) {
+        const Vector<int>& services = graph.vertices[port].services;
+        for (int k = 0; k < services.size(); k++) {
+            const Service& service = graph.services[services[k]];
+            for (int day = service.nextRun(service.firstDay); day >= 0; day = service.nextRun(day + 1)) {
+                std::string date = TimeUtils::civilDate(day);
+                if (seenDates.insert(date)) dateList.push_back(date);
+            }
+        }
+    }
+
+    void collectDirectPaths(const Graph& graph) {
         // Find direct routes (single route segment)
-        for (int i = 0; i < graph.size; i++) {
-            if (i != selectedOriginIndex) continue;
-            
-            LinkedList<Route>::Node* node = graph.vertices[i].routes.head;
-            while (node != nullptr) {
-                Route& route = node->data;
+        if (selectedOriginIndex >= 0) {
+            for (const Route& route : graph.vertices[selectedOriginIndex].routes) {
                 int destIdx = graph.findPort(route.dest.name);
                 
                 if (destIdx == selectedDestIndex && route.date == departureDate) {
                     // Create a path result for this direct route
-                    PathFinding::PathResult* result = new PathFinding::PathResult();
-                    result->found = true;
-                    result->path.insertEnd(selectedOriginIndex);
-                    result->path.insertEnd(selectedDestIndex);
-                    result->routes.insertEnd(route);
-                    result->totalCost = route.cost;
-                    
-                    // Calculate time
-                    long long dep = TimeUtils::toAbsoluteMinutes(route.date, route.deptTime);
-                    long long arr = TimeUtils::toAbsoluteMinutes(route.date, route.arrTime);
-                    if (arr < dep) arr += 24 * 60;
-                    result->totalTime = (int)(arr - dep);
+                    PathFinding::PathStep origin(selectedOriginIndex, nullptr, nullptr, 0, 0);
+                    PathFinding::PathStep dest(selectedDestIndex, &route, &origin, route.cost, 0);
+                    PathFinding::PathResult* result = PathFinding::buildResult(&dest, queryArena);
                     
-                    // Check if available (not booked)
+                    // Check if available (not booked); unavailable ones are
+                    // reclaimed with the arena
                     if (BookingSystem::isRouteAvailable(result, departureDate)) {
                         availableRoutes.push_back(result);
-                    } else {
-                        delete result;
                     }
                 }
-                node = node->next;
             }
-        }
-        
-        // Note: Routes are already filtered for availability when added above
-        // No need to filter again as we already check isRouteAvailable before adding
-        
-        currentRouteIndex = -1;
-        if (availableRoutes.size() > 0) {
-            currentRouteIndex = 0;
-        }
-    }
 
-    void findConnectedPaths(Graph& graph, PathFinding::PathResult*& currentPathResult) {
-        // Clean up old routes (but don't delete if currentPathResult points to them)
-        for (int i = 0; i < availableRoutes.size(); i++) {
-            if (availableRoutes[i] != currentPathResult) {
-                delete availableRoutes[i];
+            // Weekly services running that day
+            int day = TimeUtils::civilDay(departureDate);
+            const Vector<int>& services = graph.vertices[selectedOriginIndex].services;
+            for (int k = 0; k < services.size(); k++) {
+                const Service& service = graph.services[services[k]];
+                if (service.to != selectedDestIndex || !service.runsOn(day)) continue;
+                PathFinding::PathStep origin(selectedOriginIndex, nullptr, nullptr, 0, 0);
+                PathFinding::PathStep dest(selectedDestIndex, &service.pattern, &origin, service.pattern.cost, 0, day);
+                PathFinding::PathResult* result = PathFinding::buildResult(&dest, queryArena);
+                if (BookingSystem::isRouteAvailable(result, departureDate)) {
+                    availableRoutes.push_back(result);
+                }
             }
         }
+    }
+
+    void findConnectedPaths(const Graph& graph, PathFinding::PathResult*& currentPathResult) {
         availableRoutes.clear();
-        // Reset currentPathResult if it was in availableRoutes
+        queryArena.reset();
         currentPathResult = nullptr;
         
         showingDirectPaths = false;
+        showingProfile = false;
+        currentRouteIndex = -1;
         
-        // Use BFS to find multiple connected paths
-        struct PathState {
-            int current;
-            Vector<int> path;
-            Vector<Route> routes;
-            int cost;
-            long long arrivalTime;
-            
-            PathState() : current(-1), cost(0), arrivalTime(0) {}
-        };
-        
-        const int MAX_PATHS = 15;
-        const int MAX_DEPTH = 8;
-        
-        Vector<PathState> queue;
-        PathState initial;
-        initial.current = selectedOriginIndex;
-        initial.path.push_back(selectedOriginIndex);
-        initial.arrivalTime = 0;
-        queue.push_back(initial);
-        
-        Vector<PathFinding::PathResult*> allPaths;
-        
-        while (queue.size() > 0 && allPaths.size() < MAX_PATHS) {
-            PathState state = queue[0];
-            queue.erase(0);
-            
-            if (state.current == selectedDestIndex && state.path.size() > 2) {
-                // Connected paths must have more than 2 nodes (at least origin -> intermediate -> destination)
-                // This excludes direct paths which have exactly 2 nodes
-                // Check if first route matches departure date
-                if (state.routes.size() > 1 && state.routes[0].date == departureDate) {
-                    // Create a new PathResult for this path
-                    PathFinding::PathResult* result = new PathFinding::PathResult();
-                    result->found = true;
-                    result->totalCost = state.cost;
-                    result->totalTime = 0;
-                    
-                    // PathResult constructor already initializes empty LinkedLists
-                    // Copy path nodes
-                    for (int i = 0; i < state.path.size(); i++) {
-                        result->path.insertEnd(state.path[i]);
-                    }
-                    
-                    // Copy route nodes
-                    for (int i = 0; i < state.routes.size(); i++) {
-                        result->routes.insertEnd(state.routes[i]);
-                    }
-                    
-                    // Calculate total time
-                    if (state.routes.size() > 0) {
-                        Route first = state.routes[0];
-                        Route last = state.routes[state.routes.size() - 1];
-                        long long startT = TimeUtils::toAbsoluteMinutes(first.date, first.deptTime);
-                        long long lastDep = TimeUtils::toAbsoluteMinutes(last.date, last.deptTime);
-                        long long lastArr = TimeUtils::toAbsoluteMinutes(last.date, last.arrTime);
-                        if (lastArr < lastDep) lastArr += 24 * 60;
-                        result->totalTime = (int)(lastArr - startT);
-                    }
-                    
-                    allPaths.push_back(result);
-                }
-                continue;
+        SearchQuery query(SearchQuery::BOOKING_CONNECTED, selectedOriginIndex, selectedDestIndex, departureDate);
+        pendingQuery = query;
+        connectedKeys.clear();
+        connectedGraph = TimetableSnapshots::keep(graph);
+        connectedSearch = std::make_shared<PathEnumerator<> >(
+            *connectedGraph, selectedOriginIndex, selectedDestIndex, PathFinding::AllowAll(), departureDate, 2,
+            CONNECTED_PAGE * CONNECTED_PAGES);
+        
+        if (SearchCache::lookup(query, graph, queryArena, availableRoutes)) {
+            // Asking for more starts over and skips what is listed already
+            SearchWorker::get().cancel(SearchWorker::BOOKING_CONNECTED);
+            for (int i = 0; i < availableRoutes.size(); i++) {
+                connectedKeys.insert(pathKey(availableRoutes[i]));
             }
-            
-            if (state.path.size() > MAX_DEPTH) continue;
-            
-            // Explore neighbors
-            LinkedList<Route>::Node* routeNode = graph.vertices[state.current].routes.head;
-            while (routeNode != nullptr) {
-                Route& route = routeNode->data;
-                int destIndex = graph.findPort(route.dest.name);
-                
-                if (destIndex == -1) {
-                    routeNode = routeNode->next;
-                    continue;
-                }
-                
-                // Check if already visited in this path
-                bool alreadyVisited = false;
-                for (int visited : state.path) {
-                    if (visited == destIndex) {
-                        alreadyVisited = true;
-                        break;
-                    }
-                }
-                if (alreadyVisited) {
-                    routeNode = routeNode->next;
-                    continue;
-                }
-                
-                // Check if first route matches departure date
-                if (state.path.size() == 1 && route.date != departureDate) {
-                    routeNode = routeNode->next;
-                    continue;
-                }
-                
-                // Check timing constraints
-                long long depAbs = TimeUtils::toAbsoluteMinutes(route.date, route.deptTime);
-                long long arrAbs = TimeUtils::toAbsoluteMinutes(route.date, route.arrTime);
-                if (arrAbs < depAbs) arrAbs += 24 * 60;
-                
-                bool timeValid = true;
-                if (state.current != selectedOriginIndex) {
-                    if (state.arrivalTime > depAbs - 60) {
-                        timeValid = false;
-                    }
-                }
-                
-                if (timeValid) {
-                    // Create a new state (copy constructor)
-                    PathState newState;
-                    newState.current = destIndex;
-                    newState.path = state.path;  // Copy the vector
-                    newState.path.push_back(destIndex);
-                    newState.routes = state.routes;  // Copy the vector
-                    newState.routes.push_back(route);
-                    newState.cost = state.cost + route.cost;
-                    
-                    // Add layover fee if waiting > 12 hours
-                    if (state.current != selectedOriginIndex) {
-                        long long layover = depAbs - state.arrivalTime;
-                        if (layover > 720) {
-                            newState.cost += graph.vertices[state.current].port.portCharge;
-                        }
-                    }
-                    newState.arrivalTime = arrAbs;
-                    
-                    queue.push_back(newState);
-                }
-                
-                routeNode = routeNode->next;
+            if (availableRoutes.size() > 0) {
+                currentRouteIndex = 0;
             }
+            return;
         }
         
-        // Filter by availability (not booked) and avoid duplicates
-        Vector<std::string> seenPathKeys;  // Track paths we've seen (no built-in structures)
-        for (int i = 0; i < allPaths.size(); i++) {
-            PathFinding::PathResult* path = allPaths[i];
-            if (!BookingSystem::isRouteAvailable(path, departureDate)) {
-                delete path;
-                continue;
-            }
-            
-            // Create a unique identifier for this path to avoid duplicates
-            std::string pathKey = "";
-            for (int i = 0; i < path->path.getSize(); i++) {
-                pathKey += std::to_string(path->path.get(i)) + ",";
-            }
-            pathKey += "|";
-            for (int i = 0; i < path->routes.getSize(); i++) {
-                Route r = path->routes.get(i);
-                pathKey += r.startPoint.name + "->" + r.dest.name + ":" + r.date + ":" + r.deptTime + ",";
+        connectedTarget = CONNECTED_PAGE;
+        searchConnected();
+    }
+    
+    // More connected paths can be asked for
+    bool hasMoreConnected() const {
+        if (showingDirectPaths || showingProfile || !connectedSearch) return false;
+        // A slice in flight owns the enumerator until it comes back
+        return SearchWorker::get().isBusy(SearchWorker::BOOKING_CONNECTED) || !connectedSearch->isExhausted();
+    }
+    
+    void findMoreConnected() {
+        if (!hasMoreConnected() || SearchWorker::get().isBusy(SearchWorker::BOOKING_CONNECTED)) return;
+        connectedTarget = availableRoutes.size() + CONNECTED_PAGE;
+        searchConnected();
+    }
+    
+    // Run the enumerator for one slice on the search worker
+    void searchConnected() {
+        std::shared_ptr<PathEnumerator<> > search = connectedSearch;
+        TimetableSnapshots::Snapshot searchGraph = connectedGraph;     // outlives a cancelled slice
+        int wanted = connectedTarget - availableRoutes.size();
+        SearchWorker::get().submit(SearchWorker::BOOKING_CONNECTED, [search, searchGraph, wanted](SearchJob& job) {
+            int before = search->getExpanded();
+            search->run(SearchBudget(wanted, 0, CONNECTED_SLICE_MS), job.arena, job.paths);
+            job.control.step(search->getExpanded() - before);
+        });
+    }
+    
+    // Called every frame: adopt connected paths the worker has found and
+    // keep going until the page is full. The enumerator stays on the
+    // timetable it started on; a newer one shows from the next search.
+    void update(PathFinding::PathResult*& currentPathResult) {
+        SearchJob* job = SearchWorker::get().take(SearchWorker::BOOKING_CONNECTED);
+        if (!job) return;
+        if (!job->failed) {
+            collectConnectedPaths(job->paths);
+            if (currentRouteIndex < 0 && availableRoutes.size() > 0) {
+                currentRouteIndex = 0;
+                updateCurrentPathResult(currentPathResult);
             }
-            
-            // Check if we've seen this path before (linear search)
-            bool isDuplicate = false;
-            for (const std::string& key : seenPathKeys) {
-                if (key == pathKey) {
-                    isDuplicate = true;
-                    break;
-                }
+            if (availableRoutes.size() < connectedTarget && !connectedSearch->isExhausted()) {
+                searchConnected();
+            } else {
+                SearchCache::store(pendingQuery, *connectedGraph, availableRoutes, true);
             }
+        }
+        delete job;
+    }
+
+    // Copy the worker's paths into queryArena, keeping the ones still
+    // available (bookings are read here, on the UI thread) without duplicates
+    void collectConnectedPaths(const Vector<PathFinding::PathResult*>& paths) {
+        for (int i = 0; i < paths.size(); i++) {
+            PathFinding::PathResult* path = paths[i];
+            if (!BookingSystem::isRouteAvailable(path, pendingQuery.date)) continue;
             
             // Only add if we haven't seen this exact path before
-            if (!isDuplicate) {
-                seenPathKeys.push_back(pathKey);
-                availableRoutes.push_back(path);
-            } else {
-                delete path;  // Duplicate path, delete it
+            if (connectedKeys.insert(pathKey(path))) {
+                availableRoutes.push_back(queryArena.create<PathFinding::PathResult>(*path));
             }
         }
+    }
+    
+    // A unique identifier for a path, to avoid duplicates
+    static std::string pathKey(const PathFinding::PathResult* path) {
+        std::string key = "";
+        for (int port : path->path) {
+            key += std::to_string(port) + ",";
+        }
+        key += "|";
+        for (const Route& r : path->routes) {
+            key += r.startPoint.name + "->" + r.dest.name + ":" + r.date + ":" + r.deptTime + ",";
+        }
+        return key;
+    }
+    
+    void findProfilePaths(const Graph& graph, PathFinding::PathResult*& currentPathResult) {
+        SearchWorker::get().cancel(SearchWorker::BOOKING_CONNECTED);
+        connectedSearch.reset();
+        connectedGraph.reset();
+        availableRoutes.clear();
+        queryArena.reset();
+        currentPathResult = nullptr;
+        
+        showingDirectPaths = false;
+        showingProfile = true;
+        
+        SearchQuery query(SearchQuery::BOOKING_PROFILE, selectedOriginIndex, selectedDestIndex,
+                          departureDate, ProfileSearch::DEFAULT_WINDOW_DAYS);
+        if (!SearchCache::lookup(query, graph, queryArena, availableRoutes)) {
+            collectProfilePaths(graph);
+            SearchCache::store(query, graph, availableRoutes, true);
+        }
         
         currentRouteIndex = -1;
         if (availableRoutes.size() > 0) {
             currentRouteIndex = 0;
         }
     }
+
+    void collectProfilePaths(const Graph& graph) {
+        // Every itinerary leaving in the window that no other one beats on
+        // departure, arrival and cost at once
+        Vector<PathFinding::PathResult*> options;
+        ProfileSearch::findProfile(graph, selectedOriginIndex, selectedDestIndex, departureDate,
+                                   ProfileSearch::DEFAULT_WINDOW_DAYS, queryArena, options);
+        
+        for (PathFinding::PathResult* path : options) {
+            if (BookingSystem::isRouteAvailable(path, travelDate(path))) {
+                availableRoutes.push_back(path);
+            }
+        }
+    }
+    
+    // Departure date of a result: its first leg's (profile options leave
+    // on different days), else the selected date
+    std::string travelDate(const PathFinding::PathResult* path) const {
+        if (path && !path->routes.isEmpty()) return path->routes.front().date;
+        return departureDate;
+    }
     
     void updateRouteDetails(const Graph& graph, PathFinding::PathResult* currentPathResult) {
         if (!currentPathResult || !currentPathResult->found) {
@@ -814,9 +801,13 @@ struct BookingMenu {
         ss << "-------------\n\n";
         
         if (currentPathResult->routes.getSize() > 0) {
-            for (int i = 0; i < currentPathResult->routes.getSize(); i++) {
-                Route route = currentPathResult->routes.get(i);
-                int toIdx = currentPathResult->path.get(i + 1);
+            // Walk legs and ports side by side; the port after the first is leg 0's destination
+            LinkedList<int>::iterator portIt = currentPathResult->path.begin();
+            int legCount = currentPathResult->routes.getSize();
+            int i = 0;
+            for (const Route& route : currentPathResult->routes) {
+                if (portIt != currentPathResult->path.end()) ++portIt;
+                int toIdx = (portIt != currentPathResult->path.end()) ? *portIt : -1;
                 
                 ss << "Leg " << (i + 1) << ":\n";
                 ss << "  From: " << route.startPoint.name << "\n";
@@ -827,12 +818,13 @@ struct BookingMenu {
                 ss << "  Route Cost: $" << route.cost << "\n";
                 
                 // Add layover information if not the last leg
-                if (i < currentPathResult->routes.getSize() - 1 && toIdx >= 0 && toIdx < graph.size) {
+                if (i < legCount - 1 && toIdx >= 0 && toIdx < graph.size) {
                     int layoverCost = graph.vertices[toIdx].port.portCharge;
                     ss << "  Layover at " << route.dest.name << ": $" << layoverCost << "\n";
                 }
                 
                 ss << "\n";
+                i++;
             }
         }
         
@@ -848,7 +840,7 @@ struct BookingMenu {
         }
     }
 
-    void bookRoute(Graph& /*graph*/, PathFinding::PathResult*& currentPathResult, std::string& resultTextString) {
+    void bookRoute(const Graph& /*graph*/, PathFinding::PathResult*& currentPathResult, std::string& resultTextString) {
         if (currentRouteIndex < 0 || currentRouteIndex >= availableRoutes.size()) {
             return;
         }
@@ -860,7 +852,7 @@ struct BookingMenu {
         
         // Add to booking system (this creates a deep copy, so selectedRoute is still valid)
         BookingSystem::addBooking(selectedOriginIndex, selectedDestIndex, 
-                                  departureDate, selectedRoute);
+                                  travelDate(selectedRoute), selectedRoute);
         
         // Check if currentPathResult points to the route we're about to remove
         bool wasCurrentPath = (currentPathResult == selectedRoute);
@@ -930,7 +922,7 @@ struct BookingMenu {
         // currentPathResult should always be one of the routes in availableRoutes
         // so we don't need to delete it, just update the pointer
         currentPathResult = availableRoutes[currentRouteIndex];
-        resultTextString = showingDirectPaths ? "Direct Route" : "Connected Route";
+        resultTextString = showingProfile ? "Flexible Option" : (showingDirectPaths ? "Direct Route" : "Connected Route");
     }
 
     void navigateNext(PathFinding::PathResult*& currentPathResult,
@@ -944,22 +936,24 @@ struct BookingMenu {
         // currentPathResult should always be one of the routes in availableRoutes
         // so we don't need to delete it, just update the pointer
         currentPathResult = availableRoutes[currentRouteIndex];
-        resultTextString = showingDirectPaths ? "Direct Route" : "Connected Route";
+        resultTextString = showingProfile ? "Flexible Option" : (showingDirectPaths ? "Direct Route" : "Connected Route");
     }
 
     void reset() {
+        SearchWorker::get().cancel(SearchWorker::BOOKING_CONNECTED);
+        connectedSearch.reset();
+        connectedGraph.reset();
         selectingOrigin = selectingDest = selectingDate = false;
         originDestListOffset = 0;
         dateListOffset = 0;
         currentRouteIndex = -1;
         showingDirectPaths = false;
+        showingProfile = false;
     }
 
     void cleanup() {
-        for (int i = 0; i < availableRoutes.size(); i++) {
-            delete availableRoutes[i];
-        }
         availableRoutes.clear();
+        queryArena.reset();
     }
 
 private:
@@ -1193,6 +1187,10 @@ public:
         window.draw(directPathsTxt);
         window.draw(connectedPathsBtn);
         window.draw(connectedPathsTxt);
+        flexibleDatesBtn.setFillColor((canSearch && isHovering(flexibleDatesBtn, mouseGlobal)) ? 
+                                      btnHover : (canSearch ? btnNormal : sf::Color(30, 30, 30)));
+        window.draw(flexibleDatesBtn);
+        window.draw(flexibleDatesTxt);
         
         // Draw book button
         bool canBook = (availableRoutes.size() > 0 && currentRouteIndex >= 0);
@@ -1219,10 +1217,9 @@ public:
         if (availableRoutes.size() > 0) {
             prevBtn.setFillColor((currentRouteIndex > 0 && isHovering(prevBtn, mouseGlobal)) ? 
                                 btnHover : (currentRouteIndex > 0 ? btnNormal : sf::Color(30, 30, 30)));
-            nextBtn.setFillColor((currentRouteIndex < availableRoutes.size() - 1 && 
-                                 isHovering(nextBtn, mouseGlobal)) ? 
-                                btnHover : (currentRouteIndex < availableRoutes.size() - 1 ? 
-                                btnNormal : sf::Color(30, 30, 30)));
+            bool canNext = currentRouteIndex < availableRoutes.size() - 1 || hasMoreConnected();
+            nextBtn.setFillColor((canNext && isHovering(nextBtn, mouseGlobal)) ? 
+                                btnHover : (canNext ? btnNormal : sf::Color(30, 30, 30)));
             
             window.draw(prevBtn);
             window.draw(prevBtnTxt);
@@ -1232,6 +1229,7 @@ public:
             // Draw route counter
             std::stringstream ss;
             ss << (currentRouteIndex + 1) << " / " << availableRoutes.size();
+            if (hasMoreConnected()) ss << "+";
             routeCounterTxt.setString(ss.str());
             window.draw(routeCounterTxt);
         }
@@ -1247,21 +1245,28 @@ public:
             window.draw(resultHeader);
             
             std::stringstream ss;
-            if (availableRoutes.size() > 0 && currentRouteIndex >= 0) {
+            if (currentRouteIndex < 0 && SearchWorker::get().isBusy(SearchWorker::BOOKING_CONNECTED)) {
+                ss << searchingText(SearchWorker::get().getProgress(SearchWorker::BOOKING_CONNECTED));
+            }
+            else if (availableRoutes.size() > 0 && currentRouteIndex >= 0) {
                 PathFinding::PathResult* result = availableRoutes[currentRouteIndex];
-                ss << (showingDirectPaths ? "Direct" : "Connected") << " Route ";
+                ss << (showingProfile ? "Option" : (showingDirectPaths ? "Direct Route" : "Connected Route")) << " ";
                 ss << (currentRouteIndex + 1) << " of " << availableRoutes.size() << "\n";
                 ss << "Cost: $" << result->totalCost << "\n";
+                if (showingProfile) {
+                    ss << "Time: " << TimeUtils::formatDuration(result->totalTime) << "\n";
+                }
                 ss << "Stops: " << result->path.getSize() - 2 << "\n";
-                ss << "Date: " << departureDate << "\n";
+                ss << "Date: " << travelDate(result) << "\n";
                 ss << "Path:\n";
                 
                 std::string pathStr = "";
                 int lineLength = 0;
                 const int maxLineLength = 35;
                 
-                for (int i = 0; i < result->path.getSize(); i++) {
-                    std::string portName = graph.vertices[result->path.get(i)].port.name;
+                int i = 0;
+                for (int port : result->path) {
+                    const std::string& portName = graph.vertices[port].port.name;
                     
                     if (i > 0) {
                         pathStr += " -> ";
@@ -1275,6 +1280,7 @@ public:
                     
                     pathStr += portName;
                     lineLength += portName.length();
+                    i++;
                 }
                 ss << pathStr;
             } else if (availableRoutes.size() == 0 && selectedOriginIndex != -1 && 
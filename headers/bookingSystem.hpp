@@ -2,7 +2,9 @@
 #define BOOKINGSYSTEM_HPP
 
 #include <string>
+#include <utility>
 #include "pathFinding.h"
+#include "queryCache.h"
 #include "Graph.hpp"
 #include "timeUtils.h"
 #include "vector.h"
@@ -22,20 +24,8 @@ struct BookedRoute {
         departureDate = other.departureDate;
         
         if (other.path) {
-            path = new PathFinding::PathResult();
-            path->found = other.path->found;
-            path->totalCost = other.path->totalCost;
-            path->totalTime = other.path->totalTime;
-            
-            // Deep copy path list
-            for (int i = 0; i < other.path->path.getSize(); i++) {
-                path->path.insertEnd(other.path->path.get(i));
-            }
-            
-            // Deep copy routes list
-            for (int i = 0; i < other.path->routes.getSize(); i++) {
-                path->routes.insertEnd(other.path->routes.get(i));
-            }
+            // PathResult's lists deep copy themselves
+            path = new PathFinding::PathResult(*other.path);
         } else {
             path = nullptr;
         }
@@ -52,17 +42,7 @@ struct BookedRoute {
             departureDate = other.departureDate;
             
             if (other.path) {
-                path = new PathFinding::PathResult();
-                path->found = other.path->found;
-                path->totalCost = other.path->totalCost;
-                path->totalTime = other.path->totalTime;
-                
-                for (int i = 0; i < other.path->path.getSize(); i++) {
-                    path->path.insertEnd(other.path->path.get(i));
-                }
-                for (int i = 0; i < other.path->routes.getSize(); i++) {
-                    path->routes.insertEnd(other.path->routes.get(i));
-                }
+                path = new PathFinding::PathResult(*other.path);
             } else {
                 path = nullptr;
             }
@@ -70,6 +50,15 @@ struct BookedRoute {
         return *this;
     }
     
+    // 3. MOVE CONSTRUCTOR (lets Vector regrow without re-copying paths)
+    BookedRoute(BookedRoute&& other) noexcept
+        : originIndex(other.originIndex),
+          destinationIndex(other.destinationIndex),
+          departureDate(std::move(other.departureDate)),
+          path(other.path) {
+        other.path = nullptr;
+    }
+    
     ~BookedRoute() {
         if (path) {
             delete path;
@@ -85,16 +74,10 @@ struct BookedRoute {
         if (departureDate != date) return false;
         
         // Compare the route legs
-        int routeSize = route->routes.getSize();
-        int pathSize = path->routes.getSize();
-        
-        if (routeSize <= 0 || pathSize <= 0) return false;
+        if (route->routes.isEmpty() || path->routes.isEmpty()) return false;
         
-        for (int i = 0; i < routeSize; i++) {
-            Route r1 = route->routes.get(i);
-            for (int j = 0; j < pathSize; j++) {
-                Route r2 = path->routes.get(j);
-                
+        for (const Route& r1 : route->routes) {
+            for (const Route& r2 : path->routes) {
                 if (r1.startPoint.name == r2.startPoint.name &&
                     r1.dest.name == r2.dest.name &&
                     r1.date == r2.date &&
@@ -121,22 +104,12 @@ public:
         booking.departureDate = departureDate;
         
         // Create initial deep copy for the local variable
-        booking.path = new PathFinding::PathResult();
-        booking.path->found = path->found;
-        booking.path->totalCost = path->totalCost;
-        booking.path->totalTime = path->totalTime;
+        booking.path = new PathFinding::PathResult(*path);
         
-        int pathSize = path->path.getSize();
-        for (int i = 0; i < pathSize; i++) {
-            booking.path->path.insertEnd(path->path.get(i));
-        }
-        
-        int routesSize = path->routes.getSize();
-        for (int i = 0; i < routesSize; i++) {
-            booking.path->routes.insertEnd(path->routes.get(i));
-        }
+        bookedRoutes.push_back(std::move(booking));
         
-        bookedRoutes.push_back(booking);
+        // Cached availability-filtered results are now stale
+        SearchCache::get().invalidateBookings();
     }
     
     static bool isRouteAvailable(const PathFinding::PathResult* route, 
@@ -0,0 +1,477 @@
+#ifndef CONNECTIONS_H
+#define CONNECTIONS_H
+
+#include <limits.h>
+#include <mutex>
+#include <stdint.h>
+#include "Graph.hpp"
+#include "hashMap.h"
+#include "timeUtils.h"
+#include "priorityQueue.h"
+#include "sorting.h"
+#include "vector.h"
+
+// One dated sailing in absolute minutes (TimeUtils), as the scan-based
+// searches see the timetable. A run of a weekly Service points at the
+// service's undated pattern; Connections::routeOf gives the dated Route.
+struct Connection {
+    int from;
+    int to;
+    long long departure;
+    long long arrival;      // rolled to the next day when it is earlier than departure
+    int cost;
+    int sequence;           // timetable order among the sailings from the same port
+    const Route* route;
+    int service;            // index into Graph::services, -1 for a dated route
+    int day;                // the run's civil day (services only)
+};
+
+// Dated sailings grouped by one of their ports
+struct PortGroups {
+    Vector<Connection> sailings;
+    Vector<int> start;      // per port, its first sailing; start[port + 1] ends the group
+
+    int begin(int port) const { return start[port]; }
+    int end(int port) const { return start[port + 1]; }
+};
+
+// Dated sailings grouped by the port they leave from, each group by
+// increasing departure (equal departures in timetable order), so a search
+// can jump straight to the first sailing it can still make. Weekly
+// services are not in it: Connections::firstOccurrence finds their next
+// run directly.
+struct DepartureIndex : PortGroups {
+
+    // First sailing from port leaving at or after time, end(port) if none.
+    // Binary search, O(log d) in the port's sailings.
+    int firstFrom(int port, long long time) const {
+        int lo = start[port], hi = start[port + 1];
+        while (lo < hi) {
+            int mid = lo + (hi - lo) / 2;
+            if (sailings[mid].departure < time) lo = mid + 1;
+            else hi = mid;
+        }
+        return lo;
+    }
+};
+
+// Every sailing of a graph as a flat array, sorted once per timetable
+// (Graph::getVersion) in the order the scans need, and kept sorted through
+// live changes (timetableFeed.h) by moving only the sailings they touch.
+// Safe to call from the search worker and the UI thread at once.
+class Connections {
+public:
+    // By decreasing departure (profile search)
+    static const Vector<Connection>& byDeparture(const Graph& graph) {
+        Cache& c = cache(graph);
+        refresh(c, graph);
+        return c.byDeparture;
+    }
+
+    // By decreasing arrival (latest-departure search)
+    static const Vector<Connection>& byArrival(const Graph& graph) {
+        Cache& c = cache(graph);
+        refresh(c, graph);
+        return c.byArrival;
+    }
+
+    // By port, then increasing departure (the forward searches)
+    static const DepartureIndex& byPort(const Graph& graph) {
+        Cache& c = cache(graph);
+        refresh(c, graph);
+        return c.byPort;
+    }
+
+    // Live changes, called after the Graph has made them. Each one moves,
+    // drops or slots in a single sailing with binary searches and a shift
+    // of the entries in between; nothing is re-sorted. No-ops until the
+    // arrays are first built.
+
+    // route (already in graph) was added
+    static void added(const Graph& graph, const Route& route) {
+        Cache& c = cache(graph);
+        std::lock_guard<std::mutex> lock(c.mutex);
+        if (!current(c, graph)) return;
+        Connection conn = connectionOf(graph, route, c.nextSequence[graph.findPort(route.startPoint.name)]++);
+        insertSorted(c.byDeparture, 0, c.byDeparture.size(), conn, departureOrder);
+        insertSorted(c.byArrival, 0, c.byArrival.size(), conn, arrivalOrder);
+        insertGrouped(c.byPort, conn.from, conn, portOrder);
+    }
+
+    // route is about to leave graph
+    static void removing(const Graph& graph, const Route& route) {
+        Cache& c = cache(graph);
+        std::lock_guard<std::mutex> lock(c.mutex);
+        if (!current(c, graph)) return;
+        Connection conn;
+        if (!find(c, graph, route, conn)) return;
+        eraseAt(c.byDeparture, findSorted(c.byDeparture, 0, c.byDeparture.size(), conn, departureOrder));
+        eraseAt(c.byArrival, findSorted(c.byArrival, 0, c.byArrival.size(), conn, arrivalOrder));
+        eraseGrouped(c.byPort, conn.from, conn, portOrder);
+    }
+
+    // route was retimed in place (its entries still have the old times)
+    static void retimed(const Graph& graph, const Route& route) {
+        Cache& c = cache(graph);
+        std::lock_guard<std::mutex> lock(c.mutex);
+        if (!current(c, graph)) return;
+        Connection old;
+        if (!find(c, graph, route, old)) return;
+        Connection conn = connectionOf(graph, route, old.sequence);
+
+        move(c.byDeparture, 0, c.byDeparture.size(), old, conn, departureOrder);
+        move(c.byArrival, 0, c.byArrival.size(), old, conn, arrivalOrder);
+        move(c.byPort.sailings, c.byPort.begin(conn.from), c.byPort.end(conn.from), old, conn, portOrder);
+    }
+
+    // to was just copied from from (the next snapshot, timetableSnapshots.h)
+    // and has a copy of its arrays. Its ports share their sailings with
+    // from's (RouteList), so the arrays already point at to's own.
+    static void copied(const Graph& from, const Graph& to) {
+        Cache& c = cache(to);
+        std::lock_guard<std::mutex> lock(c.mutex);
+        if (c.owner != &from || c.graphVersion != to.getVersion() || c.portCount != to.size) return;
+        c.owner = &to;
+    }
+
+    // A change to port's sailings is coming: give the port a list of its
+    // own if it still shares one with another snapshot, and point its
+    // entries at the copies. Only that port's sailings are visited.
+    static void editing(Graph& graph, int port) {
+        RouteList& routes = graph.vertices[port].routes;
+        if (!routes.isShared()) return;
+        Vector<const Route*> shared;
+        shared.reserve(routes.getSize());
+        for (const Route& route : routes) shared.push_back(&route);
+        const LinkedList<Route>& own = routes.edit();
+
+        Cache& c = cache(graph);
+        std::lock_guard<std::mutex> lock(c.mutex);
+        if (!current(c, graph)) return;
+        HashMap<long long, const Route*> moved;
+        moved.reserve(shared.size());
+        int i = 0;
+        for (const Route& route : own) moved.insert((long long)(intptr_t)shared[i++], &route);
+
+        for (int k = c.byPort.begin(port); k < c.byPort.end(port); k++) {
+            Connection& conn = c.byPort.sailings[k];
+            const Route* const* copy = moved.find((long long)(intptr_t)conn.route);
+            if (!copy) continue;
+            repoint(c.byDeparture, 0, c.byDeparture.size(), conn, departureOrder, *copy);
+            repoint(c.byArrival, 0, c.byArrival.size(), conn, arrivalOrder, *copy);
+            conn.route = *copy;
+        }
+    }
+
+    // The run of graph.services[service] on day
+    static Connection occurrence(const Graph& graph, int service, int day) {
+        const Service& s = graph.services[service];
+        Connection conn;
+        conn.from = s.from;
+        conn.to = s.to;
+        conn.departure = s.departureOn(day);
+        conn.arrival = conn.departure + s.duration;
+        conn.cost = s.pattern.cost;
+        conn.sequence = 0;
+        conn.route = &s.pattern;
+        conn.service = service;
+        conn.day = day;
+        return conn;
+    }
+
+    // First run of a service leaving at or after time, false if none
+    static bool firstOccurrence(const Graph& graph, int service, long long time, Connection& out) {
+        int day = graph.services[service].firstDepartingFrom(time);
+        if (day < 0) return false;
+        out = occurrence(graph, service, day);
+        return true;
+    }
+
+    // The run of a service after conn (one of its runs), false if none
+    static bool nextOccurrence(const Graph& graph, const Connection& conn, Connection& out) {
+        int day = graph.services[conn.service].nextRun(conn.day + 1);
+        if (day < 0) return false;
+        out = occurrence(graph, conn.service, day);
+        return true;
+    }
+
+    // The sailing conn stands for, with its date
+    static Route routeOf(const Connection& conn) {
+        Route route = *conn.route;
+        if (conn.service >= 0) route.date = TimeUtils::civilDate(conn.day);
+        return route;
+    }
+
+private:
+    struct Cache {
+        const Graph* owner;         // the graph whose sailings the entries point at
+        unsigned long long graphVersion;
+        int portCount;
+        Vector<Connection> byDeparture;
+        Vector<Connection> byArrival;
+        DepartureIndex byPort;
+        Vector<int> nextSequence;   // per port, the sequence its next added sailing gets
+        mutable std::mutex mutex;
+
+        Cache() : owner(nullptr), graphVersion(0), portCount(-1) {}
+
+        // For the next snapshot (derivedTables.h), which patches its own
+        // once copied() has pointed it at its sailings
+        Cache(const Cache& other) : owner(nullptr), graphVersion(0), portCount(-1) {
+            std::lock_guard<std::mutex> lock(other.mutex);
+            owner = other.owner;
+            graphVersion = other.graphVersion;
+            portCount = other.portCount;
+            byDeparture = other.byDeparture;
+            byArrival = other.byArrival;
+            byPort = other.byPort;
+            nextSequence = other.nextSequence;
+        }
+    };
+
+    static Cache& cache(const Graph& graph) {
+        static const int key = 0;
+        return graph.derived.get<Cache>(&key);
+    }
+
+    static bool current(const Cache& c, const Graph& graph) {
+        return c.owner == &graph && c.graphVersion == graph.getVersion() && c.portCount == graph.size;
+    }
+
+    // The orders of the arrays, each a total order: equal times fall back
+    // on the port and then the timetable order, as the stable sorts in
+    // refresh leave them
+    static bool timetableOrder(const Connection& a, const Connection& b) {
+        return a.from < b.from || (a.from == b.from && a.sequence < b.sequence);
+    }
+
+    static bool departureOrder(const Connection& a, const Connection& b) {
+        if (a.departure != b.departure) return a.departure > b.departure;
+        return timetableOrder(a, b);
+    }
+
+    static bool arrivalOrder(const Connection& a, const Connection& b) {
+        if (a.arrival != b.arrival) return a.arrival > b.arrival;
+        return timetableOrder(a, b);
+    }
+
+    static bool portOrder(const Connection& a, const Connection& b) {
+        if (a.from != b.from) return a.from < b.from;
+        if (a.departure != b.departure) return a.departure < b.departure;
+        return a.sequence < b.sequence;
+    }
+
+    static Connection connectionOf(const Graph& graph, const Route& route, int sequence) {
+        Connection conn;
+        conn.from = graph.findPort(route.startPoint.name);
+        conn.to = graph.findPort(route.dest.name);
+        conn.departure = TimeUtils::toAbsoluteMinutes(route.date, route.deptTime);
+        conn.arrival = TimeUtils::toAbsoluteMinutes(route.date, route.arrTime);
+        if (conn.arrival < conn.departure) conn.arrival += 24 * 60;
+        conn.cost = route.cost;
+        conn.sequence = sequence;
+        conn.route = &route;
+        conn.service = -1;
+        conn.day = -1;
+        return conn;
+    }
+
+    // route's entry, found through its departure port's group
+    static bool find(const Cache& c, const Graph& graph, const Route& route, Connection& out) {
+        int from = graph.findPort(route.startPoint.name);
+        if (from == -1) return false;
+        for (int i = c.byPort.begin(from); i < c.byPort.end(from); i++) {
+            if (c.byPort.sailings[i].route == &route) {
+                out = c.byPort.sailings[i];
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // First position in [lo, hi) not ordered before conn
+    template <typename Less>
+    static int lowerBound(const Vector<Connection>& sailings, int lo, int hi, const Connection& conn, Less less) {
+        while (lo < hi) {
+            int mid = lo + (hi - lo) / 2;
+            if (less(sailings[mid], conn)) lo = mid + 1;
+            else hi = mid;
+        }
+        return lo;
+    }
+
+    // Position of conn's entry (the orders are total, so a binary search
+    // lands on it), -1 if it is not there
+    template <typename Less>
+    static int findSorted(const Vector<Connection>& sailings, int lo, int hi, const Connection& conn, Less less) {
+        int at = lowerBound(sailings, lo, hi, conn, less);
+        return (at < hi && sailings[at].route == conn.route) ? at : -1;
+    }
+
+    template <typename Less>
+    static void insertSorted(Vector<Connection>& sailings, int lo, int hi, const Connection& conn, Less less) {
+        int at = lowerBound(sailings, lo, hi, conn, less);
+        sailings.push_back(conn);
+        for (int i = sailings.size() - 1; i > at; i--) sailings[i] = sailings[i - 1];
+        sailings[at] = conn;
+    }
+
+    static bool eraseAt(Vector<Connection>& sailings, int at) {
+        if (at < 0) return false;
+        sailings.erase(at);
+        return true;
+    }
+
+    template <typename Less>
+    static void insertGrouped(PortGroups& groups, int port, const Connection& conn, Less less) {
+        insertSorted(groups.sailings, groups.begin(port), groups.end(port), conn, less);
+        for (int p = port + 1; p < groups.start.size(); p++) groups.start[p]++;
+    }
+
+    template <typename Less>
+    static void eraseGrouped(PortGroups& groups, int port, const Connection& conn, Less less) {
+        if (!eraseAt(groups.sailings, findSorted(groups.sailings, groups.begin(port), groups.end(port), conn, less))) {
+            return;
+        }
+        for (int p = port + 1; p < groups.start.size(); p++) groups.start[p]--;
+    }
+
+    // Take old's entry in [lo, hi) to where conn belongs, shifting only
+    // the entries between the two places
+    template <typename Less>
+    static void move(Vector<Connection>& sailings, int lo, int hi, const Connection& old, const Connection& conn,
+                     Less less) {
+        int from = findSorted(sailings, lo, hi, old, less);
+        if (from < 0) return;
+        int to = lowerBound(sailings, lo, hi, conn, less);
+        if (to > from) {
+            to--;       // conn goes after the entries that were behind old
+            for (int i = from; i < to; i++) sailings[i] = sailings[i + 1];
+        } else {
+            for (int i = from; i > to; i--) sailings[i] = sailings[i - 1];
+        }
+        sailings[to] = conn;
+    }
+
+    static void refresh(Cache& c, const Graph& graph) {
+        std::lock_guard<std::mutex> lock(c.mutex);
+        if (current(c, graph)) return;
+
+        c.owner = &graph;
+        c.graphVersion = graph.getVersion();
+        c.portCount = graph.size;
+        c.byDeparture.clear();
+        c.nextSequence.clear();
+        c.nextSequence.resize(graph.size);
+        for (int u = 0; u < graph.size; u++) {
+            for (const Route& route : graph.vertices[u].routes) {
+                if (graph.findPort(route.dest.name) == -1) continue;
+                c.byDeparture.push_back(connectionOf(graph, route, c.nextSequence[u]++));
+            }
+        }
+
+        c.byArrival = c.byDeparture;
+        c.byPort.sailings = c.byDeparture;
+        // Stable, so equal times keep their timetable order
+        Sorting::mergeSort(c.byDeparture, [](const Connection& a, const Connection& b) {
+            return a.departure > b.departure;
+        });
+        Sorting::mergeSort(c.byArrival, [](const Connection& a, const Connection& b) {
+            return a.arrival > b.arrival;
+        });
+        Sorting::mergeSort(c.byPort.sailings, [](const Connection& a, const Connection& b) {
+            return a.from < b.from || (a.from == b.from && a.departure < b.departure);
+        });
+        groupStarts(c.byPort, graph.size);
+    }
+
+    // Point conn's entry in [lo, hi) at copy
+    template <typename Less>
+    static void repoint(Vector<Connection>& sailings, int lo, int hi, const Connection& conn, Less less,
+                        const Route* copy) {
+        int at = findSorted(sailings, lo, hi, conn, less);
+        if (at >= 0) sailings[at].route = copy;
+    }
+
+    static void groupStarts(PortGroups& groups, int ports) {
+        const Vector<Connection>& sailings = groups.sailings;
+        groups.start.clear();
+        groups.start.resize(ports + 1);
+        int next = 0;
+        for (int port = 0; port <= ports; port++) {
+            while (next < sailings.size() && sailings[next].from < port) next++;
+            groups.start[port] = next;
+        }
+    }
+};
+
+// Every sailing, dated and weekly, by decreasing departure or arrival,
+// for the scan-based searches. Dated sailings come from the sorted
+// arrays; each service keeps a cursor on its latest run not yet returned,
+// so its runs are generated only as the scan reaches them and a long
+// validity range costs nothing until then.
+class ConnectionScan {
+public:
+    enum Order { BY_DEPARTURE, BY_ARRIVAL };
+
+    // Starting with the sailings at or before until (by the order's time)
+    ConnectionScan(const Graph& g, Order scanOrder, long long until = LLONG_MAX)
+        : graph(&g), order(scanOrder), position(0),
+          dated(scanOrder == BY_DEPARTURE ? &Connections::byDeparture(g) : &Connections::byArrival(g)) {
+        int hi = dated->size();
+        while (position < hi) {
+            int mid = position + (hi - position) / 2;
+            if (timeOf((*dated)[mid]) > until) position = mid + 1;
+            else hi = mid;
+        }
+
+        runs.resize(g.services.size());
+        for (int s = 0; s < g.services.size(); s++) {
+            const Service& service = g.services[s];
+            if (until == LLONG_MAX) {
+                runs[s] = service.previousRun(service.lastDay);
+            } else {
+                runs[s] = service.lastArrivingBy(order == BY_DEPARTURE ? until + service.duration : until);
+            }
+            if (runs[s] >= 0) queueRun(s);
+        }
+    }
+
+    // Next sailing in the order, nullptr when there are no more. The
+    // pointer stays valid until the following call.
+    const Connection* next() {
+        bool haveDated = position < dated->size();
+        if (!haveDated && queued.isEmpty()) return nullptr;
+        // Dated sailings first on a tie
+        if (haveDated && (queued.isEmpty() || -queued.topPriority() <= timeOf((*dated)[position]))) {
+            return &(*dated)[position++];
+        }
+
+        int s = queued.pop();
+        current = Connections::occurrence(*graph, s, runs[s]);
+        runs[s] = graph->services[s].previousRun(runs[s] - 1);
+        if (runs[s] >= 0) queueRun(s);
+        return &current;
+    }
+
+private:
+    const Graph* graph;
+    Order order;
+    int position;
+    const Vector<Connection>* dated;
+    Vector<int> runs;                   // per service, the next run to return (-1 when done)
+    PriorityQueue<int> queued;          // services by their next run, latest first
+    Connection current;
+
+    long long timeOf(const Connection& conn) const {
+        return order == BY_DEPARTURE ? conn.departure : conn.arrival;
+    }
+
+    void queueRun(int s) {
+        const Service& service = graph->services[s];
+        long long time = (order == BY_DEPARTURE) ? service.departureOn(runs[s]) : service.arrivalOn(runs[s]);
+        queued.push(s, (int)-time);
+    }
+};
+
+#endif
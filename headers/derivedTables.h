@@ -0,0 +1,121 @@
+#ifndef DERIVEDTABLES_H
+#define DERIVEDTABLES_H
+
+#include <memory>
+#include <mutex>
+#include <type_traits>
+#include <utility>
+#include "vector.h"
+
+// The tables the search headers derive from one Graph (sorted sailings,
+// bounds, closures), kept with it rather than in statics, so every
+// snapshot of a changing timetable (timetableSnapshots.h) has its own and
+// they go away with it. Each header finds its kind of table by the
+// address of a key it owns.
+//
+// A copied Graph gets a copy of each table that can be copied, which the
+// live changes (timetableFeed.h) then patch like the original, and starts
+// over on the rest. Shared tables are never changed once set, only
+// replaced, so the copy uses the same ones until it replaces them.
+class DerivedTables {
+private:
+    struct Slot {
+        const void* key;
+        std::shared_ptr<void> table;
+        bool shared;
+        std::shared_ptr<void> (*copy)(const void*);     // nullptr if it cannot be copied
+    };
+
+    template <typename T>
+    static std::shared_ptr<void> copyOf(const void* table) {
+        return std::make_shared<T>(*static_cast<const T*>(table));
+    }
+
+    template <typename T>
+    static std::shared_ptr<void> (*copierFor())(const void*) {
+        if constexpr (std::is_copy_constructible<T>::value) {
+            return &copyOf<T>;
+        } else {
+            return nullptr;
+        }
+    }
+
+    Vector<Slot> slots;
+    mutable std::mutex mutex;
+
+    int find(const void* key) const {
+        for (int i = 0; i < slots.size(); i++) {
+            if (slots[i].key == key) return i;
+        }
+        return -1;
+    }
+
+    void copyFrom(const DerivedTables& other) {
+        std::lock_guard<std::mutex> lock(other.mutex);
+        for (int i = 0; i < other.slots.size(); i++) {
+            Slot slot = other.slots[i];
+            if (!slot.shared) {
+                if (!slot.copy) continue;
+                slot.table = slot.copy(slot.table.get());
+            }
+            slots.push_back(slot);
+        }
+    }
+
+public:
+    DerivedTables() {}
+
+    DerivedTables(const DerivedTables& other) {
+        copyFrom(other);
+    }
+
+    DerivedTables& operator=(const DerivedTables& other) {
+        if (this != &other) {
+            clear();
+            copyFrom(other);
+        }
+        return *this;
+    }
+
+    // The table under key, default-constructed on first use. It stays
+    // where it is until clear(); keep it safe for concurrent readers.
+    template <typename T>
+    T& get(const void* key) {
+        std::lock_guard<std::mutex> lock(mutex);
+        int i = find(key);
+        if (i == -1) {
+            slots.push_back(Slot{key, std::make_shared<T>(), false, copierFor<T>()});
+            i = slots.size() - 1;
+        }
+        return *static_cast<T*>(slots[i].table.get());
+    }
+
+    // The shared table under key, or nullptr. Holding the pointer keeps it
+    // alive after it is replaced.
+    template <typename T>
+    std::shared_ptr<const T> getShared(const void* key) const {
+        std::lock_guard<std::mutex> lock(mutex);
+        int i = find(key);
+        return (i == -1) ? nullptr : std::static_pointer_cast<const T>(slots[i].table);
+    }
+
+    // Replace the shared table under key (nullptr drops it)
+    template <typename T>
+    void setShared(const void* key, std::shared_ptr<const T> table) {
+        std::lock_guard<std::mutex> lock(mutex);
+        int i = find(key);
+        std::shared_ptr<void> stored = std::const_pointer_cast<T>(std::move(table));
+        if (i == -1) {
+            slots.push_back(Slot{key, std::move(stored), true, nullptr});
+        } else {
+            slots[i].table = std::move(stored);
+        }
+    }
+
+    void clear() {
+        std::lock_guard<std::mutex> lock(mutex);
+        slots.clear();
+    }
+};
+
+#endif
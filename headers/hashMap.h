@@ -0,0 +1,341 @@
+#ifndef HASHMAP_H
+#define HASHMAP_H
+
+#include <string>
+#include <new>
+#include <utility>
+#include <stdexcept>
+
+// Default hashers. Pass your own functor as the Hasher template argument
+// for other key types: it must provide  size_t operator()(const K&) const.
+template <typename K>
+struct DefaultHash;
+
+template <>
+struct DefaultHash<int> {
+    size_t operator()(int key) const {
+        // Murmur3 finalizer so consecutive ints spread over the table
+        unsigned int h = (unsigned int)key;
+        h ^= h >> 16;
+        h *= 0x85ebca6bu;
+        h ^= h >> 13;
+        h *= 0xc2b2ae35u;
+        h ^= h >> 16;
+        return h;
+    }
+};
+
+template <>
+struct DefaultHash<long long> {
+    size_t operator()(long long key) const {
+        unsigned long long h = (unsigned long long)key;
+        h ^= h >> 33;
+        h *= 0xff51afd7ed558ccdull;
+        h ^= h >> 33;
+        h *= 0xc4ceb9fe1a85ec53ull;
+        h ^= h >> 33;
+        return (size_t)h;
+    }
+};
+
+template <>
+struct DefaultHash<std::string> {
+    size_t operator()(const std::string& key) const {
+        // FNV-1a
+        unsigned long long h = 1469598103934665603ull;
+        for (unsigned char c : key) {
+            h ^= c;
+            h *= 1099511628211ull;
+        }
+        return (size_t)h;
+    }
+};
+
+// Open-addressing hash map with linear probing.
+// Entries sit in one contiguous array (power-of-two capacity, load factor
+// kept under 3/4) so a lookup is usually a single cache line. Erase uses
+// backward-shift deletion, so there are no tombstones to clean up.
+template <typename K, typename V, typename Hasher = DefaultHash<K> >
+class HashMap {
+public:
+    struct Entry {
+        K key;
+        V value;
+        Entry(const K& k, const V& v) : key(k), value(v) {}
+        Entry(K&& k, V&& v) : key(std::move(k)), value(std::move(v)) {}
+    };
+
+private:
+    Entry* entries;
+    bool* occupied;
+    int capacity;
+    int count;
+    Hasher hasher;
+
+    int home(const K& key) const {
+        return (int)(hasher(key) & (size_t)(capacity - 1));
+    }
+
+    // Slot holding key, or the empty slot where it would go
+    int probe(const K& key) const {
+        int i = home(key);
+        while (occupied[i] && !(entries[i].key == key)) {
+            i = (i + 1) & (capacity - 1);
+        }
+        return i;
+    }
+
+    void rehash(int newCapacity) {
+        Entry* oldEntries = entries;
+        bool* oldOccupied = occupied;
+        int oldCapacity = capacity;
+
+        entries = static_cast<Entry*>(::operator new(sizeof(Entry) * newCapacity));
+        occupied = new bool[newCapacity]();
+        capacity = newCapacity;
+
+        for (int i = 0; i < oldCapacity; i++) {
+            if (oldOccupied[i]) {
+                int slot = probe(oldEntries[i].key);
+                new (&entries[slot]) Entry(std::move(oldEntries[i]));
+                occupied[slot] = true;
+                oldEntries[i].~Entry();
+            }
+        }
+        ::operator delete(oldEntries);
+        delete[] oldOccupied;
+    }
+
+    void growIfNeeded() {
+        if (capacity == 0) {
+            rehash(16);
+        } else if ((count + 1) * 4 > capacity * 3) {
+            rehash(capacity * 2);
+        }
+    }
+
+    void release() {
+        clear();
+        ::operator delete(entries);
+        delete[] occupied;
+        entries = nullptr;
+        occupied = nullptr;
+        capacity = 0;
+    }
+
+public:
+    class iterator {
+    public:
+        iterator(HashMap* m, int i) : map(m), index(i) { skip(); }
+        Entry& operator*() const { return map->entries[index]; }
+        Entry* operator->() const { return &map->entries[index]; }
+        iterator& operator++() { index++; skip(); return *this; }
+        bool operator!=(const iterator& other) const { return index != other.index; }
+        bool operator==(const iterator& other) const { return index == other.index; }
+    private:
+        void skip() { while (index < map->capacity && !map->occupied[index]) index++; }
+        HashMap* map;
+        int index;
+    };
+
+    class const_iterator {
+    public:
+        const_iterator(const HashMap* m, int i) : map(m), index(i) { skip(); }
+        const Entry& operator*() const { return map->entries[index]; }
+        const Entry* operator->() const { return &map->entries[index]; }
+        const_iterator& operator++() { index++; skip(); return *this; }
+        bool operator!=(const const_iterator& other) const { return index != other.index; }
+        bool operator==(const const_iterator& other) const { return index == other.index; }
+    private:
+        void skip() { while (index < map->capacity && !map->occupied[index]) index++; }
+        const HashMap* map;
+        int index;
+    };
+
+    explicit HashMap(Hasher h = Hasher())
+        : entries(nullptr), occupied(nullptr), capacity(0), count(0), hasher(h) {}
+
+    ~HashMap() {
+        release();
+    }
+
+    HashMap(const HashMap& other)
+        : entries(nullptr), occupied(nullptr), capacity(0), count(0), hasher(other.hasher) {
+        reserve(other.count);
+        for (const Entry& e : other) insert(e.key, e.value);
+    }
+
+    HashMap& operator=(const HashMap& other) {
+        if (this != &other) {
+            clear();
+            hasher = other.hasher;
+            reserve(other.count);
+            for (const Entry& e : other) insert(e.key, e.value);
+        }
+        return *this;
+    }
+
+    HashMap(HashMap&& other) noexcept
+        : entries(other.entries), occupied(other.occupied),
+          capacity(other.capacity), count(other.count), hasher(other.hasher) {
+        other.entries = nullptr;
+        other.occupied = nullptr;
+        other.capacity = 0;
+        other.count = 0;
+    }
+
+    HashMap& operator=(HashMap&& other) noexcept {
+        if (this != &other) {
+            release();
+            entries = other.entries;
+            occupied = other.occupied;
+            capacity = other.capacity;
+            count = other.count;
+            hasher = other.hasher;
+            other.entries = nullptr;
+            other.occupied = nullptr;
+            other.capacity = 0;
+            other.count = 0;
+        }
+        return *this;
+    }
+
+    // Inserts or overwrites. Returns true if the key was new.
+    bool insert(const K& key, const V& value) {
+        growIfNeeded();
+        int slot = probe(key);
+        if (occupied[slot]) {
+            entries[slot].value = value;
+            return false;
+        }
+        new (&entries[slot]) Entry(key, value);
+        occupied[slot] = true;
+        count++;
+        return true;
+    }
+
+    // Value for key, default-constructing it first if missing
+    V& operator[](const K& key) {
+        growIfNeeded();
+        int slot = probe(key);
+        if (!occupied[slot]) {
+            new (&entries[slot]) Entry(key, V());
+            occupied[slot] = true;
+            count++;
+        }
+        return entries[slot].value;
+    }
+
+    V* find(const K& key) {
+        if (count == 0) return nullptr;
+        int slot = probe(key);
+        return occupied[slot] ? &entries[slot].value : nullptr;
+    }
+
+    const V* find(const K& key) const {
+        if (count == 0) return nullptr;
+        int slot = probe(key);
+        return occupied[slot] ? &entries[slot].value : nullptr;
+    }
+
+    const V& at(const K& key) const {
+        const V* v = find(key);
+        if (!v) throw std::out_of_range("Key not found");
+        return *v;
+    }
+
+    bool contains(const K& key) const {
+        return find(key) != nullptr;
+    }
+
+    bool erase(const K& key) {
+        if (count == 0) return false;
+        int hole = probe(key);
+        if (!occupied[hole]) return false;
+
+        entries[hole].~Entry();
+        occupied[hole] = false;
+        count--;
+
+        // Backward-shift: pull later entries of the probe run into the hole
+        // when the hole lies between their home slot and where they sit now
+        int mask = capacity - 1;
+        int i = (hole + 1) & mask;
+        while (occupied[i]) {
+            int h = home(entries[i].key);
+            bool movable = (hole <= i) ? (h <= hole || h > i) : (h <= hole && h > i);
+            if (movable) {
+                new (&entries[hole]) Entry(std::move(entries[i]));
+                occupied[hole] = true;
+                entries[i].~Entry();
+                occupied[i] = false;
+                hole = i;
+            }
+            i = (i + 1) & mask;
+        }
+        return true;
+    }
+
+    void reserve(int n) {
+        int needed = 16;
+        while (needed * 3 < n * 4) needed *= 2;
+        if (needed > capacity) rehash(needed);
+    }
+
+    // Removes every entry but keeps the table allocated
+    void clear() {
+        for (int i = 0; i < capacity; i++) {
+            if (occupied[i]) {
+                entries[i].~Entry();
+                occupied[i] = false;
+            }
+        }
+        count = 0;
+    }
+
+    int size() const { return count; }
+    bool empty() const { return count == 0; }
+
+    iterator begin() { return iterator(this, 0); }
+    iterator end() { return iterator(this, capacity); }
+    const_iterator begin() const { return const_iterator(this, 0); }
+    const_iterator end() const { return const_iterator(this, capacity); }
+};
+
+// Set built on the same table; iterating yields the keys
+template <typename K, typename Hasher = DefaultHash<K> >
+class HashSet {
+private:
+    struct Empty {};
+    typedef HashMap<K, Empty, Hasher> Table;
+    Table table;
+
+public:
+    class const_iterator {
+    public:
+        explicit const_iterator(typename Table::const_iterator i) : it(i) {}
+        const K& operator*() const { return (*it).key; }
+        const K* operator->() const { return &(*it).key; }
+        const_iterator& operator++() { ++it; return *this; }
+        bool operator!=(const const_iterator& other) const { return it != other.it; }
+        bool operator==(const const_iterator& other) const { return it == other.it; }
+    private:
+        typename Table::const_iterator it;
+    };
+
+    explicit HashSet(Hasher h = Hasher()) : table(h) {}
+
+    // Returns true if key was not already present
+    bool insert(const K& key) { return table.insert(key, Empty()); }
+    bool contains(const K& key) const { return table.contains(key); }
+    bool erase(const K& key) { return table.erase(key); }
+    void reserve(int n) { table.reserve(n); }
+    void clear() { table.clear(); }
+    int size() const { return table.size(); }
+    bool empty() const { return table.empty(); }
+
+    const_iterator begin() const { return const_iterator(table.begin()); }
+    const_iterator end() const { return const_iterator(table.end()); }
+};
+
+#endif
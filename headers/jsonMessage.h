@@ -0,0 +1,240 @@
+#ifndef JSONMESSAGE_H
+#define JSONMESSAGE_H
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include "hashMap.h"
+#include "vector.h"
+
+// One flat JSON object per line, as the query server (queryServer.h) and
+// its clients exchange them. Values are strings, numbers, true/false/null
+// or arrays of those. Numbers and literals are kept as their text, and so
+// are objects and arrays nested any deeper, unread.
+class JsonMessage {
+private:
+    HashMap<std::string, std::string> values;
+    HashMap<std::string, Vector<std::string> > lists;
+
+    static void skipSpace(const std::string& text, size_t& at) {
+        while (at < text.size() && (text[at] == ' ' || text[at] == '\t' ||
+                                    text[at] == '\r' || text[at] == '\n')) {
+            at++;
+        }
+    }
+
+    static int hexDigit(char c) {
+        if (c >= '0' && c <= '9') return c - '0';
+        if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+        if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+        return -1;
+    }
+
+    static void appendUtf8(std::string& out, unsigned code) {
+        if (code < 0x80) {
+            out += char(code);
+        } else if (code < 0x800) {
+            out += char(0xC0 | (code >> 6));
+            out += char(0x80 | (code & 0x3F));
+        } else {
+            out += char(0xE0 | (code >> 12));
+            out += char(0x80 | ((code >> 6) & 0x3F));
+            out += char(0x80 | (code & 0x3F));
+        }
+    }
+
+    static bool readString(const std::string& text, size_t& at, std::string& out) {
+        if (at >= text.size() || text[at] != '"') return false;
+        at++;
+        out.clear();
+        while (at < text.size() && text[at] != '"') {
+            char c = text[at++];
+            if (c != '\\') {
+                out += c;
+                continue;
+            }
+            if (at >= text.size()) return false;
+            char e = text[at++];
+            switch (e) {
+                case '"': case '\\': case '/': out += e; break;
+                case 'b': out += '\b'; break;
+                case 'f': out += '\f'; break;
+                case 'n': out += '\n'; break;
+                case 'r': out += '\r'; break;
+                case 't': out += '\t'; break;
+                case 'u': {
+                    if (at + 4 > text.size()) return false;
+                    unsigned code = 0;
+                    for (int i = 0; i < 4; i++) {
+                        int d = hexDigit(text[at++]);
+                        if (d < 0) return false;
+                        code = code * 16 + d;
+                    }
+                    appendUtf8(out, code);
+                    break;
+                }
+                default: return false;
+            }
+        }
+        if (at >= text.size()) return false;
+        at++;
+        return true;
+    }
+
+    // The text of the object or array at at, brackets and all
+    static bool readNested(const std::string& text, size_t& at, std::string& out) {
+        size_t start = at;
+        int depth = 0;
+        std::string skipped;
+        while (at < text.size()) {
+            char c = text[at];
+            if (c == '"') {
+                if (!readString(text, at, skipped)) return false;
+                continue;
+            }
+            at++;
+            if (c == '{' || c == '[') depth++;
+            if ((c == '}' || c == ']') && --depth == 0) {
+                out = text.substr(start, at - start);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // A string, or the text of a number, literal or nested value
+    static bool readScalar(const std::string& text, size_t& at, std::string& out) {
+        if (at < text.size() && text[at] == '"') return readString(text, at, out);
+        if (at < text.size() && (text[at] == '{' || text[at] == '[')) return readNested(text, at, out);
+        size_t start = at;
+        while (at < text.size() && text[at] != ',' && text[at] != '}' && text[at] != ']' &&
+               text[at] != ' ' && text[at] != '\t' && text[at] != '\r' && text[at] != '\n') {
+            at++;
+        }
+        if (at == start) return false;
+        out = text.substr(start, at - start);
+        return true;
+    }
+
+    static bool readList(const std::string& text, size_t& at, Vector<std::string>& out) {
+        at++;   // '['
+        skipSpace(text, at);
+        if (at < text.size() && text[at] == ']') {
+            at++;
+            return true;
+        }
+        while (true) {
+            std::string item;
+            skipSpace(text, at);
+            if (!readScalar(text, at, item)) return false;
+            out.push_back(item);
+            skipSpace(text, at);
+            if (at >= text.size()) return false;
+            if (text[at] == ']') {
+                at++;
+                return true;
+            }
+            if (text[at++] != ',') return false;
+        }
+    }
+
+public:
+    // False (leaving what was read so far) if line is not a flat object
+    bool parse(const std::string& line) {
+        values.clear();
+        lists.clear();
+        size_t at = 0;
+        skipSpace(line, at);
+        if (at >= line.size() || line[at++] != '{') return false;
+        skipSpace(line, at);
+        if (at < line.size() && line[at] == '}') return true;
+        while (true) {
+            std::string key;
+            skipSpace(line, at);
+            if (!readString(line, at, key)) return false;
+            skipSpace(line, at);
+            if (at >= line.size() || line[at++] != ':') return false;
+            skipSpace(line, at);
+            if (at < line.size() && line[at] == '[') {
+                Vector<std::string> list;
+                if (!readList(line, at, list)) return false;
+                lists[key] = std::move(list);
+            } else {
+                std::string value;
+                if (!readScalar(line, at, value)) return false;
+                values[key] = value;
+            }
+            skipSpace(line, at);
+            if (at >= line.size()) return false;
+            if (line[at] == '}') return true;
+            if (line[at++] != ',') return false;
+        }
+    }
+
+    bool has(const std::string& key) const {
+        return values.contains(key) || lists.contains(key);
+    }
+
+    std::string getString(const std::string& key, const std::string& fallback = "") const {
+        const std::string* value = values.find(key);
+        return value ? *value : fallback;
+    }
+
+    long long getNumber(const std::string& key, long long fallback = 0) const {
+        const std::string* value = values.find(key);
+        if (!value || value->empty()) return fallback;
+        char* end = nullptr;
+        long long number = std::strtoll(value->c_str(), &end, 10);
+        return (*end == '\0' || *end == '.' || *end == 'e' || *end == 'E') ? number : fallback;
+    }
+
+    // The array under key (empty if there is none)
+    const Vector<std::string>& getList(const std::string& key) const {
+        static const Vector<std::string> none;
+        const Vector<std::string>* list = lists.find(key);
+        return list ? *list : none;
+    }
+
+    // Writing: out += "{\"id\":" ... with these for the values
+    static void appendString(std::string& out, const std::string& text) {
+        out += '"';
+        for (char c : text) {
+            switch (c) {
+                case '"': out += "\\\""; break;
+                case '\\': out += "\\\\"; break;
+                case '\n': out += "\\n"; break;
+                case '\r': out += "\\r"; break;
+                case '\t': out += "\\t"; break;
+                default:
+                    if (static_cast<unsigned char>(c) < 0x20) {
+                        char escaped[8];
+                        std::snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+                        out += escaped;
+                    } else {
+                        out += c;
+                    }
+            }
+        }
+        out += '"';
+    }
+
+    static void appendField(std::string& out, const char* key, const std::string& text) {
+        appendString(out, key);
+        out += ':';
+        appendString(out, text);
+    }
+
+    static void appendField(std::string& out, const char* key, long long number) {
+        appendString(out, key);
+        out += ':';
+        out += std::to_string(number);
+    }
+
+    static void appendFlag(std::string& out, const char* key, bool flag) {
+        appendString(out, key);
+        out += ':';
+        out += flag ? "true" : "false";
+    }
+};
+
+#endif
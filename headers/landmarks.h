@@ -0,0 +1,327 @@
+#ifndef LANDMARKS_H
+#define LANDMARKS_H
+
+#include <limits.h>
+#include <fstream>
+#include <memory>
+#include <string>
+#include "Graph.hpp"
+#include "pathFinding.h"
+#include "lowerBounds.h"
+#include "binaryFile.h"
+#include "vector.h"
+
+// ALT preprocessing: exact static distances from and to a handful of
+// landmark ports, for fare and for sailing time. By the triangle
+// inequality, for any port v and target t and every landmark L
+//     d(v,t) >= d(v,L) - d(t,L)   and   d(v,t) >= d(L,t) - d(L,v)
+// so the tables give A* lower bounds towards *any* destination without
+// the per-destination reverse search LowerBounds needs.
+struct LandmarkTables {
+    int portCount;
+    Vector<int> landmarks;      // port index of each landmark
+    // Landmark-major: entry [i * portCount + v]. INT_MAX = unreachable.
+    Vector<int> fromCost;       // d(landmark i, v)
+    Vector<int> toCost;         // d(v, landmark i)
+    Vector<int> fromTime;
+    Vector<int> toTime;
+    unsigned long long graphVersion;    // Graph::getVersion the tables belong to
+
+    LandmarkTables() : portCount(0), graphVersion(0) {}
+
+    int count() const { return landmarks.size(); }
+
+    size_t getTableBytes() const {
+        return (size_t)4 * landmarks.size() * portCount * sizeof(int);
+    }
+};
+
+// A* heuristic towards one target from the landmark tables. Only the few
+// landmarks that bound the origin best are consulted per relaxation (the
+// max over any subset is still a lower bound), and the target's own
+// distances are looked up once here.
+class LandmarkHeuristic {
+public:
+    static const int ACTIVE_LANDMARKS = 3;
+
+private:
+    struct Side {
+        const int* from;
+        const int* to;
+        int active;
+        int offset[ACTIVE_LANDMARKS];       // i * portCount per chosen landmark
+        int targetFrom[ACTIVE_LANDMARKS];   // d(L, target)
+        int targetTo[ACTIVE_LANDMARKS];     // d(target, L)
+    };
+
+    Side costSide;
+    Side timeSide;
+
+    // Bound on d(port, target) from the landmark whose rows start at offset
+    static int single(const int* from, const int* to, int offset, int tFrom, int tTo, int port) {
+        int vTo = to[offset + port];
+        int vFrom = from[offset + port];
+        int best = 0;
+        if (tTo != INT_MAX) {
+            // The target reaches L but port does not: port cannot reach the target
+            if (vTo == INT_MAX) return INT_MAX;
+            if (vTo - tTo > best) best = vTo - tTo;
+        }
+        if (vFrom != INT_MAX) {
+            // L reaches port but not the target: neither can port
+            if (tFrom == INT_MAX) return INT_MAX;
+            if (tFrom - vFrom > best) best = tFrom - vFrom;
+        }
+        return best;
+    }
+
+    static void prepare(Side& side, const LandmarkTables& tables, const Vector<int>& from,
+                        const Vector<int>& to, int origin, int target) {
+        side.from = from.begin();
+        side.to = to.begin();
+        side.active = 0;
+
+        // Keep the landmarks with the largest bounds at the origin, sorted
+        // by insertion into the small fixed array
+        int score[ACTIVE_LANDMARKS];
+        for (int i = 0; i < tables.count(); i++) {
+            int offset = i * tables.portCount;
+            int tFrom = side.from[offset + target];
+            int tTo = side.to[offset + target];
+            int s = (origin >= 0) ? single(side.from, side.to, offset, tFrom, tTo, origin) : 0;
+
+            int pos = side.active;
+            if (pos == ACTIVE_LANDMARKS) {
+                if (s <= score[pos - 1]) continue;
+                pos--;
+            } else {
+                side.active++;
+            }
+            while (pos > 0 && score[pos - 1] < s) {
+                score[pos] = score[pos - 1];
+                side.offset[pos] = side.offset[pos - 1];
+                side.targetFrom[pos] = side.targetFrom[pos - 1];
+                side.targetTo[pos] = side.targetTo[pos - 1];
+                pos--;
+            }
+            score[pos] = s;
+            side.offset[pos] = offset;
+            side.targetFrom[pos] = tFrom;
+            side.targetTo[pos] = tTo;
+        }
+    }
+
+    static int bound(const Side& side, int port) {
+        int best = 0;
+        for (int i = 0; i < side.active; i++) {
+            int b = single(side.from, side.to, side.offset[i], side.targetFrom[i], side.targetTo[i], port);
+            if (b > best) best = b;
+        }
+        return best;
+    }
+
+public:
+    // origin picks the active landmarks; pass -1 to take the first ones
+    LandmarkHeuristic(const LandmarkTables& tables, int origin, int target) {
+        prepare(costSide, tables, tables.fromCost, tables.toCost, origin, target);
+        prepare(timeSide, tables, tables.fromTime, tables.toTime, origin, target);
+    }
+
+    int cost(int port) const { return bound(costSide, port); }
+    int time(int port) const { return bound(timeSide, port); }
+};
+
+class Landmarks {
+public:
+    static const int DEFAULT_COUNT = 4;
+
+    // Pick k landmarks by farthest-point selection and compute their tables
+    static void build(const Graph& graph, int k, LandmarkTables& tables) {
+        int n = graph.size;
+        if (k > n) k = n;
+        if (k < 0) k = 0;
+
+        LowerBounds::StaticLegs forward, reverse;
+        LowerBounds::buildStaticLegs(graph, false, forward);
+        LowerBounds::buildStaticLegs(graph, true, reverse);
+
+        tables.portCount = n;
+        tables.graphVersion = graph.getVersion();
+        tables.landmarks.clear();
+        tables.fromCost.clear();
+        tables.toCost.clear();
+        tables.fromTime.clear();
+        tables.toTime.clear();
+        if (n == 0 || k == 0) return;
+
+        // Round-trip fare to the nearest landmark so far; the next landmark
+        // is the port farthest from all of them. Unreachable counts as
+        // farthest, so separate parts of the network get a landmark first.
+        // Seeded with port 0 as a pseudo-landmark that is not kept.
+        Vector<long long> nearest;
+        nearest.resize(n);
+        for (int v = 0; v < n; v++) nearest[v] = LLONG_MAX;
+
+        Vector<int> from, to;
+        int next = 0;
+        for (int round = 0; round <= k; round++) {
+            LowerBounds::staticSearch(forward, next, false, from);
+            LowerBounds::staticSearch(reverse, next, false, to);
+
+            if (round > 0) {
+                tables.landmarks.push_back(next);
+                append(tables.fromCost, from);
+                append(tables.toCost, to);
+                Vector<int> fromT, toT;
+                LowerBounds::staticSearch(forward, next, true, fromT);
+                LowerBounds::staticSearch(reverse, next, true, toT);
+                append(tables.fromTime, fromT);
+                append(tables.toTime, toT);
+            }
+
+            for (int v = 0; v < n; v++) {
+                long long roundTrip = (from[v] == INT_MAX || to[v] == INT_MAX)
+                    ? LLONG_MAX : (long long)from[v] + to[v];
+                if (roundTrip < nearest[v]) nearest[v] = roundTrip;
+            }
+            // A landmark is never picked twice
+            for (int i = 0; i < tables.landmarks.size(); i++) nearest[tables.landmarks[i]] = -1;
+
+            next = 0;
+            for (int v = 1; v < n; v++) {
+                if (nearest[v] > nearest[next]) next = v;
+            }
+        }
+    }
+
+    // Binary table file (see binaryFile.h): landmark ids, then the four
+    // tables. A file built for another timetable is rejected by load()
+    // instead of giving bad bounds.
+    static bool save(const LandmarkTables& tables, const Graph& graph, const std::string& fileName) {
+        std::ofstream out(fileName, std::ios::binary | std::ios::trunc);
+        if (!out) return false;
+
+        BinaryFile::writeHeader(out, FILE_MAGIC, FILE_VERSION, graph, tables.count());
+        BinaryFile::writeInts(out, tables.landmarks);
+        BinaryFile::writeInts(out, tables.fromCost);
+        BinaryFile::writeInts(out, tables.toCost);
+        BinaryFile::writeInts(out, tables.fromTime);
+        BinaryFile::writeInts(out, tables.toTime);
+        return (bool)out;
+    }
+
+    // False if the file is missing, damaged or was built for another timetable
+    static bool load(LandmarkTables& tables, const Graph& graph, const std::string& fileName) {
+        std::ifstream in(fileName, std::ios::binary);
+        if (!in) return false;
+
+        int k = 0;
+        if (!BinaryFile::readHeader(in, FILE_MAGIC, FILE_VERSION, graph, k) ||
+            k < 0 || k > graph.size) {
+            return false;
+        }
+
+        int cells = k * graph.size;
+        LandmarkTables loaded;
+        loaded.portCount = graph.size;
+        loaded.graphVersion = graph.getVersion();
+        if (!BinaryFile::readInts(in, loaded.landmarks, k) ||
+            !BinaryFile::readInts(in, loaded.fromCost, cells) ||
+            !BinaryFile::readInts(in, loaded.toCost, cells) ||
+            !BinaryFile::readInts(in, loaded.fromTime, cells) ||
+            !BinaryFile::readInts(in, loaded.toTime, cells)) {
+            return false;
+        }
+        for (int i = 0; i < k; i++) {
+            if (loaded.landmarks[i] < 0 || loaded.landmarks[i] >= graph.size) return false;
+        }
+
+        tables = std::move(loaded);
+        return true;
+    }
+
+    // Install the tables from fileName in graph for active() if they were
+    // built for it. Nothing is built or written: on false the searches use
+    // LowerBounds until prepare() has brought the file up to date.
+    static bool install(const Graph& graph, const std::string& fileName) {
+        std::shared_ptr<LandmarkTables> tables = std::make_shared<LandmarkTables>();
+        if (!load(*tables, graph, fileName)) return false;
+        graph.derived.setShared<LandmarkTables>(&key, tables);
+        return true;
+    }
+
+    // Load the tables from fileName if they match graph, otherwise build
+    // k landmarks and write them back. Installs the result in graph for
+    // active(); copies of graph share it. The offline step (--preprocess);
+    // normal starts only install().
+    static const LandmarkTables& prepare(const Graph& graph, const std::string& fileName,
+                                         int k = DEFAULT_COUNT) {
+        std::shared_ptr<LandmarkTables> tables = std::make_shared<LandmarkTables>();
+        if (!load(*tables, graph, fileName) || tables->count() != (k > graph.size ? graph.size : k)) {
+            build(graph, k, *tables);
+            save(*tables, graph, fileName);
+        }
+        graph.derived.setShared<LandmarkTables>(&key, tables);
+        return *tables;
+    }
+
+    // Tables installed in graph by prepare(), or nullptr if there are none
+    // or the timetable changed since
+    static const LandmarkTables* active(const Graph& graph) {
+        std::shared_ptr<const LandmarkTables> tables = graph.derived.getShared<LandmarkTables>(&key);
+        if (!tables || tables->count() == 0 || tables->graphVersion != graph.getVersion() ||
+            tables->portCount != graph.size) {
+            return nullptr;
+        }
+        return tables.get();    // graph keeps them
+    }
+
+    // A sailing from -> to was added or retimed in place (timetableFeed.h).
+    // The tables are dropped if its leg shortens any distance they hold
+    // (the bounds would overestimate); the searches then fall back on
+    // LowerBounds until the next prepare(). Cancelled sailings only make
+    // the tables looser. Call on a graph no search is reading; other snapshots
+    // keep their tables.
+    static void legAdded(const Graph& graph, int from, int to, int cost, int duration) {
+        const LandmarkTables* tables = active(graph);
+        if (!tables) return;
+        for (int i = 0; i < tables->count(); i++) {
+            int offset = i * tables->portCount;
+            if (shortens(tables->fromCost, tables->toCost, offset, from, to, cost) ||
+                shortens(tables->fromTime, tables->toTime, offset, from, to, duration)) {
+                graph.derived.setShared<LandmarkTables>(&key, nullptr);
+                return;
+            }
+        }
+    }
+
+    // Call search(heuristic) with the best bounds available from origin to target:
+    // the landmark tables once prepared, else LowerBounds' exact bounds
+    // (one reverse search per new destination)
+    template <typename Search>
+    static auto withBounds(const Graph& graph, int origin, int target, Search search)
+        -> decltype(search(PathFinding::NoHeuristic())) {
+        if (const LandmarkTables* tables = active(graph)) {
+            return search(LandmarkHeuristic(*tables, origin, target));
+        }
+        return search(BoundsHeuristic(LowerBounds::forDestination(graph, target)));
+    }
+
+private:
+    static const unsigned int FILE_MAGIC = 0x4c524f4fu;    // "OORL"
+    static const unsigned int FILE_VERSION = 1;
+
+    static constexpr int key = 0;     // graph.derived slot
+
+    // A leg from -> to of weight w beats d(L, to) or d(from, L)
+    static bool shortens(const Vector<int>& fromL, const Vector<int>& toL, int offset, int from, int to, int w) {
+        if (fromL[offset + from] != INT_MAX && fromL[offset + from] + w < fromL[offset + to]) return true;
+        return toL[offset + to] != INT_MAX && toL[offset + to] + w < toL[offset + from];
+    }
+
+    static void append(Vector<int>& table, const Vector<int>& row) {
+        for (int i = 0; i < row.size(); i++) table.push_back(row[i]);
+    }
+};
+
+#endif
@@ -0,0 +1,127 @@
+#ifndef LATESTDEPARTURE_H
+#define LATESTDEPARTURE_H
+
+#include <limits.h>
+#include <string>
+#include "Graph.hpp"
+#include "pathFinding.h"
+#include "connections.h"
+#include "timeUtils.h"
+#include "vector.h"
+
+// Latest departure from every port that still reaches one target by a
+// deadline (one-to-all, backwards in time).
+struct LatestDepartures {
+    int target;
+    long long deadline;             // absolute minutes (TimeUtils)
+    Vector<long long> departure;    // per port, LatestDeparture::NONE if it cannot make it
+    Vector<Connection> firstLeg;    // per port, the leg to take (route nullptr if none)
+
+    LatestDepartures() : target(-1), deadline(0) {}
+};
+
+// Reverse connection scan. Sailings (runs of weekly services included)
+// are scanned once by decreasing arrival, so every sailing that could follow the current one (it leaves
+// after this one arrives) has already been seen. A sailing is usable if
+// it lands at the target by the deadline, or if its far end has a
+// departure at least an hour after it arrives - the same minimum layover
+// the forward searches use. Layover fees do not change when one can leave.
+class LatestDeparture {
+public:
+    static const long long NONE = LLONG_MIN;
+    static const long long NO_DEADLINE = LLONG_MAX;
+
+    static void search(const Graph& graph, int target, long long deadline, LatestDepartures& out) {
+        out.target = target;
+        out.deadline = deadline;
+        out.departure.clear();
+        out.departure.resize(graph.size);
+        out.firstLeg.clear();
+        out.firstLeg.resize(graph.size);
+        for (int i = 0; i < graph.size; i++) {
+            out.departure[i] = NONE;
+            out.firstLeg[i].route = nullptr;
+        }
+        if (target < 0 || target >= graph.size) return;
+
+        long long* latest = out.departure.begin();
+        ConnectionScan scan(graph, ConnectionScan::BY_ARRIVAL, deadline);
+        while (const Connection* next = scan.next()) {
+            const Connection& conn = *next;
+            if (conn.from == target) continue;
+
+            bool onward = (conn.to == target) ||
+                          (latest[conn.to] != NONE && latest[conn.to] - conn.arrival >= 60);
+            // On a tie keep the later sailing in the scan, which arrives
+            // earlier and leaves the most slack further on
+            if (onward && conn.departure >= latest[conn.from]) {
+                latest[conn.from] = conn.departure;
+                out.firstLeg[conn.from] = conn;
+            }
+        }
+    }
+
+    // The itinerary behind labels from startIndex, found = false if there
+    // is none. totalCost includes layover fees (as findShortestTimePath).
+    static PathFinding::PathResult* findLatestPath(const Graph& graph, const LatestDepartures& labels,
+                                                   int startIndex) {
+        PathFinding::PathResult* result = new PathFinding::PathResult();
+        int n = labels.departure.size();
+        if (startIndex < 0 || startIndex >= n || startIndex == labels.target ||
+            labels.departure[startIndex] == NONE) {
+            return result;
+        }
+
+        // Each leg's far end leaves later than the leg arrives, so the
+        // walk cannot cycle on consistent labels; the hop limit is a guard
+        result->path.insertEnd(startIndex);
+        int port = startIndex;
+        for (int hops = 0; port != labels.target; hops++) {
+            const Connection& leg = labels.firstLeg[port];
+            if (!leg.route || hops >= n) {
+                result->path.clear();
+                result->routes.clear();
+                return result;
+            }
+            result->routes.insertEnd(Connections::routeOf(leg));
+            port = leg.to;
+            result->path.insertEnd(port);
+        }
+        result->nodesSettled = result->path.getSize();
+
+        PathFinding::finishFastest(graph, result);
+        return result;
+    }
+
+    // Latest itinerary from startIndex reaching endIndex by date ("D/M/YYYY")
+    // and time ("HH:MM")
+    static PathFinding::PathResult* findLatestPath(const Graph& graph, int startIndex, int endIndex,
+                                                   const std::string& date, const std::string& time) {
+        LatestDepartures labels;
+        search(graph, endIndex, TimeUtils::toAbsoluteMinutes(date, time), labels);
+        return findLatestPath(graph, labels, startIndex);
+    }
+};
+
+// A* heuristic for a forward search towards labels.target: inner's
+// bounds, except that ports with no schedule-feasible itinerary to the
+// target at all (labels from a search with NO_DEADLINE) are reported
+// unreachable, so they are never queued. This prunes more than the static
+// bounds, which only know which ports are connected. Because the forward
+// searches keep one label per port, not spending labels on dead ends can
+// also turn up a cheaper or feasible itinerary the plain search misses.
+template <typename Inner>
+struct FeasibleHeuristic {
+    const LatestDepartures* labels;
+    Inner inner;
+
+    FeasibleHeuristic(const LatestDepartures& l, const Inner& i) : labels(&l), inner(i) {}
+
+    bool reaches(int port) const {
+        return port == labels->target || labels->departure[port] != LatestDeparture::NONE;
+    }
+    int cost(int port) const { return reaches(port) ? inner.cost(port) : INT_MAX; }
+    int time(int port) const { return reaches(port) ? inner.time(port) : INT_MAX; }
+};
+
+#endif
@@ -2,6 +2,8 @@
 #define LINKEDLIST_H
 
 #include <stdexcept>
+#include <utility>
+#include "nodePool.h"
 
 template <typename T>
 class LinkedList {
@@ -9,7 +11,36 @@ public:
     struct Node {
         T data;
         Node* next;
-        Node(T val) : data(val), next(nullptr) {}
+        Node(const T& val) : data(val), next(nullptr) {}
+        Node(T&& val) : data(std::move(val)), next(nullptr) {}
+    };
+
+    // Forward iterators so callers can walk the list in O(n) with range-for
+    // instead of calling get(i) in a loop
+    class iterator {
+    public:
+        explicit iterator(Node* n = nullptr) : node(n) {}
+        T& operator*() const { return node->data; }
+        T* operator->() const { return &node->data; }
+        iterator& operator++() { node = node->next; return *this; }
+        iterator operator++(int) { iterator tmp = *this; node = node->next; return tmp; }
+        bool operator==(const iterator& other) const { return node == other.node; }
+        bool operator!=(const iterator& other) const { return node != other.node; }
+    private:
+        Node* node;
+    };
+
+    class const_iterator {
+    public:
+        explicit const_iterator(const Node* n = nullptr) : node(n) {}
+        const T& operator*() const { return node->data; }
+        const T* operator->() const { return &node->data; }
+        const_iterator& operator++() { node = node->next; return *this; }
+        const_iterator operator++(int) { const_iterator tmp = *this; node = node->next; return tmp; }
+        bool operator==(const const_iterator& other) const { return node == other.node; }
+        bool operator!=(const const_iterator& other) const { return node != other.node; }
+    private:
+        const Node* node;
     };
 
     Node* head;
@@ -19,30 +50,80 @@ public:
     LinkedList() : head(nullptr), tail(nullptr), size(0) {}
     ~LinkedList() { clear(); }
 
+    // Deep copy
+    LinkedList(const LinkedList& other) : head(nullptr), tail(nullptr), size(0) {
+        reserve(other.size);
+        for (const T& val : other) insertEnd(val);
+    }
+
+    LinkedList& operator=(const LinkedList& other) {
+        if (this != &other) {
+            clear();
+            reserve(other.size);
+            for (const T& val : other) insertEnd(val);
+        }
+        return *this;
+    }
+
+    // Moving hands the nodes (and the slabs they live in) to the new list
+    LinkedList(LinkedList&& other) noexcept : head(nullptr), tail(nullptr), size(0) {
+        swapWith(other);
+    }
+
+    LinkedList& operator=(LinkedList&& other) noexcept {
+        if (this != &other) {
+            clear();
+            swapWith(other);
+        }
+        return *this;
+    }
+
     void insertEnd(T val) {
-        Node* newNode = new Node(val);
+        Node* newNode = pool.create(std::move(val));
         if (!head) head = tail = newNode;
         else { tail->next = newNode; tail = newNode; }
         size++;
     }
 
     void insertFront(T val) {
-        Node* newNode = new Node(val);
+        Node* newNode = pool.create(std::move(val));
         if (!head) head = tail = newNode;
         else { newNode->next = head; head = newNode; }
         size++;
     }
 
+    // Unlink and destroy the node holding item; false if it is not in the list
+    bool remove(const T* item) {
+        Node* previous = nullptr;
+        for (Node* current = head; current; previous = current, current = current->next) {
+            if (&current->data != item) continue;
+            if (previous) previous->next = current->next;
+            else head = current->next;
+            if (tail == current) tail = previous;
+            pool.destroy(current);
+            size--;
+            return true;
+        }
+        return false;
+    }
+
+    // Make room for n elements in all, so a list built to a known length
+    // takes one allocation
+    void reserve(int n) {
+        if (n > size) pool.reserve(n - size);
+    }
+
     bool isEmpty() const { return head == nullptr; }
 
     int getSize() const { return size; }
 
+    // Nodes go back to the pool; the slabs stay around for the next inserts
     void clear() {
         Node* current = head;
         while (current) {
             Node* tmp = current;
             current = current->next;
-            delete tmp;
+            pool.destroy(tmp);
         }
         head = tail = nullptr;
         size = 0;
@@ -54,6 +135,41 @@ public:
         for (int i = 0; i < index; i++) current = current->next;
         return current->data;
     }
+
+    T& front() {
+        if (!head) throw std::out_of_range("List is empty");
+        return head->data;
+    }
+
+    const T& front() const {
+        if (!head) throw std::out_of_range("List is empty");
+        return head->data;
+    }
+
+    T& back() {
+        if (!tail) throw std::out_of_range("List is empty");
+        return tail->data;
+    }
+
+    const T& back() const {
+        if (!tail) throw std::out_of_range("List is empty");
+        return tail->data;
+    }
+
+    iterator begin() { return iterator(head); }
+    iterator end() { return iterator(nullptr); }
+    const_iterator begin() const { return const_iterator(head); }
+    const_iterator end() const { return const_iterator(nullptr); }
+
+private:
+    NodePool<Node> pool;
+
+    void swapWith(LinkedList& other) {
+        std::swap(head, other.head);
+        std::swap(tail, other.tail);
+        std::swap(size, other.size);
+        pool.swap(other.pool);
+    }
 };
 
 #endif
@@ -0,0 +1,196 @@
+#ifndef LOWERBOUNDS_H
+#define LOWERBOUNDS_H
+
+#include <limits.h>
+#include <mutex>
+#include "Graph.hpp"
+#include "pathFinding.h"
+#include "priorityQueue.h"
+#include "timeUtils.h"
+#include "vector.h"
+
+// Time-independent lower bounds towards one destination: for every port,
+// the least total fare and the least total sailing time of any sequence of
+// routes to the destination, ignoring schedules and layover fees. No real
+// itinerary can beat them, so they are admissible (and consistent) A*
+// heuristics for PathFinding's cheapest and fastest searches, with or
+// without preference filters.
+struct GoalBounds {
+    int destination;
+    Vector<int> minCost;    // INT_MAX where the destination is unreachable
+    Vector<int> minTime;
+
+    GoalBounds() : destination(-1) {}
+};
+
+// Adapts GoalBounds to the heuristic interface PathFinding expects
+struct BoundsHeuristic {
+    const GoalBounds* bounds;
+
+    explicit BoundsHeuristic(const GoalBounds& b) : bounds(&b) {}
+    int cost(int port) const { return bounds->minCost[port]; }
+    int time(int port) const { return bounds->minTime[port]; }
+};
+
+class LowerBounds {
+public:
+    // Time-independent weights of one leg, shared with the landmark tables
+    // (landmarks.h)
+    struct StaticLeg {
+        int other;      // the port at the far end of the leg
+        int cost;
+        int duration;
+    };
+    typedef Vector<Vector<StaticLeg> > StaticLegs;
+
+    // Bounds for destination, computed on first use and kept until the
+    // timetable changes (Graph::getVersion). Safe to call from the search
+    // worker and the UI thread at once; the returned bounds stay put until
+    // the timetable changes.
+    static const GoalBounds& forDestination(const Graph& graph, int destination) {
+        Cache& c = cache(graph);
+        std::lock_guard<std::mutex> lock(c.mutex);
+        if (c.graphVersion != graph.getVersion() || c.byDestination.size() != graph.size) {
+            c.graphVersion = graph.getVersion();
+            buildStaticLegs(graph, true, c.reverse);
+            c.byDestination.clear();
+            c.byDestination.resize(graph.size);
+            c.computedCount = 0;
+        }
+
+        GoalBounds& bounds = c.byDestination[destination];
+        if (bounds.destination != destination) {
+            bounds.destination = destination;
+            staticSearch(c.reverse, destination, false, bounds.minCost);
+            staticSearch(c.reverse, destination, true, bounds.minTime);
+            c.computedCount++;
+        }
+        return bounds;
+    }
+
+    // Bounds for destination if they are computed already, else nullptr
+    static const GoalBounds* cached(const Graph& graph, int destination) {
+        Cache& c = cache(graph);
+        std::lock_guard<std::mutex> lock(c.mutex);
+        if (c.graphVersion != graph.getVersion() || c.byDestination.size() != graph.size) return nullptr;
+        const GoalBounds& bounds = c.byDestination[destination];
+        return (bounds.destination == destination) ? &bounds : nullptr;
+    }
+
+    // Number of destinations with cached bounds
+    static int getCachedCount(const Graph& graph) { return cache(graph).computedCount; }
+
+    // A sailing from -> to was added or retimed in place (timetableFeed.h).
+    // Its leg joins the static legs, and only the destinations whose bounds
+    // it undercuts are recomputed on their next use. Legs of cancelled
+    // sailings are left in: the bounds get looser but stay admissible.
+    // Call on a graph no search is reading; it rewrites bounds they hold.
+    static void legAdded(const Graph& graph, int from, int to, int cost, int duration) {
+        Cache& c = cache(graph);
+        std::lock_guard<std::mutex> lock(c.mutex);
+        if (c.graphVersion != graph.getVersion() || c.byDestination.size() != graph.size) return;
+
+        c.reverse[to].push_back(StaticLeg{from, cost, duration});
+        for (int d = 0; d < c.byDestination.size(); d++) {
+            GoalBounds& bounds = c.byDestination[d];
+            if (bounds.destination != d) continue;
+            if (undercuts(bounds.minCost, from, to, cost) || undercuts(bounds.minTime, from, to, duration)) {
+                bounds.destination = -1;
+                c.computedCount--;
+            }
+        }
+    }
+
+    // Outgoing legs per port, or incoming legs when reversed
+    static void buildStaticLegs(const Graph& graph, bool reversed, StaticLegs& legs) {
+        legs.clear();
+        legs.resize(graph.size);
+        for (int u = 0; u < graph.size; u++) {
+            for (const Route& route : graph.vertices[u].routes) {
+                int v = graph.findPort(route.dest.name);
+                if (v == -1) continue;
+
+                int dep = TimeUtils::toAbsoluteMinutes(route.date, route.deptTime);
+                int arr = TimeUtils::toAbsoluteMinutes(route.date, route.arrTime);
+                if (arr < dep) arr += 24 * 60;
+
+                StaticLeg leg;
+                leg.other = reversed ? u : v;
+                leg.cost = route.cost;
+                leg.duration = arr - dep;
+                legs[reversed ? v : u].push_back(leg);
+            }
+        }
+        // Every run of a weekly service is the same leg
+        for (int i = 0; i < graph.services.size(); i++) {
+            const Service& service = graph.services[i];
+            StaticLeg leg;
+            leg.other = reversed ? service.from : service.to;
+            leg.cost = service.pattern.cost;
+            leg.duration = service.duration;
+            legs[reversed ? service.to : service.from].push_back(leg);
+        }
+    }
+
+    // A leg from -> to of weight w gives from a shorter distance than dist
+    static bool undercuts(const Vector<int>& dist, int from, int to, int w) {
+        return dist[to] != INT_MAX && dist[to] + w < dist[from];
+    }
+
+    // Dijkstra from source over legs, by fare or by sailing time.
+    // Over reversed legs this gives distances *to* source.
+    static void staticSearch(const StaticLegs& legs, int source, bool byTime, Vector<int>& dist) {
+        int n = legs.size();
+        dist.clear();
+        dist.resize(n);
+        for (int i = 0; i < n; i++) dist[i] = INT_MAX;
+        Vector<bool> done;
+        done.resize(n);
+
+        dist[source] = 0;
+        PriorityQueue<int> pq;
+        pq.push(source, 0);
+
+        while (!pq.isEmpty()) {
+            int v = pq.pop();
+            if (done[v]) continue;
+            done[v] = true;
+
+            for (const StaticLeg& leg : legs[v]) {
+                int weight = byTime ? leg.duration : leg.cost;
+                if (weight < 0) weight = 0;     // keep the bound admissible on odd data
+                int candidate = dist[v] + weight;
+                if (candidate < dist[leg.other]) {
+                    dist[leg.other] = candidate;
+                    pq.push(leg.other, candidate);
+                }
+            }
+        }
+    }
+
+private:
+    struct Cache {
+        unsigned long long graphVersion;
+        StaticLegs reverse;                     // incoming legs per port
+        Vector<GoalBounds> byDestination;       // indexed by destination port
+        int computedCount;
+        mutable std::mutex mutex;
+
+        Cache() : graphVersion(0), computedCount(0) {}
+
+        Cache(const Cache& other) : graphVersion(0), computedCount(0) {
+            std::lock_guard<std::mutex> lock(other.mutex);
+            graphVersion = other.graphVersion;
+            reverse = other.reverse;
+            byDestination = other.byDestination;
+            computedCount = other.computedCount;
+        }
+    };
+
+    static Cache& cache(const Graph& graph) {
+        static const int key = 0;
+        return graph.derived.get<Cache>(&key);
+    }
+};
+
+#endif
@@ -8,9 +8,12 @@
 #include "pathFinding.h"
 #include "uiHelpers.hpp"
 #include "vector.h"
-#include "queue.h"
+#include "arena.h"
 #include "linkedList.h"
 #include "timeUtils.h"
+#include "searchWorker.h"
+#include "pathEnumerator.h"
+#include "timetableSnapshots.h"
 
 struct MultiLegJourneyMenu {
     // Selection fields
@@ -39,8 +42,9 @@ struct MultiLegJourneyMenu {
     bool showModal;  // Whether to show port selection modal
     Vector<int> modalPorts;  // Ports to show in modal
     
-    // Pre-calculated paths from origin to destination
+    // Pre-calculated paths from origin to destination (owned by pathArena)
     Vector<PathFinding::PathResult*> allPaths;
+    Arena pathArena{"multi-leg paths"};
     
     // Current path result for drawing
     PathFinding::PathResult* currentPathResult;
@@ -78,8 +82,9 @@ struct MultiLegJourneyMenu {
     sf::RectangleShape resultCloseBtn;
     sf::Text resultCloseText;
     
-    // Helper pointers and window dimensions (for modal updates)
-    const Graph* graphPtr;
+    // Helper pointers and window dimensions (for modal updates); the
+    // timetable is pinned, as a newer one may be published in between
+    TimetableSnapshots::Snapshot graphPtr;
     const sf::Font* fontPtr;
     float winH;
     float winW;
@@ -199,6 +204,7 @@ struct MultiLegJourneyMenu {
     }
     
     void reset() {
+        SearchWorker::get().cancel(SearchWorker::MULTI_LEG);
         selectingOrigin = false;
         selectingDest = false;
         selectedOriginIndex = -1;
@@ -214,10 +220,8 @@ struct MultiLegJourneyMenu {
         showResult = false;
         
         // Clean up pre-calculated paths
-        for (int i = 0; i < allPaths.size(); i++) {
-            delete allPaths[i];
-        }
         allPaths.clear();
+        pathArena.reset();
         
         // Clean up current path result (only when leaving menu)
         if (currentPathResult) {
@@ -246,128 +250,17 @@ struct MultiLegJourneyMenu {
         }
     }
     
-    // Calculate all paths from origin to destination using BFS
-    void calculateAllPaths(Graph& graph, int origin, int destination) {
-        // Clean up old paths
-        for (int i = 0; i < allPaths.size(); i++) {
-            delete allPaths[i];
-        }
-        allPaths.clear();
-        
+    // Calculate paths from origin to destination, cheapest first, allocated
+    // from arena (runs on the search worker)
+    static void calculateAllPaths(const Graph& graph, int origin, int destination, Arena& arena,
+                                  Vector<PathFinding::PathResult*>& allPaths, SearchControl& control) {
         const int MAX_PATHS = 30;
-        const int MAX_DEPTH = 10;
-        
-        struct PathState {
-            int current;
-            Vector<int> path;
-            Vector<Route> routes;
-            int cost;
-            long long arrivalTime;
-            
-            PathState() : current(-1), cost(0), arrivalTime(0) {}
-        };
-        
-        Vector<PathState> queue;
-        PathState initial;
-        initial.current = origin;
-        initial.path.push_back(origin);
-        initial.arrivalTime = 0;
-        queue.push_back(initial);
-        
-        while (queue.size() > 0 && allPaths.size() < MAX_PATHS) {
-            PathState state = queue[0];
-            queue.erase(0);
-            
-            // Check if we reached destination
-            if (state.current == destination && state.path.size() > 1) {
-                PathFinding::PathResult* result = new PathFinding::PathResult();
-                result->found = true;
-                
-                for (int i = 0; i < state.path.size(); i++) {
-                    result->path.insertEnd(state.path[i]);
-                }
-                
-                for (int i = 0; i < state.routes.size(); i++) {
-                    result->routes.insertEnd(state.routes[i]);
-                }
-                
-                result->totalCost = state.cost;
-                
-                if (state.routes.size() > 0) {
-                    Route first = state.routes[0];
-                    Route last = state.routes[state.routes.size() - 1];
-                    long long startT = TimeUtils::toAbsoluteMinutes(first.date, first.deptTime);
-                    long long lastDep = TimeUtils::toAbsoluteMinutes(last.date, last.deptTime);
-                    long long lastArr = TimeUtils::toAbsoluteMinutes(last.date, last.arrTime);
-                    if (lastArr < lastDep) lastArr += 24 * 60;
-                    result->totalTime = (int)(lastArr - startT);
-                }
-                
-                allPaths.push_back(result);
-                continue;
-            }
-            
-            if (state.path.size() > MAX_DEPTH) continue;
-            
-            // Explore neighbors
-            LinkedList<Route>::Node* routeNode = graph.vertices[state.current].routes.head;
-            while (routeNode != nullptr) {
-                Route& route = routeNode->data;
-                int destIndex = graph.findPort(route.dest.name);
-                
-                if (destIndex == -1) {
-                    routeNode = routeNode->next;
-                    continue;
-                }
-                
-                // Check if already visited in this path
-                bool alreadyVisited = false;
-                for (int i = 0; i < state.path.size(); i++) {
-                    if (state.path[i] == destIndex) {
-                        alreadyVisited = true;
-                        break;
-                    }
-                }
-                if (alreadyVisited) {
-                    routeNode = routeNode->next;
-                    continue;
-                }
-                
-                // Check timing constraints
-                long long depAbs = TimeUtils::toAbsoluteMinutes(route.date, route.deptTime);
-                long long arrAbs = TimeUtils::toAbsoluteMinutes(route.date, route.arrTime);
-                if (arrAbs < depAbs) arrAbs += 24 * 60;
-                
-                bool timeValid = true;
-                if (state.current != origin) {
-                    if (state.arrivalTime > depAbs - 60) {
-                        timeValid = false;
-                    }
-                }
-                
-                if (timeValid) {
-                    PathState newState;
-                    newState.current = destIndex;
-                    newState.path = state.path;
-                    newState.path.push_back(destIndex);
-                    newState.routes = state.routes;
-                    newState.routes.push_back(route);
-                    newState.cost = state.cost + route.cost;
-                    
-                    // Add layover fee if waiting > 12 hours
-                    if (state.current != origin) {
-                        long long layover = depAbs - state.arrivalTime;
-                        if (layover > 720) {
-                            newState.cost += graph.vertices[state.current].port.portCharge;
-                        }
-                    }
-                    newState.arrivalTime = arrAbs;
-                    
-                    queue.push_back(newState);
-                }
-                
-                routeNode = routeNode->next;
-            }
+        
+        PathEnumerator<> paths(graph, origin, destination, PathFinding::AllowAll(), "", 1, MAX_PATHS);
+        while (!paths.isExhausted() && allPaths.size() < MAX_PATHS && !control.isCancelled()) {
+            int before = paths.getExpanded();
+            paths.run(SearchBudget(MAX_PATHS - allPaths.size(), 256), arena, allPaths);
+            control.step(paths.getExpanded() - before);
         }
     }
     
@@ -384,19 +277,32 @@ struct MultiLegJourneyMenu {
             PathFinding::PathResult* path = allPaths[i];
             if (!path || !path->found) continue;
             
-            // Find current port in this path
+            // Find current port in this path, keeping the legs in step so the
+            // legs into and out of it come for free (no indexed get())
             int currentPos = -1;
-            for (int j = 0; j < path->path.getSize(); j++) {
-                if (path->path.get(j) == currentPort) {
-                    currentPos = j;
+            int nextPort = -1;
+            const Route* legIn = nullptr;   // leg arriving at currentPort
+            const Route* legOut = nullptr;  // leg leaving currentPort
+            const Route* prevLeg = nullptr;
+            LinkedList<Route>::iterator legIt = path->routes.begin();
+            int pos = 0;
+            for (LinkedList<int>::iterator it = path->path.begin(); it != path->path.end(); ++it, ++pos) {
+                const Route* leg = (legIt != path->routes.end()) ? &*legIt : nullptr;
+                if (*it == currentPort) {
+                    currentPos = pos;
+                    legIn = prevLeg;
+                    legOut = leg;
+                    LinkedList<int>::iterator nextIt = it;
+                    ++nextIt;
+                    if (nextIt != path->path.end()) nextPort = *nextIt;
                     break;
                 }
+                prevLeg = leg;
+                if (legIt != path->routes.end()) ++legIt;
             }
             
             // If current port found and not at the end
-            if (currentPos >= 0 && currentPos < path->path.getSize() - 1) {
-                int nextPort = path->path.get(currentPos + 1);
-                
+            if (currentPos >= 0 && nextPort != -1) {
                 // Check if we've already added this port
                 bool alreadyAdded = false;
                 for (int k = 0; k < seenPorts.size(); k++) {
@@ -408,8 +314,8 @@ struct MultiLegJourneyMenu {
                 
                 // Get the route to this next port
                 Route routeToNext;
-                if (currentPos < path->routes.getSize()) {
-                    routeToNext = path->routes.get(currentPos);
+                if (legOut) {
+                    routeToNext = *legOut;
                 }
                 
                 if (!alreadyAdded) {
@@ -425,10 +331,9 @@ struct MultiLegJourneyMenu {
                         // First leg from origin - no layover
                         info.layoverDuration = 0;
                         info.layoverCost = 0;
-                    } else if (currentPos > 0 && currentPos < path->routes.getSize()) {
+                    } else if (legIn && legOut) {
                         // Connecting port - calculate layover at current port
-                        Route prevRoute = path->routes.get(currentPos - 1);
-                        int arrivalMinutes = TimeUtils::timeToMinutes(prevRoute.arrTime);
+                        int arrivalMinutes = TimeUtils::timeToMinutes(legIn->arrTime);
                         int departureMinutes = TimeUtils::timeToMinutes(routeToNext.deptTime);
                         if (departureMinutes < arrivalMinutes) {
                             departureMinutes += 24 * 60;
@@ -452,26 +357,42 @@ struct MultiLegJourneyMenu {
         return nextPorts;
     }
     
-    void startTracking(Graph& graph) {
+    void startTracking(const Graph& graph) {
         if (selectedOriginIndex >= 0 && selectedDestIndex >= 0) {
-            // Pre-calculate all paths from origin to destination
-            calculateAllPaths(graph, selectedOriginIndex, selectedDestIndex);
-            
-            isTracking = true;
-            journeyPath.clear();
-            journeyRoutes.clear();
-            journeyPath.insertEnd(selectedOriginIndex);
-            currentPortIndex = selectedOriginIndex;
-            showModal = false;  // Don't show modal automatically, wait for port click
-            
-            // Initialize path result for drawing
-            if (currentPathResult) {
-                delete currentPathResult;
-            }
-            currentPathResult = new PathFinding::PathResult();
-            currentPathResult->found = true;
-            currentPathResult->path.insertEnd(selectedOriginIndex);
+            // Pre-calculate all paths from origin to destination on the
+            // search worker; update() starts tracking once they are in
+            isTracking = false;
+            TimetableSnapshots::Snapshot searchGraph = TimetableSnapshots::keep(graph);
+            int origin = selectedOriginIndex;
+            int destination = selectedDestIndex;
+            SearchWorker::get().submit(SearchWorker::MULTI_LEG,
+                                       [searchGraph, origin, destination](SearchJob& job) {
+                calculateAllPaths(*searchGraph, origin, destination, job.arena, job.paths, job.control);
+            });
+        }
+    }
+    
+    void beginTracking(const SearchJob& job) {
+        allPaths.clear();
+        pathArena.reset();
+        for (int i = 0; i < job.paths.size(); i++) {
+            allPaths.push_back(pathArena.create<PathFinding::PathResult>(*job.paths[i]));
+        }
+        
+        isTracking = true;
+        journeyPath.clear();
+        journeyRoutes.clear();
+        journeyPath.insertEnd(selectedOriginIndex);
+        currentPortIndex = selectedOriginIndex;
+        showModal = false;  // Don't show modal automatically, wait for port click
+        
+        // Initialize path result for drawing
+        if (currentPathResult) {
+            delete currentPathResult;
         }
+        currentPathResult = new PathFinding::PathResult();
+        currentPathResult->found = true;
+        currentPathResult->path.insertEnd(selectedOriginIndex);
     }
     
     void updateModal() {
@@ -570,7 +491,7 @@ struct MultiLegJourneyMenu {
         // Check if this is the expected port
         if (portIndex == currentPortIndex) {
             // User clicked on the current port, show modal with accessible ports
-            graphPtr = &graph;
+            graphPtr = TimetableSnapshots::keep(graph);
             showModal = true;
             updateModal();
         } else {
@@ -594,8 +515,7 @@ struct MultiLegJourneyMenu {
         bool routeFound = false;
         
         // Search for route in graph from current port to selected port
-        for (int i = 0; i < graph.vertices[currentPortIndex].routes.getSize(); i++) {
-            Route r = graph.vertices[currentPortIndex].routes.get(i);
+        for (const Route& r : graph.vertices[currentPortIndex].routes) {
             if (r.dest.name == graph.vertices[portIdx].port.name) {
                 actualRoute = r;
                 routeFound = true;
@@ -644,10 +564,10 @@ struct MultiLegJourneyMenu {
         ss << "Multi-leg Journey Complete!\n\n";
         ss << "Path:\n";
         
-        for (int i = 0; i < journeyPath.getSize(); i++) {
-            int portIdx = journeyPath.get(i);
+        int legsLeft = journeyPath.getSize() - 1;
+        for (int portIdx : journeyPath) {
             ss << graph.vertices[portIdx].port.name;
-            if (i < journeyPath.getSize() - 1) {
+            if (legsLeft-- > 0) {
                 ss << " ->\n";
             }
         }
@@ -666,6 +586,11 @@ struct MultiLegJourneyMenu {
     }
     
     void update(float deltaTime) {
+        if (SearchJob* job = SearchWorker::get().take(SearchWorker::MULTI_LEG)) {
+            if (!job->failed) beginTracking(*job);
+            delete job;
+        }
+        
         if (showAlert && alertTimer > 0) {
             alertTimer -= deltaTime;
             if (alertTimer <= 0) {
@@ -754,6 +679,8 @@ struct MultiLegJourneyMenu {
                 
                 sf::FloatRect itemRect(panelX + 20, startY + visibleIndex * (itemH + 2), 340, itemH);
                 if (itemRect.contains(mouseGlobal)) {
+                    // A track still being prepared was for the old ports
+                    SearchWorker::get().cancel(SearchWorker::MULTI_LEG);
                     if (selectingOrigin) {
                         selectedOriginIndex = i;
                         originText.setString(graph.vertices[i].port.name);
@@ -832,7 +759,7 @@ struct MultiLegJourneyMenu {
              const sf::Vector2f& mouseGlobal, float panelX, float winHParam, float winWParam = 1600.f) {
         
         // Store pointers for modal updates
-        graphPtr = &graph;
+        graphPtr = TimetableSnapshots::keep(graph);
         fontPtr = &font;
         winH = winHParam;
         winW = winWParam;
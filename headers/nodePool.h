@@ -0,0 +1,120 @@
+#ifndef NODEPOOL_H
+#define NODEPOOL_H
+
+#include <cstddef>
+#include <new>
+#include <utility>
+
+// Slab allocator for fixed-size list nodes.
+// Nodes are carved out of slabs that double in size (up to MAX_SLAB_NODES),
+// and released nodes go on a free list to be reused by the next create().
+// Slabs are only returned to the system when the pool is destroyed.
+// Every list owns a pool and most lists are short, so the pool itself is
+// two pointers, and the first slab holds one node and shares its
+// allocation with the slab header.
+template <typename Node>
+class NodePool {
+private:
+    static const int FIRST_SLAB_NODES = 1;
+    static const int MAX_SLAB_NODES = 1024;
+
+    // Header of one allocation; the nodes follow it
+    struct Slab {
+        int capacity;
+        int used;       // bump index into items()
+        Slab* next;
+
+        static size_t itemsOffset() {
+            return (sizeof(Slab) + alignof(Node) - 1) / alignof(Node) * alignof(Node);
+        }
+        Node* items() { return reinterpret_cast<Node*>(reinterpret_cast<char*>(this) + itemsOffset()); }
+    };
+
+    // Overlays the memory of a released node
+    struct FreeSlot {
+        FreeSlot* next;
+    };
+
+    Slab* slabs;        // most recent slab first
+    FreeSlot* freeList;
+
+    void addSlab(int capacity) {
+        Slab* slab = static_cast<Slab*>(::operator new(Slab::itemsOffset() + sizeof(Node) * capacity));
+        slab->capacity = capacity;
+        slab->used = 0;
+        slab->next = slabs;
+        slabs = slab;
+    }
+
+    void* allocate() {
+        if (freeList) {
+            FreeSlot* slot = freeList;
+            freeList = slot->next;
+            return slot;
+        }
+        if (!slabs || slabs->used >= slabs->capacity) {
+            int capacity = slabs ? slabs->capacity * 2 : FIRST_SLAB_NODES;
+            if (capacity > MAX_SLAB_NODES) capacity = MAX_SLAB_NODES;
+            addSlab(capacity);
+        }
+        return &slabs->items()[slabs->used++];
+    }
+
+    void deallocate(void* mem) {
+        FreeSlot* slot = static_cast<FreeSlot*>(mem);
+        slot->next = freeList;
+        freeList = slot;
+    }
+
+public:
+    NodePool() : slabs(nullptr), freeList(nullptr) {}
+
+    // Every node must have been destroyed by the owner before this runs
+    ~NodePool() {
+        while (slabs) {
+            Slab* tmp = slabs;
+            slabs = slabs->next;
+            ::operator delete(tmp);
+        }
+    }
+
+    NodePool(const NodePool&) = delete;
+    NodePool& operator=(const NodePool&) = delete;
+
+    template <typename... Args>
+    Node* create(Args&&... args) {
+        void* mem = allocate();
+        Node* node;
+        try {
+            node = new (mem) Node(std::forward<Args>(args)...);
+        } catch (...) {
+            deallocate(mem);
+            throw;
+        }
+        return node;
+    }
+
+    void destroy(Node* node) {
+        node->~Node();
+        deallocate(node);
+    }
+
+    // Exchange slabs with another pool (used when a list is moved)
+    void swap(NodePool& other) {
+        std::swap(slabs, other.slabs);
+        std::swap(freeList, other.freeList);
+    }
+
+    // Room for n more nodes in one slab of just the missing size, for
+    // callers that know how many they are about to create
+    void reserve(int n) {
+        int spare = slabs ? slabs->capacity - slabs->used : 0;
+        for (FreeSlot* slot = freeList; slot && spare < n; slot = slot->next) spare++;
+        if (spare >= n) return;
+        // What is left of the current slab stays usable through the free list
+        while (slabs && slabs->used < slabs->capacity) deallocate(&slabs->items()[slabs->used++]);
+        addSlab(n - spare);
+    }
+};
+
+#endif
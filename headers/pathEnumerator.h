@@ -0,0 +1,337 @@
+#ifndef PATHENUMERATOR_H
+#define PATHENUMERATOR_H
+
+#include <algorithm>
+#include <chrono>
+#include <limits.h>
+#include <string>
+#include "Graph.hpp"
+#include "pathFinding.h"
+#include "lowerBounds.h"
+#include "latestDeparture.h"
+#include "connections.h"
+#include "priorityQueue.h"
+#include "timeUtils.h"
+#include "arena.h"
+#include "vector.h"
+
+// How much one PathEnumerator::run() may do before it returns. A zero
+// field is no limit; the run ends at whichever limit comes first.
+struct SearchBudget {
+    int results;        // itineraries to add
+    int expansions;     // partial paths to expand
+    int milliseconds;   // wall-clock time
+
+    SearchBudget(int maxResults = 0, int maxExpansions = 0, int maxMilliseconds = 0)
+        : results(maxResults), expansions(maxExpansions), milliseconds(maxMilliseconds) {}
+};
+
+// Anytime enumeration of simple itineraries from origin to destination,
+// cheapest first. Partial paths wait in a frontier keyed by their cost plus
+// the LowerBounds fare to the destination; since that bound never
+// overestimates, an itinerary is only popped once nothing left in the
+// frontier can end up cheaper, so results come out in nondecreasing cost
+// (layover fees included).
+//
+// The frontier survives between runs: each run() spends a budget and
+// returns what it found, and the next run() picks up where it stopped,
+// until isExhausted(). Partial paths that cannot reach the destination at
+// all, or whose arrival is too late for every onward sailing (latest
+// departures with no deadline), are never queued. Layover rules are the
+// searches': at least an hour, port charge when the wait exceeds 12 hours.
+//
+// With a limit of K results the enumerator only has to keep what can still
+// make the K cheapest, and prunes (branch and bound) without losing any of
+// them:
+// - a partial path whose bound is no better than the K-th cheapest
+//   complete itinerary queued so far is dropped;
+// - a partial path is not expanded when, by the time it is popped, K
+//   paths already expanded at the same port dominate it: no later
+//   arrival, no more ports visited (a subset, so every continuation stays
+//   simple), and no dearer even after paying the port charge for a longer
+//   wait. Each continuation of it is then matched by K distinct
+//   itineraries at least as cheap. Dominance is transitive, so a
+//   continuation of a dominator dropped later is still matched.
+//   Only expanded paths are compared against: the frontier pops each
+//   port's paths cheapest first, so a dominator has usually been popped
+//   already, and the labels stay as few as the expansions. They are
+//   grouped by arrival and kept cheapest first within a group, so the
+//   test stops in each group at the first label too dear to dominate.
+template <typename Allowed = PathFinding::AllowAll>
+class PathEnumerator {
+public:
+    // firstLegDate restricts the first sailing to one date ("" for any);
+    // itineraries have at least minLegs legs; limit caps the results (and
+    // enables the pruning), 0 for no limit
+    PathEnumerator(const Graph& g, int originIndex, int destinationIndex,
+                   const Allowed& allowedLegs = Allowed(), const std::string& firstLegDate = "",
+                   int minLegs = 1, int maxResults = 0)
+        : graph(&g), origin(originIndex), destination(destinationIndex), allowed(allowedLegs),
+          date(firstLegDate), minimumLegs(minLegs), limit(maxResults), words((g.size + 63) / 64),
+          firstLegDay(firstLegDate.empty() ? 0 : (long long)TimeUtils::dateToDays(firstLegDate) * 24 * 60),
+          firstLegRun(firstLegDate.empty() ? 0 : TimeUtils::civilDay(firstLegDate)),
+          bounds(nullptr), departures(&Connections::byPort(g)), expanded(0), found(0), pruned(0),
+          states("path enumerator") {
+        if (origin < 0 || destination < 0 || origin >= g.size || destination >= g.size ||
+            origin == destination) {
+            return;
+        }
+        bounds = &LowerBounds::forDestination(g, destination);
+        if (bounds->minCost[origin] == INT_MAX) return;
+        LatestDeparture::search(g, destination, LatestDeparture::NO_DEADLINE, latest);
+        if (limit > 0) {
+            labels.resize(g.size);
+        }
+
+        Partial* start = states.create<Partial>(origin, nullptr, nullptr, 0, 0);
+        start->visited = states.allocateArray<unsigned long long>(words);
+        for (int i = 0; i < words; i++) start->visited[i] = 0;
+        start->visited[origin >> 6] |= 1ull << (origin & 63);
+        start->summary = 1ull << (origin & 63);
+        frontier.push(start, bounds->minCost[origin]);
+    }
+
+    PathEnumerator(const PathEnumerator&) = delete;
+    PathEnumerator& operator=(const PathEnumerator&) = delete;
+
+    // Enumerate until budget is spent or nothing is left. New itineraries
+    // (allocated from arena) are appended to out cheapest first, continuing
+    // the order of earlier runs. Returns the number added.
+    int run(const SearchBudget& budget, Arena& arena, Vector<PathFinding::PathResult*>& out) {
+        typedef std::chrono::steady_clock Clock;
+        Clock::time_point deadline = Clock::now() + std::chrono::milliseconds(budget.milliseconds);
+        int added = 0;
+        int expandedHere = 0;
+
+        while (!isExhausted()) {
+            if (budget.results > 0 && added >= budget.results) break;
+            if (budget.expansions > 0 && expandedHere >= budget.expansions) break;
+            // Reading the clock costs about as much as an expansion
+            if (budget.milliseconds > 0 && (expandedHere & 31) == 0 && Clock::now() >= deadline) break;
+
+            const Partial* state = frontier.pop();
+            if (state->step.port == destination) {
+                out.push_back(PathFinding::buildResult(&state->step, arena));
+                added++;
+                found++;
+                continue;
+            }
+            if (limit > 0 && state->step.port != origin) {
+                if (dominated(state)) {
+                    pruned++;
+                    continue;
+                }
+                settle(state);
+            }
+            expand(state);
+            expandedHere++;
+            expanded++;
+        }
+        return added;
+    }
+
+    // Every itinerary (up to the limit) has been returned
+    bool isExhausted() const { return frontier.isEmpty() || (limit > 0 && found >= limit); }
+
+    int getExpanded() const { return expanded; }
+    int getFound() const { return found; }
+    int getPruned() const { return pruned; }    // partial paths dropped by the limit
+
+private:
+    // A queued path: the step it ends with plus the ports it has visited
+    // (one bit per port, words long)
+    struct Partial {
+        PathFinding::PathStep step;
+        unsigned long long* visited;
+        unsigned long long summary;     // visited words OR-ed together
+
+        Partial(int port, const Route* route, const Partial* from, int cost, long long arrival, int day = -1)
+            : step(port, route, from ? &from->step : nullptr, cost, arrival, day), visited(nullptr),
+              summary(0) {}
+    };
+
+    // An expanded partial path, as the dominance test sees it
+    struct Label {
+        int cost;
+        int stops;
+        unsigned long long summary;
+        const unsigned long long* visited;  // the path's own bits (in states)
+    };
+
+    // The labels at a port arriving at the same time, cheapest first
+    struct ArrivalGroup {
+        long long arrival;
+        Vector<Label> labels;
+    };
+
+    const Graph* graph;
+    int origin;
+    int destination;
+    Allowed allowed;
+    std::string date;
+    int minimumLegs;
+    int limit;
+    int words;
+    long long firstLegDay;      // start of the first-leg date, absolute minutes
+    int firstLegRun;            // the same date as a civil day, for weekly services
+    const GoalBounds* bounds;
+    const DepartureIndex* departures;
+    LatestDepartures latest;
+    int expanded;
+    int found;
+    int pruned;
+    Arena states;
+    PriorityQueue<const Partial*> frontier;
+    Vector<Vector<ArrivalGroup> > labels;   // per port, by arrival (with a limit)
+    PriorityQueue<int> cheapestComplete;    // the limit cheapest queued itineraries, dearest on top
+
+    bool visits(const Partial* state, int port) const {
+        return (state->visited[port >> 6] >> (port & 63)) & 1;
+    }
+
+    // Cost no partial path may reach from here on, INT_MAX while fewer
+    // than limit itineraries are queued
+    int cutoff() const {
+        if (limit <= 0 || cheapestComplete.getSize() < limit) return INT_MAX;
+        return -cheapestComplete.topPriority();
+    }
+
+    // At least limit paths expanded at the same port beat state for every
+    // continuation
+    bool dominated(const Partial* state) const {
+        const PathFinding::PathStep& self = state->step;
+        const Vector<ArrivalGroup>& groups = labels[self.port];
+        int fee = graph->vertices[self.port].port.portCharge;
+        int count = 0;
+        for (int g = 0; g < groups.size() && groups[g].arrival <= self.arrivalTime; g++) {
+            // Arriving earlier can only turn a wait into a long one
+            long long maxCost = self.cost - (groups[g].arrival < self.arrivalTime ? fee : 0);
+            const Vector<Label>& kept = groups[g].labels;
+            for (int i = 0; i < kept.size() && kept[i].cost <= maxCost; i++) {
+                const Label& l = kept[i];
+                // Every continuation must still make the minimum length
+                if (l.stops < self.stops && l.stops < minimumLegs) continue;
+                // Cheap necessary conditions for the subset test (stops
+                // counts the visited ports)
+                if (l.stops > self.stops || (l.summary & ~state->summary) != 0) continue;
+                bool subset = true;
+                for (int w = 0; w < words && subset; w++) subset = (l.visited[w] & ~state->visited[w]) == 0;
+                if (subset && ++count >= limit) return true;
+            }
+        }
+        return false;
+    }
+
+    // state is about to be expanded: it may dominate later paths here
+    void settle(const Partial* state) {
+        Label label;
+        label.cost = state->step.cost;
+        label.stops = state->step.stops;
+        label.summary = state->summary;
+        label.visited = state->visited;
+
+        // Both orders are usually already right, so these shifts are short
+        Vector<ArrivalGroup>& groups = labels[state->step.port];
+        long long arrival = state->step.arrivalTime;
+        int g = groups.size();
+        while (g > 0 && groups[g - 1].arrival > arrival) g--;
+        if (g == 0 || groups[g - 1].arrival != arrival) {
+            groups.push_back(ArrivalGroup());
+            for (int i = groups.size() - 1; i > g; i--) std::swap(groups[i], groups[i - 1]);
+            groups[g].arrival = arrival;
+        } else {
+            g--;
+        }
+        Vector<Label>& kept = groups[g].labels;
+        kept.push_back(label);
+        for (int i = kept.size() - 1; i > 0 && kept[i - 1].cost > label.cost; i--) std::swap(kept[i], kept[i - 1]);
+    }
+
+    void expand(const Partial* state) {
+        const PathFinding::PathStep& at = state->step;
+        bool atOrigin = (at.port == origin);
+        bool onDate = atOrigin && !date.empty();
+        long long earliest = atOrigin ? LLONG_MIN : at.arrivalTime + 60;
+        // Away from the origin only sailings an hour after arrival will do;
+        // from it, only those on the first-leg date (when one is set)
+        int first = departures->begin(at.port);
+        if (!atOrigin) {
+            first = departures->firstFrom(at.port, earliest);
+        } else if (onDate) {
+            first = departures->firstFrom(at.port, firstLegDay);
+        }
+        for (int i = first; i < departures->end(at.port); i++) {
+            const Connection& conn = departures->sailings[i];
+            if (onDate) {
+                if (conn.departure >= firstLegDay + 24 * 60) break;
+                if (conn.route->date != date) continue;
+            }
+            extend(state, conn);
+        }
+
+        // Weekly services run by run, until a run leads nowhere; the later
+        // ones would not either
+        const Vector<int>& services = graph->vertices[at.port].services;
+        for (int k = 0; k < services.size(); k++) {
+            if (onDate) {
+                if (graph->services[services[k]].runsOn(firstLegRun)) {
+                    extend(state, Connections::occurrence(*graph, services[k], firstLegRun));
+                }
+                continue;
+            }
+            Connection run;
+            bool more = Connections::firstOccurrence(*graph, services[k], earliest, run);
+            while (more && extend(state, run)) more = Connections::nextOccurrence(*graph, run, run);
+        }
+    }
+
+    // Queue state followed by conn. False when conn cannot be taken or
+    // would be cut off, and so neither can a later run of the same
+    // service: it arrives later and waits no less.
+    bool extend(const Partial* state, const Connection& conn) {
+        const PathFinding::PathStep& at = state->step;
+        int next = conn.to;
+        if (bounds->minCost[next] == INT_MAX) return false;
+        if (!allowed(*conn.route, next) || visits(state, next)) return false;
+        // Itineraries end at the destination, so a short one is dropped
+        if (next == destination && at.stops < minimumLegs) return false;
+
+        int cost = at.cost + conn.cost;
+        if (at.port != origin && conn.departure - at.arrivalTime > 720) {
+            cost += graph->vertices[at.port].port.portCharge;
+        }
+        // Too late for anything that still gets there
+        if (next != destination && (latest.departure[next] == LatestDeparture::NONE ||
+                                    latest.departure[next] - conn.arrival < 60)) {
+            return false;
+        }
+        return push(state, conn, cost);
+    }
+
+    bool push(const Partial* from, const Connection& conn, int cost) {
+        int port = conn.to;
+        int key = cost + bounds->minCost[port];
+        if (limit > 0) {
+            // Queued after the limit cheapest, so it would never come out
+            if (key >= cutoff()) {
+                pruned++;
+                return false;
+            }
+        }
+
+        Partial* next = states.create<Partial>(port, conn.route, from, cost, conn.arrival, conn.day);
+        next->visited = states.allocateArray<unsigned long long>(words);
+        for (int w = 0; w < words; w++) next->visited[w] = from->visited[w];
+        next->visited[port >> 6] |= 1ull << (port & 63);
+        next->summary = from->summary | (1ull << (port & 63));
+
+        if (limit > 0 && port == destination) {
+            cheapestComplete.push(cost, -cost);
+            if (cheapestComplete.getSize() > limit) cheapestComplete.pop();
+        }
+        frontier.push(next, key);
+        return true;
+    }
+};
+
+#endif
@@ -2,10 +2,14 @@
 #define PATHFINDING_H
 
 #include "Graph.hpp"
+#include "connections.h"
 #include "priorityQueue.h"
+#include "reachability.h"
+#include "searchControl.h"
 #include "linkedList.h"
 #include "timeUtils.h"
 #include "vector.h"
+#include "arena.h"
 #include <limits.h>
 
 class PathFinding {
@@ -16,22 +20,193 @@ public:
         int totalCost;
         int totalTime; 
         bool found;
+        int nodesSettled;   // ports the search expanded (for comparing search modes)
         
-        PathResult() : totalCost(0), totalTime(0), found(false) {}
+        PathResult() : totalCost(0), totalTime(0), found(false), nodesSettled(0) {}
+    };
+    
+    // One hop of a partial path in the route enumerators. Each step points
+    // back at the step it extends, so growing a path is one arena allocation
+    // instead of copying the whole port/route prefix into a new state.
+    struct PathStep {
+        int port;
+        const Route* route;     // leg that arrived at port (nullptr at the origin)
+        const PathStep* prev;
+        int cost;
+        long long arrivalTime;
+        int stops;              // ports on the path so far, including this one
+        int day;                // run day when route is a weekly service's pattern, else -1
+        
+        PathStep(int p, const Route* r, const PathStep* from, int c, long long arrival, int runDay = -1)
+            : port(p), route(r), prev(from), cost(c), arrivalTime(arrival),
+              stops(from ? from->stops + 1 : 1), day(runDay) {}
+    };
+    
+    static bool pathVisits(const PathStep* step, int port) {
+        for (; step; step = step->prev) {
+            if (step->port == port) return true;
+        }
+        return false;
+    }
+    
+    // First leg of the path ending at step (nullptr for a bare origin)
+    static const Route* firstLeg(const PathStep* step) {
+        const Route* first = nullptr;
+        for (; step; step = step->prev) {
+            if (step->route) first = step->route;
+        }
+        return first;
+    }
+    
+    // Size result's lists for the parent chain from endIndex back to
+    // startIndex, before it is walked into them
+    template <typename Parents>
+    static void reserveLegs(PathResult* result, const Parents& parents, int startIndex, int endIndex) {
+        int legs = 0;
+        for (int port = endIndex; port != startIndex && port != -1; port = parents[port]) legs++;
+        result->path.reserve(legs + 1);
+        result->routes.reserve(legs);
+    }
+    
+    // Materialize the path ending at step as a PathResult owned by arena
+    static PathResult* buildResult(const PathStep* last, Arena& arena) {
+        PathResult* result = arena.create<PathResult>();
+        result->found = true;
+        result->totalCost = last->cost;
+        result->path.reserve(last->stops);
+        result->routes.reserve(last->stops - 1);
+        
+        for (const PathStep* step = last; step; step = step->prev) {
+            result->path.insertFront(step->port);
+            if (step->route) {
+                result->routes.insertFront(*step->route);
+                if (step->day >= 0) result->routes.front().date = TimeUtils::civilDate(step->day);
+            }
+        }
+        
+        if (result->routes.getSize() > 0) {
+            const Route& first = result->routes.front();
+            const Route& lastLeg = result->routes.back();
+            long long startT = TimeUtils::toAbsoluteMinutes(first.date, first.deptTime);
+            long long lastDep = TimeUtils::toAbsoluteMinutes(lastLeg.date, lastLeg.deptTime);
+            long long lastArr = TimeUtils::toAbsoluteMinutes(lastLeg.date, lastLeg.arrTime);
+            if (lastArr < lastDep) lastArr += 24 * 60;
+            result->totalTime = (int)(lastArr - startT);
+        }
+        return result;
+    }
+    
+    // Edge filter that lets every leg through. Both searches take any
+    // callable bool(const Route& leg, int destIndex) to restrict which legs
+    // may be used (see RouteFilter::CompiledPreferences).
+    struct AllowAll {
+        bool operator()(const Route&, int) const { return true; }
+    };
+    
+    // A* heuristic giving no guidance, which makes the searches plain
+    // Dijkstra. A heuristic returns a lower bound on the remaining cost/time
+    // from a port to the target, or INT_MAX if the target is unreachable
+    // from it (see lowerBounds.h).
+    struct NoHeuristic {
+        int cost(int) const { return 0; }
+        int time(int) const { return 0; }
+    };
+    
+    // Same legs in the same order (compared by departure identity)
+    static bool sameLegs(const PathResult* a, const PathResult* b) {
+        if (a->routes.getSize() != b->routes.getSize()) return false;
+        LinkedList<Route>::const_iterator itB = b->routes.begin();
+        for (const Route& legA : a->routes) {
+            const Route& legB = *itB;
+            if (legA.startPoint.name != legB.startPoint.name || legA.dest.name != legB.dest.name ||
+                legA.date != legB.date || legA.deptTime != legB.deptTime ||
+                legA.company != legB.company) {
+                return false;
+            }
+            ++itB;
+        }
+        return true;
+    }
+    
+    // Labels a cheapest-path search leaves on the ports it reaches
+    struct CheapestLabels {
+        int* distances;
+        int* parents;
+        Route* parentRoutes;
+        long long* arrivalTimes;
+        
+        explicit CheapestLabels(int n)
+            : distances(new int[n]), parents(new int[n]), parentRoutes(new Route[n]),
+              arrivalTimes(new long long[n]) {}
+        ~CheapestLabels() {
+            delete[] distances; delete[] parents; delete[] parentRoutes; delete[] arrivalTimes;
+        }
+        CheapestLabels(const CheapestLabels&) = delete;
+        CheapestLabels& operator=(const CheapestLabels&) = delete;
+    };
+    
+    // Labels a fastest-path search leaves on the ports it reaches
+    struct FastestLabels {
+        long long* bestTime;
+        int* parents;
+        Route* parentRoutes;
+        long long* parentDepartureDates;    // departure of the leg into each port
+        
+        explicit FastestLabels(int n)
+            : bestTime(new long long[n]), parents(new int[n]), parentRoutes(new Route[n]),
+              parentDepartureDates(new long long[n]) {}
+        ~FastestLabels() {
+            delete[] bestTime; delete[] parents; delete[] parentRoutes; delete[] parentDepartureDates;
+        }
+        FastestLabels(const FastestLabels&) = delete;
+        FastestLabels& operator=(const FastestLabels&) = delete;
     };
     
     // ---------------------------------------------------------
     // ALGORITHM 1: CHEAPEST PATH (Cost + Conditional Layover Fee)
     // ---------------------------------------------------------
-    static PathResult* findCheapestPath(Graph& graph, int startIndex, int endIndex) {
+    // With a control, each settled port is a step of progress, and a
+    // cancelled search stops and reports nothing found
+    template <typename Allowed = AllowAll, typename Heuristic = NoHeuristic>
+    static PathResult* findCheapestPath(const Graph& graph, int startIndex, int endIndex,
+                                        const Allowed& allowed = Allowed(),
+                                        const Heuristic& heuristic = Heuristic(),
+                                        SearchControl* control = nullptr) {
         PathResult* result = new PathResult();
         if (startIndex < 0 || endIndex < 0 || startIndex >= graph.size || endIndex >= graph.size) return result;
         
-        int* distances = new int[graph.size];
-        int* parents = new int[graph.size];
+        CheapestLabels labels(graph.size);
+        result->nodesSettled = settleCheapest(graph, startIndex, endIndex, allowed, heuristic, labels, control);
+        if (control && control->isCancelled()) return result;
+        
+        if (labels.distances[endIndex] != INT_MAX) {
+            // Walk the parents back from the target, prepending so both lists
+            // come out in travel order without a reversal pass
+            reserveLegs(result, labels.parents, startIndex, endIndex);
+            int current = endIndex;
+            while (current != startIndex && current != -1) {
+                result->path.insertFront(current);
+                if (labels.parents[current] != -1) result->routes.insertFront(labels.parentRoutes[current]);
+                current = labels.parents[current];
+            }
+            result->path.insertFront(startIndex);
+            finishCheapest(result, labels.distances[endIndex]);
+        }
+        return result;
+    }
+    
+    // Dijkstra from startIndex until endIndex is settled (every reachable
+    // port when endIndex is -1). Returns the number of ports settled.
+    template <typename Allowed, typename Heuristic>
+    static int settleCheapest(const Graph& graph, int startIndex, int endIndex, const Allowed& allowed,
+                              const Heuristic& heuristic, CheapestLabels& labels,
+                              SearchControl* control = nullptr) {
+        int* distances = labels.distances;
+        int* parents = labels.parents;
+        Route* parentRoutes = labels.parentRoutes;
+        long long* arrivalTimes = labels.arrivalTimes;
         bool* visited = new bool[graph.size];
-        Route* parentRoutes = new Route[graph.size];
-        long long* arrivalTimes = new long long[graph.size]; 
+        int settled = 0;
         
         for (int i = 0; i < graph.size; i++) {
             distances[i] = INT_MAX;
@@ -43,113 +218,180 @@ public:
         distances[startIndex] = 0; 
         arrivalTimes[startIndex] = 0; 
         
+        // Ports that cannot reach the target are never worth queueing
+        const BitSet* reach = (endIndex >= 0) ? &Reachability::reaching(graph, endIndex) : nullptr;
+        
+        const DepartureIndex& departures = Connections::byPort(graph);
+        
         PriorityQueue<int> pq;
-        pq.push(startIndex, 0);
+        if (!reach || reach->test(startIndex)) pq.push(startIndex, 0);
         
         while (!pq.isEmpty()) {
             int current = pq.pop();
             
             if (visited[current]) continue;
             visited[current] = true;
+            settled++;
             
             if (current == endIndex) break;
+            // Superseded by a newer search (searchWorker.h)
+            if (control) {
+                if (control->isCancelled()) break;
+                control->step();
+            }
             
-            LinkedList<Route>::Node* routeNode = graph.vertices[current].routes.head;
-            while (routeNode != nullptr) {
-                Route& route = routeNode->data;
-                int destIndex = graph.findPort(route.dest.name);
-                
-                if (destIndex != -1 && !visited[destIndex]) {
-                    long long depAbs = TimeUtils::toAbsoluteMinutes(route.date, route.deptTime);
-                    long long arrAbs = TimeUtils::toAbsoluteMinutes(route.date, route.arrTime);
-                    if (arrAbs < depAbs) arrAbs += 24 * 60; 
-
-                    bool isTimeValid = true;
-                    int layoverFee = 0;
-
-                    if (current != startIndex) {
-                        // Check if we arrived before this boat leaves
-                        long long layoverMinutes = depAbs - arrivalTimes[current];
-                        
-                        // Must arrive 60 mins before departure
-                        if (layoverMinutes < 60) isTimeValid = false; 
-                        
-                        // Apply Layover Fee if waiting > 12 hours
-                        if (isTimeValid && layoverMinutes > 720) {
-                            layoverFee = graph.vertices[current].port.portCharge;
-                        }
-                    }
-
-                    if (isTimeValid) {
-                        int newCost = distances[current] + route.cost + layoverFee;
-                        if (newCost < distances[destIndex]) {
-                            distances[destIndex] = newCost;
-                            parents[destIndex] = current;
-                            parentRoutes[destIndex] = route;
-                            arrivalTimes[destIndex] = arrAbs; 
-                            pq.push(destIndex, newCost);
-                        }
-                    }
+            bool atOrigin = (current == startIndex);
+            auto relax = [&](const Connection& conn) {
+                int destIndex = conn.to;
+                int remaining = heuristic.cost(destIndex);
+                if (visited[destIndex] || remaining == INT_MAX || (reach && !reach->test(destIndex)) ||
+                    !allowed(*conn.route, destIndex)) {
+                    return;
+                }
+                int newCost = cheapestLegCost(graph, conn, atOrigin, distances[current], arrivalTimes[current]);
+                if (newCost != INT_MAX && newCost < distances[destIndex]) {
+                    distances[destIndex] = newCost;
+                    parents[destIndex] = current;
+                    parentRoutes[destIndex] = Connections::routeOf(conn);
+                    arrivalTimes[destIndex] = conn.arrival; 
+                    pq.push(destIndex, newCost + remaining);
                 }
-                routeNode = routeNode->next;
+            };
+            
+            // Sailings leaving within the hour after arrival are skipped
+            // without looking at them
+            long long earliest = atOrigin ? LLONG_MIN : arrivalTimes[current] + 60;
+            int first = atOrigin ? departures.begin(current) : departures.firstFrom(current, earliest);
+            for (int i = first; i < departures.end(current); i++) relax(departures.sailings[i]);
+            
+            // Of a weekly service's runs, the first that can be made waits
+            // least and arrives first, so it is the only one worth a label
+            const Vector<int>& services = graph.vertices[current].services;
+            for (int k = 0; k < services.size(); k++) {
+                Connection run;
+                if (Connections::firstOccurrence(graph, services[k], earliest, run)) relax(run);
             }
         }
         
-        if (distances[endIndex] != INT_MAX) {
-            result->found = true;
-            result->totalCost = distances[endIndex];
-            
-            LinkedList<int> reversePath;
-            LinkedList<Route> reverseRoutes;
-            int current = endIndex;
-            while (current != startIndex && current != -1) {
-                reversePath.insertEnd(current);
-                if (parents[current] != -1) reverseRoutes.insertEnd(parentRoutes[current]);
-                current = parents[current];
-            }
-            reversePath.insertEnd(startIndex);
+        delete[] visited;
+        return settled;
+    }
+    
+    // Cost at the far end of route when taken from port, which was reached
+    // at cost/arrival (ignored at the origin). INT_MAX if the connection is
+    // too tight.
+    static int cheapestLegCost(const Graph& graph, const Route& route, int port, bool atOrigin,
+                               int cost, long long arrival) {
+        return cheapestLegCost(graph, TimeUtils::toAbsoluteMinutes(route.date, route.deptTime), route.cost,
+                               port, atOrigin, cost, arrival);
+    }
+    
+    // Same, for a sailing from the connection arrays
+    static int cheapestLegCost(const Graph& graph, const Connection& conn, bool atOrigin, int cost,
+                               long long arrival) {
+        return cheapestLegCost(graph, conn.departure, conn.cost, conn.from, atOrigin, cost, arrival);
+    }
+    
+    static int cheapestLegCost(const Graph& graph, long long depAbs, int legCost, int port, bool atOrigin,
+                               int cost, long long arrival) {
+        return cheapestLegCost(depAbs, legCost, graph.vertices[port].port.portCharge, atOrigin, cost, arrival);
+    }
+    
+    // Same, given the charge of the port it leaves from
+    static int cheapestLegCost(long long depAbs, int legCost, int portCharge, bool atOrigin, int cost,
+                               long long arrival) {
+        int layoverFee = 0;
+        
+        if (!atOrigin) {
+            // Check if we arrived before this boat leaves
+            long long layoverMinutes = depAbs - arrival;
             
-            for (int i = reversePath.getSize() - 1; i >= 0; i--) result->path.insertEnd(reversePath.get(i));
+            // Must arrive 60 mins before departure
+            if (layoverMinutes < 60) return INT_MAX; 
             
-            // Calculate Total Time
-            long long startT = 0; 
-            long long endT = 0;
-            if(reverseRoutes.getSize() > 0) {
-                 Route first = reverseRoutes.get(reverseRoutes.getSize()-1);
-                 startT = TimeUtils::toAbsoluteMinutes(first.date, first.deptTime);
-                 
-                 Route last = reverseRoutes.get(0);
-                 long long lastDep = TimeUtils::toAbsoluteMinutes(last.date, last.deptTime);
-                 long long lastArr = TimeUtils::toAbsoluteMinutes(last.date, last.arrTime);
-                 if (lastArr < lastDep) lastArr += 24*60;
-                //  if (lastArr - lastDep < 720) lastArr += 24*60; // Heuristic for last leg
-                 endT = lastArr;
-                 
-                 result->totalTime = (int)(endT - startT);
+            // Apply Layover Fee if waiting > 12 hours
+            if (layoverMinutes > 720) {
+                layoverFee = portCharge;
             }
-            
-            for (int i = reverseRoutes.getSize() - 1; i >= 0; i--) result->routes.insertEnd(reverseRoutes.get(i));
         }
+        return cost + legCost + layoverFee;
+    }
+    
+    // Fill in the totals of a cheapest path whose routes are in place
+    static void finishCheapest(PathResult* result, int totalCost) {
+        result->found = true;
+        result->totalCost = totalCost;
         
-        delete[] distances; delete[] parents; delete[] visited; delete[] parentRoutes; delete[] arrivalTimes;
-        return result;
+        // Calculate Total Time
+        if (result->routes.getSize() > 0) {
+            const Route& first = result->routes.front();
+            long long startT = TimeUtils::toAbsoluteMinutes(first.date, first.deptTime);
+            
+            const Route& last = result->routes.back();
+            long long lastDep = TimeUtils::toAbsoluteMinutes(last.date, last.deptTime);
+            long long lastArr = TimeUtils::toAbsoluteMinutes(last.date, last.arrTime);
+            if (lastArr < lastDep) lastArr += 24*60;
+            
+            result->totalTime = (int)(lastArr - startT);
+        }
     }
     
+    // Parent of every port in the tree findCheapestPath grows from
+    // startIndex (-1 at the origin and at unreachable ports). The cheapest
+    // path to any port follows these parents back to the origin.
+    static void cheapestTree(const Graph& graph, int startIndex, Vector<int>& parents) {
+        CheapestLabels labels(graph.size);
+        settleCheapest(graph, startIndex, -1, AllowAll(), NoHeuristic(), labels);
+        parents.resize(graph.size);
+        for (int i = 0; i < graph.size; i++) parents[i] = labels.parents[i];
+    }
     
-    static PathResult* findShortestTimePath(Graph& graph, int startIndex, int endIndex) {
+    
+    template <typename Allowed = AllowAll, typename Heuristic = NoHeuristic>
+    static PathResult* findShortestTimePath(const Graph& graph, int startIndex, int endIndex,
+                                            const Allowed& allowed = Allowed(),
+                                            const Heuristic& heuristic = Heuristic(),
+                                            SearchControl* control = nullptr) {
         PathResult* result = new PathResult();
 
         if (startIndex < 0 || endIndex < 0 || startIndex >= graph.size || endIndex >= graph.size) {
             return result;
         }
 
-        long long* bestTime = new long long[graph.size]; 
-        int* parents = new int[graph.size];
-        bool* visited = new bool[graph.size];
-        Route* parentRoutes = new Route[graph.size];
+        FastestLabels labels(graph.size);
+        result->nodesSettled = settleFastest(graph, startIndex, endIndex, allowed, heuristic, labels, control);
+        if (control && control->isCancelled()) return result;
+
+        if (labels.bestTime[endIndex] != LLONG_MAX) {
+            result->found = true;
+
+            // Reconstruct path & routes in travel order
+            reserveLegs(result, labels.parents, startIndex, endIndex);
+            int cur = endIndex;
+            while (cur != startIndex && cur != -1) {
+                result->path.insertFront(cur);
+                if (labels.parents[cur] != -1) result->routes.insertFront(labels.parentRoutes[cur]);
+                cur = labels.parents[cur];
+            }
+            result->path.insertFront(startIndex);
 
-        // NEW: Store parent departure DATE (absolute minutes)
-        long long* parentDepartureDates = new long long[graph.size];
+            finishFastest(graph, result);
+        }
+
+        return result;
+    }
+
+    // Fastest-path counterpart of settleCheapest
+    template <typename Allowed, typename Heuristic>
+    static int settleFastest(const Graph& graph, int startIndex, int endIndex, const Allowed& allowed,
+                             const Heuristic& heuristic, FastestLabels& labels,
+                             SearchControl* control = nullptr) {
+        long long* bestTime = labels.bestTime;
+        int* parents = labels.parents;
+        Route* parentRoutes = labels.parentRoutes;
+        long long* parentDepartureDates = labels.parentDepartureDates;
+        bool* visited = new bool[graph.size];
+        int settled = 0;
 
         for (int i = 0; i < graph.size; i++) {
             bestTime[i] = LLONG_MAX;
@@ -161,179 +403,180 @@ public:
         // Start at time = 0
         bestTime[startIndex] = 0;
 
-        PriorityQueue<long long> pq;
-        pq.push(startIndex, 0);
+        const BitSet* reach = (endIndex >= 0) ? &Reachability::reaching(graph, endIndex) : nullptr;
+
+        const DepartureIndex& departures = Connections::byPort(graph);
+
+        // Times plus bounds can pass INT_MAX, so the keys are long long
+        PriorityQueue<int, long long> pq;
+        if (!reach || reach->test(startIndex)) pq.push(startIndex, 0);
 
         while (!pq.isEmpty()) {
             int current = pq.pop();
             if (visited[current]) continue;
             visited[current] = true;
+            settled++;
 
             if (current == endIndex) break;
+            if (control) {
+                if (control->isCancelled()) break;
+                control->step();
+            }
 
-            auto* routeNode = graph.vertices[current].routes.head;
-            while (routeNode != nullptr) {
-                Route& route = routeNode->data;
-                int destIndex = graph.findPort(route.dest.name);
-
-                if (destIndex != -1 && !visited[destIndex]) {
-
-                    long long depAbs = TimeUtils::toAbsoluteMinutes(route.date, route.deptTime);
-                    long long arrAbs = TimeUtils::toAbsoluteMinutes(route.date, route.arrTime);
-
-                    // if arrival time < departure time -> next day arrival
-                    if (arrAbs < depAbs) arrAbs += 24 * 60;
-
-                    bool canTake = false;
-
-                    if (current == startIndex) {
-                        // Starting node can always take route
-                        canTake = true;
-                    } else {
-                        // Must arrive at least 60 minutes before departure
-                        if (bestTime[current] <= depAbs - 60)
-                            canTake = true;
-                    }
-
-                    if (canTake) {
+            bool atOrigin = (current == startIndex);
+            auto relax = [&](const Connection& conn) {
+                int destIndex = conn.to;
+                int remaining = heuristic.time(destIndex);
+                if (visited[destIndex] || remaining == INT_MAX || (reach && !reach->test(destIndex)) ||
+                    !allowed(*conn.route, destIndex)) {
+                    return;
+                }
+                long long newTime = fastestLegTime(conn.departure, conn.arrival, atOrigin, bestTime[current],
+                                                   parentDepartureDates[current]);
+                if (newTime != LLONG_MAX && newTime < bestTime[destIndex]) {
+                    bestTime[destIndex] = newTime;
+                    parents[destIndex] = current;
+                    parentRoutes[destIndex] = Connections::routeOf(conn);
+                    // This departure, for the legs taken on from there
+                    parentDepartureDates[destIndex] = conn.departure;
+                    pq.push(destIndex, newTime + remaining);
+                }
+            };
+
+            // As in settleCheapest, sailings fastestLegTime would refuse
+            // for leaving within the hour are skipped without looking at them
+            long long earliest = atOrigin ? LLONG_MIN : bestTime[current] + 60;
+            int first = atOrigin ? departures.begin(current) : departures.firstFrom(current, earliest);
+            for (int i = first; i < departures.end(current); i++) relax(departures.sailings[i]);
+
+            // A weekly service's first run that fastestLegTime accepts
+            // arrives first, which is the least time
+            const Vector<int>& services = graph.vertices[current].services;
+            for (int k = 0; k < services.size(); k++) {
+                long long from = earliest;
+                long long duration = graph.services[services[k]].duration;
+                if (!atOrigin && parentDepartureDates[current] - duration > from) {
+                    from = parentDepartureDates[current] - duration;
+                }
+                Connection run;
+                if (Connections::firstOccurrence(graph, services[k], from, run)) relax(run);
+            }
+        }
 
-                        long long parentDate = (current == startIndex)
-                            ? depAbs
-                            : parentDepartureDates[current];
+        delete[] visited;
+        return settled;
+    }
 
-                        if (parentDate == -1)
-                            parentDate = depAbs;
+    // Time label at the far end of route when taken from a port labelled
+    // time/parentDeparture. LLONG_MAX if the leg cannot be taken.
+    static long long fastestLegTime(const Route& route, bool atOrigin, long long time,
+                                    long long parentDeparture) {
+        long long depAbs = TimeUtils::toAbsoluteMinutes(route.date, route.deptTime);
+        long long arrAbs = TimeUtils::toAbsoluteMinutes(route.date, route.arrTime);
 
-                        // ---------- NEW LOGIC ----------
-                        // Travel time = arrivalDate - parentDepartureDate
-                        long long travelTime = arrAbs - parentDate;
-                        // Time cannot be negative → invalid route
-                        if (travelTime < 0) {
-                            routeNode = routeNode->next;
-                            continue;
-                        }
+        // if arrival time < departure time -> next day arrival
+        if (arrAbs < depAbs) arrAbs += 24 * 60;
 
-                        long long newTime = bestTime[current] + travelTime;
-                        // --------------------------------
+        return fastestLegTime(depAbs, arrAbs, atOrigin, time, parentDeparture);
+    }
 
-                        if (newTime < bestTime[destIndex]) {
-                            bestTime[destIndex] = newTime;
-                            parents[destIndex] = current;
-                            parentRoutes[destIndex] = route;
+    // Same, with the leg's departure and (rolled) arrival in absolute minutes
+    static long long fastestLegTime(long long depAbs, long long arrAbs, bool atOrigin, long long time,
+                                    long long parentDeparture) {
+        // Starting node can always take route; otherwise we must arrive
+        // at least 60 minutes before departure
+        if (!atOrigin && time > depAbs - 60) return LLONG_MAX;
+
+        long long parentDate = atOrigin ? depAbs : parentDeparture;
+        if (parentDate == -1)
+            parentDate = depAbs;
+
+        // ---------- NEW LOGIC ----------
+        // Travel time = arrivalDate - parentDepartureDate
+        long long travelTime = arrAbs - parentDate;
+        // Time cannot be negative → invalid route
+        if (travelTime < 0) return LLONG_MAX;
+
+        return time + travelTime;
+        // --------------------------------
+    }
 
-                            // Store THIS departure date for children
-                            parentDepartureDates[destIndex] = depAbs;
+    // Fill in the totals of a fastest path whose routes are in place:
+    // totalCost including layover fees, and totalTime
+    static void finishFastest(const Graph& graph, PathResult* result) {
+        finishFastest(result, [&](const Route& leg) {
+            int portIndex = graph.findPort(leg.dest.name);
+            return (portIndex != -1) ? graph.vertices[portIndex].port.portCharge : 0;
+        });
+    }
 
-                            pq.push(destIndex, newTime);
-                        }
-                    }
+    // Same, with layoverFee(leg) the charge of the port leg arrives at
+    template <typename LayoverFee>
+    static void finishFastest(PathResult* result, const LayoverFee& layoverFee) {
+        result->found = true;
+
+        if (result->routes.getSize() > 0) {
+            const Route& firstLeg = result->routes.front();
+            long long startT = TimeUtils::toAbsoluteMinutes(firstLeg.date, firstLeg.deptTime);
+            long long prevArrival = TimeUtils::toAbsoluteMinutes(firstLeg.date, firstLeg.arrTime);
+            if (prevArrival < startT) prevArrival += 24 * 60;
+
+            int totalCost = firstLeg.cost;
+            const Route* prevLeg = &firstLeg;
+
+            // iterate remaining legs and compute waiting & layover fee same as cheapest
+            LinkedList<Route>::iterator it = result->routes.begin();
+            for (++it; it != result->routes.end(); ++it) {
+                const Route &r = *it;
+
+                long long depAbs = TimeUtils::toAbsoluteMinutes(r.date, r.deptTime);
+                long long arrAbs = TimeUtils::toAbsoluteMinutes(r.date, r.arrTime);
+                if (arrAbs < depAbs) arrAbs += 24 * 60;
+
+                // Strict timing (you already enforced while searching), but recompute waiting:
+                long long waiting = depAbs - prevArrival;
+
+                // If waiting negative -> invalid path (shouldn't happen), skip adding fee and treat as invalid
+                if (waiting < 0) {
+                    // defensive: treat path invalid (shouldn't happen)
+                    totalCost = INT_MAX;
+                    break;
                 }
-                routeNode = routeNode->next;
-            }
-        }
-
-        if (bestTime[endIndex] != LLONG_MAX) {
-            result->found = true;
 
-            LinkedList<int> revPath;
-            LinkedList<Route> revRoutes;
-
-            // Reconstruct path & routes (in reverse) first
-            int cur = endIndex;
-            while (cur != startIndex && cur != -1) {
-                revPath.insertEnd(cur);
-                if (parents[cur] != -1) revRoutes.insertEnd(parentRoutes[cur]);
-                cur = parents[cur];
-            }
-            revPath.insertEnd(startIndex);
-
-            // Build final path in correct order
-            for (int i = revPath.getSize() - 1; i >= 0; i--)
-                result->path.insertEnd(revPath.get(i));
-
-            // If we have route legs, compute totalCost including layover fees and totalTime
-            if (revRoutes.getSize() > 0) {
-                // revRoutes is in reverse (last leg at index 0), so build a forward vector
-                Vector<Route> legs;
-                for (int i = revRoutes.getSize() - 1; i >= 0; i--) legs.push_back(revRoutes.get(i));
-
-                long long startT = TimeUtils::toAbsoluteMinutes(legs.front().date, legs.front().deptTime);
-                long long prevArrival = TimeUtils::toAbsoluteMinutes(legs.front().date, legs.front().arrTime);
-                if (prevArrival < startT) prevArrival += 24 * 60;
-
-                int totalCost = 0;
-                totalCost += legs.front().cost;
-
-                // iterate remaining legs and compute waiting & layover fee same as cheapest
-                for (int i = 1; i < legs.size(); ++i) {
-                    Route &r = legs[i];
-
-                    long long depAbs = TimeUtils::toAbsoluteMinutes(r.date, r.deptTime);
-                    long long arrAbs = TimeUtils::toAbsoluteMinutes(r.date, r.arrTime);
-                    if (arrAbs < depAbs) arrAbs += 24 * 60;
-
-                    // Strict timing (you already enforced while searching), but recompute waiting:
-                    long long waiting = depAbs - prevArrival;
-
-                    // If waiting negative -> invalid path (shouldn't happen), skip adding fee and treat as invalid
-                    if (waiting < 0) {
-                        // defensive: treat path invalid (shouldn't happen)
-                        totalCost = INT_MAX;
-                        break;
-                    }
-
-                    // Apply layover fee same rule as cheapest
-                    if (waiting > 720) {
-                        
-                        
-                        int portIndex = -1;
-                        portIndex = graph.findPort(legs[i-1].dest.name);
-                        if (portIndex != -1) {
-                            totalCost += graph.vertices[portIndex].port.portCharge;
-                        } else {
-                            // If for some reason portIndex unknown, still safe to skip fee or log (defensive)
-                        }
-                    }
-
-                    totalCost += r.cost;
-
-                    // update prevArrival for next leg (arrival of this leg)
-                    prevArrival = arrAbs;
+                // Apply layover fee same rule as cheapest
+                if (waiting > 720) {
+                    totalCost += layoverFee(*prevLeg);
                 }
 
-                // If only one leg (single route), cost already added; prevArrival is arrival of that leg.
-
-                // Now compute total time: prevArrival - startT
-                long long  totalTimeLong = prevArrival - startT;
-                if (totalCost == INT_MAX) {
-                    // defensive: mark as not found if cost invalid
-                    result->found = false;
-                    result->totalCost = 0;
-                    result->totalTime = 0;
-                } else {
-                    result->totalCost = totalCost;
-                    result->totalTime = (int) totalTimeLong;
-                }
+                totalCost += r.cost;
 
-                // Finally insert forward routes into result->routes
-                for (const Route &r : legs) result->routes.insertEnd(r);
+                // update prevArrival for next leg (arrival of this leg)
+                prevArrival = arrAbs;
+                prevLeg = &r;
             }
 
-
-            // Build final routes
-            for (int i = revRoutes.getSize() - 1; i >= 0; i--)
-                result->routes.insertEnd(revRoutes.get(i));
+            // Now compute total time: prevArrival - startT
+            long long  totalTimeLong = prevArrival - startT;
+            if (totalCost == INT_MAX) {
+                // defensive: mark as not found if cost invalid
+                result->found = false;
+                result->totalCost = 0;
+                result->totalTime = 0;
+            } else {
+                result->totalCost = totalCost;
+                result->totalTime = (int) totalTimeLong;
+            }
         }
+    }
 
-        delete[] bestTime;
-        delete[] parents;
-        delete[] visited;
-        delete[] parentRoutes;
-        delete[] parentDepartureDates;
-
-        return result;
+    // Fastest-path counterpart of cheapestTree
+    static void fastestTree(const Graph& graph, int startIndex, Vector<int>& parents) {
+        FastestLabels labels(graph.size);
+        settleFastest(graph, startIndex, -1, AllowAll(), NoHeuristic(), labels);
+        parents.resize(graph.size);
+        for (int i = 0; i < graph.size; i++) parents[i] = labels.parents[i];
     }
 
 };
 
-#endif
\ No newline at end of file
+#endif
@@ -8,6 +8,7 @@
 #include "routeFilter.hpp"
 #include "uiHelpers.hpp"
 #include "vector.h"
+#include "arena.h"
 
 struct PreferencesMenu {
     // 1. Origin and Destination selection
@@ -34,6 +35,7 @@ struct PreferencesMenu {
     bool selectingCompanies;
     Vector<std::string> selectedCompanies;
     Vector<std::string> allCompanies;
+    unsigned long long companiesRevision;   // of the snapshot allCompanies was listed from
     int companyListOffset;
     
     // 4. Show Routes button
@@ -47,8 +49,10 @@ struct PreferencesMenu {
     sf::Text nextBtnTxt;
     sf::Text routeCounterTxt;
     
-    // 6. Filtered routes
+    // 6. Filtered routes (owned by candidates, which keeps them between
+    // preference changes)
     Vector<PathFinding::PathResult*> filteredRoutes;
+    RouteFilter::CandidateSet candidates;
     int currentRouteIndex;
     
     // 7. Results display
@@ -81,6 +85,7 @@ struct PreferencesMenu {
           portListOffset(0),
           companyField(sf::Vector2f(340.f, 40.f)),
           selectingCompanies(false),
+          companiesRevision(graph.getRevision()),
           companyListOffset(0),
           showRoutesBtn(sf::Vector2f(340.f, 50.f)),
           prevBtn(sf::Vector2f(50.f, 40.f)),
@@ -200,7 +205,18 @@ struct PreferencesMenu {
         resultBody.setPosition(panelX + 35, winH - 180 + 50);
     }
 
+    // A feed change can bring a new company (or take one's last sailing),
+    // so the list follows the snapshot on screen
+    void refreshCompanies(const Graph& graph) {
+        if (graph.getRevision() == companiesRevision) return;
+        allCompanies = RouteFilter::getAllCompanies(graph);
+        companiesRevision = graph.getRevision();
+        int maxOffset = std::max(0, (int)allCompanies.size() - 6);
+        if (companyListOffset > maxOffset) companyListOffset = maxOffset;
+    }
+
     void handleMouseWheel(float delta, bool isOriginDest, bool isPortSelection, const Graph& graph) {
+        refreshCompanies(graph);
         if (isOriginDest) {
             int availableItems = 0;
             for (int i = 0; i < graph.size; i++) {
@@ -237,22 +253,29 @@ struct PreferencesMenu {
     }
 
     // --- FIX: ADDED FONT PARAMETER FOR ACCURATE HITBOXES ---
-    bool handleClick(Graph& graph,
+    bool handleClick(const Graph& graph,
                     const sf::Vector2f& mouseGlobal,
                     float panelX,
                     float winH,
                     const sf::Font& font, // Required for calculating layout
                     PathFinding::PathResult*& currentPathResult,
                     std::string& resultTextString) {
+        refreshCompanies(graph);
         // Handle origin/destination selection
         if (selectingOrigin || selectingDest) {
             return handleOriginDestSelectionClick(graph, mouseGlobal, panelX);
         }
         else if (selectingPorts) {
-            return handlePortSelectionClick(graph, mouseGlobal, panelX);
+            int before = selectedPorts.size();
+            bool handled = handlePortSelectionClick(graph, mouseGlobal, panelX);
+            if (selectedPorts.size() != before) refreshFilters(graph, currentPathResult, resultTextString);
+            return handled;
         }
         else if (selectingCompanies) {
-            return handleCompanySelectionClick(mouseGlobal, panelX);
+            int before = selectedCompanies.size();
+            bool handled = handleCompanySelectionClick(mouseGlobal, panelX);
+            if (selectedCompanies.size() != before) refreshFilters(graph, currentPathResult, resultTextString);
+            return handled;
         }
         else if (fieldOrigin.getGlobalBounds().contains(mouseGlobal)) {
             selectingOrigin = true;
@@ -304,55 +327,39 @@ struct PreferencesMenu {
         return false;
     }
 
-    void applyFilters(Graph& graph, 
+    void applyFilters(const Graph& graph, 
                      PathFinding::PathResult*& currentPathResult,
                      std::string& resultTextString) {
-        bool currentIsInFiltered = false;
-        for (int i = 0; i < filteredRoutes.size(); i++) {
-            if (filteredRoutes[i] == currentPathResult) {
-                currentIsInFiltered = true;
-                break;
-            }
-        }
-        
-        for (int i = 0; i < filteredRoutes.size(); i++) {
-            if (filteredRoutes[i] != currentPathResult) {
-                delete filteredRoutes[i];
-            }
-        }
-        filteredRoutes.clear();
-        
-        if (currentPathResult && currentIsInFiltered) {
+        // A result from elsewhere is ours to free; our own ones are owned
+        // by candidates
+        bool currentIsOurs = ownsCurrent(currentPathResult);
+        if (currentPathResult && !currentIsOurs) {
             delete currentPathResult;
-            currentPathResult = nullptr;
         }
         
-        filteredRoutes = RouteFilter::findFilteredRoutes(
+        int keptIndex = -1;
+        filteredRoutes = candidates.update(
             graph, selectedOriginIndex, selectedDestIndex, 
-            selectedPorts, selectedCompanies);
+            selectedPorts, selectedCompanies,
+            currentIsOurs ? currentPathResult : nullptr, keptIndex);
         
+        // Stay on the route the user was looking at if it still matches
+        currentPathResult = nullptr;
         currentRouteIndex = -1;
         if (filteredRoutes.size() > 0) {
-            currentRouteIndex = 0;
-            if (currentPathResult) {
-                bool isInNewFiltered = false;
-                for (int i = 0; i < filteredRoutes.size(); i++) {
-                    if (filteredRoutes[i] == currentPathResult) {
-                        isInNewFiltered = true;
-                        break;
-                    }
-                }
-                if (!isInNewFiltered) {
-                    delete currentPathResult;
-                }
-            }
-            currentPathResult = filteredRoutes[0];
+            currentRouteIndex = (keptIndex >= 0) ? keptIndex : 0;
+            currentPathResult = filteredRoutes[currentRouteIndex];
             resultTextString = "Filtered Route";
-        } else {
-            if (currentPathResult) {
-                delete currentPathResult;
-                currentPathResult = nullptr;
-            }
+        }
+    }
+
+    // After a company/port toggle: refresh the shown routes if they are for
+    // the selected origin and destination. Tightening is only a filter pass.
+    void refreshFilters(const Graph& graph,
+                        PathFinding::PathResult*& currentPathResult,
+                        std::string& resultTextString) {
+        if (candidates.isActiveFor(selectedOriginIndex, selectedDestIndex)) {
+            applyFilters(graph, currentPathResult, resultTextString);
         }
     }
 
@@ -360,17 +367,10 @@ struct PreferencesMenu {
                          std::string& resultTextString) {
         if (filteredRoutes.size() == 0 || currentRouteIndex <= 0) return;
         
-        currentRouteIndex--;
-        bool isInFiltered = false;
-        for (int i = 0; i < filteredRoutes.size(); i++) {
-            if (filteredRoutes[i] == currentPathResult) {
-                isInFiltered = true;
-                break;
-            }
-        }
-        if (currentPathResult && !isInFiltered) {
+        if (currentPathResult && !ownsCurrent(currentPathResult)) {
             delete currentPathResult;
         }
+        currentRouteIndex--;
         currentPathResult = filteredRoutes[currentRouteIndex];
         resultTextString = "Filtered Route";
     }
@@ -380,21 +380,22 @@ struct PreferencesMenu {
         if (filteredRoutes.size() == 0 || 
             currentRouteIndex >= filteredRoutes.size() - 1) return;
         
-        currentRouteIndex++;
-        bool isInFiltered = false;
-        for (int i = 0; i < filteredRoutes.size(); i++) {
-            if (filteredRoutes[i] == currentPathResult) {
-                isInFiltered = true;
-                break;
-            }
-        }
-        if (currentPathResult && !isInFiltered) {
+        if (currentPathResult && !ownsCurrent(currentPathResult)) {
             delete currentPathResult;
         }
+        currentRouteIndex++;
         currentPathResult = filteredRoutes[currentRouteIndex];
         resultTextString = "Filtered Route";
     }
 
+    // This menu only ever shows filteredRoutes[currentRouteIndex], so that
+    // is the one slot to check
+    bool ownsCurrent(const PathFinding::PathResult* currentPathResult) const {
+        return currentPathResult && currentRouteIndex >= 0 &&
+               currentRouteIndex < filteredRoutes.size() &&
+               filteredRoutes[currentRouteIndex] == currentPathResult;
+    }
+
     void reset() {
         selectingOrigin = selectingDest = selectingPorts = selectingCompanies = false;
         originDestListOffset = portListOffset = companyListOffset = 0;
@@ -402,10 +403,8 @@ struct PreferencesMenu {
     }
 
     void cleanup() {
-        for (int i = 0; i < filteredRoutes.size(); i++) {
-            delete filteredRoutes[i];
-        }
         filteredRoutes.clear();
+        candidates.clear();
     }
 
 private:
@@ -590,6 +589,7 @@ public:
              const sf::Vector2f& mouseGlobal,
              float panelX,
              float winH) {
+        refreshCompanies(graph);
         window.draw(fieldOrigin);
         window.draw(fieldDest);
         window.draw(portField);
@@ -699,8 +699,9 @@ public:
                 int lineLength = 0;
                 const int maxLineLength = 35;
                 
-                for (int i = 0; i < result->path.getSize(); i++) {
-                    std::string portName = graph.vertices[result->path.get(i)].port.name;
+                int i = 0;
+                for (int port : result->path) {
+                    const std::string& portName = graph.vertices[port].port.name;
                     
                     if (i > 0) {
                         pathStr += " -> ";
@@ -714,6 +715,7 @@ public:
                     
                     pathStr += portName;
                     lineLength += portName.length();
+                    i++;
                 }
                 ss << pathStr;
             } else if (filteredRoutes.empty() && selectedOriginIndex != -1 && selectedDestIndex != -1) {
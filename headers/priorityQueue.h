@@ -2,80 +2,99 @@
 #define PRIORITYQUEUE_H
 
 #include <stdexcept>
-
-template <typename T>
+#include <utility>
+#include "vector.h"
+
+// Min-priority queue backed by a binary heap in a Vector, so push and pop
+// are O(log n) however large the queue gets. Items with equal priority
+// come out in the order they were pushed (each carries a sequence number
+// as a tie-breaker), so the searches settle ports in a fixed order.
+// Priority is int unless keys can outgrow it (absolute times plus bounds).
+template <typename T, typename Priority = int>
 class PriorityQueue {
 private:
     struct Node {
         T data;
-        int priority;
-        Node* next;
-
-        Node(T d, int p) : data(d), priority(p), next(nullptr) {}
+        Priority priority;
+        unsigned long long sequence;
     };
 
-    Node* head;    // always points to smallest priority
-    int size;
+    Vector<Node> heap;
+    unsigned long long pushed;
 
-public:
-    PriorityQueue() : head(nullptr), size(0) {}
+    static bool before(const Node& a, const Node& b) {
+        if (a.priority != b.priority) return a.priority < b.priority;
+        return a.sequence < b.sequence;
+    }
 
-    ~PriorityQueue() {
-        clear();
+    void siftUp(int i) {
+        Node node = std::move(heap[i]);
+        while (i > 0) {
+            int parent = (i - 1) / 2;
+            if (!before(node, heap[parent])) break;
+            heap[i] = std::move(heap[parent]);
+            i = parent;
+        }
+        heap[i] = std::move(node);
     }
 
-    void push(T data, int priority) {
-        Node* newNode = new Node(data, priority);
-
-        // Insert at beginning if queue empty or smaller priority
-        if (!head || priority < head->priority) {
-            newNode->next = head;
-            head = newNode;
-        } else {
-            // Otherwise find correct sorted position
-            Node* current = head;
-            while (current->next && current->next->priority <= priority) {
-                current = current->next;
-            }
-            newNode->next = current->next;
-            current->next = newNode;
+    void siftDown(int i) {
+        int n = heap.size();
+        Node node = std::move(heap[i]);
+        while (true) {
+            int child = 2 * i + 1;
+            if (child >= n) break;
+            if (child + 1 < n && before(heap[child + 1], heap[child])) child++;
+            if (!before(heap[child], node)) break;
+            heap[i] = std::move(heap[child]);
+            i = child;
         }
+        heap[i] = std::move(node);
+    }
 
-        size++;
+public:
+    PriorityQueue() : pushed(0) {}
+
+    void push(T data, Priority priority) {
+        Node node;
+        node.data = std::move(data);
+        node.priority = priority;
+        node.sequence = pushed++;
+        heap.push_back(std::move(node));
+        siftUp(heap.size() - 1);
     }
 
     T pop() {
-        if (!head) throw std::runtime_error("Priority queue is empty");
-
-        Node* temp = head;
-        T result = temp->data;
-        head = head->next;
-        delete temp;
+        if (heap.empty()) throw std::runtime_error("Priority queue is empty");
 
-        size--;
+        T result = std::move(heap[0].data);
+        if (heap.size() > 1) heap[0] = std::move(heap.back());
+        heap.pop_back();
+        if (!heap.empty()) siftDown(0);
         return result;
     }
 
     T top() const {
-        if (!head) throw std::runtime_error("Priority queue is empty");
-        return head->data;
+        if (heap.empty()) throw std::runtime_error("Priority queue is empty");
+        return heap[0].data;
+    }
+
+    Priority topPriority() const {
+        if (heap.empty()) throw std::runtime_error("Priority queue is empty");
+        return heap[0].priority;
     }
 
     bool isEmpty() const {
-        return head == nullptr;
+        return heap.empty();
     }
 
     int getSize() const {
-        return size;
+        return heap.size();
     }
 
     void clear() {
-        while (head) {
-            Node* temp = head;
-            head = head->next;
-            delete temp;
-        }
-        size = 0;
+        heap.clear();
+        pushed = 0;
     }
 };
 
@@ -0,0 +1,199 @@
+#ifndef PROFILESEARCH_H
+#define PROFILESEARCH_H
+
+#include <string>
+#include "Graph.hpp"
+#include "pathFinding.h"
+#include "timeUtils.h"
+#include "arena.h"
+#include "connections.h"
+#include "vector.h"
+
+// Profile queries: every itinerary from origin to destination that leaves
+// within a date window and is Pareto-optimal in (later departure, earlier
+// arrival, lower cost), found in one pass.
+//
+// Profile connection scan: every sailing is a connection, scanned once by
+// decreasing departure time. Each port keeps the Pareto set of ways to
+// reach the destination from it, keyed by departure. A connection into a
+// port extends that port's entries that still leave at least an hour
+// after it arrives, with the same layover fee as the searches (port charge
+// when the wait exceeds 12 hours).
+class ProfileSearch {
+public:
+    static const int DEFAULT_WINDOW_DAYS = 14;
+
+    // Itineraries whose first leg departs on one of the days days starting
+    // at fromDate ("D/M/YYYY"), in departure order, owned by arena. Each
+    // result is a full PathResult (totalTime = first departure to last
+    // arrival). Returns the number added to out.
+    static int findProfile(const Graph& graph, int originIndex, int destinationIndex,
+                           const std::string& fromDate, int days, Arena& arena,
+                           Vector<PathFinding::PathResult*>& out) {
+        if (originIndex < 0 || destinationIndex < 0 || originIndex >= graph.size ||
+            destinationIndex >= graph.size || originIndex == destinationIndex || days <= 0) {
+            return 0;
+        }
+        long long windowStart = (long long)TimeUtils::dateToDays(fromDate) * 24 * 60;
+        long long windowEnd = windowStart + (long long)days * 24 * 60 - 1;
+        return findProfile(graph, originIndex, destinationIndex, windowStart, windowEnd, arena, out);
+    }
+
+    // Same, with the window given in absolute minutes (TimeUtils)
+    static int findProfile(const Graph& graph, int originIndex, int destinationIndex,
+                           long long windowStart, long long windowEnd, Arena& arena,
+                           Vector<PathFinding::PathResult*>& out) {
+        Vector<Entry> entries;
+        Vector<Vector<int> > profiles;      // per port, entry ids by decreasing departure
+        profiles.resize(graph.size);
+        Vector<Candidate> candidates;
+
+        ConnectionScan scan(graph, ConnectionScan::BY_DEPARTURE);
+        while (const Connection* next = scan.next()) {
+            const Connection& conn = *next;
+            // Every leg of an itinerary leaves after its first one
+            if (conn.departure < windowStart) break;
+            // Itineraries end on reaching the destination
+            if (conn.from == destinationIndex) continue;
+            // Leaving the origin after the window is never an option, and
+            // such entries must not hide the in-window ones behind them
+            if (conn.from == originIndex && conn.departure > windowEnd) continue;
+
+            candidates.clear();
+            if (conn.to == destinationIndex) {
+                addCandidate(candidates, conn.arrival, conn.cost, -1);
+            } else {
+                const Vector<int>& onward = profiles[conn.to];
+                int fee = graph.vertices[conn.to].port.portCharge;
+                for (int i = 0; i < onward.size(); i++) {
+                    const Entry& next = entries[onward[i]];
+                    long long wait = next.departure - conn.arrival;
+                    // Sorted by departure, so the rest leave even earlier
+                    if (wait < 60) break;
+                    if (next.dominated) continue;
+                    int cost = conn.cost + (wait > 720 ? fee : 0) + next.cost;
+                    addCandidate(candidates, next.arrival, cost, onward[i]);
+                }
+            }
+
+            int fromFee = graph.vertices[conn.from].port.portCharge;
+            for (int i = 0; i < candidates.size(); i++) {
+                insertEntry(entries, profiles[conn.from], conn, candidates[i], fromFee);
+            }
+        }
+
+        // The origin's own profile, restricted to the window. Ports keep a
+        // few entries that only win when a layover fee applies, and there
+        // is no layover at the origin, so filter once more. Oldest first.
+        Vector<int> window;
+        const Vector<int>& atOrigin = profiles[originIndex];
+        for (int i = atOrigin.size() - 1; i >= 0; i--) {
+            const Entry& first = entries[atOrigin[i]];
+            if (!first.dominated && first.departure <= windowEnd) window.push_back(atOrigin[i]);
+        }
+
+        int added = 0;
+        for (int i = 0; i < window.size(); i++) {
+            const Entry& option = entries[window[i]];
+            bool beaten = false;
+            for (int j = 0; j < window.size() && !beaten; j++) {
+                const Entry& other = entries[window[j]];
+                beaten = other.departure >= option.departure && other.arrival <= option.arrival &&
+                         other.cost <= option.cost &&
+                         (other.departure > option.departure || other.arrival < option.arrival ||
+                          other.cost < option.cost);
+            }
+            if (beaten) continue;
+            out.push_back(buildResult(entries, window[i], originIndex, arena));
+            added++;
+        }
+        return added;
+    }
+
+    // Number of connections in the scan order for graph (builds it if needed)
+    static int getConnectionCount(const Graph& graph) {
+        return Connections::byDeparture(graph).size();
+    }
+
+private:
+    // One Pareto-optimal way to the destination from a port
+    struct Entry {
+        long long departure;
+        long long arrival;      // at the destination
+        int cost;               // from here to the destination
+        Connection leg;         // first leg
+        int next;               // entry continued at the leg's far end, -1 if it arrives
+        bool dominated;         // superseded by a later entry with the same departure
+    };
+
+    struct Candidate {
+        long long arrival;
+        int cost;
+        int next;
+    };
+
+    // Keep candidates of one connection Pareto-optimal in (arrival, cost)
+    static void addCandidate(Vector<Candidate>& candidates, long long arrival, int cost, int next) {
+        for (int i = 0; i < candidates.size(); i++) {
+            if (candidates[i].arrival <= arrival && candidates[i].cost <= cost) return;
+        }
+        for (int i = candidates.size() - 1; i >= 0; i--) {
+            if (arrival <= candidates[i].arrival && cost <= candidates[i].cost) candidates.erase(i);
+        }
+        Candidate candidate;
+        candidate.arrival = arrival;
+        candidate.cost = cost;
+        candidate.next = next;
+        candidates.push_back(candidate);
+    }
+
+    static void insertEntry(Vector<Entry>& entries, Vector<int>& profile, const Connection& conn,
+                            const Candidate& candidate, int layoverFee) {
+        // Everything already here leaves no earlier, so it dominates the
+        // candidate when it is no worse on arrival and cost. A later
+        // departure can mean a longer layover for whoever connects into it,
+        // so it must stay no worse even after paying the port's fee.
+        for (int i = 0; i < profile.size(); i++) {
+            const Entry& existing = entries[profile[i]];
+            if (existing.dominated) continue;
+            int fee = (existing.departure > conn.departure) ? layoverFee : 0;
+            if (existing.arrival <= candidate.arrival && existing.cost + fee <= candidate.cost) return;
+        }
+        // The candidate can only supersede entries leaving at the same time
+        for (int i = profile.size() - 1; i >= 0; i--) {
+            Entry& existing = entries[profile[i]];
+            if (existing.departure != conn.departure) break;
+            if (candidate.arrival <= existing.arrival && candidate.cost <= existing.cost) {
+                existing.dominated = true;
+            }
+        }
+
+        Entry entry;
+        entry.departure = conn.departure;
+        entry.arrival = candidate.arrival;
+        entry.cost = candidate.cost;
+        entry.leg = conn;
+        entry.next = candidate.next;
+        entry.dominated = false;
+        profile.push_back(entries.size());
+        entries.push_back(entry);
+    }
+
+    static PathFinding::PathResult* buildResult(const Vector<Entry>& entries, int first, int originIndex,
+                                                Arena& arena) {
+        PathFinding::PathResult* result = arena.create<PathFinding::PathResult>();
+        result->found = true;
+        result->totalCost = entries[first].cost;
+        result->totalTime = (int)(entries[first].arrival - entries[first].departure);
+
+        result->path.insertEnd(originIndex);
+        for (int id = first; id != -1; id = entries[id].next) {
+            const Connection& conn = entries[id].leg;
+            result->routes.insertEnd(Connections::routeOf(conn));
+            result->path.insertEnd(conn.to);
+        }
+        return result;
+    }
+};
+
+#endif
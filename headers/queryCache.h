@@ -0,0 +1,308 @@
+#ifndef QUERYCACHE_H
+#define QUERYCACHE_H
+
+#include <string>
+#include <utility>
+#include "pathFinding.h"
+#include "landmarks.h"
+#include "transferPatterns.h"
+#include "hashMap.h"
+#include "bitSet.h"
+#include "vector.h"
+
+// Everything that determines a search's answer
+struct SearchQuery {
+    enum Objective {
+        CHEAPEST,           // PathFinding::findCheapestPath (optionally constrained)
+        FASTEST,            // PathFinding::findShortestTimePath (optionally constrained)
+        FILTER_LEADERS,     // RouteFilter constrained cheapest + fastest
+        FILTER_ALTERNATIVES,// RouteFilter BFS paths
+        BOOKING_DIRECT,     // BookingMenu direct routes on date
+        BOOKING_CONNECTED,  // BookingMenu connected routes on date
+        BOOKING_PROFILE     // BookingMenu Pareto options leaving within days of date
+    };
+
+    Objective objective;
+    int origin;
+    int destination;
+    std::string date;   // empty when the query is not date-specific
+    int days;           // window length from date (profile queries), else 0
+    BitSet companies;   // compiled preference masks, empty when unfiltered
+    BitSet ports;
+
+    SearchQuery() : objective(CHEAPEST), origin(-1), destination(-1), days(0) {}
+
+    SearchQuery(Objective obj, int from, int to, const std::string& onDate = "", int windowDays = 0)
+        : objective(obj), origin(from), destination(to), date(onDate), days(windowDays) {}
+
+    bool operator==(const SearchQuery& other) const {
+        return objective == other.objective && origin == other.origin &&
+               destination == other.destination && date == other.date &&
+               days == other.days && companies == other.companies && ports == other.ports;
+    }
+};
+
+struct SearchQueryHash {
+    size_t operator()(const SearchQuery& q) const {
+        size_t h = DefaultHash<std::string>()(q.date);
+        h = h * 31 + (size_t)q.objective;
+        h = h * 1000003 + (size_t)q.origin;
+        h = h * 1000003 + (size_t)q.destination;
+        h = h * 31 + (size_t)q.days;
+        h ^= q.companies.hash() + 0x9e3779b97f4a7c15ull + (h << 6) + (h >> 2);
+        h ^= q.ports.hash() + 0x9e3779b97f4a7c15ull + (h << 6) + (h >> 2);
+        return DefaultHash<long long>()((long long)h);
+    }
+};
+
+// Bounded LRU cache of search results.
+// Entries are stamped with the Graph revision they were computed against;
+// the first lookup on a later revision drops everything, unless the
+// change was applied through invalidateIf() and rebase(). Lookups and
+// results from an earlier revision (a search that ran on an older
+// snapshot, timetableSnapshots.h) miss and are not kept. Results that
+// depend on bookings are flagged and dropped by invalidateBookings().
+class QueryCache {
+public:
+    typedef Vector<PathFinding::PathResult> Paths;
+
+private:
+    struct Entry {
+        SearchQuery query;
+        Paths paths;
+        bool dependsOnBookings;
+        int prev;   // towards most recently used
+        int next;   // towards least recently used
+    };
+
+    Vector<Entry> entries;      // slots, grown up to capacity
+    Vector<int> freeSlots;
+    HashMap<SearchQuery, int, SearchQueryHash> index;
+    int capacity;
+    int mostRecent;
+    int leastRecent;
+    unsigned long long graphRevision;
+
+    int hits;
+    int misses;
+    int evictions;
+    int invalidations;
+
+    void unlink(int slot) {
+        Entry& e = entries[slot];
+        if (e.prev != -1) entries[e.prev].next = e.next; else mostRecent = e.next;
+        if (e.next != -1) entries[e.next].prev = e.prev; else leastRecent = e.prev;
+        e.prev = e.next = -1;
+    }
+
+    void pushFront(int slot) {
+        Entry& e = entries[slot];
+        e.prev = -1;
+        e.next = mostRecent;
+        if (mostRecent != -1) entries[mostRecent].prev = slot;
+        mostRecent = slot;
+        if (leastRecent == -1) leastRecent = slot;
+    }
+
+    void removeSlot(int slot) {
+        unlink(slot);
+        index.erase(entries[slot].query);
+        entries[slot].paths.clear();
+        freeSlots.push_back(slot);
+    }
+
+    // False for a revision older than the entries
+    bool checkGraph(unsigned long long revision) {
+        if (revision < graphRevision) return false;
+        if (revision > graphRevision) {
+            if (index.size() > 0) invalidations++;
+            clear();
+            graphRevision = revision;
+        }
+        return true;
+    }
+
+public:
+    explicit QueryCache(int maxEntries = 64)
+        : capacity(maxEntries < 1 ? 1 : maxEntries), mostRecent(-1), leastRecent(-1),
+          graphRevision(0), hits(0), misses(0), evictions(0), invalidations(0) {}
+
+    // Cached paths for q, or nullptr. A hit makes q the most recently used.
+    const Paths* find(const SearchQuery& q, unsigned long long revision) {
+        const int* slot = checkGraph(revision) ? index.find(q) : nullptr;
+        if (!slot) {
+            misses++;
+            return nullptr;
+        }
+        hits++;
+        unlink(*slot);
+        pushFront(*slot);
+        return &entries[*slot].paths;
+    }
+
+    void insert(const SearchQuery& q, Paths paths, bool dependsOnBookings, unsigned long long revision) {
+        if (!checkGraph(revision)) return;
+
+        int* existing = index.find(q);
+        if (existing) removeSlot(*existing);
+
+        int slot;
+        if (!freeSlots.empty()) {
+            slot = freeSlots.back();
+            freeSlots.pop_back();
+        } else if (entries.size() < capacity) {
+            entries.push_back(Entry());
+            slot = entries.size() - 1;
+        } else {
+            slot = leastRecent;
+            removeSlot(slot);
+            freeSlots.pop_back();
+            evictions++;
+        }
+
+        Entry& e = entries[slot];
+        e.query = q;
+        e.paths = std::move(paths);
+        e.dependsOnBookings = dependsOnBookings;
+        index.insert(q, slot);
+        pushFront(slot);
+    }
+
+    // A booking was made or cancelled: drop only the results that filter
+    // on availability
+    void invalidateBookings() {
+        bool dropped = false;
+        int slot = mostRecent;
+        while (slot != -1) {
+            int next = entries[slot].next;
+            if (entries[slot].dependsOnBookings) {
+                removeSlot(slot);
+                dropped = true;
+            }
+            slot = next;
+        }
+        if (dropped) invalidations++;
+    }
+
+    // The timetable changed (timetableFeed.h): drop the results
+    // stale(query, paths) picks, then rebase() to keep the rest
+    template <typename Stale>
+    void invalidateIf(Stale stale) {
+        bool dropped = false;
+        int slot = mostRecent;
+        while (slot != -1) {
+            int next = entries[slot].next;
+            if (stale(entries[slot].query, entries[slot].paths)) {
+                removeSlot(slot);
+                dropped = true;
+            }
+            slot = next;
+        }
+        if (dropped) invalidations++;
+    }
+
+    // The entries from revision from hold for revision to as well
+    void rebase(unsigned long long from, unsigned long long to) {
+        if (graphRevision == from) graphRevision = to;
+    }
+
+    void clear() {
+        while (mostRecent != -1) removeSlot(mostRecent);
+    }
+
+    int getHits() const { return hits; }
+    int getMisses() const { return misses; }
+    int getEvictions() const { return evictions; }
+    int getInvalidations() const { return invalidations; }
+    int getSize() const { return index.size(); }
+    int getCapacity() const { return capacity; }
+};
+
+// Shared cache for the app's searches, plus cached versions of the
+// PathFinding searches that hand back a fresh PathResult like the originals
+class SearchCache {
+public:
+    static QueryCache& get() {
+        static QueryCache cache(64);
+        return cache;
+    }
+
+    // Copies cached paths into arena (or nothing, on a miss)
+    static bool lookup(const SearchQuery& q, const Graph& graph, Arena& arena,
+                       Vector<PathFinding::PathResult*>& out) {
+        const QueryCache::Paths* cached = get().find(q, graph.getRevision());
+        if (!cached) return false;
+        for (const PathFinding::PathResult& path : *cached) {
+            out.push_back(arena.create<PathFinding::PathResult>(path));
+        }
+        return true;
+    }
+
+    static void store(const SearchQuery& q, const Graph& graph,
+                      const Vector<PathFinding::PathResult*>& paths, bool dependsOnBookings) {
+        QueryCache::Paths copies;
+        copies.reserve(paths.size());
+        for (const PathFinding::PathResult* path : paths) copies.push_back(*path);
+        get().insert(q, std::move(copies), dependsOnBookings, graph.getRevision());
+    }
+
+    // Same contract as PathFinding::findCheapestPath (caller owns the result)
+    static PathFinding::PathResult* findCheapestPath(const Graph& graph, int startIndex, int endIndex) {
+        return findCached(SearchQuery(SearchQuery::CHEAPEST, startIndex, endIndex), graph);
+    }
+
+    static PathFinding::PathResult* findShortestTimePath(const Graph& graph, int startIndex, int endIndex) {
+        return findCached(SearchQuery(SearchQuery::FASTEST, startIndex, endIndex), graph);
+    }
+
+    // Cached answer to a CHEAPEST/FASTEST query as a fresh PathResult the
+    // caller owns, or nullptr on a miss
+    static PathFinding::PathResult* lookupPath(const SearchQuery& q, const Graph& graph) {
+        const QueryCache::Paths* cached = get().find(q, graph.getRevision());
+        return cached ? new PathFinding::PathResult((*cached)[0]) : nullptr;
+    }
+
+    static void storePath(const SearchQuery& q, const Graph& graph, const PathFinding::PathResult& result) {
+        QueryCache::Paths copies;
+        copies.push_back(result);
+        get().insert(q, std::move(copies), false, graph.getRevision());
+    }
+
+    // Answer a CHEAPEST/FASTEST query without touching the cache, so it can
+    // run on the search worker (searchWorker.h). Caller owns the result.
+    // A search given the job's control reports progress and stops (found
+    // false) once the job is cancelled.
+    static PathFinding::PathResult* computePath(const SearchQuery& q, const Graph& graph,
+                                                SearchControl* control = nullptr) {
+        if (q.origin < 0 || q.destination < 0 || q.origin >= graph.size || q.destination >= graph.size) {
+            return new PathFinding::PathResult();
+        }
+        if (const TransferPatternTables* patterns = TransferPatterns::active(graph)) {
+            // Precomputed: only the direct sailings along one transfer pattern
+            return (q.objective == SearchQuery::CHEAPEST)
+                ? TransferPatterns::findCheapestPath(graph, *patterns, q.origin, q.destination)
+                : TransferPatterns::findShortestTimePath(graph, *patterns, q.origin, q.destination);
+        }
+
+        // A* towards the destination
+        PathFinding::AllowAll any;
+        bool cheapest = (q.objective == SearchQuery::CHEAPEST);
+        return Landmarks::withBounds(graph, q.origin, q.destination, [&](const auto& toTarget) {
+            return cheapest
+                ? PathFinding::findCheapestPath(graph, q.origin, q.destination, any, toTarget, control)
+                : PathFinding::findShortestTimePath(graph, q.origin, q.destination, any, toTarget, control);
+        });
+    }
+
+private:
+    static PathFinding::PathResult* findCached(const SearchQuery& q, const Graph& graph) {
+        PathFinding::PathResult* result = lookupPath(q, graph);
+        if (result) return result;
+
+        result = computePath(q, graph);
+        storePath(q, graph, *result);
+        return result;
+    }
+};
+
+#endif
@@ -0,0 +1,628 @@
+#ifndef QUERYSERVER_H
+#define QUERYSERVER_H
+
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include "Graph.hpp"
+#include "arena.h"
+#include "bookingSystem.hpp"
+#include "hashMap.h"
+#include "jsonMessage.h"
+#include "pathFinding.h"
+#include "queryCache.h"
+#include "queue.h"
+#include "routeFilter.hpp"
+#include "sharedTimetable.h"
+#include "timetableFeed.h"
+#include "timetableSnapshots.h"
+#include "vector.h"
+
+// Answers route queries from other programs on this host, one JSON object
+// per line each way (jsonMessage.h), over a Unix socket or a loopback TCP
+// port:
+//   {"id":1,"op":"cheapest","origin":"A","destination":"B"}   (or "fastest")
+//   {"id":2,"op":"filtered","origin":"A","destination":"B",
+//    "companies":["X"],"ports":["C"],"limit":5}
+//   {"id":3,"op":"book","origin":"A","destination":"B","objective":"fastest"}
+//   {"id":4,"op":"ports"}
+// Every reply has the request's id and "ok"; replies on one connection can
+// come back in a different order than the requests.
+//
+// One thread reads the sockets and queues the lines. A fixed pool of
+// workers takes them in batches: a batch is answered from one pinned
+// snapshot of the timetable (timetableSnapshots.h), and a cheapest or
+// fastest query asked more than once in it is searched once. Bookings are
+// searched by the workers but made one at a time by a single writer
+// thread, which also applies the live feed. Only the writer touches the
+// bookings and the result cache.
+//
+// A server on a timetable another process shared (sharedTimetable.h)
+// answers "ports", "cheapest" and "fastest" from the mapped segment, so
+// any number of server processes keep one copy of it; "filtered" and
+// "book" need a Graph of its own and are refused.
+//
+// POSIX sockets only; server.cpp is its entry point.
+class QueryServer {
+private:
+    static constexpr int MAX_BATCH = 32;           // requests a worker takes at once
+    static constexpr int FEED_INTERVAL_MS = 200;   // how often the writer polls the feed
+    static constexpr int MAX_LINE = 1 << 16;       // longer requests close the connection
+
+    struct Connection {
+        int fd;
+        std::string received;   // reader thread only: the unfinished line
+        std::mutex sending;
+
+        explicit Connection(int socket) : fd(socket) {}
+        ~Connection() { ::close(fd); }
+
+        // False once the peer has gone
+        bool send(const std::string& text) {
+            std::lock_guard<std::mutex> lock(sending);
+            size_t sent = 0;
+            while (sent < text.size()) {
+                ssize_t n = ::send(fd, text.data() + sent, text.size() - sent, MSG_NOSIGNAL);
+                if (n < 0 && errno == EINTR) continue;
+                if (n <= 0) return false;
+                sent += n;
+            }
+            return true;
+        }
+    };
+    typedef std::shared_ptr<Connection> ConnectionPtr;
+
+    struct Request {
+        ConnectionPtr from;
+        std::string line;
+    };
+
+    // A searched itinerary waiting for the writer
+    struct Booking {
+        ConnectionPtr from;
+        std::string id;
+        SearchQuery query;
+        PathFinding::PathResult* path;  // the writer deletes it
+        unsigned long long revision;    // of the snapshot path was found on
+    };
+
+    TimetableSnapshots* timetable;  // null when serving a shared timetable
+    const SharedTimetable* shared;
+    TimetableFeed* feed;
+    int workerCount;
+    int listener;
+    int wake[2];                    // stop() writes to wake[1]
+    std::string socketPath;         // unlinked when a Unix socket closes
+    std::atomic<bool> stopping;
+
+    std::mutex requestMutex;
+    std::condition_variable requestsQueued;
+    Queue<Request> requests;
+    bool requestsClosed;
+
+    std::mutex bookingMutex;
+    std::condition_variable bookingsQueued;
+    Queue<Booking> bookings;
+    bool bookingsClosed;
+
+    Vector<std::thread> threads;
+    std::atomic<long long> answered;
+    std::atomic<long long> batches;
+
+    // A number means a TCP port on 127.0.0.1; anything else is a socket path
+    static bool isPort(const std::string& address) {
+        if (address.empty()) return false;
+        for (char c : address) {
+            if (c < '0' || c > '9') return false;
+        }
+        return true;
+    }
+
+    // The port address names, or -1 if it is out of range
+    static int portNumber(const std::string& address) {
+        if (address.size() > 5) return -1;
+        int port = std::stoi(address);
+        return (port >= 1 && port <= 65535) ? port : -1;
+    }
+
+    static int openSocket(const std::string& address, bool listening) {
+        int fd;
+        if (isPort(address)) {
+            int port = portNumber(address);
+            if (port == -1) return -1;
+            sockaddr_in where;
+            std::memset(&where, 0, sizeof(where));
+            where.sin_family = AF_INET;
+            where.sin_port = htons(static_cast<unsigned short>(port));
+            where.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+            fd = ::socket(AF_INET, SOCK_STREAM, 0);
+            if (fd == -1) return -1;
+            int on = 1;
+            if (listening) ::setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+            ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+            int done = listening ? ::bind(fd, (sockaddr*)&where, sizeof(where))
+                                 : ::connect(fd, (sockaddr*)&where, sizeof(where));
+            if (done == -1) {
+                ::close(fd);
+                return -1;
+            }
+        } else {
+            sockaddr_un where;
+            std::memset(&where, 0, sizeof(where));
+            if (address.size() >= sizeof(where.sun_path)) return -1;
+            where.sun_family = AF_UNIX;
+            std::memcpy(where.sun_path, address.c_str(), address.size());
+            fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+            if (fd == -1) return -1;
+            // A socket left by a server that died; never any other file
+            struct stat existing;
+            if (listening && ::lstat(address.c_str(), &existing) == 0) {
+                if (!S_ISSOCK(existing.st_mode)) {
+                    ::close(fd);
+                    return -1;
+                }
+                ::unlink(address.c_str());
+            }
+            int done = listening ? ::bind(fd, (sockaddr*)&where, sizeof(where))
+                                 : ::connect(fd, (sockaddr*)&where, sizeof(where));
+            if (done == -1) {
+                ::close(fd);
+                return -1;
+            }
+        }
+        if (listening && ::listen(fd, SOMAXCONN) == -1) {
+            ::close(fd);
+            return -1;
+        }
+        return fd;
+    }
+
+    // ---- replies ----
+
+    // An integer as JSON writes it: digits, no leading zero, maybe a '-'
+    static bool isInteger(const std::string& text) {
+        size_t digits = (!text.empty() && text[0] == '-') ? 1 : 0;
+        if (digits == text.size()) return false;
+        if (text[digits] == '0' && text.size() > digits + 1) return false;
+        for (size_t i = digits; i < text.size(); i++) {
+            if (text[i] < '0' || text[i] > '9') return false;
+        }
+        return true;
+    }
+
+    // The id as the client sent it (integers stay numbers)
+    static void appendId(std::string& out, const std::string& id) {
+        out += "\"id\":";
+        if (id.empty()) {
+            out += "null";
+            return;
+        }
+        if (isInteger(id)) {
+            out += id;
+        } else {
+            JsonMessage::appendString(out, id);
+        }
+    }
+
+    static std::string failure(const std::string& id, const std::string& error) {
+        std::string out = "{";
+        appendId(out, id);
+        out += ",\"ok\":false,";
+        JsonMessage::appendField(out, "error", error);
+        out += "}\n";
+        return out;
+    }
+
+    // "found", and the totals and legs when there is an itinerary
+    static void appendItinerary(std::string& out, const PathFinding::PathResult* path) {
+        JsonMessage::appendFlag(out, "found", path->found);
+        if (!path->found) return;
+        out += ',';
+        JsonMessage::appendField(out, "cost", (long long)path->totalCost);
+        out += ',';
+        JsonMessage::appendField(out, "minutes", (long long)path->totalTime);
+        out += ",\"legs\":[";
+        bool first = true;
+        for (const Route& leg : path->routes) {
+            if (!first) out += ',';
+            first = false;
+            out += '{';
+            JsonMessage::appendField(out, "from", leg.startPoint.name);
+            out += ',';
+            JsonMessage::appendField(out, "to", leg.dest.name);
+            out += ',';
+            JsonMessage::appendField(out, "date", leg.date);
+            out += ',';
+            JsonMessage::appendField(out, "departs", leg.deptTime);
+            out += ',';
+            JsonMessage::appendField(out, "arrives", leg.arrTime);
+            out += ',';
+            JsonMessage::appendField(out, "company", leg.company);
+            out += ',';
+            JsonMessage::appendField(out, "cost", (long long)leg.cost);
+            out += '}';
+        }
+        out += ']';
+    }
+
+    // ---- workers ----
+
+    void work() {
+        Arena arena("query server");
+        Vector<Request> batch;
+        while (true) {
+            {
+                std::unique_lock<std::mutex> lock(requestMutex);
+                requestsQueued.wait(lock, [&] { return requestsClosed || !requests.isEmpty(); });
+                if (requests.isEmpty()) return;
+                requests.drain(batch, MAX_BATCH);
+            }
+            answer(batch, arena);
+            batch.clear();
+        }
+    }
+
+    void answer(Vector<Request>& batch, Arena& arena) {
+        TimetableSnapshots::Snapshot pinned;
+        if (timetable) pinned = timetable->pin();
+        HashMap<SearchQuery, std::string, SearchQueryHash> searched;
+
+        // Replies gathered per connection, so each gets one send
+        Vector<Connection*> to;
+        Vector<std::string> replies;
+        for (int i = 0; i < batch.size(); i++) {
+            std::string reply = pinned ? respond(*pinned, batch[i], searched, arena)
+                                       : respondShared(batch[i].line, searched);
+            if (reply.empty()) continue;    // a booking, answered by the writer
+            Connection* from = batch[i].from.get();
+            int slot = 0;
+            while (slot < to.size() && to[slot] != from) slot++;
+            if (slot == to.size()) {
+                to.push_back(from);
+                replies.push_back(std::string());
+            }
+            replies[slot] += reply;
+        }
+        for (int i = 0; i < to.size(); i++) to[i]->send(replies[i]);
+
+        answered.fetch_add(batch.size(), std::memory_order_relaxed);
+        batches.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    template <typename Name>
+    static std::string portsReply(const std::string& id, int count, Name nameOf) {
+        std::string out = "{";
+        appendId(out, id);
+        out += ",\"ok\":true,\"ports\":[";
+        for (int i = 0; i < count; i++) {
+            if (i > 0) out += ',';
+            JsonMessage::appendString(out, nameOf(i));
+        }
+        out += "]}\n";
+        return out;
+    }
+
+    // A cheapest or fastest reply; each query is searched once per batch
+    template <typename Search>
+    static std::string searchReply(const std::string& id, const SearchQuery& query,
+                                   HashMap<SearchQuery, std::string, SearchQueryHash>& searched, Search search) {
+        const std::string* found = searched.find(query);
+        if (!found) {
+            PathFinding::PathResult* path = search();
+            std::string text;
+            appendItinerary(text, path);
+            delete path;
+            searched.insert(query, text);
+            found = searched.find(query);
+        }
+        std::string out = "{";
+        appendId(out, id);
+        out += ",\"ok\":true,";
+        out += *found;
+        out += "}\n";
+        return out;
+    }
+
+    // The reply line, or "" when the request went to the writer
+    std::string respond(const Graph& graph, Request& request,
+                        HashMap<SearchQuery, std::string, SearchQueryHash>& searched, Arena& arena) {
+        JsonMessage message;
+        if (!message.parse(request.line)) return failure("", "malformed request");
+        std::string id = message.getString("id");
+        std::string op = message.getString("op");
+
+        if (op == "ports") {
+            return portsReply(id, graph.size, [&](int i) { return graph.vertices[i].port.name; });
+        }
+
+        int origin = graph.findPort(message.getString("origin"));
+        int destination = graph.findPort(message.getString("destination"));
+        if (origin == -1 || destination == -1) return failure(id, "unknown port");
+
+        if (op == "cheapest" || op == "fastest") {
+            SearchQuery query(op == "cheapest" ? SearchQuery::CHEAPEST : SearchQuery::FASTEST,
+                              origin, destination);
+            return searchReply(id, query, searched, [&]() { return SearchCache::computePath(query, graph); });
+        }
+
+        if (op == "filtered") {
+            Vector<int> ports;
+            for (const std::string& name : message.getList("ports")) {
+                int port = graph.findPort(name);
+                if (port == -1) return failure(id, "unknown port");
+                ports.push_back(port);
+            }
+            long long limit = message.getNumber("limit", 5);
+            Vector<PathFinding::PathResult*> paths = RouteFilter::findFilteredRoutes(
+                graph, origin, destination, ports, message.getList("companies"), arena);
+
+            std::string out = "{";
+            appendId(out, id);
+            out += ",\"ok\":true,\"itineraries\":[";
+            for (int i = 0; i < paths.size() && i < limit; i++) {
+                if (i > 0) out += ',';
+                out += '{';
+                appendItinerary(out, paths[i]);
+                out += '}';
+            }
+            out += "]}\n";
+            arena.reset();
+            return out;
+        }
+
+        if (op == "book") {
+            SearchQuery query(message.getString("objective") == "fastest"
+                                  ? SearchQuery::FASTEST : SearchQuery::CHEAPEST,
+                              origin, destination);
+            Booking booking{request.from, id, query, SearchCache::computePath(query, graph),
+                            graph.getRevision()};
+            {
+                std::lock_guard<std::mutex> lock(bookingMutex);
+                bookings.enqueue(std::move(booking));
+            }
+            bookingsQueued.notify_one();
+            return std::string();
+        }
+
+        return failure(id, "unknown op");
+    }
+
+    // The reply line from the shared timetable
+    std::string respondShared(const std::string& line, HashMap<SearchQuery, std::string, SearchQueryHash>& searched) {
+        JsonMessage message;
+        if (!message.parse(line)) return failure("", "malformed request");
+        std::string id = message.getString("id");
+        std::string op = message.getString("op");
+
+        if (op == "ports") {
+            return portsReply(id, shared->getPortCount(), [&](int i) { return shared->getPortName(i); });
+        }
+        if (op == "filtered" || op == "book") return failure(id, "not available on a shared timetable");
+        if (op != "cheapest" && op != "fastest") return failure(id, "unknown op");
+
+        int origin = shared->findPort(message.getString("origin"));
+        int destination = shared->findPort(message.getString("destination"));
+        if (origin == -1 || destination == -1) return failure(id, "unknown port");
+        bool cheapest = op == "cheapest";
+        SearchQuery query(cheapest ? SearchQuery::CHEAPEST : SearchQuery::FASTEST, origin, destination);
+        return searchReply(id, query, searched, [&]() {
+            return cheapest ? shared->findCheapestPath(origin, destination)
+                            : shared->findShortestTimePath(origin, destination);
+        });
+    }
+
+    // ---- writer ----
+
+    void write() {
+        Vector<Booking> taken;
+        Vector<TimetableChange> changes;
+        while (true) {
+            {
+                std::unique_lock<std::mutex> lock(bookingMutex);
+                auto ready = [&] { return bookingsClosed || !bookings.isEmpty(); };
+                if (feed) {
+                    bookingsQueued.wait_for(lock, std::chrono::milliseconds(FEED_INTERVAL_MS), ready);
+                } else {
+                    bookingsQueued.wait(lock, ready);
+                }
+                if (bookingsClosed && bookings.isEmpty()) return;
+                bookings.drain(taken);
+            }
+            for (int i = 0; i < taken.size(); i++) book(taken[i]);
+            taken.clear();
+
+            if (feed && feed->read(changes) > 0) {
+                timetable->update([&](Graph& next) { feed->apply(next, changes, &SearchCache::get()); });
+                changes.clear();
+            }
+        }
+    }
+
+    // Taken unless it shares a sailing with an earlier booking that day.
+    // Only the writer publishes changes, so the current snapshot holds
+    // until the booking is made; a path found on an older one is searched
+    // again, as its sailings may have been delayed or cancelled since.
+    void book(Booking& booking) {
+        std::string out = "{";
+        appendId(out, booking.id);
+        out += ",\"ok\":true,";
+        TimetableSnapshots::Snapshot current = timetable->pin();
+        if (booking.revision != current->getRevision()) {
+            delete booking.path;
+            booking.path = SearchCache::computePath(booking.query, *current);
+        }
+        PathFinding::PathResult* path = booking.path;
+        if (!path->found || path->routes.isEmpty()) {
+            out += "\"booked\":false,\"reason\":\"no itinerary\"";
+        } else {
+            std::string date = path->routes.front().date;
+            if (!BookingSystem::isRouteAvailable(path, date)) {
+                out += "\"booked\":false,\"reason\":\"already booked\"";
+            } else {
+                BookingSystem::addBooking(booking.query.origin, booking.query.destination, date, path);
+                out += "\"booked\":true,";
+                appendItinerary(out, path);
+            }
+        }
+        out += "}\n";
+        delete path;
+        booking.from->send(out);
+    }
+
+    // ---- reader ----
+
+    void queueLines(Connection& connection, const ConnectionPtr& from, Vector<Request>& out) {
+        size_t start = 0;
+        while (true) {
+            size_t end = connection.received.find('\n', start);
+            if (end == std::string::npos) break;
+            if (end > start) out.push_back(Request{from, connection.received.substr(start, end - start)});
+            start = end + 1;
+        }
+        connection.received.erase(0, start);
+    }
+
+    void shutdownWorkers() {
+        {
+            std::lock_guard<std::mutex> lock(requestMutex);
+            requestsClosed = true;
+        }
+        requestsQueued.notify_all();
+        for (int i = 0; i < workerCount && i < threads.size(); i++) threads[i].join();
+        {
+            std::lock_guard<std::mutex> lock(bookingMutex);
+            bookingsClosed = true;
+        }
+        bookingsQueued.notify_all();
+        if (threads.size() > workerCount) threads[workerCount].join();
+        threads.clear();
+    }
+
+public:
+    // feed, if given, is polled by the writer and applied to timetable
+    QueryServer(TimetableSnapshots& snapshots, int workers, TimetableFeed* liveFeed = nullptr)
+        : timetable(&snapshots), shared(nullptr), feed(liveFeed), workerCount(workers < 1 ? 1 : workers),
+          listener(-1), stopping(false), requestsClosed(false), bookingsClosed(false),
+          answered(0), batches(0) {
+        if (::pipe(wake) == -1) wake[0] = wake[1] = -1;
+    }
+
+    // Serving an attached segment; it must stay attached while this runs
+    QueryServer(const SharedTimetable& segment, int workers)
+        : timetable(nullptr), shared(&segment), feed(nullptr), workerCount(workers < 1 ? 1 : workers),
+          listener(-1), stopping(false), requestsClosed(false), bookingsClosed(false),
+          answered(0), batches(0) {
+        if (::pipe(wake) == -1) wake[0] = wake[1] = -1;
+    }
+
+    ~QueryServer() {
+        if (wake[0] != -1) ::close(wake[0]);
+        if (wake[1] != -1) ::close(wake[1]);
+    }
+
+    QueryServer(const QueryServer&) = delete;
+    QueryServer& operator=(const QueryServer&) = delete;
+
+    // A client connection to a server at address, or -1
+    static int connectTo(const std::string& address) {
+        return openSocket(address, false);
+    }
+
+    // Serve on address until stop(); false if it cannot be listened on
+    bool run(const std::string& address) {
+        listener = openSocket(address, true);
+        if (listener == -1 || wake[0] == -1) return false;
+        if (!isPort(address)) socketPath = address;
+
+        for (int i = 0; i < workerCount; i++) threads.push_back(std::thread(&QueryServer::work, this));
+        threads.push_back(std::thread(&QueryServer::write, this));
+
+        Vector<ConnectionPtr> open;
+        Vector<pollfd> watched;
+        Vector<Request> arrived;
+        char buffer[1 << 16];
+        while (!stopping.load()) {
+            watched.clear();
+            watched.push_back(pollfd{wake[0], POLLIN, 0});
+            watched.push_back(pollfd{listener, POLLIN, 0});
+            for (int i = 0; i < open.size(); i++) watched.push_back(pollfd{open[i]->fd, POLLIN, 0});
+            if (::poll(&watched[0], watched.size(), -1) == -1) {
+                if (errno == EINTR) continue;
+                break;
+            }
+            if (watched[0].revents) break;
+
+            // Newest first, so dropping one moves an already-read one into its place
+            for (int i = open.size() - 1; i >= 0; i--) {
+                if (!watched[i + 2].revents) continue;
+                ssize_t n = ::recv(open[i]->fd, buffer, sizeof(buffer), 0);
+                if (n < 0 && errno == EINTR) continue;
+                if (n > 0) {
+                    open[i]->received.append(buffer, n);
+                    queueLines(*open[i], open[i], arrived);
+                    if (open[i]->received.size() <= (size_t)MAX_LINE) continue;
+                }
+                // Gone (or sending garbage): in-flight replies still hold it
+                open[i] = std::move(open[open.size() - 1]);
+                open.pop_back();
+            }
+            if (watched[1].revents & POLLIN) {
+                int fd = ::accept(listener, nullptr, nullptr);
+                if (fd != -1) {
+                    int on = 1;
+                    ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));   // fails harmlessly on Unix sockets
+                    open.push_back(std::make_shared<Connection>(fd));
+                }
+            }
+
+            if (arrived.size() > 0) {
+                {
+                    std::lock_guard<std::mutex> lock(requestMutex);
+                    for (int i = 0; i < arrived.size(); i++) requests.enqueue(std::move(arrived[i]));
+                }
+                if (arrived.size() > 1) {
+                    requestsQueued.notify_all();
+                } else {
+                    requestsQueued.notify_one();
+                }
+                arrived.clear();
+            }
+        }
+
+        // Answer what was queued, then stop
+        ::close(listener);
+        listener = -1;
+        if (!socketPath.empty()) ::unlink(socketPath.c_str());
+        shutdownWorkers();
+        return true;
+    }
+
+    // Make run() return; safe from a signal handler
+    void stop() {
+        stopping.store(true);
+        if (wake[1] != -1) {
+            char c = 0;
+            ssize_t ignored = ::write(wake[1], &c, 1);
+            (void)ignored;
+        }
+    }
+
+    long long getAnswered() const { return answered.load(); }
+    long long getBatches() const { return batches.load(); }
+};
+
+#endif
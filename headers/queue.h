@@ -2,67 +2,197 @@
 #define QUEUE_H
 
 #include <stdexcept>
+#include <new>
+#include <utility>
+#include "vector.h"
 
+// FIFO queue backed by a contiguous ring buffer.
+// Capacity is always a power of two so wrap-around is a mask, and the
+// buffer doubles when full, so enqueue is amortized O(1) with no per-item
+// allocation. Elements live in raw storage and are moved in and out.
 template <typename T>
 class Queue {
 private:
-    struct Node {
-        T data;
-        Node* next;
-        Node(T val) : data(val), next(nullptr) {}
-    };
-    
-    Node* front;
-    Node* rear;
+    T* buffer;
+    int capacity;
+    int head;   // index of the front element
     int size;
 
+    static T* allocate(int n) {
+        return static_cast<T*>(::operator new(sizeof(T) * n));
+    }
+
+    int slot(int offset) const {
+        return (head + offset) & (capacity - 1);
+    }
+
+    void resizeCapacity(int newCapacity) {
+        T* newBuffer = allocate(newCapacity);
+        for (int i = 0; i < size; i++) {
+            T& item = buffer[slot(i)];
+            new (&newBuffer[i]) T(std::move(item));
+            item.~T();
+        }
+        ::operator delete(buffer);
+        buffer = newBuffer;
+        capacity = newCapacity;
+        head = 0;
+    }
+
+    void ensureRoom(int extra) {
+        if (size + extra <= capacity) return;
+        int newCapacity = (capacity == 0) ? 8 : capacity;
+        while (newCapacity < size + extra) newCapacity *= 2;
+        resizeCapacity(newCapacity);
+    }
+
+    void release() {
+        clear();
+        ::operator delete(buffer);
+        buffer = nullptr;
+        capacity = 0;
+    }
+
 public:
-    Queue() : front(nullptr), rear(nullptr), size(0) {}
-    
+    Queue() : buffer(nullptr), capacity(0), head(0), size(0) {}
+
     ~Queue() {
-        clear();
+        release();
+    }
+
+    Queue(const Queue& other) : buffer(nullptr), capacity(0), head(0), size(0) {
+        ensureRoom(other.size);
+        for (int i = 0; i < other.size; i++) {
+            new (&buffer[i]) T(other.buffer[other.slot(i)]);
+            size++;
+        }
+    }
+
+    Queue& operator=(const Queue& other) {
+        if (this != &other) {
+            Queue copy(other);
+            *this = std::move(copy);
+        }
+        return *this;
+    }
+
+    Queue(Queue&& other) noexcept
+        : buffer(other.buffer), capacity(other.capacity), head(other.head), size(other.size) {
+        other.buffer = nullptr;
+        other.capacity = 0;
+        other.head = 0;
+        other.size = 0;
+    }
+
+    Queue& operator=(Queue&& other) noexcept {
+        if (this != &other) {
+            release();
+            buffer = other.buffer;
+            capacity = other.capacity;
+            head = other.head;
+            size = other.size;
+            other.buffer = nullptr;
+            other.capacity = 0;
+            other.head = 0;
+            other.size = 0;
+        }
+        return *this;
     }
-    
-    void enqueue(T val) {
-        Node* newNode = new Node(val);
-        if (isEmpty()) {
-            front = rear = newNode;
+
+    void enqueue(const T& val) {
+        if (size == capacity) {
+            // val may live inside this queue, copy it before the buffer moves
+            T copy(val);
+            ensureRoom(1);
+            new (&buffer[slot(size)]) T(std::move(copy));
         } else {
-            rear->next = newNode;
-            rear = newNode;
+            new (&buffer[slot(size)]) T(val);
         }
         size++;
     }
-    
+
+    void enqueue(T&& val) {
+        ensureRoom(1);
+        new (&buffer[slot(size)]) T(std::move(val));
+        size++;
+    }
+
+    // Append every element of [first, last) with at most one regrow
+    template <typename Iterator>
+    void enqueue_range(Iterator first, Iterator last) {
+        int count = 0;
+        for (Iterator it = first; it != last; ++it) count++;
+        ensureRoom(count);
+        for (; first != last; ++first) {
+            new (&buffer[slot(size)]) T(*first);
+            size++;
+        }
+    }
+
+    void enqueue_range(const Vector<T>& items) {
+        enqueue_range(items.begin(), items.end());
+    }
+
     T dequeue() {
         if (isEmpty()) throw std::runtime_error("Queue is empty");
-        Node* temp = front;
-        T data = front->data;
-        front = front->next;
-        if (!front) rear = nullptr;
-        delete temp;
+        T& item = buffer[head];
+        T data = std::move(item);
+        item.~T();
+        head = slot(1);
         size--;
         return data;
     }
-    
+
+    // Move up to maxItems elements (all of them when maxItems < 0) into out,
+    // in FIFO order. Returns how many were moved.
+    int drain(Vector<T>& out, int maxItems = -1) {
+        int count = (maxItems < 0 || maxItems > size) ? size : maxItems;
+        out.reserve(out.size() + count);
+        for (int i = 0; i < count; i++) {
+            T& item = buffer[head];
+            out.push_back(std::move(item));
+            item.~T();
+            head = slot(1);
+            size--;
+        }
+        return count;
+    }
+
     T peek() const {
         if (isEmpty()) throw std::runtime_error("Queue is empty");
-        return front->data;
+        return buffer[head];
+    }
+
+    // Reference to the front element, for callers that want to avoid a copy
+    T& front() {
+        if (isEmpty()) throw std::runtime_error("Queue is empty");
+        return buffer[head];
     }
-    
+
     bool isEmpty() const {
-        return front == nullptr;
+        return size == 0;
     }
-    
+
     int getSize() const {
         return size;
     }
-    
+
+    int getCapacity() const {
+        return capacity;
+    }
+
+    void reserve(int minCapacity) {
+        ensureRoom(minCapacity - size);
+    }
+
+    // Destroys the elements but keeps the buffer
     void clear() {
-        while (!isEmpty()) {
-            dequeue();
+        for (int i = 0; i < size; i++) {
+            buffer[slot(i)].~T();
         }
+        head = 0;
+        size = 0;
     }
 };
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,185 @@
+#ifndef REACHABILITY_H
+#define REACHABILITY_H
+
+#include <mutex>
+#include "Graph.hpp"
+#include "bitSet.h"
+#include "vector.h"
+
+// Static transitive closure of the timetable: which ports some sequence of
+// sailings leads to, ignoring dates and layovers. The ports of one
+// strongly connected component reach the same ports, so the closure is
+// kept once per component, as the set of ports that can reach it. One
+// pass of Tarjan's algorithm over the incoming legs builds it: a component
+// is finished only after every component it leads to, so its set is its
+// own ports OR-ed with theirs. That is O(V + E * V / 64) words.
+//
+// A search towards a target can drop every leg into a port outside
+// reaching(target), since nothing explored from there ever arrives. The
+// schedule-aware version of the question is LatestDeparture.
+class Reachability {
+public:
+    // Ports from which target can be reached, target included. Built on
+    // first use and kept until the timetable changes (Graph::getVersion);
+    // safe to call from the search worker and the UI thread at once.
+    static const BitSet& reaching(const Graph& graph, int target) {
+        static const BitSet none;
+        Cache& c = cache(graph);
+        std::lock_guard<std::mutex> lock(c.mutex);
+        if (c.graphVersion != graph.getVersion() || c.component.size() != graph.size) build(graph, c);
+        if (target < 0 || target >= graph.size) return none;
+        return c.reaching[c.component[target]];
+    }
+
+    // Some sequence of sailings leads from one port to the other
+    static bool canReach(const Graph& graph, int from, int to) {
+        return reaching(graph, to).test(from);
+    }
+
+    // A sailing from -> to was added (timetableFeed.h). Every port that
+    // reached from now also reaches whatever to reaches: a path over the
+    // new leg is an old path to from, the leg, and an old path on from
+    // the last time it is taken. The components may then no longer be
+    // strongly connected, but their sets stay exact. Cancellations leave
+    // the closure a superset, which prunes less but never wrongly. Call
+    // on a graph no search is reading.
+    static void legAdded(const Graph& graph, int from, int to) {
+        Cache& c = cache(graph);
+        std::lock_guard<std::mutex> lock(c.mutex);
+        if (c.graphVersion != graph.getVersion() || c.component.size() != graph.size) return;
+        if (c.reaching[c.component[to]].test(from)) return;
+
+        BitSet reachedFrom = c.reaching[c.component[from]];
+        for (int i = 0; i < c.reaching.size(); i++) {
+            if (c.reaching[i].test(to)) c.reaching[i] |= reachedFrom;
+        }
+    }
+
+private:
+    struct Cache {
+        unsigned long long graphVersion;
+        Vector<int> component;          // per port
+        Vector<BitSet> reaching;        // per component
+        mutable std::mutex mutex;
+
+        Cache() : graphVersion(0) {}
+
+        Cache(const Cache& other) : graphVersion(0) {
+            std::lock_guard<std::mutex> lock(other.mutex);
+            graphVersion = other.graphVersion;
+            component = other.component;
+            reaching = other.reaching;
+        }
+    };
+
+    // Tarjan's depth-first search, one frame per port on the path
+    struct Frame {
+        int port;
+        int nextLeg;
+    };
+
+    static Cache& cache(const Graph& graph) {
+        static const int key = 0;
+        return graph.derived.get<Cache>(&key);
+    }
+
+    static void build(const Graph& graph, Cache& c) {
+        int n = graph.size;
+        c.graphVersion = graph.getVersion();
+        c.component.clear();
+        c.component.resize(n);
+        c.reaching.clear();
+
+        // Incoming legs, one per pair of ports
+        Vector<Vector<int> > incoming;
+        incoming.resize(n);
+        Vector<int> seenFrom;
+        seenFrom.resize(n);
+        for (int i = 0; i < n; i++) seenFrom[i] = -1;
+        for (int u = 0; u < n; u++) {
+            for (const Route& route : graph.vertices[u].routes) {
+                int v = graph.findPort(route.dest.name);
+                if (v == -1 || seenFrom[v] == u) continue;
+                seenFrom[v] = u;
+                incoming[v].push_back(u);
+            }
+            for (int k = 0; k < graph.vertices[u].services.size(); k++) {
+                int v = graph.services[graph.vertices[u].services[k]].to;
+                if (seenFrom[v] == u) continue;
+                seenFrom[v] = u;
+                incoming[v].push_back(u);
+            }
+        }
+
+        Vector<int> index, low, stack;
+        Vector<bool> onStack;
+        Vector<Frame> frames;
+        Vector<int> mergedInto;     // per component, the last component OR-ed into
+        index.resize(n);
+        low.resize(n);
+        onStack.resize(n);
+        for (int i = 0; i < n; i++) {
+            index[i] = -1;
+            c.component[i] = -1;
+        }
+        int counter = 0;
+
+        for (int root = 0; root < n; root++) {
+            if (index[root] != -1) continue;
+            index[root] = low[root] = counter++;
+            stack.push_back(root);
+            onStack[root] = true;
+            frames.push_back(Frame{root, 0});
+
+            while (!frames.empty()) {
+                int v = frames.back().port;
+                if (frames.back().nextLeg < incoming[v].size()) {
+                    int w = incoming[v][frames.back().nextLeg++];
+                    if (index[w] == -1) {
+                        index[w] = low[w] = counter++;
+                        stack.push_back(w);
+                        onStack[w] = true;
+                        frames.push_back(Frame{w, 0});
+                    } else if (onStack[w] && index[w] < low[v]) {
+                        low[v] = index[w];
+                    }
+                    continue;
+                }
+
+                frames.pop_back();
+                if (!frames.empty()) {
+                    int parent = frames.back().port;
+                    if (low[v] < low[parent]) low[parent] = low[v];
+                }
+                if (low[v] != index[v]) continue;
+
+                // v roots a component: pop it, then take in the sets of
+                // the components its ports lead to
+                int id = c.reaching.size();
+                c.reaching.push_back(BitSet(n));
+                mergedInto.push_back(-1);
+                BitSet& set = c.reaching[id];
+                int first = stack.size();
+                do {
+                    first--;
+                    onStack[stack[first]] = false;
+                    c.component[stack[first]] = id;
+                    set.set(stack[first]);
+                } while (stack[first] != v);
+
+                for (int i = first; i < stack.size(); i++) {
+                    const Vector<int>& legs = incoming[stack[i]];
+                    for (int j = 0; j < legs.size(); j++) {
+                        int other = c.component[legs[j]];
+                        if (other == id || mergedInto[other] == id) continue;
+                        mergedInto[other] = id;
+                        set |= c.reaching[other];
+                    }
+                }
+                stack.resize(first);
+            }
+        }
+    }
+};
+
+#endif
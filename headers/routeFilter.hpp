@@ -7,43 +7,89 @@
 #include "linkedList.h"
 #include "timeUtils.h"
 #include "vector.h"
+#include "hashMap.h"
+#include "bitSet.h"
+#include "arena.h"
+#include "queryCache.h"
+#include "landmarks.h"
+#include "pathEnumerator.h"
 
 class RouteFilter {
 public:
+    // Preferences compiled once per query. An empty preference list means
+    // "anything goes" and is compiled to an all-ones mask, and the final
+    // destination is always an allowed stop, so the per-edge check is
+    // just two bit tests.
+    struct CompiledPreferences {
+        BitSet companies;   // by Route::companyId
+        BitSet ports;       // ports a leg may arrive at
+        
+        bool allows(const Route& route, int destIndex) const {
+            return companies.test(route.companyId) & ports.test(destIndex);
+        }
+        
+        // Lets the preferences be passed straight to the PathFinding searches
+        bool operator()(const Route& route, int destIndex) const {
+            return allows(route, destIndex);
+        }
+    };
+    
+    static CompiledPreferences compilePreferences(
+        const Graph& graph,
+        int destinationIndex,
+        const Vector<std::string>& preferredCompanies,
+        const Vector<int>& preferredLayoverPorts) {
+        CompiledPreferences prefs;
+        
+        prefs.companies.resize(graph.getCompanyCount(), preferredCompanies.empty());
+        for (const std::string& name : preferredCompanies) {
+            prefs.companies.set(graph.findCompany(name));  // unknown names are ignored
+        }
+        
+        prefs.ports.resize(graph.size, preferredLayoverPorts.empty());
+        for (int port : preferredLayoverPorts) {
+            prefs.ports.set(port);
+        }
+        prefs.ports.set(destinationIndex);
+        
+        return prefs;
+    }
+
     // Get all unique companies from the graph
     static Vector<std::string> getAllCompanies(const Graph& graph) {
         Vector<std::string> companyList;
+        HashSet<std::string> seen;
         
         for (int i = 0; i < graph.size; i++) {
-            LinkedList<Route>::Node* node = graph.vertices[i].routes.head;
-            while (node != nullptr) {
-                // Check if company already exists (manual linear search)
-                bool exists = false;
-                for (int j = 0; j < companyList.size(); j++) {
-                    if (companyList[j] == node->data.company) {
-                        exists = true;
-                        break;
-                    }
-                }
-                if (!exists) {
-                    companyList.push_back(node->data.company);
+            for (const Route& route : graph.vertices[i].routes) {
+                // Keep first-seen order for the UI list
+                if (seen.insert(route.company)) {
+                    companyList.push_back(route.company);
                 }
-                node = node->next;
+            }
+        }
+        for (int i = 0; i < graph.services.size(); i++) {
+            if (seen.insert(graph.services[i].pattern.company)) {
+                companyList.push_back(graph.services[i].pattern.company);
             }
         }
         
         return companyList;
     }
 
-    // Find all routes from origin to destination that match preferences
+    // Find routes from origin to destination that match preferences
     // preferredPorts: ports that can be used for layovers (intermediate stops)
     // preferredCompanies: companies that can be used for route segments
+    // The optimal constrained itineraries come first (cheapest, then fastest
+    // if it differs), followed by the other matching paths the BFS finds.
+    // The results and all search state live in arena; resetting it frees them.
     static Vector<PathFinding::PathResult*> findFilteredRoutes(
-        Graph& graph,
+        const Graph& graph,
         int originIndex,
         int destinationIndex,
         const Vector<int>& preferredPorts,
-        const Vector<std::string>& preferredCompanies) {
+        const Vector<std::string>& preferredCompanies,
+        Arena& arena) {
         
         Vector<PathFinding::PathResult*> filteredPaths;
         
@@ -52,187 +98,290 @@ public:
             return filteredPaths;
         }
         
-        // Use modified Dijkstra/BFS to find all valid paths
-        // We'll find multiple paths by exploring different routes
-        filteredPaths = findAllPathsWithPreferences(
-            graph, originIndex, destinationIndex, preferredCompanies, preferredPorts);
+        CompiledPreferences prefs = compilePreferences(
+            graph, destinationIndex, preferredCompanies, preferredPorts);
         
+        findBestConstrained(graph, originIndex, destinationIndex, prefs, arena, filteredPaths);
+        
+        // Alternatives cheapest first, skipping the ones already listed
+        bool complete;
+        Vector<PathFinding::PathResult*> others = findAllPathsWithPreferences(
+            graph, originIndex, destinationIndex, prefs, arena, complete);
+        for (PathFinding::PathResult* path : others) {
+            if (!isListed(filteredPaths, path)) filteredPaths.push_back(path);
+        }
+        
+        promoteBest(filteredPaths);
         return filteredPaths;
     }
-
-private:
-    // Find all paths from start to end using preferred companies and layover ports
-    static Vector<PathFinding::PathResult*> findAllPathsWithPreferences(
-        Graph& graph,
-        int startIndex,
-        int endIndex,
-        const Vector<std::string>& preferredCompanies,
-        const Vector<int>& preferredLayoverPorts) {
+    
+    // Keeps the results of the last preference query together with a
+    // signature per path (companies used, layover ports used). A preference
+    // change that only tightens the filter is answered by testing those
+    // signatures, as long as the BFS found every matching path (the work
+    // budget can cut it short). Relaxing past what was searched, a cut
+    // short BFS, or a timetable change since (a new Graph revision) runs
+    // the search again.
+    class CandidateSet {
+    public:
+        CandidateSet() : arena("preference filter"), originIndex(-1), destinationIndex(-1),
+                         revision(0), complete(false), searchCount(0) {}
         
-        Vector<PathFinding::PathResult*> allPaths;
+        CandidateSet(const CandidateSet&) = delete;
+        CandidateSet& operator=(const CandidateSet&) = delete;
         
-        // Use BFS to find multiple paths
-        // We'll limit to reasonable number of paths to avoid explosion
-        const int MAX_PATHS = 20;
-        const int MAX_DEPTH = 10; // Maximum number of stops
-        
-        // PathState structure for BFS
-        struct PathState {
-            int current;
-            Vector<int> path;
-            Vector<Route> routes;
-            int cost;
-            long long arrivalTime;
+        // Same ordering as findFilteredRoutes. keep is a result from the
+        // previous call; keepIndex receives its position in the new list, or
+        // -1 if it was filtered out or the candidates had to be searched again.
+        const Vector<PathFinding::PathResult*>& update(
+            const Graph& graph,
+            int origin,
+            int destination,
+            const Vector<int>& preferredPorts,
+            const Vector<std::string>& preferredCompanies,
+            const PathFinding::PathResult* keep,
+            int& keepIndex) {
+            keepIndex = -1;
+            visible.clear();
             
-            PathState() : current(-1), cost(0), arrivalTime(0) {}
-        };
-        
-        Vector<PathState> queue;
-        PathState initial;
-        initial.current = startIndex;
-        initial.path.push_back(startIndex);
-        initial.cost = 0;
-        initial.arrivalTime = 0;
-        queue.push_back(initial);
-        
-        while (queue.size() > 0 && allPaths.size() < MAX_PATHS) {
-            PathState state = queue[0];
-            queue.erase(0);
+            if (origin < 0 || destination < 0 || origin >= graph.size || destination >= graph.size) {
+                clear();
+                return visible;
+            }
             
-            // Check if we reached destination
-            if (state.current == endIndex && state.path.size() > 1) {
-                PathFinding::PathResult* result = new PathFinding::PathResult();
-                result->found = true;
-                
-                // Build path
-                for (int i = 0; i < state.path.size(); i++) {
-                    result->path.insertEnd(state.path[i]);
-                }
-                
-                // Build routes
-                for (int i = 0; i < state.routes.size(); i++) {
-                    result->routes.insertEnd(state.routes[i]);
-                }
-                
-                // Calculate costs and time
-                result->totalCost = state.cost;
-                
-                // Calculate total time
-                if (state.routes.size() > 0) {
-                    Route first = state.routes[0];
-                    Route last = state.routes[state.routes.size() - 1];
-                    
-                    long long startT = TimeUtils::toAbsoluteMinutes(first.date, first.deptTime);
-                    long long lastDep = TimeUtils::toAbsoluteMinutes(last.date, last.deptTime);
-                    long long lastArr = TimeUtils::toAbsoluteMinutes(last.date, last.arrTime);
-                    if (lastArr < lastDep) lastArr += 24 * 60;
-                    
-                    result->totalTime = (int)(lastArr - startT);
-                }
-                
-                allPaths.push_back(result);
-                continue;
+            CompiledPreferences prefs = compilePreferences(
+                graph, destination, preferredCompanies, preferredPorts);
+            
+            bool sameQuery = origin == originIndex && destination == destinationIndex &&
+                             graph.getRevision() == revision;
+            if (!sameQuery || !complete || !isWithin(prefs, searchedPrefs)) {
+                search(graph, origin, destination, prefs);
+                keep = nullptr;  // old results are gone with the arena
+            } else if (!leadersStillBest(prefs)) {
+                // The alternatives just get filtered, but the optimal
+                // itineraries have to be recomputed for the tighter filter
+                findLeaders(graph, prefs);
             }
             
-            // Limit depth
-            if (state.path.size() > MAX_DEPTH) continue;
+            for (const Candidate& leader : leaders) visible.push_back(leader.path);
+            int leaderCount = visible.size();
+            for (const Candidate& alt : alternatives) {
+                if (!alt.allowedBy(prefs) || isLeader(alt.path, leaderCount)) continue;
+                visible.push_back(alt.path);
+            }
+            // The leaders were optimal for the filter they were searched
+            // under only as far as the constrained searches are; the
+            // surviving alternatives get the same comparison as a fresh query
+            promoteBest(visible);
+            for (int i = 0; i < visible.size(); i++) {
+                if (visible[i] == keep) keepIndex = i;
+            }
+            return visible;
+        }
+        
+        // True when results for this origin/destination are being kept
+        bool isActiveFor(int origin, int destination) const {
+            return originIndex != -1 && origin == originIndex && destination == destinationIndex;
+        }
+        
+        // Number of full searches run (for checking the incremental path)
+        int getSearchCount() const { return searchCount; }
+        
+        void clear() {
+            leaders.clear();
+            alternatives.clear();
+            visible.clear();
+            arena.reset();
+            originIndex = destinationIndex = -1;
+        }
+        
+    private:
+        struct Candidate {
+            PathFinding::PathResult* path;
+            BitSet companies;   // companies of its legs
+            BitSet layovers;    // ports it stops at between origin and destination
             
-            // Explore neighbors
-            LinkedList<Route>::Node* routeNode = graph.vertices[state.current].routes.head;
-            while (routeNode != nullptr) {
-                Route& route = routeNode->data;
-                int destIndex = graph.findPort(route.dest.name);
-                
-                if (destIndex == -1) {
-                    routeNode = routeNode->next;
-                    continue;
-                }
-                
-                // Check if we've already visited this node in this path
-                bool alreadyVisited = false;
-                for (int i = 0; i < state.path.size(); i++) {
-                    if (state.path[i] == destIndex) {
-                        alreadyVisited = true;
-                        break;
-                    }
-                }
-                if (alreadyVisited) {
-                    routeNode = routeNode->next;
-                    continue;
-                }
-                
-                // Check company preference (linear search)
-                bool matchesCompany = (preferredCompanies.size() == 0);
-                if (!matchesCompany) {
-                    for (int i = 0; i < preferredCompanies.size(); i++) {
-                        if (preferredCompanies[i] == route.company) {
-                            matchesCompany = true;
-                            break;
-                        }
-                    }
-                }
-                if (!matchesCompany) {
-                    routeNode = routeNode->next;
-                    continue;
-                }
-                
-                // Check layover port preference (linear search)
-                // If destination is the final destination, allow it
-                // If destination is an intermediate stop, it must be in preferred layover ports
-                bool canUsePort = true;
-                if (destIndex != endIndex && preferredLayoverPorts.size() > 0) {
-                    canUsePort = false;
-                    for (int i = 0; i < preferredLayoverPorts.size(); i++) {
-                        if (preferredLayoverPorts[i] == destIndex) {
-                            canUsePort = true;
-                            break;
-                        }
-                    }
-                }
-                
-                if (!canUsePort) {
-                    routeNode = routeNode->next;
-                    continue;
-                }
-                
-                // Check timing constraints (must arrive 60 mins before departure)
-                long long depAbs = TimeUtils::toAbsoluteMinutes(route.date, route.deptTime);
-                long long arrAbs = TimeUtils::toAbsoluteMinutes(route.date, route.arrTime);
-                if (arrAbs < depAbs) arrAbs += 24 * 60;
-                
-                bool timeValid = true;
-                if (state.current != startIndex) {
-                    // Must arrive at least 60 minutes before departure
-                    if (state.arrivalTime > depAbs - 60) {
-                        timeValid = false;
-                    }
-                }
-                
-                if (timeValid) {
-                    PathState newState;
-                    newState.current = destIndex;
-                    // Deep copy vectors
-                    newState.path = state.path;
-                    newState.path.push_back(destIndex);
-                    newState.routes = state.routes;
-                    newState.routes.push_back(route);
-                    newState.cost = state.cost + route.cost;
-                    // Add layover fee if waiting > 12 hours
-                    if (state.current != startIndex) {
-                        long long layover = depAbs - state.arrivalTime;
-                        if (layover > 720) {
-                            newState.cost += graph.vertices[state.current].port.portCharge;
-                        }
-                    }
-                    newState.arrivalTime = arrAbs;
-                    
-                    queue.push_back(newState);
-                }
-                
-                routeNode = routeNode->next;
+            bool allowedBy(const CompiledPreferences& prefs) const {
+                return companies.isSubsetOf(prefs.companies) && layovers.isSubsetOf(prefs.ports);
+            }
+        };
+        
+        Arena arena;
+        int originIndex;
+        int destinationIndex;
+        unsigned long long revision;        // Graph revision the paths were found on
+        CompiledPreferences searchedPrefs;  // filter the alternatives were found under
+        bool complete;                      // alternatives hold every path searchedPrefs allows
+        CompiledPreferences leaderPrefs;    // filter the leaders are optimal for
+        Vector<Candidate> leaders;          // constrained cheapest, then fastest
+        Vector<Candidate> alternatives;     // BFS paths
+        Vector<PathFinding::PathResult*> visible;
+        int searchCount;
+        
+        bool isLeader(const PathFinding::PathResult* path, int leaderCount) const {
+            for (int i = 0; i < leaderCount; i++) {
+                if (PathFinding::sameLegs(visible[i], path)) return true;
+            }
+            return false;
+        }
+        
+        static bool isWithin(const CompiledPreferences& inner, const CompiledPreferences& outer) {
+            return inner.companies.isSubsetOf(outer.companies) && inner.ports.isSubsetOf(outer.ports);
+        }
+        
+        Candidate makeCandidate(const Graph& graph, PathFinding::PathResult* path) const {
+            Candidate c;
+            c.path = path;
+            c.companies.resize(graph.getCompanyCount());
+            c.layovers.resize(graph.size);
+            for (const Route& leg : path->routes) c.companies.set(leg.companyId);
+            for (int port : path->path) {
+                if (port != originIndex && port != destinationIndex) c.layovers.set(port);
+            }
+            return c;
+        }
+        
+        // A path that was the best the constrained searches found under a
+        // looser filter and still passes the new one is what they would
+        // find again; update() still checks it against the alternatives
+        bool leadersStillBest(const CompiledPreferences& prefs) const {
+            if (!isWithin(prefs, leaderPrefs)) return false;
+            for (const Candidate& leader : leaders) {
+                if (!leader.allowedBy(prefs)) return false;
+            }
+            return true;
+        }
+        
+        SearchQuery makeQuery(SearchQuery::Objective objective, const CompiledPreferences& prefs) const {
+            SearchQuery q(objective, originIndex, destinationIndex);
+            q.companies = prefs.companies;
+            q.ports = prefs.ports;
+            return q;
+        }
+        
+        void findLeaders(const Graph& graph, const CompiledPreferences& prefs) {
+            Vector<PathFinding::PathResult*> best;
+            SearchQuery q = makeQuery(SearchQuery::FILTER_LEADERS, prefs);
+            if (!SearchCache::lookup(q, graph, arena, best)) {
+                findBestConstrained(graph, originIndex, destinationIndex, prefs, arena, best);
+                SearchCache::store(q, graph, best, false);
             }
+            leaders.clear();
+            for (PathFinding::PathResult* path : best) leaders.push_back(makeCandidate(graph, path));
+            leaderPrefs = prefs;
         }
         
+        void search(const Graph& graph, int origin, int destination, const CompiledPreferences& prefs) {
+            leaders.clear();
+            alternatives.clear();
+            arena.reset();
+            originIndex = origin;
+            destinationIndex = destination;
+            revision = graph.getRevision();
+            searchedPrefs = prefs;
+            searchCount++;
+            
+            findLeaders(graph, prefs);
+            Vector<PathFinding::PathResult*> others;
+            SearchQuery q = makeQuery(SearchQuery::FILTER_ALTERNATIVES, prefs);
+            // A cached list does not say whether the BFS finished
+            complete = false;
+            if (!SearchCache::lookup(q, graph, arena, others)) {
+                others = findAllPathsWithPreferences(graph, origin, destination, prefs, arena, complete);
+                SearchCache::store(q, graph, others, false);
+            }
+            for (PathFinding::PathResult* path : others) {
+                alternatives.push_back(makeCandidate(graph, path));
+            }
+        }
+    };
+
+private:
+    // Constrained cheapest, then constrained fastest if its legs differ
+    static void findBestConstrained(const Graph& graph, int originIndex, int destinationIndex,
+                                    const CompiledPreferences& prefs, Arena& arena,
+                                    Vector<PathFinding::PathResult*>& out) {
+        // Bounds over the unfiltered graph stay admissible under any filter
+        PathFinding::PathResult* cheapest = nullptr;
+        PathFinding::PathResult* fastest = nullptr;
+        Landmarks::withBounds(graph, originIndex, destinationIndex, [&](const auto& toTarget) {
+            cheapest = adopt(PathFinding::findCheapestPath(
+                graph, originIndex, destinationIndex, prefs, toTarget), arena);
+            fastest = adopt(PathFinding::findShortestTimePath(
+                graph, originIndex, destinationIndex, prefs, toTarget), arena);
+        });
+        
+        if (cheapest) out.push_back(cheapest);
+        if (fastest && !(cheapest && PathFinding::sameLegs(cheapest, fastest))) {
+            out.push_back(fastest);
+        }
+    }
+    
+    // The constrained searches keep one label per port, so a cheaper (or
+    // quicker) itinerary that reaches a layover later than their label can
+    // be missed, while the enumeration lists it among the alternatives.
+    // Moves the cheapest and then the fastest of all paths to the front;
+    // ties keep the earlier one, so the search results lead when they are
+    // as good. The rest keep their order.
+    static void promoteBest(Vector<PathFinding::PathResult*>& paths) {
+        if (paths.size() < 2) return;
+        int cheapest = 0;
+        int fastest = 0;
+        for (int i = 1; i < paths.size(); i++) {
+            if (paths[i]->totalCost < paths[cheapest]->totalCost) cheapest = i;
+            if (paths[i]->totalTime < paths[fastest]->totalTime) fastest = i;
+        }
+        // A cheapest path that is also the quickest leads alone
+        if (paths[cheapest]->totalTime == paths[fastest]->totalTime) fastest = cheapest;
+        
+        Vector<PathFinding::PathResult*> ordered;
+        ordered.reserve(paths.size());
+        ordered.push_back(paths[cheapest]);
+        if (fastest != cheapest) ordered.push_back(paths[fastest]);
+        for (int i = 0; i < paths.size(); i++) {
+            if (i != cheapest && i != fastest) ordered.push_back(paths[i]);
+        }
+        paths = std::move(ordered);
+    }
+    
+    static bool isListed(const Vector<PathFinding::PathResult*>& paths,
+                         const PathFinding::PathResult* path) {
+        for (const PathFinding::PathResult* listed : paths) {
+            if (PathFinding::sameLegs(listed, path)) return true;
+        }
+        return false;
+    }
+    
+    // Move a heap result from PathFinding into arena. Returns nullptr (and
+    // frees it) when no path was found.
+    static PathFinding::PathResult* adopt(PathFinding::PathResult* result, Arena& arena) {
+        PathFinding::PathResult* owned = nullptr;
+        if (result->found) owned = arena.create<PathFinding::PathResult>(std::move(*result));
+        delete result;
+        return owned;
+    }
+    
+    // Find paths from start to end using preferred companies and layover
+    // ports, cheapest first. The work budget keeps the latency bounded (and
+    // the answer the same every time, so it can be cached). complete is set
+    // when no other path matches: the enumeration ran out before the budget
+    // or the result cap did.
+    static Vector<PathFinding::PathResult*> findAllPathsWithPreferences(
+        const Graph& graph,
+        int startIndex,
+        int endIndex,
+        const CompiledPreferences& prefs,
+        Arena& arena,
+        bool& complete) {
+        
+        Vector<PathFinding::PathResult*> allPaths;
+        
+        const int MAX_PATHS = 20;
+        const int MAX_EXPANSIONS = 20000;
+        
+        PathEnumerator<CompiledPreferences> paths(graph, startIndex, endIndex, prefs, "", 1, MAX_PATHS);
+        paths.run(SearchBudget(MAX_PATHS, MAX_EXPANSIONS), arena, allPaths);
+        complete = paths.isExhausted() && paths.getFound() < MAX_PATHS;
         return allPaths;
     }
 };
@@ -5,6 +5,10 @@
 #include <sstream>
 #include "Graph.hpp"
 #include "pathFinding.h"
+#include "queryCache.h"
+#include "reachability.h"
+#include "searchWorker.h"
+#include "timetableSnapshots.h"
 #include "uiHelpers.hpp"
 
 struct RouteFindingMenu {
@@ -31,6 +35,8 @@ struct RouteFindingMenu {
     int selectedOriginIndex;
     int selectedDestIndex;
     int listOffset;
+    SearchQuery pendingQuery;   // running on the search worker
+    TimetableSnapshots::Snapshot pendingGraph;     // the timetable it searches
     
     sf::Color btnNormal;
     sf::Color btnHover;
@@ -128,7 +134,7 @@ struct RouteFindingMenu {
         if (listOffset > maxOffset) listOffset = maxOffset;
     }
 
-    bool handleClick(Graph& graph, 
+    bool handleClick(const Graph& graph, 
                     const sf::Vector2f& mouseGlobal,
                     float panelX,
                     PathFinding::PathResult*& currentPathResult,
@@ -155,6 +161,7 @@ struct RouteFindingMenu {
                     else selectedDestIndex = i;
                     
                     selectingOrigin = selectingDest = false;
+                    SearchWorker::get().cancel(SearchWorker::ROUTE_FINDING);
                     if(currentPathResult) { 
                         delete currentPathResult; 
                         currentPathResult = nullptr; 
@@ -181,16 +188,12 @@ struct RouteFindingMenu {
         }
         else if (selectedOriginIndex != -1 && selectedDestIndex != -1) {
             if (subBtn1.getGlobalBounds().contains(mouseGlobal)) {
-                if(currentPathResult) delete currentPathResult;
-                currentPathResult = PathFinding::findShortestTimePath(
-                    graph, selectedOriginIndex, selectedDestIndex);
+                startSearch(graph, SearchQuery::FASTEST, currentPathResult);
                 resultTextString = "Optimization: FASTEST";
                 return true;
             }
             else if (subBtn2.getGlobalBounds().contains(mouseGlobal)) {
-                if(currentPathResult) delete currentPathResult;
-                currentPathResult = PathFinding::findCheapestPath(
-                    graph, selectedOriginIndex, selectedDestIndex);
+                startSearch(graph, SearchQuery::CHEAPEST, currentPathResult);
                 resultTextString = "Optimization: CHEAPEST";
                 return true;
             }
@@ -198,7 +201,50 @@ struct RouteFindingMenu {
         return false;
     }
 
+    // Answer from the cache straight away, else hand the search to the
+    // worker; update() picks the result up
+    void startSearch(const Graph& graph, SearchQuery::Objective objective,
+                     PathFinding::PathResult*& currentPathResult) {
+        if(currentPathResult) delete currentPathResult;
+        SearchQuery query(objective, selectedOriginIndex, selectedDestIndex);
+        // No sailings lead there at all: nothing to search
+        if (!Reachability::canReach(graph, selectedOriginIndex, selectedDestIndex)) {
+            currentPathResult = new PathFinding::PathResult();
+        } else {
+            currentPathResult = SearchCache::lookupPath(query, graph);
+        }
+        if (currentPathResult) {
+            SearchWorker::get().cancel(SearchWorker::ROUTE_FINDING);
+            return;
+        }
+
+        pendingQuery = query;
+        pendingGraph = TimetableSnapshots::keep(graph);
+        TimetableSnapshots::Snapshot searchGraph = pendingGraph;
+        SearchWorker::get().submit(SearchWorker::ROUTE_FINDING, [searchGraph, query](SearchJob& job) {
+            PathFinding::PathResult* result = SearchCache::computePath(query, *searchGraph, &job.control);
+            job.paths.push_back(job.arena.create<PathFinding::PathResult>(*result));
+            delete result;
+        });
+    }
+
+    // Called every frame: adopt a search the worker has finished
+    void update(PathFinding::PathResult*& currentPathResult) {
+        SearchJob* job = SearchWorker::get().take(SearchWorker::ROUTE_FINDING);
+        if (!job) return;
+        if (!job->failed && job->paths.size() == 1) {
+            if(currentPathResult) delete currentPathResult;
+            currentPathResult = new PathFinding::PathResult(*job->paths[0]);
+            // Stamped with the timetable it was found on, so it is not
+            // kept if that has since been replaced
+            SearchCache::storePath(pendingQuery, *pendingGraph, *currentPathResult);
+        }
+        pendingGraph.reset();
+        delete job;
+    }
+
     void reset() {
+        SearchWorker::get().cancel(SearchWorker::ROUTE_FINDING);
         selectingOrigin = selectingDest = false;
         selectedOriginIndex = selectedDestIndex = -1;
         listOffset = 0;
@@ -279,7 +325,11 @@ struct RouteFindingMenu {
             window.draw(resultHeader);
             
             std::stringstream ss;
-            if(currentPathResult && currentPathResult->found) {
+            if (SearchWorker::get().isBusy(SearchWorker::ROUTE_FINDING)) {
+                ss << resultTextString << "\n\n"
+                   << searchingText(SearchWorker::get().getProgress(SearchWorker::ROUTE_FINDING));
+            }
+            else if(currentPathResult && currentPathResult->found) {
                 ss << resultTextString << "\n\n";
                 ss << "Total Cost: $" << currentPathResult->totalCost << "\n";
                 int totalMins = currentPathResult->totalTime;
@@ -292,6 +342,11 @@ struct RouteFindingMenu {
             else if (currentPathResult && !currentPathResult->found) {
                 ss << "Route impossible.\nTry different ports.";
             }
+            else if (selectedOriginIndex != -1 && selectedDestIndex != -1 &&
+                     !Reachability::canReach(graph, selectedOriginIndex, selectedDestIndex)) {
+                ss << "No sailings lead from\n" << graph.vertices[selectedOriginIndex].port.name
+                   << " to " << graph.vertices[selectedDestIndex].port.name << ".";
+            }
             else {
                 ss << "Select Origin and \nDestination above\nto see details.";
             }
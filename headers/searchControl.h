@@ -0,0 +1,24 @@
+#ifndef SEARCHCONTROL_H
+#define SEARCHCONTROL_H
+
+#include <atomic>
+
+// What a running search sees of its job (searchWorker.h): whether the UI
+// has moved on, and a work counter the UI shows as progress. Long searches
+// should check isCancelled() in their main loop and return early.
+class SearchControl {
+private:
+    std::atomic<bool> cancelled;
+    std::atomic<int> progress;
+
+public:
+    SearchControl() : cancelled(false), progress(0) {}
+
+    bool isCancelled() const { return cancelled.load(std::memory_order_relaxed); }
+    void cancel() { cancelled.store(true, std::memory_order_relaxed); }
+
+    void step(int units = 1) { progress.fetch_add(units, std::memory_order_relaxed); }
+    int getProgress() const { return progress.load(std::memory_order_relaxed); }
+};
+
+#endif
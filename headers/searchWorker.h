@@ -0,0 +1,202 @@
+#ifndef SEARCHWORKER_H
+#define SEARCHWORKER_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include "pathFinding.h"
+#include "arena.h"
+#include "searchControl.h"
+#include "spscQueue.h"
+#include "vector.h"
+
+// One query for the worker. run() executes on the worker thread and
+// leaves its results in paths (allocated from arena); everything else the
+// job needs is captured by value when it is submitted.
+struct SearchJob {
+    int channel;
+    std::function<void(SearchJob&)> run;
+    SearchControl control;
+    Arena arena{"search job"};
+    Vector<PathFinding::PathResult*> paths;
+    bool failed;    // run() threw; paths are incomplete
+
+    SearchJob(int ch, std::function<void(SearchJob&)> fn)
+        : channel(ch), run(std::move(fn)), failed(false) {}
+};
+
+// Background thread for the searches the menus start, so the frame loop
+// keeps drawing while they run. Jobs go to the worker and come back
+// through two SpscQueues, so neither side ever waits on a lock to hand one
+// over; the worker only blocks on a condition variable while it is idle.
+//
+// Each UI feature submits on its own channel. A new job on a channel
+// cancels the one still in flight there, whose results are dropped when
+// it comes back. Everything except run() is called from the UI thread.
+//
+// Jobs read the Graph and the precomputed tables but not the result cache
+// or the bookings: look those up before submitting and apply them to the
+// finished job.
+class SearchWorker {
+public:
+    enum Channel {
+        ROUTE_FINDING,      // RouteFindingMenu cheapest/fastest
+        BOOKING_CONNECTED,  // BookingMenu connected paths
+        MULTI_LEG,          // MultiLegJourneyMenu track
+        CHANNEL_COUNT
+    };
+
+    static SearchWorker& get() {
+        static SearchWorker worker;
+        return worker;
+    }
+
+    ~SearchWorker() {
+        shutdown();
+    }
+
+    SearchWorker(const SearchWorker&) = delete;
+    SearchWorker& operator=(const SearchWorker&) = delete;
+
+    // Queue run on channel, superseding whatever the channel had in flight
+    void submit(int channel, std::function<void(SearchJob&)> run) {
+        cancel(channel);
+        SearchJob* job = new SearchJob(channel, std::move(run));
+        if (!thread.joinable() && !stopping) thread = std::thread(&SearchWorker::loop, this);
+
+        if (stopping || !requests.tryEnqueue(job)) {
+            // No worker or a full queue: answer on this thread instead
+            execute(job);
+            finished[channel] = job;
+            return;
+        }
+        pending[channel] = job;
+        {
+            std::lock_guard<std::mutex> lock(wakeMutex);
+        }
+        wakeup.notify_one();
+    }
+
+    // Collect jobs the worker has finished. Call once per frame; never blocks.
+    void update() {
+        SearchJob* job;
+        while (results.tryDequeue(job)) {
+            int channel = job->channel;
+            if (pending[channel] == job) {
+                pending[channel] = nullptr;
+                delete finished[channel];
+                finished[channel] = job;
+            } else {
+                delete job;     // superseded or cancelled
+            }
+        }
+    }
+
+    // The finished job on channel, or nullptr. The caller deletes it.
+    SearchJob* take(int channel) {
+        SearchJob* job = finished[channel];
+        finished[channel] = nullptr;
+        return job;
+    }
+
+    bool isBusy(int channel) const { return pending[channel] != nullptr; }
+
+    bool isBusy() const {
+        for (int i = 0; i < CHANNEL_COUNT; i++) {
+            if (pending[i]) return true;
+        }
+        return false;
+    }
+
+    // Work done so far by the job in flight on channel (0 when idle)
+    int getProgress(int channel) const {
+        return pending[channel] ? pending[channel]->control.getProgress() : 0;
+    }
+
+    // Drop channel's job in flight and any finished one not yet taken
+    void cancel(int channel) {
+        if (pending[channel]) {
+            pending[channel]->control.cancel();
+            pending[channel] = nullptr;
+        }
+        delete finished[channel];
+        finished[channel] = nullptr;
+    }
+
+    // Cancel everything and stop the thread. Call before the graph and the
+    // search tables go away; get() stays usable and answers inline after.
+    void shutdown() {
+        for (int i = 0; i < CHANNEL_COUNT; i++) cancel(i);
+        stopping = true;
+        {
+            std::lock_guard<std::mutex> lock(wakeMutex);
+        }
+        wakeup.notify_one();
+
+        // Keep draining so the worker never waits on a full results queue
+        SearchJob* job;
+        if (thread.joinable()) {
+            while (!exited) {
+                while (results.tryDequeue(job)) delete job;
+                std::this_thread::yield();
+            }
+            thread.join();
+        }
+        while (results.tryDequeue(job)) delete job;
+        while (requests.tryDequeue(job)) delete job;
+    }
+
+private:
+    SpscQueue<SearchJob*> requests;     // UI -> worker
+    SpscQueue<SearchJob*> results;      // worker -> UI
+    SearchJob* pending[CHANNEL_COUNT];
+    SearchJob* finished[CHANNEL_COUNT];
+
+    std::thread thread;
+    std::atomic<bool> stopping;
+    std::atomic<bool> exited;
+    std::mutex wakeMutex;
+    std::condition_variable wakeup;
+
+    SearchWorker() : requests(64), results(64), stopping(false), exited(false) {
+        for (int i = 0; i < CHANNEL_COUNT; i++) {
+            pending[i] = nullptr;
+            finished[i] = nullptr;
+        }
+    }
+
+    static void execute(SearchJob* job) {
+        if (job->control.isCancelled()) return;
+        try {
+            job->run(*job);
+        } catch (const std::exception&) {
+            job->failed = true;
+        }
+    }
+
+    void loop() {
+        while (true) {
+            SearchJob* job;
+            if (requests.tryDequeue(job)) {
+                execute(job);
+                // The UI drains results every frame
+                while (!results.tryEnqueue(job)) std::this_thread::yield();
+                continue;
+            }
+            if (stopping) {
+                exited = true;
+                return;
+            }
+
+            std::unique_lock<std::mutex> lock(wakeMutex);
+            wakeup.wait_for(lock, std::chrono::milliseconds(100),
+                            [this] { return stopping.load() || !requests.isEmpty(); });
+        }
+    }
+};
+
+#endif
@@ -0,0 +1,161 @@
+#ifndef SERVICE_H
+#define SERVICE_H
+
+#include <string>
+#include "Route.h"
+#include "timeUtils.h"
+#include "vector.h"
+
+// Which days a weekly sailing runs and when, over exception dates kept
+// elsewhere, so the same arithmetic serves a Service and the copies in a
+// shared segment (sharedTimetable.h). Days are civil days
+// (TimeUtils::civilDay); times are the searches' absolute minutes
+// (TimeUtils::toAbsoluteMinutes).
+struct ServiceCalendar {
+    unsigned char weekdays;     // bit 0 Monday ... bit 6 Sunday
+    int firstDay;
+    int lastDay;
+    const int* exceptions;      // days it does not run, sorted
+    int exceptionCount;
+    int departureMinute;        // minutes after midnight
+    int duration;               // minutes, overnight arrivals rolled as for dated routes
+
+    bool runsOn(int day) const {
+        if (day < firstDay || day > lastDay) return false;
+        if (!((weekdays >> TimeUtils::weekday(day)) & 1)) return false;
+        return !isException(day);
+    }
+
+    // First day it runs on or after day, -1 if none
+    int nextRun(int day) const {
+        if (day < firstDay) day = firstDay;
+        for (; day <= lastDay; day++) {
+            if (runsOn(day)) return day;
+        }
+        return -1;
+    }
+
+    // Last day it runs on or before day, -1 if none
+    int previousRun(int day) const {
+        if (day > lastDay) day = lastDay;
+        for (; day >= firstDay; day--) {
+            if (runsOn(day)) return day;
+        }
+        return -1;
+    }
+
+    long long departureOn(int day) const {
+        return (long long)TimeUtils::roughDay(day) * 24 * 60 + departureMinute;
+    }
+
+    long long arrivalOn(int day) const { return departureOn(day) + duration; }
+
+    // First run departing at or after time, -1 if none
+    int firstDepartingFrom(long long time) const {
+        // Departures never decrease with the day, so binary search for
+        // the first day late enough, then step to a running one
+        int lo = firstDay, hi = lastDay + 1;
+        while (lo < hi) {
+            int mid = lo + (hi - lo) / 2;
+            if (departureOn(mid) < time) lo = mid + 1;
+            else hi = mid;
+        }
+        return nextRun(lo);
+    }
+
+    // Last run arriving at or before time, -1 if none
+    int lastArrivingBy(long long time) const {
+        int lo = firstDay - 1, hi = lastDay;
+        while (lo < hi) {
+            int mid = hi - (hi - lo) / 2;
+            if (arrivalOn(mid) <= time) lo = mid;
+            else hi = mid - 1;
+        }
+        return lo < firstDay ? -1 : previousRun(lo);
+    }
+
+private:
+    bool isException(int day) const {
+        int lo = 0, hi = exceptionCount;
+        while (lo < hi) {
+            int mid = lo + (hi - lo) / 2;
+            if (exceptions[mid] < day) lo = mid + 1;
+            else hi = mid;
+        }
+        return lo < exceptionCount && exceptions[lo] == day;
+    }
+};
+
+// A sailing that repeats every week: from -> to at the same clock times,
+// on the weekdays in a mask, between two dates, except on listed dates.
+// One Service stands for all of its occurrences; the searches work out
+// the ones they need (by departure or by arrival) instead of the timetable
+// keeping a dated Route per run, so a year-long service costs what a
+// one-week one does.
+struct Service {
+    static const int WEEK = 7;
+
+    int from;
+    int to;
+    Route pattern;              // every field but the date
+    unsigned char weekdays;     // bit 0 Monday ... bit 6 Sunday
+    int firstDay;
+    int lastDay;
+    Vector<int> exceptions;     // days it does not run, sorted
+    int departureMinute;        // minutes after midnight
+    int duration;               // minutes, overnight arrivals rolled as for dated routes
+
+    Service() : from(-1), to(-1), weekdays(0), firstDay(0), lastDay(-1), departureMinute(0), duration(0) {}
+
+    ServiceCalendar calendar() const {
+        return ServiceCalendar{weekdays, firstDay, lastDay, exceptions.begin(), exceptions.size(),
+                               departureMinute, duration};
+    }
+
+    bool runsOn(int day) const { return calendar().runsOn(day); }
+    int nextRun(int day) const { return calendar().nextRun(day); }
+    int previousRun(int day) const { return calendar().previousRun(day); }
+    long long departureOn(int day) const { return calendar().departureOn(day); }
+    long long arrivalOn(int day) const { return calendar().arrivalOn(day); }
+    int firstDepartingFrom(long long time) const { return calendar().firstDepartingFrom(time); }
+    int lastArrivingBy(long long time) const { return calendar().lastArrivingBy(time); }
+
+    // The run on day as a dated Route
+    Route on(int day) const {
+        Route route = pattern;
+        route.date = TimeUtils::civilDate(day);
+        return route;
+    }
+
+    // Weekday mask from "Mon,Wed,Fri", "Daily" or seven 0/1 flags from
+    // Monday ("1010100"); 0 if it cannot be read
+    static unsigned char parseWeekdays(const std::string& text) {
+        static const char* names[WEEK] = { "Mon", "Tue", "Wed", "Thu", "Fri", "Sat", "Sun" };
+        if (text == "Daily") return 0x7f;
+        if (text.size() == WEEK && text.find_first_not_of("01") == std::string::npos) {
+            unsigned char mask = 0;
+            for (int i = 0; i < WEEK; i++) {
+                if (text[i] == '1') mask |= 1 << i;
+            }
+            return mask;
+        }
+
+        unsigned char mask = 0;
+        size_t start = 0;
+        while (start <= text.size()) {
+            size_t end = text.find(',', start);
+            if (end == std::string::npos) end = text.size();
+            std::string name = text.substr(start, end - start);
+            int day = -1;
+            for (int i = 0; i < WEEK; i++) {
+                if (name == names[i]) day = i;
+            }
+            if (day == -1) return 0;
+            mask |= 1 << day;
+            start = end + 1;
+        }
+        return mask;
+    }
+};
+
+#endif
@@ -0,0 +1,631 @@
+#ifndef SHAREDTIMETABLE_H
+#define SHAREDTIMETABLE_H
+
+#include <atomic>
+#include <limits.h>
+#include <string.h>
+#include <string>
+#include "Graph.hpp"
+#include "pathFinding.h"
+#include "priorityQueue.h"
+#include "service.h"
+#include "sorting.h"
+#include "timeUtils.h"
+#include "vector.h"
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// A timetable laid out flat in one POSIX shared-memory segment, so every
+// query process on a host can map the same read-only copy instead of
+// loading its own Graph. Nothing in it is a pointer: records refer to
+// each other by index and to their text by offset into a string pool,
+// and every table is found by its offset from the start of the segment,
+// so each process can map it at any address.
+//
+// publish() writes a Graph into a named segment; attach() maps one and
+// answers cheapest and fastest queries on it directly, as PathFinding
+// does on a Graph, building Routes only for the legs of the answer.
+// Publishing under a name that is in use replaces the segment for the
+// processes that attach later; those attached keep the old one until
+// they detach.
+//
+// Layout: Header, then the tables it lists, each 8-byte aligned:
+//   ports          PortRecord per port, in load order
+//   portsByName    port indices sorted by name (findPort)
+//   sailingStart   per port, its first sailing; [port + 1] ends the group
+//   sailings       SailingRecord per dated sailing, grouped by departure
+//                  port, each group in timetable order
+//   departures     sailing indices, the same groups by increasing departure
+//   serviceStart   per port, its first entry in servicesFrom
+//   servicesFrom   service indices, grouped by departure port
+//   services       ServiceRecord per weekly service
+//   exceptions     the services' exception days, each service's sorted
+//   strings        names, dates and times, not terminated
+class SharedTimetable {
+public:
+    static const unsigned int SEGMENT_MAGIC = 0x53544f4fu;     // "OOTS"
+    static const unsigned int SEGMENT_VERSION = 1;
+
+    // Write graph into the segment name ("/oceanroute"); false on failure
+    static bool publish(const Graph& graph, const std::string& name) {
+#ifdef _WIN32
+        (void)graph; (void)name;
+        return false;
+#else
+        Header layout;
+        plan(graph, layout);
+
+        shm_unlink(name.c_str());
+        int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+        if (fd == -1) return false;
+        void* base = MAP_FAILED;
+        if (ftruncate(fd, (off_t)layout.bytes) == 0) {
+            base = mmap(nullptr, (size_t)layout.bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        }
+        close(fd);
+        if (base == MAP_FAILED) {
+            shm_unlink(name.c_str());
+            return false;
+        }
+        write(graph, layout, (char*)base);
+        munmap(base, (size_t)layout.bytes);
+        return true;
+#endif
+    }
+
+    // Remove the segment name; attached processes keep their mapping
+    static void unpublish(const std::string& name) {
+#ifndef _WIN32
+        shm_unlink(name.c_str());
+#else
+        (void)name;
+#endif
+    }
+
+    SharedTimetable() : base(nullptr), bytes(0), header(nullptr) {}
+
+    ~SharedTimetable() {
+        detach();
+    }
+
+    SharedTimetable(const SharedTimetable&) = delete;
+    SharedTimetable& operator=(const SharedTimetable&) = delete;
+
+    // Map the segment name read-only; false if there is none or it is not
+    // a complete segment of this version
+    bool attach(const std::string& name) {
+        detach();
+#ifdef _WIN32
+        (void)name;
+        return false;
+#else
+        int fd = shm_open(name.c_str(), O_RDONLY, 0);
+        if (fd == -1) return false;
+        struct stat info;
+        void* mapped = MAP_FAILED;
+        if (fstat(fd, &info) == 0 && (size_t)info.st_size >= sizeof(Header)) {
+            mapped = mmap(nullptr, (size_t)info.st_size, PROT_READ, MAP_SHARED, fd, 0);
+        }
+        close(fd);
+        if (mapped == MAP_FAILED) return false;
+
+        base = (const char*)mapped;
+        bytes = (size_t)info.st_size;
+        header = (const Header*)base;
+        // The magic is written last: without it the writer is not done
+        bool complete = (header->magic == SEGMENT_MAGIC);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (!complete || header->version != SEGMENT_VERSION || header->bytes != bytes) {
+            detach();
+            return false;
+        }
+        return true;
+#endif
+    }
+
+    void detach() {
+#ifndef _WIN32
+        if (base) munmap((void*)base, bytes);
+#endif
+        base = nullptr;
+        bytes = 0;
+        header = nullptr;
+    }
+
+    bool isAttached() const { return base != nullptr; }
+    size_t getBytes() const { return bytes; }
+
+    // Graph::fingerprint of the timetable it was written from
+    unsigned long long fingerprint() const { return header->fingerprint; }
+
+    int getPortCount() const { return header->portCount; }
+    int getSailingCount() const { return header->sailingCount; }
+    int getServiceCount() const { return header->serviceCount; }
+
+    std::string getPortName(int port) const { return text(ports()[port].name); }
+    int getPortCharge(int port) const { return ports()[port].charge; }
+
+    // Index of the port called name, -1 if none
+    int findPort(const std::string& name) const {
+        const int* byName = table<int>(header->portsByName);
+        int lo = 0, hi = header->portCount;
+        while (lo < hi) {
+            int mid = lo + (hi - lo) / 2;
+            if (compare(ports()[byName[mid]].name, name) < 0) lo = mid + 1;
+            else hi = mid;
+        }
+        if (lo < header->portCount && compare(ports()[byName[lo]].name, name) == 0) return byName[lo];
+        return -1;
+    }
+
+    // Same contract as PathFinding::findCheapestPath (caller owns the result)
+    PathFinding::PathResult* findCheapestPath(int startIndex, int endIndex) const {
+        PathFinding::PathResult* result = new PathFinding::PathResult();
+        int n = header->portCount;
+        if (startIndex < 0 || endIndex < 0 || startIndex >= n || endIndex >= n) return result;
+
+        Labels labels(n);
+        Vector<long long> arrivals;
+        arrivals.resize(n);
+        for (int i = 0; i < n; i++) {
+            labels.value[i] = LLONG_MAX;
+            arrivals[i] = -1;
+        }
+        labels.value[startIndex] = 0;
+        arrivals[startIndex] = 0;
+
+        const int* start = table<int>(header->sailingStart);
+        const int* departures = table<int>(header->departures);
+        const SailingRecord* sailings = table<SailingRecord>(header->sailings);
+
+        PriorityQueue<int> pq;
+        pq.push(startIndex, 0);
+        while (!pq.isEmpty()) {
+            int current = pq.pop();
+            if (labels.visited[current]) continue;
+            labels.visited[current] = true;
+            result->nodesSettled++;
+            if (current == endIndex) break;
+
+            bool atOrigin = (current == startIndex);
+            int charge = ports()[current].charge;
+            auto relax = [&](int to, long long departure, long long arrival, int legCost, const Leg& leg) {
+                if (labels.visited[to]) return;
+                int newCost = PathFinding::cheapestLegCost(departure, legCost, charge, atOrigin,
+                                                           (int)labels.value[current], arrivals[current]);
+                if (newCost != INT_MAX && newCost < labels.value[to]) {
+                    labels.value[to] = newCost;
+                    labels.parent[to] = current;
+                    labels.leg[to] = leg;
+                    arrivals[to] = arrival;
+                    pq.push(to, newCost);
+                }
+            };
+
+            // Sailings leaving within the hour after arrival cannot be made
+            long long earliest = atOrigin ? LLONG_MIN : arrivals[current] + 60;
+            for (int i = firstFrom(current, earliest); i < start[current + 1]; i++) {
+                const SailingRecord& s = sailings[departures[i]];
+                relax(s.to, s.departure, s.arrival, s.cost, Leg{departures[i], -1, 0});
+            }
+            forEachService(current, [&](int service, const ServiceRecord& s) {
+                int day = calendar(s).firstDepartingFrom(earliest);
+                if (day < 0) return;
+                long long departure = calendar(s).departureOn(day);
+                relax(s.to, departure, departure + s.duration, s.cost, Leg{-1, service, day});
+            });
+        }
+
+        if (labels.value[endIndex] != LLONG_MAX) {
+            labels.walk(*this, result, startIndex, endIndex);
+            PathFinding::finishCheapest(result, (int)labels.value[endIndex]);
+        }
+        return result;
+    }
+
+    // Same contract as PathFinding::findShortestTimePath
+    PathFinding::PathResult* findShortestTimePath(int startIndex, int endIndex) const {
+        PathFinding::PathResult* result = new PathFinding::PathResult();
+        int n = header->portCount;
+        if (startIndex < 0 || endIndex < 0 || startIndex >= n || endIndex >= n) return result;
+
+        Labels labels(n);
+        Vector<long long> parentDepartures;    // departure of the leg into each port
+        parentDepartures.resize(n);
+        for (int i = 0; i < n; i++) {
+            labels.value[i] = LLONG_MAX;
+            parentDepartures[i] = -1;
+        }
+        labels.value[startIndex] = 0;
+
+        const int* start = table<int>(header->sailingStart);
+        const int* departures = table<int>(header->departures);
+        const SailingRecord* sailings = table<SailingRecord>(header->sailings);
+
+        PriorityQueue<int, long long> pq;
+        pq.push(startIndex, 0);
+        while (!pq.isEmpty()) {
+            int current = pq.pop();
+            if (labels.visited[current]) continue;
+            labels.visited[current] = true;
+            result->nodesSettled++;
+            if (current == endIndex) break;
+
+            bool atOrigin = (current == startIndex);
+            auto relax = [&](int to, long long departure, long long arrival, const Leg& leg) {
+                if (labels.visited[to]) return;
+                long long newTime = PathFinding::fastestLegTime(departure, arrival, atOrigin, labels.value[current],
+                                                                parentDepartures[current]);
+                if (newTime != LLONG_MAX && newTime < labels.value[to]) {
+                    labels.value[to] = newTime;
+                    labels.parent[to] = current;
+                    labels.leg[to] = leg;
+                    parentDepartures[to] = departure;
+                    pq.push(to, newTime);
+                }
+            };
+
+            // Sailings leaving within the hour after arrival cannot be made
+            long long earliest = atOrigin ? LLONG_MIN : labels.value[current] + 60;
+            for (int i = firstFrom(current, earliest); i < start[current + 1]; i++) {
+                const SailingRecord& s = sailings[departures[i]];
+                relax(s.to, s.departure, s.arrival, Leg{departures[i], -1, 0});
+            }
+            forEachService(current, [&](int service, const ServiceRecord& s) {
+                long long from = earliest;
+                if (!atOrigin && parentDepartures[current] - s.duration > from) {
+                    from = parentDepartures[current] - s.duration;
+                }
+                int day = calendar(s).firstDepartingFrom(from);
+                if (day < 0) return;
+                long long departure = calendar(s).departureOn(day);
+                relax(s.to, departure, departure + s.duration, Leg{-1, service, day});
+            });
+        }
+
+        if (labels.value[endIndex] != LLONG_MAX) {
+            labels.walk(*this, result, startIndex, endIndex);
+            PathFinding::finishFastest(result, [&](const Route& leg) { return leg.dest.portCharge; });
+        }
+        return result;
+    }
+
+private:
+    // Offset of a table from the start of the segment, and its length
+    struct Span {
+        unsigned long long offset;
+        long long count;
+    };
+
+    // Offset into the string pool, and length
+    struct Text {
+        unsigned int offset;
+        unsigned int length;
+    };
+
+    struct Header {
+        unsigned int magic;
+        unsigned int version;
+        unsigned long long fingerprint;
+        unsigned long long bytes;
+        int portCount;
+        int sailingCount;
+        int serviceCount;
+        int exceptionCount;
+        Span ports, portsByName, sailingStart, sailings, departures;
+        Span serviceStart, servicesFrom, services, exceptions, strings;
+    };
+
+    struct PortRecord {
+        Text name;
+        int charge;
+    };
+
+    struct SailingRecord {
+        int from;
+        int to;
+        long long departure;        // absolute minutes (TimeUtils)
+        long long arrival;          // rolled to the next day when earlier than departure
+        int cost;
+        int companyId;
+        Text date, deptTime, arrTime, company;
+    };
+
+    struct ServiceRecord {
+        int from;
+        int to;
+        int cost;
+        int companyId;
+        int weekdays;
+        int firstDay;
+        int lastDay;
+        int departureMinute;
+        int duration;
+        int exceptionsBegin;        // into exceptions
+        int exceptionCount;
+        Text deptTime, arrTime, company;
+    };
+
+    // The leg a search arrived at a port by: a dated sailing, or a run of
+    // a weekly service on day
+    struct Leg {
+        int sailing;
+        int service;
+        int day;
+    };
+
+    // Per-port labels of one search
+    struct Labels {
+        Vector<long long> value;
+        Vector<int> parent;
+        Vector<Leg> leg;
+        Vector<char> visited;
+
+        explicit Labels(int n) {
+            value.resize(n);
+            parent.resize(n);
+            leg.resize(n);
+            visited.resize(n);
+            for (int i = 0; i < n; i++) {
+                parent[i] = -1;
+                visited[i] = false;
+            }
+        }
+
+        // Path and routes from startIndex to endIndex in travel order
+        void walk(const SharedTimetable& timetable, PathFinding::PathResult* result, int startIndex,
+                  int endIndex) const {
+            PathFinding::reserveLegs(result, parent, startIndex, endIndex);
+            int current = endIndex;
+            while (current != startIndex && current != -1) {
+                result->path.insertFront(current);
+                if (parent[current] != -1) result->routes.insertFront(timetable.routeOf(leg[current]));
+                current = parent[current];
+            }
+            result->path.insertFront(startIndex);
+        }
+    };
+
+    const char* base;
+    size_t bytes;
+    const Header* header;
+
+    template <typename T>
+    const T* table(const Span& span) const {
+        return (const T*)(base + span.offset);
+    }
+
+    const PortRecord* ports() const { return table<PortRecord>(header->ports); }
+
+    std::string text(const Text& t) const {
+        return std::string(table<char>(header->strings) + t.offset, t.length);
+    }
+
+    int compare(const Text& t, const std::string& s) const {
+        const char* chars = table<char>(header->strings) + t.offset;
+        size_t shared = (t.length < s.size()) ? t.length : s.size();
+        int c = memcmp(chars, s.data(), shared);
+        if (c != 0) return c;
+        return (t.length < s.size()) ? -1 : (t.length > s.size()) ? 1 : 0;
+    }
+
+    ServiceCalendar calendar(const ServiceRecord& s) const {
+        const int* days = table<int>(header->exceptions) + s.exceptionsBegin;
+        return ServiceCalendar{(unsigned char)s.weekdays, s.firstDay, s.lastDay, days, s.exceptionCount,
+                               s.departureMinute, s.duration};
+    }
+
+    // First of port's sailings by departure leaving at or after time
+    int firstFrom(int port, long long time) const {
+        const int* start = table<int>(header->sailingStart);
+        const int* departures = table<int>(header->departures);
+        const SailingRecord* sailings = table<SailingRecord>(header->sailings);
+        int lo = start[port], hi = start[port + 1];
+        while (lo < hi) {
+            int mid = lo + (hi - lo) / 2;
+            if (sailings[departures[mid]].departure < time) lo = mid + 1;
+            else hi = mid;
+        }
+        return lo;
+    }
+
+    template <typename Visit>
+    void forEachService(int port, Visit visit) const {
+        const int* start = table<int>(header->serviceStart);
+        const int* from = table<int>(header->servicesFrom);
+        const ServiceRecord* services = table<ServiceRecord>(header->services);
+        for (int i = start[port]; i < start[port + 1]; i++) visit(from[i], services[from[i]]);
+    }
+
+    Route routeOf(const Leg& leg) const {
+        Route route;
+        if (leg.sailing >= 0) {
+            const SailingRecord& s = table<SailingRecord>(header->sailings)[leg.sailing];
+            fillRoute(route, s.from, s.to, s.cost, s.companyId, s.deptTime, s.arrTime, s.company);
+            route.date = text(s.date);
+        } else {
+            const ServiceRecord& s = table<ServiceRecord>(header->services)[leg.service];
+            fillRoute(route, s.from, s.to, s.cost, s.companyId, s.deptTime, s.arrTime, s.company);
+            route.date = TimeUtils::civilDate(leg.day);
+        }
+        return route;
+    }
+
+    void fillRoute(Route& route, int from, int to, int cost, int companyId, const Text& deptTime,
+                   const Text& arrTime, const Text& company) const {
+        route.startPoint = Port(getPortName(from), getPortCharge(from));
+        route.dest = Port(getPortName(to), getPortCharge(to));
+        route.deptTime = text(deptTime);
+        route.arrTime = text(arrTime);
+        route.cost = cost;
+        route.company = text(company);
+        route.companyId = companyId;
+    }
+
+    // --- Writing ---
+
+    static size_t align(size_t offset) {
+        return (offset + 7) & ~(size_t)7;
+    }
+
+    static Span place(size_t& end, long long count, size_t itemSize) {
+        Span span;
+        span.offset = align(end);
+        span.count = count;
+        end = span.offset + (size_t)count * itemSize;
+        return span;
+    }
+
+    // Copy s to the end of the string pool
+    struct Pool {
+        char* chars;
+        unsigned int used;
+
+        Text intern(const std::string& s) {
+            Text t;
+            t.offset = used;
+            t.length = (unsigned int)s.size();
+            if (!s.empty()) memcpy(chars + used, s.data(), s.size());
+            used += t.length;
+            return t;
+        }
+    };
+
+    static size_t routeText(const Route& route, bool dated) {
+        return (dated ? route.date.size() : 0) + route.deptTime.size() + route.arrTime.size() + route.company.size();
+    }
+
+    // Where each table goes, worked out before anything is written
+    static void plan(const Graph& graph, Header& h) {
+        h.magic = 0;
+        h.version = SEGMENT_VERSION;
+        h.fingerprint = graph.fingerprint();
+        h.portCount = graph.size;
+        h.sailingCount = 0;
+        h.serviceCount = graph.services.size();
+        h.exceptionCount = 0;
+        int servicesFrom = 0;
+        size_t stringBytes = 0;
+        for (int u = 0; u < graph.size; u++) {
+            stringBytes += graph.vertices[u].port.name.size();
+            for (const Route& route : graph.vertices[u].routes) {
+                if (graph.findPort(route.dest.name) == -1) continue;
+                h.sailingCount++;
+                stringBytes += routeText(route, true);
+            }
+            servicesFrom += graph.vertices[u].services.size();
+        }
+        for (const Service& service : graph.services) {
+            h.exceptionCount += service.exceptions.size();
+            stringBytes += routeText(service.pattern, false);
+        }
+
+        size_t end = sizeof(Header);
+        h.ports = place(end, h.portCount, sizeof(PortRecord));
+        h.portsByName = place(end, h.portCount, sizeof(int));
+        h.sailingStart = place(end, h.portCount + 1, sizeof(int));
+        h.sailings = place(end, h.sailingCount, sizeof(SailingRecord));
+        h.departures = place(end, h.sailingCount, sizeof(int));
+        h.serviceStart = place(end, h.portCount + 1, sizeof(int));
+        h.servicesFrom = place(end, servicesFrom, sizeof(int));
+        h.services = place(end, h.serviceCount, sizeof(ServiceRecord));
+        h.exceptions = place(end, h.exceptionCount, sizeof(int));
+        h.strings = place(end, (long long)stringBytes, 1);
+        h.bytes = align(end);
+    }
+
+    static void write(const Graph& graph, const Header& h, char* out) {
+        Pool strings = { out + h.strings.offset, 0 };
+
+        PortRecord* ports = (PortRecord*)(out + h.ports.offset);
+        int* byName = (int*)(out + h.portsByName.offset);
+        for (int u = 0; u < graph.size; u++) {
+            ports[u].name = strings.intern(graph.vertices[u].port.name);
+            ports[u].charge = graph.vertices[u].port.portCharge;
+            byName[u] = u;
+        }
+        Vector<int> order;
+        order.resize(graph.size);
+        for (int u = 0; u < graph.size; u++) order[u] = u;
+        Sorting::mergeSort(order, [&](int a, int b) {
+            return graph.vertices[a].port.name < graph.vertices[b].port.name;
+        });
+        for (int u = 0; u < graph.size; u++) byName[u] = order[u];
+
+        int* sailingStart = (int*)(out + h.sailingStart.offset);
+        SailingRecord* sailings = (SailingRecord*)(out + h.sailings.offset);
+        int* departures = (int*)(out + h.departures.offset);
+        int next = 0;
+        for (int u = 0; u < graph.size; u++) {
+            sailingStart[u] = next;
+            Vector<int> group;
+            for (const Route& route : graph.vertices[u].routes) {
+                int v = graph.findPort(route.dest.name);
+                if (v == -1) continue;
+                SailingRecord& s = sailings[next];
+                s.from = u;
+                s.to = v;
+                s.departure = TimeUtils::toAbsoluteMinutes(route.date, route.deptTime);
+                s.arrival = TimeUtils::toAbsoluteMinutes(route.date, route.arrTime);
+                if (s.arrival < s.departure) s.arrival += 24 * 60;
+                s.cost = route.cost;
+                s.companyId = route.companyId;
+                s.date = strings.intern(route.date);
+                s.deptTime = strings.intern(route.deptTime);
+                s.arrTime = strings.intern(route.arrTime);
+                s.company = strings.intern(route.company);
+                group.push_back(next++);
+            }
+            // Stable, so equal departures keep their timetable order
+            Sorting::mergeSort(group, [&](int a, int b) { return sailings[a].departure < sailings[b].departure; });
+            for (int i = 0; i < group.size(); i++) departures[sailingStart[u] + i] = group[i];
+        }
+        sailingStart[graph.size] = next;
+
+        int* serviceStart = (int*)(out + h.serviceStart.offset);
+        int* servicesFrom = (int*)(out + h.servicesFrom.offset);
+        next = 0;
+        for (int u = 0; u < graph.size; u++) {
+            serviceStart[u] = next;
+            const Vector<int>& leaving = graph.vertices[u].services;
+            for (int k = 0; k < leaving.size(); k++) servicesFrom[next++] = leaving[k];
+        }
+        serviceStart[graph.size] = next;
+
+        ServiceRecord* services = (ServiceRecord*)(out + h.services.offset);
+        int* exceptions = (int*)(out + h.exceptions.offset);
+        next = 0;
+        for (int i = 0; i < graph.services.size(); i++) {
+            const Service& service = graph.services[i];
+            ServiceRecord& s = services[i];
+            s.from = service.from;
+            s.to = service.to;
+            s.cost = service.pattern.cost;
+            s.companyId = service.pattern.companyId;
+            s.weekdays = service.weekdays;
+            s.firstDay = service.firstDay;
+            s.lastDay = service.lastDay;
+            s.departureMinute = service.departureMinute;
+            s.duration = service.duration;
+            s.exceptionsBegin = next;
+            s.exceptionCount = service.exceptions.size();
+            for (int k = 0; k < service.exceptions.size(); k++) exceptions[next++] = service.exceptions[k];
+            s.deptTime = strings.intern(service.pattern.deptTime);
+            s.arrTime = strings.intern(service.pattern.arrTime);
+            s.company = strings.intern(service.pattern.company);
+        }
+
+        // Everything else before the magic, which readers take as done
+        Header* header = (Header*)out;
+        *header = h;
+        std::atomic_thread_fence(std::memory_order_release);
+        header->magic = SEGMENT_MAGIC;
+    }
+};
+
+#endif
@@ -0,0 +1,47 @@
+#ifndef SORTING_H
+#define SORTING_H
+
+#include <utility>
+#include "vector.h"
+
+// Stable bottom-up merge sort for Vector, O(n log n) with one scratch
+// buffer. less(a, b) returns true when a must come before b; equal items
+// keep their original order.
+class Sorting {
+public:
+    template <typename T, typename Less>
+    static void mergeSort(Vector<T>& items, Less less) {
+        int n = items.size();
+        if (n < 2) return;
+
+        Vector<T> scratch;
+        scratch.resize(n);
+        T* from = items.begin();
+        T* to = scratch.begin();
+
+        for (int width = 1; width < n; width *= 2) {
+            for (int lo = 0; lo < n; lo += 2 * width) {
+                int mid = (lo + width < n) ? lo + width : n;
+                int hi = (lo + 2 * width < n) ? lo + 2 * width : n;
+                int i = lo, j = mid, k = lo;
+                while (i < mid && j < hi) {
+                    // Take from the right run only when strictly smaller
+                    if (less(from[j], from[i])) to[k++] = std::move(from[j++]);
+                    else to[k++] = std::move(from[i++]);
+                }
+                while (i < mid) to[k++] = std::move(from[i++]);
+                while (j < hi) to[k++] = std::move(from[j++]);
+            }
+            T* swap = from;
+            from = to;
+            to = swap;
+        }
+
+        // An odd number of passes leaves the result in scratch
+        if (from != items.begin()) {
+            for (int i = 0; i < n; i++) items[i] = std::move(from[i]);
+        }
+    }
+};
+
+#endif
@@ -0,0 +1,81 @@
+#ifndef SPSCQUEUE_H
+#define SPSCQUEUE_H
+
+#include <atomic>
+#include <cstddef>
+#include <new>
+#include <utility>
+
+// Bounded lock-free ring buffer for handing work from exactly one producer
+// thread to exactly one consumer thread.
+// The producer only writes `tail` and the consumer only writes `head`, so
+// each side needs a single acquire load of the other's index per call.
+// Capacity is rounded up to a power of two; tryEnqueue fails when full
+// instead of growing.
+template <typename T>
+class SpscQueue {
+private:
+    T* slots;
+    size_t capacity;
+    size_t mask;
+
+    // Kept on separate cache lines so producer and consumer don't false-share
+    alignas(64) std::atomic<size_t> head;   // next slot to read (consumer)
+    alignas(64) std::atomic<size_t> tail;   // next slot to write (producer)
+
+public:
+    explicit SpscQueue(int minCapacity = 64) : head(0), tail(0) {
+        capacity = 2;
+        while ((int)capacity < minCapacity) capacity *= 2;
+        mask = capacity - 1;
+        slots = static_cast<T*>(::operator new(sizeof(T) * capacity));
+    }
+
+    ~SpscQueue() {
+        size_t h = head.load(std::memory_order_relaxed);
+        size_t t = tail.load(std::memory_order_relaxed);
+        for (; h != t; h++) {
+            slots[h & mask].~T();
+        }
+        ::operator delete(slots);
+    }
+
+    SpscQueue(const SpscQueue&) = delete;
+    SpscQueue& operator=(const SpscQueue&) = delete;
+
+    // Producer side. Returns false (and leaves val untouched) when full.
+    template <typename U>
+    bool tryEnqueue(U&& val) {
+        size_t t = tail.load(std::memory_order_relaxed);
+        if (t - head.load(std::memory_order_acquire) >= capacity) return false;
+        new (&slots[t & mask]) T(std::forward<U>(val));
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer side. Returns false when empty.
+    bool tryDequeue(T& out) {
+        size_t h = head.load(std::memory_order_relaxed);
+        if (h == tail.load(std::memory_order_acquire)) return false;
+        T& item = slots[h & mask];
+        out = std::move(item);
+        item.~T();
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Approximate when called while the other side is running
+    bool isEmpty() const {
+        return head.load(std::memory_order_acquire) == tail.load(std::memory_order_acquire);
+    }
+
+    int getSize() const {
+        return (int)(tail.load(std::memory_order_acquire) - head.load(std::memory_order_acquire));
+    }
+
+    int getCapacity() const {
+        return (int)capacity;
+    }
+};
+
+#endif
@@ -13,14 +13,78 @@ public:
         return hours * 60 + minutes;
     }
     
-    // Convert date string "DD/MM/YYYY" to days since epoch
+    // Convert date string "D/M/YYYY" to days since epoch. Day and month
+    // may be one or two digits ("9/12/2024" as well as "09/12/2024").
     static int dateToDays(const string& date) {
-        int day = (date[0] - '0') * 10 + (date[1] - '0');
-        int month = (date[3] - '0') * 10 + (date[4] - '0');
-        int year = ((date[6] - '0') * 1000 + (date[7] - '0') * 100 + 
-                    (date[8] - '0') * 10 + (date[9] - '0'));
+        int parts[3] = {0, 0, 0};   // day, month, year
+        int field = 0;
+        for (char c : date) {
+            if (c == '/') {
+                if (++field > 2) break;
+            } else if (c >= '0' && c <= '9') {
+                parts[field] = parts[field] * 10 + (c - '0');
+            }
+        }
         
         // Simple approximation: assume 30 days per month
+        return parts[2] * 365 + parts[1] * 30 + parts[0];
+    }
+
+    // Real calendar days since 1/1/1970 for "D/M/YYYY" (proleptic
+    // Gregorian), for schedules that repeat on weekdays. The absolute
+    // minutes the searches use stay on the rough calendar above.
+    static int civilDay(const string& date) {
+        int parts[3] = {0, 0, 0};
+        int field = 0;
+        for (char c : date) {
+            if (c == '/') {
+                if (++field > 2) break;
+            } else if (c >= '0' && c <= '9') {
+                parts[field] = parts[field] * 10 + (c - '0');
+            }
+        }
+        return civilDay(parts[0], parts[1], parts[2]);
+    }
+
+    static int civilDay(int day, int month, int year) {
+        year -= month <= 2;
+        int era = (year >= 0 ? year : year - 399) / 400;
+        int yearOfEra = year - era * 400;
+        int dayOfYear = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+        int dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+        return era * 146097 + dayOfEra - 719468;
+    }
+
+    // Inverse of civilDay
+    static void civilDate(int days, int& day, int& month, int& year) {
+        days += 719468;
+        int era = (days >= 0 ? days : days - 146096) / 146097;
+        int dayOfEra = days - era * 146097;
+        int yearOfEra = (dayOfEra - dayOfEra / 1460 + dayOfEra / 36524 - dayOfEra / 146096) / 365;
+        int dayOfYear = dayOfEra - (365 * yearOfEra + yearOfEra / 4 - yearOfEra / 100);
+        int shifted = (5 * dayOfYear + 2) / 153;
+        day = dayOfYear - (153 * shifted + 2) / 5 + 1;
+        month = shifted < 10 ? shifted + 3 : shifted - 9;
+        year = yearOfEra + era * 400 + (month <= 2);
+    }
+
+    // "D/M/YYYY" for a civil day, as the timetable writes dates
+    static string civilDate(int days) {
+        int day, month, year;
+        civilDate(days, day, month, year);
+        return to_string(day) + "/" + to_string(month) + "/" + to_string(year);
+    }
+
+    // 0 for Monday through 6 for Sunday (1/1/1970 was a Thursday)
+    static int weekday(int days) {
+        int w = (days + 3) % 7;
+        return w < 0 ? w + 7 : w;
+    }
+
+    // dateToDays of civilDate(days), without the string
+    static int roughDay(int days) {
+        int day, month, year;
+        civilDate(days, day, month, year);
         return year * 365 + month * 30 + day;
     }
 
@@ -0,0 +1,382 @@
+#ifndef TIMETABLEFEED_H
+#define TIMETABLEFEED_H
+
+#include <limits.h>
+#include <sstream>
+#include <string>
+#include "Graph.hpp"
+#include "connections.h"
+#include "lowerBounds.h"
+#include "landmarks.h"
+#include "reachability.h"
+#include "transferPatterns.h"
+#include "queryCache.h"
+
+#ifdef _WIN32
+#include <fstream>
+#else
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+// One line of a live timetable feed. Sailings are named the way
+// Routes.txt writes them; a weekly service's run is named by its date.
+//   DELAY  <from> <to> <D/M/YYYY> <HH:MM> <company> <minutes>
+//   CANCEL <from> <to> <D/M/YYYY> <HH:MM> <company>
+//   ADD    <from> <to> <D/M/YYYY> <HH:MM> <HH:MM> <cost> <company>
+struct TimetableChange {
+    enum Kind { DELAY, CANCEL, ADD };
+
+    Kind kind;
+    Route sailing;      // ports by name; ADD fills in every field
+    int minutes;        // DELAY only, may be negative
+
+    TimetableChange() : kind(CANCEL), minutes(0) {}
+
+    // False for blank lines, comments (#) and anything malformed
+    static bool parse(const std::string& line, TimetableChange& out) {
+        std::istringstream fields(line);
+        std::string kind, from, to;
+        if (!(fields >> kind >> from >> to >> out.sailing.date >> out.sailing.deptTime)) return false;
+        out.sailing.startPoint.name = from;
+        out.sailing.dest.name = to;
+        out.minutes = 0;
+
+        if (kind == "DELAY") {
+            out.kind = DELAY;
+            return (bool)(fields >> out.sailing.company >> out.minutes);
+        }
+        if (kind == "CANCEL") {
+            out.kind = CANCEL;
+            return (bool)(fields >> out.sailing.company);
+        }
+        if (kind == "ADD") {
+            out.kind = ADD;
+            return (bool)(fields >> out.sailing.arrTime >> out.sailing.cost >> out.sailing.company);
+        }
+        return false;
+    }
+};
+
+// Applies TimetableChanges to a loaded Graph in place, instead of editing
+// Routes.txt and reloading. The Graph's version does not move, so nothing
+// is rebuilt: the sorted sailing arrays (connections.h) move the one
+// sailing, and the other tables and a search cache drop only what the
+// change can affect. A cancelled sailing can only remove itineraries,
+// so only cached results that used it go; a new or retimed one can
+// improve any query whose origin reaches its departure port and whose
+// destination is reachable from its arrival port, unless the static
+// bounds (lowerBounds.h) show it cannot beat the cached answer. A delay
+// keeps the sailing's static leg, so only the cache sees it.
+//
+// The tables are patched under the searches' feet: apply changes to a
+// Graph no search is reading, such as the next snapshot
+// (timetableSnapshots.h).
+class TimetableUpdates {
+public:
+    // False if the change names no known sailing or port. results, if
+    // given, holds answers for the graph as it was and keeps the ones the
+    // change leaves standing.
+    static bool apply(Graph& graph, const TimetableChange& change, QueryCache* results) {
+        unsigned long long revision = graph.getRevision();
+        if (!patch(graph, change, results)) return false;
+        if (results) results->rebase(revision, graph.getRevision());
+        return true;
+    }
+
+private:
+    static bool patch(Graph& graph, const TimetableChange& change, QueryCache* results) {
+        const Route& named = change.sailing;
+        int from = graph.findPort(named.startPoint.name);
+        if (from == -1) return false;
+        Connections::editing(graph, from);
+
+        if (change.kind == TimetableChange::ADD) {
+            Route* added = graph.addSailing(named);
+            if (!added) return false;
+            Connections::added(graph, *added);
+            changed(graph, nullptr, added, results);
+            return true;
+        }
+
+        Route* route = graph.findSailing(from, named.dest.name, named.date, named.deptTime, named.company);
+        if (route) {
+            Route before = *route;
+            if (change.kind == TimetableChange::DELAY) {
+                graph.delaySailing(route, change.minutes);
+                Connections::retimed(graph, *route);
+                changed(graph, &before, route, results);
+            } else {
+                Connections::removing(graph, *route);
+                graph.cancelSailing(route);
+                changed(graph, &before, nullptr, results);
+            }
+            return true;
+        }
+
+        // A run of a weekly service: cancelled by an exception, delayed by
+        // also putting a dated sailing in its place
+        int day = TimeUtils::civilDay(named.date);
+        int service = graph.findServiceRun(from, named.dest.name, day, named.deptTime, named.company);
+        if (service == -1) return false;
+        Route before = graph.services[service].on(day);
+        graph.cancelServiceRun(service, day);
+
+        Route* delayed = nullptr;
+        if (change.kind == TimetableChange::DELAY) {
+            delayed = graph.addSailing(before);
+            graph.delaySailing(delayed, change.minutes);
+            Connections::added(graph, *delayed);
+        }
+        changed(graph, &before, delayed, results);
+        return true;
+    }
+
+    // removed is the sailing as it was (nullptr when one was only added),
+    // added the sailing as it is now (nullptr when one was only removed)
+    static void changed(const Graph& graph, const Route* removed, const Route* added, QueryCache* results) {
+        TransferPatterns::timetableChanged(graph);
+
+        int removedFrom = -1, removedTo = -1;
+        long long removedDeparture = 0;
+        if (removed) {
+            removedFrom = graph.findPort(removed->startPoint.name);
+            removedTo = graph.findPort(removed->dest.name);
+            removedDeparture = TimeUtils::toAbsoluteMinutes(removed->date, removed->deptTime);
+        }
+
+        int from = -1, to = -1;
+        long long departure = 0;
+        if (added) {
+            from = graph.findPort(added->startPoint.name);
+            to = graph.findPort(added->dest.name);
+            departure = TimeUtils::toAbsoluteMinutes(added->date, added->deptTime);
+        }
+
+        // Before the closure takes the new leg in: an itinerary's first
+        // use of it starts from a path the old timetable already had, and
+        // so does the rest after its last use
+        int duration = 0;
+        if (added) duration = TimeUtils::absoluteArrivalMinutes(added->date, added->deptTime, added->date,
+                                                                added->arrTime) - (int)departure;
+        if (results) results->invalidateIf([&](const SearchQuery& q, const QueryCache::Paths& paths) {
+            if (removed && (uses(paths, *removed) ||
+                            couldMatter(graph, q, *removed, removedFrom, removedTo, removedDeparture))) {
+                return true;
+            }
+            return added && couldUse(graph, q, paths, *added, from, to, departure, duration);
+        });
+
+        if (added && !(removed && sameLeg(graph, *removed, from, to, added->cost, duration))) {
+            LowerBounds::legAdded(graph, from, to, added->cost, duration);
+            Landmarks::legAdded(graph, from, to, added->cost, duration);
+            Reachability::legAdded(graph, from, to);
+        }
+    }
+
+    static bool sameSailing(const Route& a, const Route& b) {
+        return a.startPoint.name == b.startPoint.name && a.dest.name == b.dest.name &&
+               a.deptTime == b.deptTime && a.company == b.company &&
+               TimeUtils::dateToDays(a.date) == TimeUtils::dateToDays(b.date);
+    }
+
+    static bool uses(const QueryCache::Paths& paths, const Route& sailing) {
+        for (const PathFinding::PathResult& path : paths) {
+            for (const Route& route : path.routes) {
+                if (sameSailing(route, sailing)) return true;
+            }
+        }
+        return false;
+    }
+
+    // route was the same static leg: same ports, fare and sailing time
+    static bool sameLeg(const Graph& graph, const Route& route, int from, int to, int cost, int duration) {
+        int departure = TimeUtils::toAbsoluteMinutes(route.date, route.deptTime);
+        int arrival = TimeUtils::absoluteArrivalMinutes(route.date, route.deptTime, route.date, route.arrTime);
+        return graph.findPort(route.startPoint.name) == from && graph.findPort(route.dest.name) == to &&
+               route.cost == cost && arrival - departure == duration;
+    }
+
+    // The search for q could see sailing (from -> to, leaving at
+    // departure), whether or not its answer uses it. The searches keep one
+    // label per port, so a leg that only leads to a dead end still changes
+    // which itinerary comes out, or whether one does (not-found answers
+    // included). The closure only grows until a rebuild, so it also covers
+    // a sailing just removed.
+    static bool couldMatter(const Graph& graph, const SearchQuery& q, const Route& sailing,
+                            int from, int to, long long departure) {
+        if (q.origin < 0 || q.destination < 0 || from < 0 || to < 0) return false;
+        if (q.objective == SearchQuery::BOOKING_DIRECT) {
+            return q.origin == from && q.destination == to &&
+                   TimeUtils::dateToDays(q.date) == TimeUtils::dateToDays(sailing.date);
+        }
+        // Dated queries leave on or after their date
+        if (!q.date.empty() && departure < (long long)TimeUtils::dateToDays(q.date) * 24 * 60) return false;
+        return Reachability::canReach(graph, q.origin, from) && Reachability::canReach(graph, to, q.destination);
+    }
+
+    static bool couldUse(const Graph& graph, const SearchQuery& q, const QueryCache::Paths& paths,
+                         const Route& sailing, int from, int to, long long departure, int duration) {
+        if (!couldMatter(graph, q, sailing, from, to, departure)) return false;
+        if (q.objective == SearchQuery::BOOKING_DIRECT) return true;
+
+        // An itinerary over the leg pays at least the least to its departure
+        // port (landmarks), its fare and sailing time, and the least from
+        // its arrival port on; ties still count, as they may change which
+        // itinerary is returned
+        bool cheapest = (q.objective == SearchQuery::CHEAPEST);
+        if (!cheapest && q.objective != SearchQuery::FASTEST) return true;
+        if (paths.size() == 0 || !paths[0].found) return true;
+        const GoalBounds* bounds = LowerBounds::cached(graph, q.destination);
+        if (!bounds) return true;
+        long long least = cheapest ? (long long)sailing.cost + bounds->minCost[to]
+                                   : (long long)duration + bounds->minTime[to];
+        if (const LandmarkTables* tables = Landmarks::active(graph)) {
+            LandmarkHeuristic toLeg(*tables, q.origin, from);
+            least += cheapest ? toLeg.cost(q.origin) : toLeg.time(q.origin);
+        }
+        return least <= (cheapest ? paths[0].totalCost : paths[0].totalTime);
+    }
+};
+
+// Reads TimetableChanges from a file that is appended to (tail -f style)
+// or a named pipe, without ever blocking the frame loop: read() takes the
+// complete lines written since the last call.
+class TimetableFeed {
+private:
+#ifdef _WIN32
+    std::ifstream in;
+#else
+    int fd;
+#endif
+    std::string partial;    // text after the last newline read
+    int applied;
+    int rejected;
+
+    // Append what can be read right now to text
+    bool readAvailable(std::string& text) {
+#ifdef _WIN32
+        if (!in.is_open()) return false;
+        char buffer[4096];
+        in.clear();
+        while (in.read(buffer, sizeof(buffer)) || in.gcount() > 0) {
+            text.append(buffer, (size_t)in.gcount());
+        }
+        in.clear();     // at the end for now, not for good
+        return true;
+#else
+        if (fd == -1) return false;
+        char buffer[4096];
+        while (true) {
+            ssize_t n = ::read(fd, buffer, sizeof(buffer));
+            if (n > 0) {
+                text.append(buffer, (size_t)n);
+            } else if (n == -1 && errno == EINTR) {
+                continue;
+            } else {
+                return true;    // end of file so far, or nothing in the pipe yet
+            }
+        }
+#endif
+    }
+
+public:
+#ifdef _WIN32
+    TimetableFeed() : applied(0), rejected(0) {}
+#else
+    TimetableFeed() : fd(-1), applied(0), rejected(0) {}
+#endif
+
+    ~TimetableFeed() {
+        close();
+    }
+
+    TimetableFeed(const TimetableFeed&) = delete;
+    TimetableFeed& operator=(const TimetableFeed&) = delete;
+
+    // Start reading path from its current contents. A pipe opens at once,
+    // with or without a writer.
+    bool open(const std::string& path) {
+        close();
+        partial.clear();
+#ifdef _WIN32
+        in.open(path, std::ios::binary);
+        return in.is_open();
+#else
+        fd = ::open(path.c_str(), O_RDONLY | O_NONBLOCK);
+        return fd != -1;
+#endif
+    }
+
+    void close() {
+#ifdef _WIN32
+        if (in.is_open()) in.close();
+#else
+        if (fd != -1) ::close(fd);
+        fd = -1;
+#endif
+    }
+
+    bool isOpen() const {
+#ifdef _WIN32
+        return in.is_open();
+#else
+        return fd != -1;
+#endif
+    }
+
+    // Append the changes on every complete line that has arrived to out;
+    // returns how many
+    int read(Vector<TimetableChange>& out) {
+        std::string text = partial;
+        partial.clear();
+        if (!readAvailable(text)) return 0;
+
+        int count = 0;
+        size_t start = 0;
+        while (true) {
+            size_t end = text.find('\n', start);
+            if (end == std::string::npos) break;
+            std::string line = text.substr(start, end - start);
+            start = end + 1;
+
+            TimetableChange change;
+            if (!TimetableChange::parse(line, change)) {
+                if (line.find_first_not_of(" \t\r") != std::string::npos && line[0] != '#') rejected++;
+                continue;
+            }
+            out.push_back(change);
+            count++;
+        }
+        partial = text.substr(start);
+        return count;
+    }
+
+    // Apply changes as TimetableUpdates::apply does; returns how many
+    // changed the timetable
+    int apply(Graph& graph, const Vector<TimetableChange>& changes, QueryCache* results) {
+        int count = 0;
+        for (int i = 0; i < changes.size(); i++) {
+            if (TimetableUpdates::apply(graph, changes[i], results)) {
+                count++;
+            } else {
+                rejected++;
+            }
+        }
+        applied += count;
+        return count;
+    }
+
+    // read() and apply() in one, for a Graph no search is reading
+    int poll(Graph& graph, QueryCache* results) {
+        Vector<TimetableChange> changes;
+        read(changes);
+        return apply(graph, changes, results);
+    }
+
+    int getApplied() const { return applied; }
+    int getRejected() const { return rejected; }
+};
+
+#endif
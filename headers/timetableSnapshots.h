@@ -0,0 +1,71 @@
+#ifndef TIMETABLESNAPSHOTS_H
+#define TIMETABLESNAPSHOTS_H
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include "Graph.hpp"
+#include "connections.h"
+#include "reachability.h"
+
+// The live timetable as a series of read-only Graphs, so searches never
+// wait for a change and never see one half made. A reader pins the
+// current snapshot and searches it for as long as it likes; a change is
+// made to a copy of the current one (copy-on-write), which is then
+// published in one atomic swap. A snapshot is freed when the last reader
+// lets go of it.
+//
+// A copy shares every port's sailings with the snapshot before and copies
+// only those of the ports a change touches (RouteList, Vertex.hpp). The
+// ports, services and search tables are still copied whole, so batch the
+// changes that arrive together into one update().
+class TimetableSnapshots {
+public:
+    typedef std::shared_ptr<const Graph> Snapshot;
+
+private:
+    Snapshot current;
+    std::mutex writer;      // one update at a time
+
+    // Build the tables the searches expect to find before readers see it
+    static void warm(const Graph& graph) {
+        Connections::byDeparture(graph);
+        Reachability::reaching(graph, 0);
+    }
+
+public:
+    explicit TimetableSnapshots(std::shared_ptr<Graph> loaded) {
+        warm(*loaded);
+        current = std::move(loaded);
+    }
+
+    TimetableSnapshots(const TimetableSnapshots&) = delete;
+    TimetableSnapshots& operator=(const TimetableSnapshots&) = delete;
+
+    // The current snapshot; it stays as it is while held
+    Snapshot pin() const {
+        return std::atomic_load(&current);
+    }
+
+    // Make the next snapshot: patch(Graph&) changes a copy of the current
+    // one (TimetableUpdates::apply), which is then published
+    template <typename Patch>
+    void update(Patch patch) {
+        std::lock_guard<std::mutex> lock(writer);
+        Snapshot base = pin();
+        std::shared_ptr<Graph> next = std::make_shared<Graph>(*base);
+        Connections::copied(*base, *next);
+        patch(*next);
+        warm(*next);
+        std::atomic_store(&current, Snapshot(std::move(next)));
+    }
+
+    // A pin on the snapshot graph belongs to. A Graph that is no snapshot
+    // is not owned here: the pin then lasts only as long as its owner.
+    static Snapshot keep(const Graph& graph) {
+        Snapshot owned = graph.weak_from_this().lock();
+        return owned ? owned : Snapshot(Snapshot(), &graph);
+    }
+};
+
+#endif
@@ -0,0 +1,339 @@
+#ifndef TRANSFERPATTERNS_H
+#define TRANSFERPATTERNS_H
+
+#include <limits.h>
+#include <fstream>
+#include <memory>
+#include <string>
+#include "Graph.hpp"
+#include "pathFinding.h"
+#include "binaryFile.h"
+#include "vector.h"
+
+// Transfer patterns: for every origin, the sequence of layover ports the
+// optimal cheapest and fastest itinerary to each destination goes through.
+// The timetable is a fixed set of sailings (dated ones and weekly
+// services over their validity), so there is one pattern per (origin,
+// destination, objective) over the whole horizon. The patterns from one
+// origin share their prefixes and form a small DAG of transfer ports: one
+// node per port some pattern reaches, pointing back to the previous
+// transfer port of the cheapest and of the fastest pattern through it.
+// Only those nodes are stored, so ports an origin cannot reach cost
+// nothing, and offsets are size_t however large the network.
+struct TransferPatternTables {
+    struct Node {
+        int port;
+        int cheapestParent;     // previous port of the cheapest pattern, -1 if none
+        int fastestParent;
+    };
+
+    int portCount;
+    Vector<size_t> originStart;     // origin o's nodes are [originStart[o], originStart[o + 1])
+    Vector<Node> nodes;             // per origin, sorted by port (the origin itself left out)
+    unsigned long long graphVersion;    // Graph::getVersion the patterns belong to
+
+    TransferPatternTables() : portCount(0), graphVersion(0) {}
+
+    // Node of port in origin's DAG, or nullptr if no pattern reaches it
+    const Node* find(int origin, int port) const {
+        size_t lo = originStart[origin];
+        size_t hi = originStart[origin + 1];
+        while (lo < hi) {
+            size_t mid = lo + (hi - lo) / 2;
+            if (nodes[mid].port < port) lo = mid + 1;
+            else hi = mid;
+        }
+        return (lo < originStart[origin + 1] && nodes[lo].port == port) ? &nodes[lo] : nullptr;
+    }
+
+    size_t getTableBytes() const {
+        return (size_t)originStart.size() * sizeof(size_t) + (size_t)nodes.size() * sizeof(Node);
+    }
+};
+
+class TransferPatterns {
+public:
+    // Offline step: one full tree search per origin and objective
+    static void build(const Graph& graph, TransferPatternTables& tables) {
+        int n = graph.size;
+        tables.portCount = n;
+        tables.graphVersion = graph.getVersion();
+        tables.originStart.clear();
+        tables.nodes.clear();
+        tables.originStart.reserve(n + 1);
+
+        Vector<int> cheapest, fastest;
+        for (int origin = 0; origin < n; origin++) {
+            tables.originStart.push_back(tables.nodes.size());
+            PathFinding::cheapestTree(graph, origin, cheapest);
+            PathFinding::fastestTree(graph, origin, fastest);
+            for (int v = 0; v < n; v++) {
+                if (v == origin || (cheapest[v] == -1 && fastest[v] == -1)) continue;
+                TransferPatternTables::Node node = { v, cheapest[v], fastest[v] };
+                tables.nodes.push_back(node);
+            }
+        }
+        tables.originStart.push_back(tables.nodes.size());
+    }
+
+    // Per origin, its node count and then its nodes as (port, cheapest
+    // parent, fastest parent) ints
+    static bool save(const TransferPatternTables& tables, const Graph& graph, const std::string& fileName) {
+        std::ofstream out(fileName, std::ios::binary | std::ios::trunc);
+        if (!out) return false;
+
+        BinaryFile::writeHeader(out, FILE_MAGIC, FILE_VERSION, graph, 2);
+        Vector<int> row;
+        for (int origin = 0; origin < tables.portCount; origin++) {
+            row.clear();
+            row.push_back((int)(tables.originStart[origin + 1] - tables.originStart[origin]));
+            BinaryFile::writeInts(out, row);
+            row.clear();
+            for (size_t i = tables.originStart[origin]; i < tables.originStart[origin + 1]; i++) {
+                row.push_back(tables.nodes[i].port);
+                row.push_back(tables.nodes[i].cheapestParent);
+                row.push_back(tables.nodes[i].fastestParent);
+            }
+            BinaryFile::writeInts(out, row);
+        }
+        return (bool)out;
+    }
+
+    // False if the file is missing, damaged or was built for another timetable
+    static bool load(TransferPatternTables& tables, const Graph& graph, const std::string& fileName) {
+        std::ifstream in(fileName, std::ios::binary);
+        if (!in) return false;
+
+        int objectives = 0;
+        if (!BinaryFile::readHeader(in, FILE_MAGIC, FILE_VERSION, graph, objectives) ||
+            objectives != 2) {
+            return false;
+        }
+
+        int n = graph.size;
+        TransferPatternTables loaded;
+        loaded.portCount = n;
+        loaded.graphVersion = graph.getVersion();
+        loaded.originStart.reserve(n + 1);
+        Vector<int> row;
+        for (int origin = 0; origin < n; origin++) {
+            loaded.originStart.push_back(loaded.nodes.size());
+            if (!BinaryFile::readInts(in, row, 1) || row[0] < 0 || row[0] >= n) return false;
+            int count = row[0];
+            if (!BinaryFile::readInts(in, row, count * 3)) return false;
+            for (int i = 0; i < count; i++) {
+                TransferPatternTables::Node node = { row[3 * i], row[3 * i + 1], row[3 * i + 2] };
+                bool sorted = (i == 0) || node.port > loaded.nodes.back().port;
+                if (node.port < 0 || node.port >= n || node.port == origin || !sorted ||
+                    node.cheapestParent < -1 || node.cheapestParent >= n ||
+                    node.fastestParent < -1 || node.fastestParent >= n) {
+                    return false;
+                }
+                loaded.nodes.push_back(node);
+            }
+        }
+        loaded.originStart.push_back(loaded.nodes.size());
+
+        tables = std::move(loaded);
+        return true;
+    }
+
+    // Install the patterns from fileName in graph for active() if they
+    // were built for it. Nothing is built or written: on false the menus
+    // search until prepare() has brought the file up to date.
+    static bool install(const Graph& graph, const std::string& fileName) {
+        std::shared_ptr<TransferPatternTables> tables = std::make_shared<TransferPatternTables>();
+        if (!load(*tables, graph, fileName)) return false;
+        graph.derived.setShared<TransferPatternTables>(&key, tables);
+        return true;
+    }
+
+    // Load the patterns from fileName if they match graph, otherwise build
+    // and write them back. Installs the result in graph for active();
+    // copies of graph share it. The offline step (--preprocess); normal
+    // starts only install().
+    static const TransferPatternTables& prepare(const Graph& graph, const std::string& fileName) {
+        std::shared_ptr<TransferPatternTables> tables = std::make_shared<TransferPatternTables>();
+        if (!load(*tables, graph, fileName)) {
+            build(graph, *tables);
+            save(*tables, graph, fileName);
+        }
+        graph.derived.setShared<TransferPatternTables>(&key, tables);
+        return *tables;
+    }
+
+    // Patterns installed in graph by prepare(), or nullptr if there are
+    // none or the timetable changed since
+    static const TransferPatternTables* active(const Graph& graph) {
+        std::shared_ptr<const TransferPatternTables> tables = graph.derived.getShared<TransferPatternTables>(&key);
+        if (!tables || tables->portCount == 0 || tables->graphVersion != graph.getVersion() ||
+            tables->portCount != graph.size) {
+            return nullptr;
+        }
+        return tables.get();    // graph keeps them
+    }
+
+    // Any live change (timetableFeed.h) can move an optimal itinerary off
+    // its stored pattern, so graph drops the patterns and the menus search
+    // until the next prepare(). Call on a graph no search is reading; other
+    // snapshots keep theirs.
+    static void timetableChanged(const Graph& graph) {
+        graph.derived.setShared<TransferPatternTables>(&key, nullptr);
+    }
+
+    // Same answer as PathFinding::findCheapestPath, evaluating only the
+    // direct sailings between consecutive ports of the stored pattern
+    static PathFinding::PathResult* findCheapestPath(const Graph& graph, const TransferPatternTables& tables,
+                                                     int startIndex, int endIndex) {
+        PathFinding::PathResult* result = new PathFinding::PathResult();
+        if (!loadPattern(tables, false, startIndex, endIndex, result)) {
+            return result;
+        }
+
+        const DepartureIndex& departures = Connections::byPort(graph);
+        int cost = 0;
+        long long arrival = 0;
+        LinkedList<int>::iterator from = result->path.begin();
+        LinkedList<int>::iterator to = from;
+        for (++to; to != result->path.end(); ++from, ++to) {
+            bool atOrigin = (*from == startIndex);
+            Connection bestLeg;
+            int bestCost = INT_MAX;
+            // In departure order from the first that can be made, so ties
+            // go to the sailing PathFinding keeps
+            long long earliest = atOrigin ? LLONG_MIN : arrival + 60;
+            int first = atOrigin ? departures.begin(*from) : departures.firstFrom(*from, earliest);
+            for (int i = first; i < departures.end(*from); i++) {
+                const Connection& conn = departures.sailings[i];
+                if (conn.to != *to) continue;
+                int legCost = PathFinding::cheapestLegCost(graph, conn, atOrigin, cost, arrival);
+                if (legCost < bestCost) {
+                    bestCost = legCost;
+                    bestLeg = conn;
+                }
+            }
+            // Of a weekly service, the first run that can be made
+            const Vector<int>& services = graph.vertices[*from].services;
+            for (int k = 0; k < services.size(); k++) {
+                Connection run;
+                if (graph.services[services[k]].to != *to ||
+                    !Connections::firstOccurrence(graph, services[k], earliest, run)) {
+                    continue;
+                }
+                int legCost = PathFinding::cheapestLegCost(graph, run, atOrigin, cost, arrival);
+                if (legCost < bestCost) {
+                    bestCost = legCost;
+                    bestLeg = run;
+                }
+            }
+            if (bestCost == INT_MAX) return clear(result);   // patterns out of step with the timetable
+
+            cost = bestCost;
+            arrival = bestLeg.arrival;
+            result->routes.insertEnd(Connections::routeOf(bestLeg));
+        }
+
+        PathFinding::finishCheapest(result, cost);
+        return result;
+    }
+
+    // Same answer as PathFinding::findShortestTimePath, along the stored pattern
+    static PathFinding::PathResult* findShortestTimePath(const Graph& graph, const TransferPatternTables& tables,
+                                                         int startIndex, int endIndex) {
+        PathFinding::PathResult* result = new PathFinding::PathResult();
+        if (!loadPattern(tables, true, startIndex, endIndex, result)) {
+            return result;
+        }
+
+        const DepartureIndex& departures = Connections::byPort(graph);
+        long long time = 0;
+        long long parentDeparture = -1;
+        LinkedList<int>::iterator from = result->path.begin();
+        LinkedList<int>::iterator to = from;
+        for (++to; to != result->path.end(); ++from, ++to) {
+            bool atOrigin = (*from == startIndex);
+            Connection bestLeg;
+            long long bestTime = LLONG_MAX;
+            long long earliest = atOrigin ? LLONG_MIN : time + 60;
+            int first = atOrigin ? departures.begin(*from) : departures.firstFrom(*from, earliest);
+            for (int i = first; i < departures.end(*from); i++) {
+                const Connection& conn = departures.sailings[i];
+                if (conn.to != *to) continue;
+                long long legTime = PathFinding::fastestLegTime(conn.departure, conn.arrival, atOrigin, time,
+                                                                parentDeparture);
+                if (legTime < bestTime) {
+                    bestTime = legTime;
+                    bestLeg = conn;
+                }
+            }
+            const Vector<int>& services = graph.vertices[*from].services;
+            for (int k = 0; k < services.size(); k++) {
+                const Service& service = graph.services[services[k]];
+                if (service.to != *to) continue;
+                // The first run fastestLegTime can accept, as PathFinding picks it
+                long long runFrom = earliest;
+                if (!atOrigin && parentDeparture - service.duration > runFrom) {
+                    runFrom = parentDeparture - service.duration;
+                }
+                Connection run;
+                if (!Connections::firstOccurrence(graph, services[k], runFrom, run)) continue;
+                long long legTime = PathFinding::fastestLegTime(run.departure, run.arrival, atOrigin, time,
+                                                                parentDeparture);
+                if (legTime < bestTime) {
+                    bestTime = legTime;
+                    bestLeg = run;
+                }
+            }
+            if (bestTime == LLONG_MAX) return clear(result);
+
+            time = bestTime;
+            parentDeparture = bestLeg.departure;
+            result->routes.insertEnd(Connections::routeOf(bestLeg));
+        }
+
+        PathFinding::finishFastest(graph, result);
+        return result;
+    }
+
+private:
+    static const unsigned int FILE_MAGIC = 0x50544f4fu;    // "OOTP"
+    static const unsigned int FILE_VERSION = 3;     // 2: single-digit days parsed correctly; 3: sparse DAGs
+
+    static constexpr int key = 0;     // graph.derived slot
+
+    // Put the pattern's ports into result->path, walking origin's DAG back
+    // from endIndex along one objective's parents. False if there is none.
+    static bool loadPattern(const TransferPatternTables& tables, bool fastest, int startIndex, int endIndex,
+                            PathFinding::PathResult* result) {
+        int n = tables.portCount;
+        if (startIndex < 0 || endIndex < 0 || startIndex >= n || endIndex >= n) return false;
+
+        int hops = 0;
+        for (int port = endIndex; port != startIndex;) {
+            const TransferPatternTables::Node* node = tables.find(startIndex, port);
+            // Unreachable, or a cycle from a damaged table
+            if (!node || ++hops > n) {
+                result->path.clear();
+                return false;
+            }
+            result->path.insertFront(port);
+            port = fastest ? node->fastestParent : node->cheapestParent;
+            if (port == -1) {
+                result->path.clear();
+                return false;
+            }
+        }
+        result->path.insertFront(startIndex);
+        result->nodesSettled = result->path.getSize();
+        return true;
+    }
+
+    static PathFinding::PathResult* clear(PathFinding::PathResult* result) {
+        result->path.clear();
+        result->routes.clear();
+        result->nodesSettled = 0;
+        return result;
+    }
+};
+
+#endif
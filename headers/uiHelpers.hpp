@@ -3,6 +3,7 @@
 
 #include <SFML/Graphics.hpp>
 #include <cmath>
+#include <string>
 
 // Helper function to draw thick lines
 inline void drawThickLine(sf::RenderWindow& window, sf::Vector2f point1, sf::Vector2f point2, float thickness, sf::Color color) {
@@ -180,6 +181,15 @@ inline void drawDottedArrow(sf::RenderWindow& window, sf::Vector2f point1, sf::V
     window.draw(arrowhead);
 }
 
-#endif
+// Status text while a search runs on the search worker: animated dots, plus
+// the work done so far when the search reports it
+inline std::string searchingText(int progress = 0) {
+    static sf::Clock clock;
+    int dots = (int)(clock.getElapsedTime().asSeconds() * 3.f) % 4;
+    std::string text = "Searching" + std::string(dots, '.');
+    if (progress > 0) text += "\n" + std::to_string(progress) + " paths explored";
+    return text;
+}
 
+#endif
 
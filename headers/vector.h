@@ -3,82 +3,159 @@
 
 #include <stdexcept>
 #include <initializer_list>
+#include <new>
+#include <utility>
 
 template <typename T>
 class Vector {
 private:
+    // Raw storage: only the first `count` slots hold constructed objects.
+    // T does not need to be default-constructible unless resize() grows.
     T* data;
     int capacity;
     int count;
 
+    static T* allocate(int n) {
+        return static_cast<T*>(::operator new(sizeof(T) * n));
+    }
+
+    void destroyRange(int from, int to) {
+        for (int i = from; i < to; i++) {
+            data[i].~T();
+        }
+    }
+
     void resizeCapacity(int newCapacity) {
-        T* newData = new T[newCapacity];
+        T* newData = allocate(newCapacity);
         for (int i = 0; i < count; i++) {
-            newData[i] = data[i];
+            new (&newData[i]) T(std::move(data[i]));
+            data[i].~T();
         }
-        delete[] data;
+        ::operator delete(data);
         data = newData;
         capacity = newCapacity;
     }
 
+    void grow() {
+        resizeCapacity((capacity == 0) ? 4 : capacity * 2);
+    }
+
+    void copyFrom(const Vector& other) {
+        if (other.count > 0) {
+            data = allocate(other.count);
+            capacity = other.count;
+            for (int i = 0; i < other.count; i++) {
+                new (&data[i]) T(other.data[i]);
+                count++;
+            }
+        }
+    }
+
+    void release() {
+        destroyRange(0, count);
+        ::operator delete(data);
+        data = nullptr;
+        capacity = 0;
+        count = 0;
+    }
+
 public:
     Vector() : data(nullptr), capacity(0), count(0) {}
     
     // Initializer list constructor
     Vector(std::initializer_list<T> init) : data(nullptr), capacity(0), count(0) {
         if (init.size() > 0) {
-            capacity = init.size();
-            count = init.size();
-            data = new T[capacity];
-            int i = 0;
+            data = allocate((int)init.size());
+            capacity = (int)init.size();
             for (const T& item : init) {
-                data[i++] = item;
+                new (&data[count]) T(item);
+                count++;
             }
         }
     }
     
     ~Vector() {
-        delete[] data;
+        release();
     }
     
     // Copy constructor
     Vector(const Vector& other) : data(nullptr), capacity(0), count(0) {
-        if (other.count > 0) {
-            capacity = other.count;
-            count = other.count;
-            data = new T[capacity];
-            for (int i = 0; i < count; i++) {
-                data[i] = other.data[i];
-            }
-        }
+        copyFrom(other);
+    }
+
+    // Move constructor (steals the buffer, no element copies)
+    Vector(Vector&& other) noexcept
+        : data(other.data), capacity(other.capacity), count(other.count) {
+        other.data = nullptr;
+        other.capacity = 0;
+        other.count = 0;
     }
     
     // Assignment operator
     Vector& operator=(const Vector& other) {
         if (this != &other) {
-            delete[] data;
-            data = nullptr;
-            capacity = 0;
-            count = 0;
+            release();
+            copyFrom(other);
+        }
+        return *this;
+    }
             
-            if (other.count > 0) {
-                capacity = other.count;
-                count = other.count;
-                data = new T[capacity];
-                for (int i = 0; i < count; i++) {
-                    data[i] = other.data[i];
-                }
-            }
+    // Move assignment
+    Vector& operator=(Vector&& other) noexcept {
+        if (this != &other) {
+            release();
+            data = other.data;
+            capacity = other.capacity;
+            count = other.count;
+            other.data = nullptr;
+            other.capacity = 0;
+            other.count = 0;
         }
         return *this;
     }
     
     void push_back(const T& value) {
         if (count >= capacity) {
-            int newCapacity = (capacity == 0) ? 4 : capacity * 2;
-            resizeCapacity(newCapacity);
+            // value may alias an element of this vector, copy it before regrowing
+            T copy(value);
+            grow();
+            new (&data[count]) T(std::move(copy));
+        } else {
+            new (&data[count]) T(value);
+        }
+        count++;
+    }
+
+    void push_back(T&& value) {
+        if (count >= capacity) {
+            T moved(std::move(value));
+            grow();
+            new (&data[count]) T(std::move(moved));
+        } else {
+            new (&data[count]) T(std::move(value));
+        }
+        count++;
+    }
+
+    // Construct an element in place at the end
+    template <typename... Args>
+    T& emplace_back(Args&&... args) {
+        if (count >= capacity) {
+            T value(std::forward<Args>(args)...);
+            grow();
+            new (&data[count]) T(std::move(value));
+        } else {
+            new (&data[count]) T(std::forward<Args>(args)...);
         }
-        data[count++] = value;
+        return data[count++];
+    }
+
+    void pop_back() {
+        if (count == 0) {
+            throw std::out_of_range("Vector is empty");
+        }
+        count--;
+        data[count].~T();
     }
     
     void erase(int index) {
@@ -87,21 +164,43 @@ public:
         }
         
         for (int i = index; i < count - 1; i++) {
-            data[i] = data[i + 1];
+            data[i] = std::move(data[i + 1]);
         }
         count--;
+        data[count].~T();
     }
     
+    // Destroys the elements but keeps the buffer for reuse
     void clear() {
-        delete[] data;
-        data = nullptr;
-        capacity = 0;
+        destroyRange(0, count);
         count = 0;
     }
+
+    // Make sure at least newCapacity elements fit without reallocating
+    void reserve(int newCapacity) {
+        if (newCapacity > capacity) {
+            resizeCapacity(newCapacity);
+        }
+    }
+
+    // Give back unused capacity (frees the buffer entirely when empty)
+    void shrink_to_fit() {
+        if (count == 0) {
+            ::operator delete(data);
+            data = nullptr;
+            capacity = 0;
+        } else if (count < capacity) {
+            resizeCapacity(count);
+        }
+    }
     
     int size() const {
         return count;
     }
+
+    int getCapacity() const {
+        return capacity;
+    }
     
     bool empty() const {
         return count == 0;
@@ -169,6 +268,10 @@ public:
         }
         // If newSize > count, new elements are default-constructed
         // If newSize < count, elements are removed
+        for (int i = count; i < newSize; i++) {
+            new (&data[i]) T();
+        }
+        destroyRange(newSize, count);
         count = newSize;
     }
     
@@ -185,8 +288,20 @@ public:
         }
         return data[0];
     }
-};
 
-#endif
+    T& back() {
+        if (count == 0) {
+            throw std::out_of_range("Vector is empty");
+        }
+        return data[count - 1];
+    }
 
+    const T& back() const {
+        if (count == 0) {
+            throw std::out_of_range("Vector is empty");
+        }
+        return data[count - 1];
+    }
+};
 
+#endif
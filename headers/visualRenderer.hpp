@@ -10,6 +10,24 @@
 class VisualRenderer
 {
 public:
+    // Bits stored per port by markPath()
+    static const unsigned char PATH_STOP = 1;  // intermediate port on the path
+    static const unsigned char PATH_END = 2;   // origin or destination
+
+    static void markPath(const PathFinding::PathResult *result, Vector<unsigned char> &marks)
+    {
+        if (!result || !result->found) return;
+
+        int k = 0;
+        int last = result->path.getSize() - 1;
+        for (int port : result->path)
+        {
+            if (port >= 0 && port < marks.size())
+                marks[port] |= (k == 0 || k == last) ? PATH_END : PATH_STOP;
+            k++;
+        }
+    }
+
     static void drawMap(sf::RenderWindow &window, const sf::Sprite &mapSprite)
     {
         window.clear(sf::Color(10, 10, 10));
@@ -23,12 +41,11 @@ public:
     {
         if (currentPathResult && currentPathResult->found)
         {
-            for (int i = 0; i < currentPathResult->path.getSize() - 1; i++)
+            bool firstPort = true;
+            int u = -1;
+            for (int v : currentPathResult->path)
             {
-                int u = currentPathResult->path.get(i);
-                int v = currentPathResult->path.get(i + 1);
-
-                if (u >= 0 && u < (int)positions.size() && v >= 0 && v < (int)positions.size())
+                if (!firstPort && u >= 0 && u < (int)positions.size() && v >= 0 && v < (int)positions.size())
                 {
                     if (useDottedLines) {
                         // Draw dotted arrows for simulation
@@ -40,6 +57,8 @@ public:
                         drawArrow(window, positions[u], positions[v], 3.f, sf::Color::Green);
                     }
                 }
+                firstPort = false;
+                u = v;
             }
         }
     }
@@ -58,67 +77,43 @@ public:
                           PathFinding::PathResult *highlightPathResult = nullptr,
                           bool showSubgraph = false)
     {
+        // Mark each port's role once per frame instead of rescanning
+        // the paths for every port
+        Vector<unsigned char> pathMarks;
+        Vector<unsigned char> highlightMarks;
+        Vector<bool> isPreferred;
+        pathMarks.resize(graph.size);
+        highlightMarks.resize(graph.size);
+        isPreferred.resize(graph.size);
+        markPath(currentPathResult, pathMarks);
+        markPath(highlightPathResult, highlightMarks);
+        for (int prefPort : preferredPorts) {
+            if (prefPort >= 0 && prefPort < graph.size) isPreferred[prefPort] = true;
+        }
+        bool subgraphActive = showSubgraph && currentPathResult && currentPathResult->found;
+
         for (int i = 0; i < graph.size; i++)
         {
             // In subgraph mode, only show ports in the current path
-            if (showSubgraph && currentPathResult && currentPathResult->found) {
-                bool inSubgraph = false;
-                for (int k = 0; k < currentPathResult->path.getSize(); k++) {
-                    if (currentPathResult->path.get(k) == i) {
-                        inSubgraph = true;
-                        break;
-                    }
-                }
-                if (!inSubgraph) {
-                    continue; // Skip ports not in the subgraph
-                }
+            if (subgraphActive && pathMarks[i] == 0) {
+                continue; // Skip ports not in the subgraph
             }
             
             bool underPanel = panelOpen && positions[i].x < panelWidth;
             if (!underPanel)
             {
-                bool inPath = false;
-                bool isEndNode = false;
-                bool inHighlightPath = false;
-                bool isHighlightEndNode = false;
-                
-                // Check current path result
-                if (currentPathResult && currentPathResult->found)
-                {
-                    for (int k = 0; k < currentPathResult->path.getSize(); k++)
-                        if (currentPathResult->path.get(k) == i)
-                        {
-                            if (k == 0 || k == currentPathResult->path.getSize() - 1)
-                                isEndNode = true;
-                            else
-                                inPath = true;
-                        }
-                }
+                // Current path result
+                bool inPath = (pathMarks[i] & PATH_STOP) != 0;
+                bool isEndNode = (pathMarks[i] & PATH_END) != 0;
                 
-                // Check highlight path (for boat simulation or multi-leg journey)
-                if (highlightPathResult && highlightPathResult->found)
-                {
-                    for (int k = 0; k < highlightPathResult->path.getSize(); k++)
-                        if (highlightPathResult->path.get(k) == i)
-                        {
-                            if (k == 0 || k == highlightPathResult->path.getSize() - 1)
-                                isHighlightEndNode = true;
-                            else
-                                inHighlightPath = true;
-                        }
-                }
+                // Highlight path (for boat simulation or multi-leg journey)
+                bool inHighlightPath = (highlightMarks[i] & PATH_STOP) != 0;
+                bool isHighlightEndNode = (highlightMarks[i] & PATH_END) != 0;
 
                 float currentScale = baseScale;
                 sf::Color tintColor = sf::Color::White;
                 
-                // Check if port is a preferred port
-                bool isPreferredPort = false;
-                for (int prefPort : preferredPorts) {
-                    if (prefPort == i) {
-                        isPreferredPort = true;
-                        break;
-                    }
-                }
+                bool isPreferredPort = isPreferred[i];
 
                 // Priority: Highlight path > Current path > End nodes > Preferred ports
                 if (inHighlightPath || isHighlightEndNode)
@@ -193,17 +188,8 @@ public:
         for (int i = 0; i < graph.size; i++)
         {
             // In subgraph mode, only show labels for ports in the current path
-            if (showSubgraph && currentPathResult && currentPathResult->found) {
-                bool inSubgraph = false;
-                for (int k = 0; k < currentPathResult->path.getSize(); k++) {
-                    if (currentPathResult->path.get(k) == i) {
-                        inSubgraph = true;
-                        break;
-                    }
-                }
-                if (!inSubgraph) {
-                    continue; // Skip labels for ports not in the subgraph
-                }
+            if (subgraphActive && pathMarks[i] == 0) {
+                continue; // Skip labels for ports not in the subgraph
             }
             
             bool underPanel = panelOpen && positions[i].x < panelWidth;
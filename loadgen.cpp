@@ -0,0 +1,231 @@
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include "headers/jsonMessage.h"
+#include "headers/queryServer.h"
+#include "headers/sorting.h"
+#include "headers/vector.h"
+
+using namespace std;
+
+// Load generator for the query server (server.cpp): keeps a window of
+// requests in flight on each connection and reports throughput and
+// latency percentiles.
+//   loadgen <socket path | port> [--connections C] [--requests N]
+//           [--window W] [--op cheapest|fastest|filtered|book|mixed] [--seed S]
+
+typedef chrono::steady_clock Clock;
+
+struct Settings {
+    string address;
+    int connections = 4;
+    int requests = 20000;   // in total
+    int window = 8;         // requests in flight per connection
+    string op = "mixed";
+    unsigned seed = 1;
+};
+
+struct Tally {
+    Vector<double> latencies;   // microseconds
+    int failed = 0;
+    int booked = 0;
+    bool broken = false;        // the connection went away
+};
+
+// Reads whole lines off a socket
+class LineReader {
+private:
+    int fd;
+    string buffered;
+
+public:
+    explicit LineReader(int socket) : fd(socket) {}
+
+    bool next(string& line) {
+        while (true) {
+            size_t end = buffered.find('\n');
+            if (end != string::npos) {
+                line = buffered.substr(0, end);
+                buffered.erase(0, end + 1);
+                return true;
+            }
+            char chunk[1 << 16];
+            ssize_t n = ::recv(fd, chunk, sizeof(chunk), 0);
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) return false;
+            buffered.append(chunk, n);
+        }
+    }
+};
+
+static bool sendAll(int fd, const string& text) {
+    size_t sent = 0;
+    while (sent < text.size()) {
+        ssize_t n = ::send(fd, text.data() + sent, text.size() - sent, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        sent += n;
+    }
+    return true;
+}
+
+static string makeRequest(int id, const string& op, const Vector<string>& ports, mt19937& random) {
+    const string& origin = ports[random() % ports.size()];
+    const string& destination = ports[random() % ports.size()];
+    string out = "{";
+    JsonMessage::appendField(out, "id", (long long)id);
+    out += ',';
+    JsonMessage::appendField(out, "op", op);
+    out += ',';
+    JsonMessage::appendField(out, "origin", origin);
+    out += ',';
+    JsonMessage::appendField(out, "destination", destination);
+    if (op == "filtered") {
+        out += ",\"ports\":[";
+        JsonMessage::appendString(out, ports[random() % ports.size()]);
+        out += ',';
+        JsonMessage::appendString(out, ports[random() % ports.size()]);
+        out += "],\"limit\":3";
+    } else if (op == "book") {
+        out += ',';
+        JsonMessage::appendField(out, "objective", string(random() % 2 ? "fastest" : "cheapest"));
+    }
+    out += "}\n";
+    return out;
+}
+
+// 40% cheapest, 40% fastest, 15% filtered, 5% book
+static string pickOp(const string& op, mt19937& random) {
+    if (op != "mixed") return op;
+    int roll = random() % 100;
+    if (roll < 40) return "cheapest";
+    if (roll < 80) return "fastest";
+    if (roll < 95) return "filtered";
+    return "book";
+}
+
+static void drive(const Settings& settings, const Vector<string>& ports, int count,
+                  unsigned seed, Tally& tally) {
+    int fd = QueryServer::connectTo(settings.address);
+    if (fd == -1) {
+        tally.broken = true;
+        return;
+    }
+    mt19937 random(seed);
+    LineReader reader(fd);
+    Vector<Clock::time_point> sentAt;
+    sentAt.reserve(count);
+
+    int sent = 0;
+    int received = 0;
+    string line;
+    JsonMessage reply;
+    while (received < count) {
+        // Top the window up in one send
+        string batch;
+        while (sent < count && sent - received < settings.window) {
+            batch += makeRequest(sent, pickOp(settings.op, random), ports, random);
+            sentAt.push_back(Clock::now());
+            sent++;
+        }
+        if (!batch.empty() && !sendAll(fd, batch)) break;
+
+        if (!reader.next(line)) break;
+        Clock::time_point now = Clock::now();
+        received++;
+        if (!reply.parse(line) || reply.getString("ok") != "true") {
+            tally.failed++;
+            continue;
+        }
+        long long id = reply.getNumber("id", -1);
+        if (id < 0 || id >= sentAt.size()) {
+            tally.failed++;
+            continue;
+        }
+        if (reply.getString("booked") == "true") tally.booked++;
+        tally.latencies.push_back(chrono::duration<double, micro>(now - sentAt[id]).count());
+    }
+    if (received < count) tally.broken = true;
+    ::close(fd);
+}
+
+static bool loadPorts(const string& address, Vector<string>& ports) {
+    int fd = QueryServer::connectTo(address);
+    if (fd == -1) return false;
+    LineReader reader(fd);
+    string line;
+    JsonMessage reply;
+    bool ok = sendAll(fd, "{\"id\":0,\"op\":\"ports\"}\n") && reader.next(line) && reply.parse(line);
+    ::close(fd);
+    if (!ok) return false;
+    ports = reply.getList("ports");
+    return ports.size() > 0;
+}
+
+static double percentile(const Vector<double>& sorted, double p) {
+    if (sorted.size() == 0) return 0;
+    int at = (int)(p * (sorted.size() - 1) + 0.5);
+    return sorted[at];
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        cerr << "Usage: " << argv[0] << " <socket path | port> [--connections C] [--requests N]"
+             << " [--window W] [--op cheapest|fastest|filtered|book|mixed] [--seed S]\n";
+        return 1;
+    }
+    Settings settings;
+    settings.address = argv[1];
+    for (int i = 2; i + 1 < argc; i += 2) {
+        string flag = argv[i];
+        if (flag == "--connections") settings.connections = atoi(argv[i + 1]);
+        else if (flag == "--requests") settings.requests = atoi(argv[i + 1]);
+        else if (flag == "--window") settings.window = atoi(argv[i + 1]);
+        else if (flag == "--op") settings.op = argv[i + 1];
+        else if (flag == "--seed") settings.seed = (unsigned)atoi(argv[i + 1]);
+    }
+    if (settings.connections < 1) settings.connections = 1;
+    if (settings.window < 1) settings.window = 1;
+
+    Vector<string> ports;
+    if (!loadPorts(settings.address, ports)) {
+        cerr << "Error: no server on " << settings.address << ".\n";
+        return 1;
+    }
+
+    Vector<Tally> tallies;
+    for (int i = 0; i < settings.connections; i++) tallies.push_back(Tally());
+    Vector<thread> clients;
+    Clock::time_point start = Clock::now();
+    for (int i = 0; i < settings.connections; i++) {
+        int count = settings.requests / settings.connections +
+                    (i < settings.requests % settings.connections ? 1 : 0);
+        clients.push_back(thread(drive, cref(settings), cref(ports), count,
+                                 settings.seed * 7919u + i, ref(tallies[i])));
+    }
+    for (int i = 0; i < clients.size(); i++) clients[i].join();
+    double seconds = chrono::duration<double>(Clock::now() - start).count();
+
+    Vector<double> all;
+    int failed = 0, booked = 0, broken = 0;
+    for (int i = 0; i < tallies.size(); i++) {
+        for (double us : tallies[i].latencies) all.push_back(us);
+        failed += tallies[i].failed;
+        booked += tallies[i].booked;
+        if (tallies[i].broken) broken++;
+    }
+    Sorting::mergeSort(all, [](double a, double b) { return a < b; });
+
+    printf("%d requests (%s) on %d connections, window %d: %.2f s, %.0f req/s\n",
+           all.size(), settings.op.c_str(), settings.connections, settings.window,
+           seconds, seconds > 0 ? all.size() / seconds : 0.0);
+    printf("latency us: p50 %.0f  p90 %.0f  p99 %.0f  max %.0f\n",
+           percentile(all, 0.50), percentile(all, 0.90), percentile(all, 0.99),
+           all.size() ? all[all.size() - 1] : 0.0);
+    printf("failed %d, booked %d, connections lost %d\n", failed, booked, broken);
+    return broken ? 1 : 0;
+}
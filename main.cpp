@@ -7,9 +7,18 @@
 #include <cmath>
 #include <string>
 #include <iomanip>
+#include <cstdlib>
 
 // Include pathfinding logic
 #include "headers/pathFinding.h"
+#include "headers/landmarks.h"
+#include "headers/transferPatterns.h"
+#include "headers/profileSearch.h"
+#include "headers/latestDeparture.h"
+#include "headers/searchWorker.h"
+#include "headers/timetableFeed.h"
+#include "headers/timetableSnapshots.h"
+#include "headers/sharedTimetable.h"
 
 // Include UI components
 #include "headers/uiHelpers.hpp"
@@ -25,17 +34,140 @@
 
 using namespace std;
 
-int main() {
+// One tab-separated line per itinerary for the batch modes:
+// first departure date and time, total minutes, total cost, ports
+static void printItinerary(const PathFinding::PathResult* itinerary) {
+    const Route& first = itinerary->routes.front();
+    cout << first.date << "\t" << first.deptTime << "\t" << itinerary->totalTime
+         << "\t" << itinerary->totalCost << "\t" << first.startPoint.name;
+    for (const Route& leg : itinerary->routes) {
+        cout << " -> " << leg.dest.name;
+    }
+    cout << "\n";
+}
+
+int main(int argc, char* argv[]) {
+    // Query the timetable another process shared (--share below) without
+    // loading one of its own:
+    //   --shared <segment> <cheapest|fastest> <origin> <destination>
+    if (argc > 5 && string(argv[1]) == "--shared") {
+        SharedTimetable shared;
+        if (!shared.attach(argv[2])) {
+            cerr << "Error: no timetable shared as " << argv[2] << ".\n";
+            return 1;
+        }
+        int origin = shared.findPort(argv[4]);
+        int dest = shared.findPort(argv[5]);
+        if (origin == -1 || dest == -1) {
+            cerr << "Error: unknown port.\n";
+            return 1;
+        }
+
+        PathFinding::PathResult* path = (string(argv[3]) == "fastest")
+            ? shared.findShortestTimePath(origin, dest)
+            : shared.findCheapestPath(origin, dest);
+        if (path->found && path->routes.getSize() > 0) {
+            printItinerary(path);
+        } else {
+            cout << "No itinerary.\n";
+        }
+        delete path;
+        return 0;
+    }
+
     // --- GRAPH SETUP ---
-    Graph graph;
-    graph.addPorts("data/PortCharges.txt");
-    graph.addRoutes("data/Routes.txt");
+    // The first snapshot of the timetable (timetableSnapshots.h)
+    std::shared_ptr<Graph> loaded = std::make_shared<Graph>();
+    loaded->addPorts("data/PortCharges.txt");
+    loaded->addRoutes("data/Routes.txt");
+    loaded->addServices("data/Services.txt");    // optional weekly timetable
 
-    if (graph.size == 0) {
+    if (loaded->size == 0) {
         cerr << "Error: No ports loaded.\n";
         return 1;
     }
 
+    // Precomputed search data: landmark tables for goal-directed searches,
+    // and transfer patterns that answer the route-finding menu without a
+    // search. Offline mode rebuilds them for the current timetable and exits
+    if (argc > 1 && string(argv[1]) == "--preprocess") {
+        Landmarks::prepare(*loaded, "data/landmarks.bin");
+        TransferPatterns::prepare(*loaded, "data/transfer_patterns.bin");
+        cout << "Preprocessed " << loaded->size << " ports\n";
+        return 0;
+    }
+
+    // A normal start only loads them. Missing or stale landmark tables
+    // leave the searches on per-destination bounds, and without transfer
+    // patterns the route-finding menu searches
+    if (!Landmarks::install(*loaded, "data/landmarks.bin")) {
+        cerr << "Note: data/landmarks.bin is missing or out of date; run with --preprocess.\n";
+    }
+    if (!TransferPatterns::install(*loaded, "data/transfer_patterns.bin")) {
+        cerr << "Note: data/transfer_patterns.bin is missing or out of date; run with --preprocess.\n";
+    }
+
+    // Write the timetable into a shared-memory segment that query
+    // processes on this host attach to read-only (sharedTimetable.h):
+    //   --share <segment>      e.g. /oceanroute
+    if (argc > 2 && string(argv[1]) == "--share") {
+        if (!SharedTimetable::publish(*loaded, argv[2])) {
+            cerr << "Error: cannot share the timetable as " << argv[2] << ".\n";
+            return 1;
+        }
+        cout << "Shared " << loaded->size << " ports as " << argv[2] << "\n";
+        return 0;
+    }
+
+    // Batch profile query, one tab-separated line per Pareto option:
+    //   --profile <origin> <destination> <D/M/YYYY> [days]
+    if (argc > 4 && string(argv[1]) == "--profile") {
+        int origin = loaded->findPort(argv[2]);
+        int dest = loaded->findPort(argv[3]);
+        if (origin == -1 || dest == -1) {
+            cerr << "Error: unknown port.\n";
+            return 1;
+        }
+        int days = (argc > 5) ? atoi(argv[5]) : ProfileSearch::DEFAULT_WINDOW_DAYS;
+
+        Arena arena("profile query");
+        Vector<PathFinding::PathResult*> options;
+        ProfileSearch::findProfile(*loaded, origin, dest, argv[4], days, arena, options);
+        for (PathFinding::PathResult* option : options) {
+            printItinerary(option);
+        }
+        return 0;
+    }
+
+    // Latest departure that still arrives by a deadline:
+    //   --latest <origin> <destination> <D/M/YYYY> <HH:MM>
+    if (argc > 5 && string(argv[1]) == "--latest") {
+        int origin = loaded->findPort(argv[2]);
+        int dest = loaded->findPort(argv[3]);
+        if (origin == -1 || dest == -1) {
+            cerr << "Error: unknown port.\n";
+            return 1;
+        }
+
+        PathFinding::PathResult* latest = LatestDeparture::findLatestPath(*loaded, origin, dest, argv[4], argv[5]);
+        if (latest->found) {
+            printItinerary(latest);
+        } else {
+            cout << "No itinerary arrives by then.\n";
+        }
+        delete latest;
+        return 0;
+    }
+
+    // Live delays, cancellations and new sailings, one per line, from a
+    // file that is appended to or a named pipe (timetableFeed.h):
+    //   --feed <path>
+    TimetableFeed feed;
+    if (argc > 2 && string(argv[1]) == "--feed" && !feed.open(argv[2])) {
+        cerr << "Error: cannot open feed " << argv[2] << ".\n";
+        return 1;
+    }
+
     // --- WINDOW SETUP ---
     const unsigned int winW = 1600;
     const unsigned int winH = 900;
@@ -79,7 +211,7 @@ int main() {
     Vector<sf::Text> labels;
     float baseScale = 0.15f;
     
-    PortInitializer::initializePorts(graph, portTexture, font, positions, 
+    PortInitializer::initializePorts(*loaded, portTexture, font, positions, 
                                     portSprites, labels, baseScale);
 
     // --- UI PANEL SETUP ---
@@ -90,16 +222,26 @@ int main() {
     // --- MENU COMPONENTS ---
     MainMenu mainMenu(font);
     RouteFindingMenu routeMenu(font);
-    PreferencesMenu preferencesMenu(graph, font);
-    BookingMenu bookingMenu(graph, font);
+    PreferencesMenu preferencesMenu(*loaded, font);
+    BookingMenu bookingMenu(*loaded, font);
     BoatSimulationMenu boatSimMenu(font);
     MultiLegJourneyMenu multiLegMenu(font);
     
     // Clock for delta time
     sf::Clock clock;
 
+    // Searches read a pinned snapshot of the timetable while the feed
+    // publishes the next one, so neither waits for the other
+    TimetableSnapshots timetable(loaded);
+    loaded.reset();
+
     // --- MAIN LOOP ---
     while (window.isOpen()) {
+        // This frame's timetable; searches started on it keep it for as
+        // long as they run
+        TimetableSnapshots::Snapshot frame = timetable.pin();
+        const Graph& graph = *frame;
+
         sf::Vector2i mousePos = sf::Mouse::getPosition(window);
         sf::Vector2f mouseGlobal = window.mapPixelToCoords(mousePos);
 
@@ -260,6 +402,18 @@ int main() {
             }
         }
 
+        // --- BACKGROUND SEARCHES ---
+        SearchWorker::get().update();
+        routeMenu.update(currentPathResult);
+        bookingMenu.update(currentPathResult);
+
+        // Everything that arrived this frame goes into one new snapshot,
+        // shown from the next frame on
+        Vector<TimetableChange> changes;
+        if (feed.isOpen() && feed.read(changes) > 0) {
+            timetable.update([&](Graph& next) { feed.apply(next, changes, &SearchCache::get()); });
+        }
+
         // --- ANIMATION ---
         uiPanel.updateAnimation();
         boatSimMenu.update(deltaTime, positions);
@@ -354,10 +508,21 @@ int main() {
             multiLegMenu.draw(window, graph, font, mouseGlobal, uiPanel.panelX, winH, winW);
         }
         
+        // Multi-leg tracking starts once its paths are in; the panel is closed by then
+        if (!uiPanel.panelOpen && SearchWorker::get().isBusy(SearchWorker::MULTI_LEG)) {
+            sf::Text searching(searchingText(SearchWorker::get().getProgress(SearchWorker::MULTI_LEG)), font, 20);
+            searching.setFillColor(sf::Color::White);
+            searching.setPosition(20.f, 20.f);
+            window.draw(searching);
+        }
+        
         window.display();
     }
     
     // Cleanup
+    // Stop the search worker first: its jobs read the graph and the menus' data
+    SearchWorker::get().shutdown();
+    
     // Check if currentPathResult is in filteredRoutes or availableRoutes to avoid double deletion
     bool isInFilteredRoutes = false;
     for (auto* route : preferencesMenu.filteredRoutes) {
@@ -0,0 +1,126 @@
+#include <csignal>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include "headers/Graph.hpp"
+#include "headers/landmarks.h"
+#include "headers/transferPatterns.h"
+#include "headers/timetableFeed.h"
+#include "headers/timetableSnapshots.h"
+#include "headers/queryServer.h"
+#include "headers/sharedTimetable.h"
+
+using namespace std;
+
+// The routing engine as a local service, without the window
+// (queryServer.h lists the requests):
+//   server <socket path | port> [workers] [--feed <path>]
+//   server <socket path | port> [workers] --shared <segment>
+//                              answer from a timetable the app shared
+//                              (main --share), mapped rather than loaded
+//   server --preprocess        rebuild the files in data/ and exit, as the app's
+// A port listens on 127.0.0.1 only. Ctrl-C answers what is queued and exits.
+
+static QueryServer* running = nullptr;
+
+static void stopServer(int) {
+    if (running) running->stop();
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        cerr << "Usage: " << argv[0]
+             << " <socket path | port> [workers] [--feed <path> | --shared <segment>] | --preprocess\n";
+        return 1;
+    }
+    string address = argv[1];
+    int workers = (int)thread::hardware_concurrency();
+    string feedPath;
+    string segment;
+    for (int i = 2; i < argc; i++) {
+        if (string(argv[i]) == "--feed" && i + 1 < argc) {
+            feedPath = argv[++i];
+        } else if (string(argv[i]) == "--shared" && i + 1 < argc) {
+            segment = argv[++i];
+        } else {
+            workers = atoi(argv[i]);
+        }
+    }
+    if (workers < 1) workers = 4;
+    signal(SIGINT, stopServer);
+    signal(SIGTERM, stopServer);
+
+    // Every server on the segment maps the same pages; nothing is loaded
+    if (!segment.empty()) {
+        if (!feedPath.empty()) {
+            cerr << "Error: a shared timetable cannot take a feed; apply it where it is shared.\n";
+            return 1;
+        }
+        SharedTimetable shared;
+        if (!shared.attach(segment)) {
+            cerr << "Error: no timetable shared as " << segment << ".\n";
+            return 1;
+        }
+        QueryServer server(shared, workers);
+        running = &server;
+        cout << "Serving " << shared.getPortCount() << " ports shared as " << segment << " on " << address
+             << " with " << workers << " workers\n" << flush;
+        if (!server.run(address)) {
+            cerr << "Error: cannot listen on " << address << ".\n";
+            return 1;
+        }
+        running = nullptr;
+        cout << "Answered " << server.getAnswered() << " requests in "
+             << server.getBatches() << " batches\n";
+        return 0;
+    }
+
+    // Loaded and prepared as by the app (main.cpp)
+    std::shared_ptr<Graph> loaded = std::make_shared<Graph>();
+    loaded->addPorts("data/PortCharges.txt");
+    loaded->addRoutes("data/Routes.txt");
+    loaded->addServices("data/Services.txt");
+    if (loaded->size == 0) {
+        cerr << "Error: No ports loaded.\n";
+        return 1;
+    }
+    if (address == "--preprocess") {
+        Landmarks::prepare(*loaded, "data/landmarks.bin");
+        TransferPatterns::prepare(*loaded, "data/transfer_patterns.bin");
+        cout << "Preprocessed " << loaded->size << " ports\n";
+        return 0;
+    }
+    // Serving never rebuilds the files, so workers and restarts do not
+    // race to rewrite them
+    if (!Landmarks::install(*loaded, "data/landmarks.bin")) {
+        cerr << "Note: data/landmarks.bin is missing or out of date; run with --preprocess.\n";
+    }
+    if (!TransferPatterns::install(*loaded, "data/transfer_patterns.bin")) {
+        cerr << "Note: data/transfer_patterns.bin is missing or out of date; run with --preprocess.\n";
+    }
+
+    TimetableFeed feed;
+    if (!feedPath.empty() && !feed.open(feedPath)) {
+        cerr << "Error: cannot open feed " << feedPath << ".\n";
+        return 1;
+    }
+
+    TimetableSnapshots timetable(loaded);
+    loaded.reset();
+
+    QueryServer server(timetable, workers, feed.isOpen() ? &feed : nullptr);
+    running = &server;
+
+    cout << "Serving " << timetable.pin()->size << " ports on " << address
+         << " with " << workers << " workers\n" << flush;
+    if (!server.run(address)) {
+        cerr << "Error: cannot listen on " << address << ".\n";
+        return 1;
+    }
+    running = nullptr;
+    cout << "Answered " << server.getAnswered() << " requests in "
+         << server.getBatches() << " batches\n";
+    return 0;
+}
@@ -0,0 +1,100 @@
+// Arena (headers/arena.h): alignment, chunk growth and oversized requests,
+// destructors run in reverse on reset, and the largest chunk kept for the
+// next query.
+#include <cstdint>
+#include <string>
+#include "testUtil.h"
+#include "../headers/arena.h"
+#include "../headers/vector.h"
+
+// Records its id in log when destroyed
+struct Tracked {
+    Vector<int>* log;
+    int id;
+    Tracked(Vector<int>* l, int i) : log(l), id(i) {}
+    ~Tracked() { log->push_back(id); }
+};
+
+struct alignas(32) Wide {
+    char bytes[32];
+};
+
+static void alignsEveryAllocation() {
+    Arena arena("test", 256);
+    for (int i = 0; i < 50; i++) {
+        char* c = arena.create<char>('a');
+        CHECK_EQ(*c, 'a');
+        double* d = arena.create<double>(1.5);
+        CHECK_EQ((uintptr_t)d % alignof(double), (uintptr_t)0);
+        Wide* w = arena.create<Wide>();
+        CHECK_EQ((uintptr_t)w % 32, (uintptr_t)0);
+    }
+    int* values = arena.allocateArray<int>(100);
+    for (int i = 0; i < 100; i++) values[i] = i;
+    CHECK_EQ(values[99], 99);
+    CHECK_EQ(arena.getAllocationCount(), 151);
+    CHECK(arena.getChunkCount() > 1);
+}
+
+static void destroysInReverseOnReset() {
+    Vector<int> log;
+    Arena arena("test", 128);
+    for (int i = 0; i < 40; i++) arena.create<Tracked>(&log, i);   // spans chunks
+    // Objects with destructors and without share the arena
+    std::string* s = arena.create<std::string>(100, 'x');
+    CHECK_EQ(s->size(), (size_t)100);
+    CHECK_EQ(log.size(), 0);
+
+    arena.reset();
+    CHECK_EQ(log.size(), 40);
+    bool reversed = true;
+    for (int i = 0; i < log.size(); i++) {
+        if (log[i] != 39 - i) reversed = false;
+    }
+    CHECK(reversed);
+    CHECK_EQ(arena.getBytesUsed(), (size_t)0);
+    CHECK_EQ(arena.getAllocationCount(), 0);
+
+    // Nothing runs twice, neither on a second reset nor on destruction
+    arena.reset();
+    CHECK_EQ(log.size(), 40);
+}
+
+static void keepsLargestChunk() {
+    Arena arena("test", 1024);
+    arena.allocate(100);
+    arena.allocate(4 * 1024 * 1024);   // oversized: a chunk of its own
+    arena.allocate(100);               // next chunk is capped below that
+    CHECK_EQ(arena.getChunkCount(), 3);
+    CHECK(arena.getPeakBytes() >= (size_t)4 * 1024 * 1024);
+
+    arena.reset();
+    CHECK_EQ(arena.getChunkCount(), 1);
+    CHECK_EQ(arena.getPeakBytes(), (size_t)0);
+
+    // The kept chunk is the 4 MB one, so the same query fits without growing
+    arena.allocate(4 * 1024 * 1024);
+    CHECK_EQ(arena.getChunkCount(), 1);
+}
+
+static void reusesMemoryAcrossQueries() {
+    Arena arena("test", 4096);
+    Vector<int> log;
+    for (int query = 0; query < 100; query++) {
+        for (int i = 0; i < 20; i++) {
+            Tracked* t = arena.create<Tracked>(&log, query);
+            CHECK_EQ(t->id, query);
+        }
+        arena.reset();
+    }
+    CHECK_EQ(log.size(), 2000);
+    CHECK_EQ(arena.getChunkCount(), 1);
+}
+
+int main() {
+    alignsEveryAllocation();
+    destroysInReverseOnReset();
+    keepsLargestChunk();
+    reusesMemoryAcrossQueries();
+    return finish("arenaTest");
+}
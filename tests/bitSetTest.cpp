@@ -0,0 +1,131 @@
+// BitSet (headers/bitSet.h) and the compiled route preferences built on it
+// (RouteFilter::compilePreferences): word boundaries, out-of-range ids,
+// subset and union across sizes, and what a compiled filter lets through.
+#include <string>
+#include "testUtil.h"
+#include "../headers/bitSet.h"
+#include "../headers/Graph.hpp"
+#include "../headers/routeFilter.hpp"
+
+static void setTestAcrossWords() {
+    BitSet bits(130);
+    CHECK_EQ(bits.size(), 130);
+    CHECK(!bits.any());
+    int ids[] = { 0, 63, 64, 127, 128, 129 };
+    for (int i : ids) bits.set(i);
+    for (int i : ids) CHECK(bits.test(i));
+    CHECK(!bits.test(1));
+    CHECK(!bits.test(65));
+    CHECK_EQ(bits.count(), 6);
+
+    bits.reset(64);
+    CHECK(!bits.test(64));
+    CHECK_EQ(bits.count(), 5);
+
+    // -1 is how an unknown company id reads; past the end is ignored too
+    CHECK(!bits.test(-1));
+    CHECK(!bits.test(130));
+    bits.set(130);
+    bits.set(-1);
+    CHECK_EQ(bits.count(), 5);
+
+    // Filling keeps the bits past the end clear
+    bits.setAll();
+    CHECK_EQ(bits.count(), 130);
+    CHECK(!bits.test(130));
+    BitSet full(130, true);
+    CHECK(bits == full);
+    bits.clearAll();
+    CHECK(!bits.any());
+    CHECK(bits != full);
+}
+
+static void subsetAndUnionAcrossSizes() {
+    BitSet small(10), large(200);
+    small.set(3);
+    large.set(3);
+    large.set(150);
+    CHECK(small.isSubsetOf(large));
+    CHECK(!large.isSubsetOf(small));   // 150 is past the end of small
+
+    BitSet empty;
+    CHECK(empty.isSubsetOf(small));
+    CHECK(!small.isSubsetOf(empty));
+
+    // Union only keeps what fits
+    BitSet target(70);
+    target |= large;
+    CHECK(target.test(3));
+    CHECK_EQ(target.count(), 1);
+    BitSet wide(200);
+    wide |= small;
+    CHECK(wide.test(3));
+    CHECK_EQ(wide.count(), 1);
+
+    // Bits of a full larger set beyond this size stay out of count()
+    BitSet partial(70);
+    partial |= BitSet(128, true);
+    CHECK_EQ(partial.count(), 70);
+
+    // Equal sets hash alike; the size is part of the identity
+    BitSet a(70), b(70);
+    a.set(5);
+    b.set(5);
+    CHECK_EQ(a.hash(), b.hash());
+    CHECK(a != BitSet(71));
+}
+
+static void compiledPreferences() {
+    Graph graph;
+    graph.addPorts("data/PortCharges.txt");
+    graph.addRoutes("data/Routes.txt");
+    int destination = 3;
+
+    // Nothing picked: every company and port is allowed
+    Vector<std::string> noCompanies;
+    Vector<int> noPorts;
+    RouteFilter::CompiledPreferences all =
+        RouteFilter::compilePreferences(graph, destination, noCompanies, noPorts);
+    CHECK_EQ(all.companies.count(), graph.getCompanyCount());
+    CHECK_EQ(all.ports.count(), graph.size);
+
+    // Pick one company and one layover port; the destination is always allowed
+    const Route* sample = nullptr;
+    for (int i = 0; i < graph.size && !sample; i++) {
+        for (const Route& route : graph.vertices[i].routes) {
+            sample = &route;
+            break;
+        }
+    }
+    CHECK(sample != nullptr);
+    if (!sample) return;
+    Vector<std::string> companies;
+    companies.push_back(sample->company);
+    companies.push_back("No Such Line");   // unknown names are ignored
+    Vector<int> ports;
+    ports.push_back(7);
+    RouteFilter::CompiledPreferences picked =
+        RouteFilter::compilePreferences(graph, destination, companies, ports);
+    CHECK_EQ(picked.companies.count(), 1);
+    CHECK_EQ(picked.ports.count(), 2);
+    CHECK(picked.ports.test(destination));
+    CHECK(picked.companies.isSubsetOf(all.companies));
+
+    CHECK(picked.allows(*sample, 7));
+    CHECK(picked.allows(*sample, destination));
+    CHECK(!picked.allows(*sample, 8));
+    bool otherCompanyBlocked = true;
+    for (int i = 0; i < graph.size; i++) {
+        for (const Route& route : graph.vertices[i].routes) {
+            if (route.company != sample->company && picked(route, 7)) otherCompanyBlocked = false;
+        }
+    }
+    CHECK(otherCompanyBlocked);
+}
+
+int main() {
+    setTestAcrossWords();
+    subsetAndUnionAcrossSizes();
+    compiledPreferences();
+    return finish("bitSetTest");
+}
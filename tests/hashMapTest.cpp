@@ -0,0 +1,176 @@
+// HashMap and HashSet (headers/hashMap.h): insert and overwrite, probing
+// runs that wrap past the end of the table, backward-shift erase, growth,
+// and a randomized run against std::unordered_map.
+#include <random>
+#include <string>
+#include <unordered_map>
+#include "testUtil.h"
+#include "../headers/hashMap.h"
+
+// Sends every key to slot 14 or 15 of a 16-slot table, so runs of
+// collisions wrap round to slot 0
+struct TailHash {
+    size_t operator()(int key) const { return 14 + (key & 1); }
+};
+
+static void insertFindOverwrite() {
+    HashMap<std::string, int> map;
+    CHECK(map.empty());
+    CHECK(map.find("Dubai") == nullptr);
+    CHECK(map.insert("Dubai", 1));
+    CHECK(map.insert("Oslo", 2));
+    CHECK(!map.insert("Dubai", 3));   // overwrites
+    CHECK_EQ(map.size(), 2);
+    CHECK_EQ(map.at("Dubai"), 3);
+    CHECK_EQ(*map.find("Oslo"), 2);
+    CHECK_THROWS(map.at("Lisbon"), std::out_of_range);
+
+    map["Lisbon"] += 5;   // default-constructed first
+    CHECK_EQ(map.at("Lisbon"), 5);
+    CHECK_EQ(map.size(), 3);
+    CHECK(map.contains("Lisbon"));
+}
+
+static void wrapAroundAndBackwardShift() {
+    HashMap<int, int, TailHash> map;
+    // 0, 2, 4 start at slot 14; 1, 3 at slot 15. In insertion order they
+    // fill 14, 15, 0, 1, 2
+    int keys[] = { 0, 1, 2, 3, 4 };
+    for (int k : keys) map.insert(k, k * 10);
+    CHECK_EQ(map.size(), 5);
+    for (int k : keys) {
+        CHECK(map.find(k) != nullptr);
+        if (map.find(k)) CHECK_EQ(*map.find(k), k * 10);
+    }
+
+    // Emptying slot 14 has to pull the run back across the wrap, or 2, 3
+    // and 4 would sit behind an empty slot and vanish from lookups
+    CHECK(map.erase(0));
+    CHECK(!map.erase(0));
+    CHECK(!map.contains(0));
+    for (int k = 1; k <= 4; k++) CHECK(map.contains(k));
+
+    // Slot 0 now holds a key whose home is 15; erasing 1 at slot 15 must
+    // move it back there, past the end of the table
+    CHECK(map.erase(1));
+    for (int k = 2; k <= 4; k++) {
+        CHECK(map.find(k) != nullptr);
+        if (map.find(k)) CHECK_EQ(*map.find(k), k * 10);
+    }
+
+    // Erasing from the middle of the wrapped run
+    CHECK(map.erase(3));
+    CHECK(map.contains(2));
+    CHECK(map.contains(4));
+    CHECK_EQ(map.size(), 2);
+
+    // A key absent from a run that wraps is still reported missing
+    CHECK(!map.contains(6));
+    CHECK(!map.erase(7));
+
+    int seen = 0;
+    for (auto& e : map) seen += e.key;
+    CHECK_EQ(seen, 6);
+}
+
+static void growthKeepsEverything() {
+    HashMap<int, int> map;
+    for (int i = 0; i < 1000; i++) map.insert(i, -i);
+    CHECK_EQ(map.size(), 1000);
+    bool all = true;
+    for (int i = 0; i < 1000; i++) {
+        const int* v = map.find(i);
+        if (!v || *v != -i) all = false;
+    }
+    CHECK(all);
+
+    // clear keeps the table; everything is gone and it can refill
+    map.clear();
+    CHECK(map.empty());
+    CHECK(!map.contains(5));
+    map.insert(5, 1);
+    CHECK_EQ(map.at(5), 1);
+}
+
+static void matchesUnorderedMap() {
+    std::mt19937 rng(7);
+    HashMap<long long, int> map;
+    std::unordered_map<long long, int> reference;
+    // Small key range, so inserts, overwrites and erases all collide often
+    for (int step = 0; step < 50000; step++) {
+        long long key = rng() % 300;
+        int op = rng() % 3;
+        if (op == 0) {
+            bool fresh = reference.find(key) == reference.end();
+            CHECK_EQ(map.insert(key, step), fresh);
+            reference[key] = step;
+        } else if (op == 1) {
+            CHECK_EQ(map.erase(key), reference.erase(key) == 1);
+        } else {
+            const int* v = map.find(key);
+            auto it = reference.find(key);
+            CHECK_EQ(v != nullptr, it != reference.end());
+            if (v && it != reference.end()) CHECK_EQ(*v, it->second);
+        }
+    }
+    CHECK_EQ(map.size(), (int)reference.size());
+    int visited = 0;
+    for (auto& e : map) {
+        visited++;
+        CHECK_EQ(e.value, reference[e.key]);
+    }
+    CHECK_EQ(visited, (int)reference.size());
+}
+
+static void copyAndMove() {
+    HashMap<std::string, std::string> map;
+    map.insert("a", "1");
+    map.insert("b", "2");
+
+    HashMap<std::string, std::string> copy(map);
+    copy.insert("a", "changed");
+    CHECK_EQ(map.at("a"), std::string("1"));
+    CHECK_EQ(copy.at("a"), std::string("changed"));
+
+    HashMap<std::string, std::string> moved(std::move(copy));
+    CHECK_EQ(moved.size(), 2);
+    CHECK(copy.empty());
+    CHECK(!copy.contains("a"));
+    copy.insert("c", "3");   // usable after being moved from
+    CHECK_EQ(copy.size(), 1);
+
+    map = moved;
+    CHECK_EQ(map.at("a"), std::string("changed"));
+    map = std::move(moved);
+    CHECK_EQ(map.size(), 2);
+}
+
+static void hashSet() {
+    HashSet<std::string> set;
+    CHECK(set.insert("Mon"));
+    CHECK(set.insert("Tue"));
+    CHECK(!set.insert("Mon"));
+    CHECK_EQ(set.size(), 2);
+    CHECK(set.contains("Tue"));
+    CHECK(set.erase("Tue"));
+    CHECK(!set.contains("Tue"));
+    int count = 0;
+    for (const std::string& s : set) {
+        count++;
+        CHECK_EQ(s, std::string("Mon"));
+    }
+    CHECK_EQ(count, 1);
+
+    set.reserve(500);
+    CHECK(set.contains("Mon"));
+}
+
+int main() {
+    insertFindOverwrite();
+    wrapAroundAndBackwardShift();
+    growthKeepsEverything();
+    matchesUnorderedMap();
+    copyAndMove();
+    hashSet();
+    return finish("hashMapTest");
+}
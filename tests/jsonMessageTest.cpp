@@ -0,0 +1,125 @@
+// JsonMessage (headers/jsonMessage.h): flat objects with strings, numbers,
+// literals and arrays parse, escapes decode, deeper values are kept as
+// their text, malformed lines are refused, and what appendString writes
+// reads back unchanged.
+#include <string>
+#include "testUtil.h"
+#include "../headers/jsonMessage.h"
+
+static void requests() {
+    JsonMessage m;
+    CHECK(m.parse("{\"id\":7,\"op\":\"filtered\",\"origin\":\"Durban\",\"destination\":\"Marseille\","
+                  "\"companies\":[\"MSC\",\"PIL\"],\"ports\":[],\"limit\":3,\"exact\":true,\"note\":null}"));
+    CHECK(m.getString("op") == "filtered");
+    CHECK(m.getString("id") == "7");
+    CHECK_EQ(m.getNumber("id"), 7LL);
+    CHECK_EQ(m.getNumber("limit", 5), 3LL);
+    CHECK(m.getString("exact") == "true");
+    CHECK(m.getString("note") == "null");
+    CHECK_EQ(m.getList("companies").size(), 2);
+    CHECK(m.getList("companies")[1] == "PIL");
+    CHECK(m.has("ports"));
+    CHECK_EQ(m.getList("ports").size(), 0);
+
+    // Missing keys fall back; a second parse forgets the first
+    CHECK(m.getString("missing", "x") == "x");
+    CHECK_EQ(m.getList("missing").size(), 0);
+    CHECK(m.parse(" { \"op\" : \"ports\" } "));
+    CHECK(m.getString("op") == "ports");
+    CHECK(!m.has("id"));
+    CHECK(!m.has("companies"));
+    CHECK(m.parse("{}"));
+    CHECK(!m.has("op"));
+}
+
+static void numbers() {
+    JsonMessage m;
+    CHECK(m.parse("{\"a\":-12,\"b\":5.7,\"c\":\"abc\",\"d\":\"\",\"e\":12abc}"));
+    CHECK_EQ(m.getNumber("a"), -12LL);
+    CHECK_EQ(m.getNumber("b"), 5LL);
+    CHECK_EQ(m.getNumber("c", 9), 9LL);
+    CHECK_EQ(m.getNumber("d", 9), 9LL);
+    CHECK_EQ(m.getNumber("e", 9), 9LL);
+    CHECK_EQ(m.getNumber("missing", 9), 9LL);
+}
+
+static void escapes() {
+    JsonMessage m;
+    CHECK(m.parse("{\"s\":\"a\\\"b\\\\c\\/d\\n\\t\",\"u\":\"\\u00e9\\u20AC\\u0041\"}"));
+    CHECK(m.getString("s") == "a\"b\\c/d\n\t");
+    CHECK(m.getString("u") == "\xC3\xA9\xE2\x82\xAC" "A");
+}
+
+// Objects and arrays below the top level come back as written
+static void nested() {
+    JsonMessage m;
+    CHECK(m.parse("{\"a\":{\"b\":[1,2],\"c\":\"}]\"},\"list\":[[1,2],{\"k\":\"v\"},\"x\"],\"z\":1}"));
+    CHECK(m.getString("a") == "{\"b\":[1,2],\"c\":\"}]\"}");
+    const Vector<std::string>& list = m.getList("list");
+    CHECK_EQ(list.size(), 3);
+    if (list.size() == 3) {
+        CHECK(list[0] == "[1,2]");
+        CHECK(list[1] == "{\"k\":\"v\"}");
+        CHECK(list[2] == "x");
+    }
+    CHECK_EQ(m.getNumber("z"), 1LL);
+}
+
+static void malformed() {
+    const char* lines[] = {
+        "",
+        "[]",
+        "{",
+        "{\"a\":1",
+        "{\"a\":}",
+        "{\"a\" 1}",
+        "{a:1}",
+        "{\"a\":1,}",
+        "{\"a\":1 \"b\":2}",
+        "{\"a\":\"x}",
+        "{\"a\":\"\\q\"}",
+        "{\"a\":\"\\u12\"}",
+        "{\"a\":\"\\u12zz\"}",
+        "{\"a\":[1,2}",
+        "{\"a\":[1,,2]}",
+        "{\"a\":{\"b\":1}",
+    };
+    JsonMessage m;
+    int accepted = 0;
+    for (const char* line : lines) {
+        if (m.parse(line)) {
+            accepted++;
+            std::cerr << "accepted: " << line << "\n";
+        }
+    }
+    CHECK_EQ(accepted, 0);
+}
+
+static void writing() {
+    const std::string text = std::string("say \"hi\"\\ \n\r\t") + '\x01' + "\xC3\xA9";
+    std::string out = "{";
+    JsonMessage::appendField(out, "text", text);
+    out += ',';
+    JsonMessage::appendField(out, "count", -3LL);
+    out += ',';
+    JsonMessage::appendFlag(out, "ok", true);
+    out += '}';
+    CHECK(out.find('\n') == std::string::npos);
+    CHECK(out.find("\\u0001") != std::string::npos);
+
+    JsonMessage m;
+    CHECK(m.parse(out));
+    CHECK(m.getString("text") == text);
+    CHECK_EQ(m.getNumber("count"), -3LL);
+    CHECK(m.getString("ok") == "true");
+}
+
+int main() {
+    requests();
+    numbers();
+    escapes();
+    nested();
+    malformed();
+    writing();
+    return finish("jsonMessageTest");
+}
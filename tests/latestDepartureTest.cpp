@@ -0,0 +1,130 @@
+// LatestDeparture (headers/latestDeparture.h): on a small generated grid
+// and on data/, the latest departure from every port towards every target
+// equals the latest first departure of any simple itinerary that makes
+// the deadline, found by a brute-force walk, and the itinerary
+// findLatestPath builds leaves then and arrives in time.
+#include <fstream>
+#include <string>
+#include "testUtil.h"
+#include "../headers/Graph.hpp"
+#include "../headers/pathFinding.h"
+#include "../headers/latestDeparture.h"
+#include "../headers/connections.h"
+
+// side x side ports, sailings both ways between neighbours twice a day
+// for three days
+static void writeGrid(int side, const std::string& portsFile, const std::string& routesFile) {
+    std::ofstream ports(portsFile);
+    for (int p = 0; p < side * side; p++) ports << "T" << p << " " << 300 + (p * 97) % 500 << "\n";
+    std::ofstream routes(routesFile);
+    const char* departs[] = { "02:00", "14:00" };
+    const char* arrives[] = { "09:00", "21:00" };
+    for (int p = 0; p < side * side; p++) {
+        int r = p / side, c = p % side;
+        const int next[] = { c + 1 < side ? p + 1 : -1, r + 1 < side ? p + side : -1,
+                             c > 0 ? p - 1 : -1, r > 0 ? p - side : -1 };
+        for (int q : next) {
+            if (q < 0) continue;
+            for (int day = 1; day <= 3; day++) {
+                for (int s = 0; s < 2; s++) {
+                    routes << "T" << p << " T" << q << " " << day << "/12/2024 " << departs[s] << " "
+                           << arrives[s] << " 1000 Grid\n";
+                }
+            }
+        }
+    }
+}
+
+// Whether some simple itinerary from port reaches target by deadline,
+// having arrived at port at arrival
+static bool reaches(const Graph& graph, int port, int target, long long arrival, long long deadline,
+                    Vector<bool>& onPath) {
+    if (port == target) return true;
+    const DepartureIndex& departures = Connections::byPort(graph);
+    onPath[port] = true;
+    bool found = false;
+    for (int i = departures.begin(port); i < departures.end(port) && !found; i++) {
+        const Connection& conn = departures.sailings[i];
+        if (onPath[conn.to] || conn.departure - arrival < 60 || conn.arrival > deadline) continue;
+        found = reaches(graph, conn.to, target, conn.arrival, deadline, onPath);
+    }
+    onPath[port] = false;
+    return found;
+}
+
+static long long bruteForce(const Graph& graph, int start, int target, long long deadline) {
+    long long latest = LatestDeparture::NONE;
+    Vector<bool> onPath;
+    onPath.resize(graph.size);
+    onPath[start] = true;
+    const DepartureIndex& departures = Connections::byPort(graph);
+    for (int i = departures.begin(start); i < departures.end(start); i++) {
+        const Connection& conn = departures.sailings[i];
+        if (conn.departure <= latest || conn.arrival > deadline) continue;
+        if (reaches(graph, conn.to, target, conn.arrival, deadline, onPath)) latest = conn.departure;
+    }
+    return latest;
+}
+
+// The legs chain with an hour's layover, leave at the label and land by
+// the deadline
+static bool consistent(const Graph& graph, const LatestDepartures& labels, int start) {
+    PathFinding::PathResult* path = LatestDeparture::findLatestPath(graph, labels, start);
+    bool ok = path->found && !path->routes.isEmpty();
+    if (ok) {
+        long long arrival = LLONG_MIN;
+        std::string at = graph.vertices[start].port.name;
+        bool first = true;
+        for (const Route& leg : path->routes) {
+            long long departure = TimeUtils::toAbsoluteMinutes(leg.date, leg.deptTime);
+            if (first && departure != labels.departure[start]) ok = false;
+            if (!first && departure - arrival < 60) ok = false;
+            if (leg.startPoint.name != at) ok = false;
+            arrival = TimeUtils::absoluteArrivalMinutes(leg.date, leg.deptTime, leg.date, leg.arrTime);
+            at = leg.dest.name;
+            first = false;
+        }
+        if (at != graph.vertices[labels.target].port.name || arrival > labels.deadline) ok = false;
+    }
+    delete path;
+    return ok;
+}
+
+static int mismatches(const Graph& graph, long long deadline) {
+    int wrong = 0;
+    LatestDepartures labels;
+    for (int target = 0; target < graph.size; target++) {
+        LatestDeparture::search(graph, target, deadline, labels);
+        for (int s = 0; s < graph.size; s++) {
+            if (s == target) continue;
+            if (labels.departure[s] != bruteForce(graph, s, target, deadline)) wrong++;
+            if (labels.departure[s] != LatestDeparture::NONE && !consistent(graph, labels, s)) wrong++;
+        }
+    }
+    return wrong;
+}
+
+int main() {
+    writeGrid(4, "tests/bin/latest_ports.txt", "tests/bin/latest_routes.txt");
+    Graph grid;
+    grid.addPorts("tests/bin/latest_ports.txt");
+    grid.addRoutes("tests/bin/latest_routes.txt");
+    CHECK_EQ(mismatches(grid, TimeUtils::toAbsoluteMinutes("3/12/2024", "21:00")), 0);
+    CHECK_EQ(mismatches(grid, TimeUtils::toAbsoluteMinutes("2/12/2024", "12:00")), 0);
+
+    Graph data;
+    data.addPorts("data/PortCharges.txt");
+    data.addRoutes("data/Routes.txt");
+    CHECK_EQ(mismatches(data, TimeUtils::toAbsoluteMinutes("20/12/2024", "12:00")), 0);
+    CHECK_EQ(mismatches(data, LatestDeparture::NO_DEADLINE), 0);
+
+    // A deadline before every sailing leaves no port able to make it
+    LatestDepartures labels;
+    LatestDeparture::search(data, 0, TimeUtils::toAbsoluteMinutes("1/1/2000", "00:00"), labels);
+    int reached = 0;
+    for (int s = 0; s < data.size; s++) {
+        if (labels.departure[s] != LatestDeparture::NONE) reached++;
+    }
+    CHECK_EQ(reached, 0);
+    return finish("latestDepartureTest");
+}
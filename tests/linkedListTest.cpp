@@ -0,0 +1,142 @@
+// LinkedList and its NodePool (headers/linkedList.h, headers/nodePool.h):
+// order, copies, moves, removal and how many allocations a list makes.
+#include <cstdlib>
+#include <new>
+#include <string>
+#include <utility>
+#include "testUtil.h"
+#include "../headers/linkedList.h"
+
+// Every allocation in the program goes through these, so a test can count
+// what a list asks the system for
+static int allocations = 0;
+
+void* operator new(std::size_t bytes) {
+    allocations++;
+    void* p = std::malloc(bytes ? bytes : 1);
+    if (!p) throw std::bad_alloc();
+    return p;
+}
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+
+static std::string joined(const LinkedList<int>& list) {
+    std::string s;
+    for (int v : list) s += std::to_string(v) + ",";
+    return s;
+}
+
+static void orderAndAccess() {
+    LinkedList<int> list;
+    CHECK(list.isEmpty());
+    CHECK_THROWS(list.front(), std::out_of_range);
+    list.insertEnd(2);
+    list.insertEnd(3);
+    list.insertFront(1);
+    CHECK_EQ(joined(list), std::string("1,2,3,"));
+    CHECK_EQ(list.front(), 1);
+    CHECK_EQ(list.back(), 3);
+    CHECK_EQ(list.get(1), 2);
+    CHECK_EQ(list.getSize(), 3);
+    CHECK_THROWS(list.get(3), std::out_of_range);
+}
+
+static void copiesAreDeepMovesSteal() {
+    LinkedList<int> a;
+    for (int i = 0; i < 5; i++) a.insertEnd(i);
+    LinkedList<int> b(a);
+    b.front() = 9;
+    CHECK_EQ(a.front(), 0);
+    CHECK_EQ(joined(b), std::string("9,1,2,3,4,"));
+
+    LinkedList<int> c(std::move(a));
+    CHECK(a.isEmpty());
+    CHECK_EQ(joined(c), std::string("0,1,2,3,4,"));
+
+    // Nodes of the moved-from pool must keep working in their new owner
+    c.insertEnd(5);
+    b = c;
+    CHECK_EQ(joined(b), std::string("0,1,2,3,4,5,"));
+    b = std::move(c);
+    CHECK_EQ(b.getSize(), 6);
+    CHECK(c.isEmpty());
+    c.insertEnd(1);
+    CHECK_EQ(joined(c), std::string("1,"));
+}
+
+static void removeRelinks() {
+    LinkedList<int> list;
+    for (int i = 0; i < 4; i++) list.insertEnd(i);
+    CHECK(list.remove(&list.back()));
+    CHECK_EQ(list.back(), 2);
+    CHECK(list.remove(&list.front()));
+    CHECK_EQ(joined(list), std::string("1,2,"));
+    int outside = 1;
+    CHECK(!list.remove(&outside));
+    list.insertEnd(7);  // tail was relinked
+    CHECK_EQ(joined(list), std::string("1,2,7,"));
+}
+
+static void allocationCounts() {
+    // A one-element list makes one allocation: a one-node slab
+    int before = allocations;
+    {
+        LinkedList<int> list;
+        list.insertEnd(1);
+    }
+    CHECK_EQ(allocations - before, 1);
+
+    // A reserved list is one slab however long it is
+    before = allocations;
+    {
+        LinkedList<int> list;
+        list.reserve(50);
+        for (int i = 0; i < 50; i++) list.insertEnd(i);
+        CHECK_EQ(allocations - before, 1);
+
+        // So is a copy of it
+        before = allocations;
+        LinkedList<int> copy(list);
+        CHECK_EQ(allocations - before, 1);
+        CHECK_EQ(copy.getSize(), 50);
+
+        // Cleared nodes are reused by the next inserts
+        before = allocations;
+        list.clear();
+        for (int i = 0; i < 50; i++) list.insertFront(i);
+        CHECK_EQ(allocations - before, 0);
+    }
+
+    // Unreserved growth doubles the slabs: 1+2+4+...+64 covers 100 nodes
+    before = allocations;
+    {
+        LinkedList<int> list;
+        for (int i = 0; i < 100; i++) list.insertEnd(i);
+    }
+    CHECK_EQ(allocations - before, 7);
+}
+
+static void reserveKeepsSpareNodes() {
+    LinkedList<std::string> list;
+    list.insertEnd("a");
+    list.insertEnd("b");        // second slab of 2, one node spare
+    int before = allocations;
+    list.reserve(3);            // the spare node is enough
+    list.insertEnd("c");
+    CHECK_EQ(allocations - before, 0);
+    list.reserve(10);           // one slab of exactly the 7 missing
+    before = allocations;
+    for (int i = 0; i < 7; i++) list.insertEnd(std::string(1, 'd' + i));
+    CHECK_EQ(allocations - before, 0);
+    CHECK_EQ(list.getSize(), 10);
+    CHECK_EQ(list.back(), std::string("j"));
+}
+
+int main() {
+    orderAndAccess();
+    copiesAreDeepMovesSteal();
+    removeRelinks();
+    allocationCounts();
+    reserveKeepsSpareNodes();
+    return finish("linkedListTest");
+}
@@ -0,0 +1,138 @@
+// PathEnumerator (headers/pathEnumerator.h): on a small generated grid it
+// returns every simple itinerary a brute-force walk finds, cheapest first,
+// and with a limit K (cutoff and dominance pruning) the first K costs of
+// the unlimited enumeration, on the grid and for every pair of data/.
+#include <algorithm>
+#include <fstream>
+#include <string>
+#include "testUtil.h"
+#include "../headers/Graph.hpp"
+#include "../headers/pathFinding.h"
+#include "../headers/pathEnumerator.h"
+#include "../headers/connections.h"
+#include "../headers/arena.h"
+
+// side x side ports, sailings both ways between neighbours twice a day
+// for three days, at costs that vary by leg so few itineraries tie
+static void writeGrid(int side, const std::string& portsFile, const std::string& routesFile) {
+    std::ofstream ports(portsFile);
+    for (int p = 0; p < side * side; p++) ports << "T" << p << " " << 300 + (p * 97) % 500 << "\n";
+    std::ofstream routes(routesFile);
+    const char* departs[] = { "02:00", "14:00" };
+    const char* arrives[] = { "09:00", "21:00" };
+    for (int p = 0; p < side * side; p++) {
+        int r = p / side, c = p % side;
+        const int next[] = { c + 1 < side ? p + 1 : -1, r + 1 < side ? p + side : -1,
+                             c > 0 ? p - 1 : -1, r > 0 ? p - side : -1 };
+        for (int q : next) {
+            if (q < 0) continue;
+            for (int day = 1; day <= 3; day++) {
+                for (int s = 0; s < 2; s++) {
+                    routes << "T" << p << " T" << q << " " << day << "/12/2024 " << departs[s] << " "
+                           << arrives[s] << " " << 1000 + (p * 31 + q * 17 + day * 7 + s * 13) % 900 << " Grid\n";
+                }
+            }
+        }
+    }
+}
+
+// Costs of every simple itinerary from port to destination
+static void walk(const Graph& graph, int port, int destination, bool atOrigin, int cost, long long arrival,
+                 Vector<bool>& onPath, Vector<int>& costs) {
+    if (port == destination) {
+        costs.push_back(cost);
+        return;
+    }
+    const DepartureIndex& departures = Connections::byPort(graph);
+    onPath[port] = true;
+    for (int i = departures.begin(port); i < departures.end(port); i++) {
+        const Connection& conn = departures.sailings[i];
+        if (onPath[conn.to]) continue;
+        int next = PathFinding::cheapestLegCost(graph, conn, atOrigin, cost, arrival);
+        if (next == INT_MAX) continue;
+        walk(graph, conn.to, destination, false, next, conn.arrival, onPath, costs);
+    }
+    onPath[port] = false;
+}
+
+static Vector<int> enumerate(const Graph& graph, int a, int b, int limit, int results) {
+    PathEnumerator<> enumerator(graph, a, b, PathFinding::AllowAll(), "", 1, limit);
+    Arena arena("test");
+    Vector<PathFinding::PathResult*> out;
+    enumerator.run(SearchBudget(results), arena, out);
+    Vector<int> costs;
+    for (PathFinding::PathResult* p : out) costs.push_back(p->totalCost);
+    return costs;
+}
+
+static bool sameCosts(const Vector<int>& a, const Vector<int>& b) {
+    if (a.size() != b.size()) return false;
+    for (int i = 0; i < a.size(); i++) {
+        if (a[i] != b[i]) return false;
+    }
+    return true;
+}
+
+static bool nondecreasing(const Vector<int>& costs) {
+    for (int i = 1; i < costs.size(); i++) {
+        if (costs[i] < costs[i - 1]) return false;
+    }
+    return true;
+}
+
+static void matchesBruteForce(const Graph& grid) {
+    int wrong = 0;
+    int pairs[][2] = { { 0, 15 }, { 5, 10 }, { 3, 12 }, { 1, 14 }, { 0, 1 } };
+    for (auto& pair : pairs) {
+        Vector<bool> onPath;
+        onPath.resize(grid.size);
+        Vector<int> expected;
+        walk(grid, pair[0], pair[1], true, 0, 0, onPath, expected);
+        std::sort(expected.begin(), expected.end());
+
+        Vector<int> all = enumerate(grid, pair[0], pair[1], 0, 0);
+        if (!sameCosts(all, expected) || !nondecreasing(all)) wrong++;
+    }
+    CHECK_EQ(wrong, 0);
+}
+
+// The limited enumeration returns the unlimited one's first K costs
+static int limitedMismatches(const Graph& graph, int a, int b) {
+    const int limits[] = { 1, 5, 15 };
+    int wrong = 0;
+    Vector<int> all = enumerate(graph, a, b, 0, 15);
+    for (int limit : limits) {
+        Vector<int> limited = enumerate(graph, a, b, limit, 0);
+        Vector<int> first;
+        for (int i = 0; i < all.size() && i < limit; i++) first.push_back(all[i]);
+        if (!sameCosts(limited, first)) wrong++;
+    }
+    return wrong;
+}
+
+int main() {
+    writeGrid(4, "tests/bin/enumerator_ports.txt", "tests/bin/enumerator_routes.txt");
+    Graph grid;
+    grid.addPorts("tests/bin/enumerator_ports.txt");
+    grid.addRoutes("tests/bin/enumerator_routes.txt");
+    matchesBruteForce(grid);
+    int wrong = 0;
+    for (int a = 0; a < grid.size; a++) {
+        for (int b = 0; b < grid.size; b++) {
+            if (a != b) wrong += limitedMismatches(grid, a, b);
+        }
+    }
+    CHECK_EQ(wrong, 0);
+
+    Graph data;
+    data.addPorts("data/PortCharges.txt");
+    data.addRoutes("data/Routes.txt");
+    wrong = 0;
+    for (int a = 0; a < data.size; a++) {
+        for (int b = 0; b < data.size; b++) {
+            if (a != b) wrong += limitedMismatches(data, a, b);
+        }
+    }
+    CHECK_EQ(wrong, 0);
+    return finish("pathEnumeratorTest");
+}
@@ -0,0 +1,119 @@
+// PathFinding's A* mode (headers/pathFinding.h, headers/priorityQueue.h):
+// guided searches give the plain searches' answers on data/, also when
+// time plus bound no longer fits in an int; a SearchControl sees progress
+// and a cancelled one stops the search.
+#include <climits>
+#include "testUtil.h"
+#include "../headers/Graph.hpp"
+#include "../headers/pathFinding.h"
+#include "../headers/lowerBounds.h"
+#include "../headers/priorityQueue.h"
+
+// The same bound for every port: the keys shift by a constant, so the
+// order (and the answer) must not change, but the sum passes INT_MAX
+struct FlatHeuristic {
+    int cost(int) const { return 0; }
+    int time(int) const { return INT_MAX - 1; }
+};
+
+static void longLongPriorities() {
+    PriorityQueue<int, long long> pq;
+    pq.push(1, 3000000000ll);
+    pq.push(2, 5);
+    pq.push(3, 3000000000ll);
+    pq.push(4, -3000000000ll);
+    CHECK_EQ(pq.topPriority(), -3000000000ll);
+    CHECK_EQ(pq.pop(), 4);
+    CHECK_EQ(pq.pop(), 2);
+    CHECK_EQ(pq.pop(), 1);   // equal keys in push order
+    CHECK_EQ(pq.pop(), 3);
+    CHECK(pq.isEmpty());
+}
+
+static void guidedMatchesPlain(const Graph& graph) {
+    int mismatches = 0;
+    for (int a = 0; a < graph.size; a++) {
+        for (int b = 0; b < graph.size; b++) {
+            if (a == b) continue;
+            BoundsHeuristic bounds(LowerBounds::forDestination(graph, b));
+            PathFinding::PathResult* plain = PathFinding::findShortestTimePath(graph, a, b);
+            PathFinding::PathResult* guided = PathFinding::findShortestTimePath(
+                graph, a, b, PathFinding::AllowAll(), bounds);
+            PathFinding::PathResult* flat = PathFinding::findShortestTimePath(
+                graph, a, b, PathFinding::AllowAll(), FlatHeuristic());
+            if (plain->found != guided->found || plain->totalTime != guided->totalTime ||
+                plain->found != flat->found || plain->totalTime != flat->totalTime) {
+                mismatches++;
+            }
+            delete plain;
+            delete guided;
+            delete flat;
+
+            plain = PathFinding::findCheapestPath(graph, a, b);
+            guided = PathFinding::findCheapestPath(graph, a, b, PathFinding::AllowAll(), bounds);
+            if (plain->found != guided->found || plain->totalCost != guided->totalCost) mismatches++;
+            delete plain;
+            delete guided;
+        }
+    }
+    CHECK_EQ(mismatches, 0);
+}
+
+static void cancellation(const Graph& graph) {
+    // The pair whose search settles the most ports
+    int from = 0, to = 1, most = 0;
+    for (int a = 0; a < graph.size; a++) {
+        for (int b = 0; b < graph.size; b++) {
+            if (a == b) continue;
+            PathFinding::PathResult* r = PathFinding::findCheapestPath(graph, a, b);
+            if (r->found && r->nodesSettled > most) {
+                most = r->nodesSettled;
+                from = a;
+                to = b;
+            }
+            delete r;
+        }
+    }
+    CHECK(most > 2);
+
+    const PathFinding::AllowAll any;
+    const PathFinding::NoHeuristic none;
+    for (int fastest = 0; fastest < 2; fastest++) {
+        PathFinding::PathResult* plain = fastest ? PathFinding::findShortestTimePath(graph, from, to)
+                                                 : PathFinding::findCheapestPath(graph, from, to);
+        // Watched but left alone: the same answer, one step per port
+        // settled (but the destination)
+        SearchControl watching;
+        PathFinding::PathResult* watched = fastest
+            ? PathFinding::findShortestTimePath(graph, from, to, any, none, &watching)
+            : PathFinding::findCheapestPath(graph, from, to, any, none, &watching);
+        CHECK_EQ(watched->found, plain->found);
+        CHECK_EQ(watched->totalCost, plain->totalCost);
+        CHECK_EQ(watched->totalTime, plain->totalTime);
+        CHECK(watching.getProgress() > 0);
+        CHECK(watching.getProgress() >= watched->nodesSettled - 1 && watching.getProgress() <= watched->nodesSettled);
+
+        // Cancelled: stops at the first port and reports nothing
+        SearchControl cancelled;
+        cancelled.cancel();
+        PathFinding::PathResult* stopped = fastest
+            ? PathFinding::findShortestTimePath(graph, from, to, any, none, &cancelled)
+            : PathFinding::findCheapestPath(graph, from, to, any, none, &cancelled);
+        CHECK(!stopped->found);
+        CHECK(stopped->routes.isEmpty());
+        CHECK_EQ(stopped->nodesSettled, 1);
+        delete plain;
+        delete watched;
+        delete stopped;
+    }
+}
+
+int main() {
+    Graph graph;
+    graph.addPorts("data/PortCharges.txt");
+    graph.addRoutes("data/Routes.txt");
+    longLongPriorities();
+    guidedMatchesPlain(graph);
+    cancellation(graph);
+    return finish("pathFindingTest");
+}
@@ -0,0 +1,156 @@
+// ProfileSearch (headers/profileSearch.h): for every pair of a small
+// generated grid and of data/, the options a date window returns are the
+// Pareto set (later departure, earlier arrival, lower cost) of every simple
+// itinerary a brute-force walk finds leaving in that window.
+#include <algorithm>
+#include <fstream>
+#include <string>
+#include "testUtil.h"
+#include "../headers/Graph.hpp"
+#include "../headers/pathFinding.h"
+#include "../headers/profileSearch.h"
+#include "../headers/connections.h"
+#include "../headers/arena.h"
+
+// side x side ports, sailings both ways between neighbours twice a day
+// for three days, at costs that vary by leg so few itineraries tie
+static void writeGrid(int side, const std::string& portsFile, const std::string& routesFile) {
+    std::ofstream ports(portsFile);
+    for (int p = 0; p < side * side; p++) ports << "T" << p << " " << 300 + (p * 97) % 500 << "\n";
+    std::ofstream routes(routesFile);
+    const char* departs[] = { "02:00", "14:00" };
+    const char* arrives[] = { "09:00", "21:00" };
+    for (int p = 0; p < side * side; p++) {
+        int r = p / side, c = p % side;
+        const int next[] = { c + 1 < side ? p + 1 : -1, r + 1 < side ? p + side : -1,
+                             c > 0 ? p - 1 : -1, r > 0 ? p - side : -1 };
+        for (int q : next) {
+            if (q < 0) continue;
+            for (int day = 1; day <= 3; day++) {
+                for (int s = 0; s < 2; s++) {
+                    routes << "T" << p << " T" << q << " " << day << "/12/2024 " << departs[s] << " "
+                           << arrives[s] << " " << 1000 + (p * 31 + q * 17 + day * 7 + s * 13) % 900 << " Grid\n";
+                }
+            }
+        }
+    }
+}
+
+struct Option {
+    long long departure;
+    long long arrival;
+    int cost;
+
+    bool operator<(const Option& other) const {
+        if (departure != other.departure) return departure < other.departure;
+        if (arrival != other.arrival) return arrival < other.arrival;
+        return cost < other.cost;
+    }
+    bool operator==(const Option& other) const {
+        return departure == other.departure && arrival == other.arrival && cost == other.cost;
+    }
+    bool beats(const Option& other) const {
+        return departure >= other.departure && arrival <= other.arrival && cost <= other.cost &&
+               !(*this == other);
+    }
+};
+
+// Every simple itinerary from port to destination, with the first
+// departure already fixed
+static void walk(const Graph& graph, int port, int destination, long long departure, int cost,
+                 long long arrival, Vector<bool>& onPath, Vector<Option>& found) {
+    if (port == destination) {
+        found.push_back(Option{departure, arrival, cost});
+        return;
+    }
+    const DepartureIndex& departures = Connections::byPort(graph);
+    onPath[port] = true;
+    for (int i = departures.begin(port); i < departures.end(port); i++) {
+        const Connection& conn = departures.sailings[i];
+        if (onPath[conn.to]) continue;
+        int next = PathFinding::cheapestLegCost(graph, conn, false, cost, arrival);
+        if (next == INT_MAX) continue;
+        walk(graph, conn.to, destination, departure, next, conn.arrival, onPath, found);
+    }
+    onPath[port] = false;
+}
+
+static Vector<Option> bruteForce(const Graph& graph, int a, int b, long long windowStart, long long windowEnd) {
+    Vector<Option> all;
+    Vector<bool> onPath;
+    onPath.resize(graph.size);
+    onPath[a] = true;
+    const DepartureIndex& departures = Connections::byPort(graph);
+    for (int i = departures.begin(a); i < departures.end(a); i++) {
+        const Connection& conn = departures.sailings[i];
+        if (conn.departure < windowStart || conn.departure > windowEnd) continue;
+        walk(graph, conn.to, b, conn.departure, conn.cost, conn.arrival, onPath, all);
+    }
+    Vector<Option> pareto;
+    for (const Option& option : all) {
+        bool beaten = false;
+        for (const Option& other : all) {
+            if (other.beats(option)) beaten = true;
+        }
+        if (!beaten) pareto.push_back(option);
+    }
+    std::sort(pareto.begin(), pareto.end());
+    Vector<Option> unique;
+    for (const Option& option : pareto) {
+        if (unique.size() == 0 || !(unique.back() == option)) unique.push_back(option);
+    }
+    return unique;
+}
+
+static Vector<Option> profile(const Graph& graph, int a, int b, const std::string& date, int days) {
+    Arena arena("test");
+    Vector<PathFinding::PathResult*> out;
+    ProfileSearch::findProfile(graph, a, b, date, days, arena, out);
+    Vector<Option> options;
+    for (PathFinding::PathResult* p : out) {
+        const Route& first = p->routes.front();
+        long long departure = TimeUtils::toAbsoluteMinutes(first.date, first.deptTime);
+        options.push_back(Option{departure, departure + p->totalTime, p->totalCost});
+    }
+    std::sort(options.begin(), options.end());
+    return options;
+}
+
+static int mismatches(const Graph& graph, const std::string& date, int days) {
+    long long windowStart = (long long)TimeUtils::dateToDays(date) * 24 * 60;
+    long long windowEnd = windowStart + (long long)days * 24 * 60 - 1;
+    int wrong = 0;
+    for (int a = 0; a < graph.size; a++) {
+        for (int b = 0; b < graph.size; b++) {
+            if (a == b) continue;
+            Vector<Option> expected = bruteForce(graph, a, b, windowStart, windowEnd);
+            Vector<Option> options = profile(graph, a, b, date, days);
+            bool same = expected.size() == options.size();
+            for (int i = 0; same && i < options.size(); i++) same = expected[i] == options[i];
+            if (!same) wrong++;
+        }
+    }
+    return wrong;
+}
+
+int main() {
+    writeGrid(4, "tests/bin/profile_ports.txt", "tests/bin/profile_routes.txt");
+    Graph grid;
+    grid.addPorts("tests/bin/profile_ports.txt");
+    grid.addRoutes("tests/bin/profile_routes.txt");
+    CHECK_EQ(mismatches(grid, "1/12/2024", 1), 0);
+    CHECK_EQ(mismatches(grid, "1/12/2024", 2), 0);
+
+    Graph data;
+    data.addPorts("data/PortCharges.txt");
+    data.addRoutes("data/Routes.txt");
+    CHECK_EQ(mismatches(data, "10/12/2024", 7), 0);
+    CHECK_EQ(mismatches(data, "1/12/2024", 31), 0);
+
+    // Nothing outside the window, and no options for an empty one
+    CHECK_EQ(mismatches(data, "1/1/2030", 7), 0);
+    Arena arena("test");
+    Vector<PathFinding::PathResult*> out;
+    CHECK_EQ(ProfileSearch::findProfile(data, 0, 1, "10/12/2024", 0, arena, out), 0);
+    return finish("profileSearchTest");
+}
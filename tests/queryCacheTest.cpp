@@ -0,0 +1,115 @@
+// QueryCache (headers/queryCache.h): least recently used entries go first,
+// a later graph revision drops everything and an earlier one is neither
+// answered nor kept, and invalidateBookings/invalidateIf drop only the
+// entries they pick.
+#include "testUtil.h"
+#include "../headers/queryCache.h"
+
+static QueryCache::Paths costing(int cost) {
+    QueryCache::Paths paths;
+    PathFinding::PathResult path;
+    path.found = true;
+    path.totalCost = cost;
+    paths.push_back(path);
+    return paths;
+}
+
+static SearchQuery cheapest(int from, int to) {
+    return SearchQuery(SearchQuery::CHEAPEST, from, to);
+}
+
+static void leastRecentlyUsed() {
+    QueryCache cache(3);
+    cache.insert(cheapest(0, 1), costing(1), false, 1);
+    cache.insert(cheapest(0, 2), costing(2), false, 1);
+    cache.insert(cheapest(0, 3), costing(3), false, 1);
+    // A hit makes (0, 1) the most recent, so (0, 2) is the one to go
+    CHECK(cache.find(cheapest(0, 1), 1) != nullptr);
+    cache.insert(cheapest(0, 4), costing(4), false, 1);
+    CHECK_EQ(cache.getSize(), 3);
+    CHECK_EQ(cache.getEvictions(), 1);
+    CHECK(cache.find(cheapest(0, 2), 1) == nullptr);
+    CHECK(cache.find(cheapest(0, 1), 1) != nullptr);
+    CHECK(cache.find(cheapest(0, 3), 1) != nullptr);
+
+    // Inserting a cached query again replaces it without evicting
+    cache.insert(cheapest(0, 4), costing(40), false, 1);
+    CHECK_EQ(cache.getSize(), 3);
+    CHECK_EQ(cache.getEvictions(), 1);
+    const QueryCache::Paths* hit = cache.find(cheapest(0, 4), 1);
+    CHECK(hit != nullptr);
+    if (hit) CHECK_EQ((*hit)[0].totalCost, 40);
+    CHECK_EQ(cache.getHits(), 4);
+    CHECK_EQ(cache.getMisses(), 1);
+}
+
+// Queries that differ in anything but their endpoints are other entries
+static void keys() {
+    QueryCache cache(8);
+    SearchQuery filtered = cheapest(0, 1);
+    filtered.companies = BitSet(4);
+    filtered.companies.set(2);
+    cache.insert(cheapest(0, 1), costing(1), false, 1);
+    cache.insert(filtered, costing(2), false, 1);
+    cache.insert(SearchQuery(SearchQuery::FASTEST, 0, 1), costing(3), false, 1);
+    cache.insert(SearchQuery(SearchQuery::BOOKING_PROFILE, 0, 1, "10/12/2024", 3), costing(4), true, 1);
+    CHECK_EQ(cache.getSize(), 4);
+    const QueryCache::Paths* hit = cache.find(filtered, 1);
+    CHECK(hit != nullptr);
+    if (hit) CHECK_EQ((*hit)[0].totalCost, 2);
+    CHECK(cache.find(SearchQuery(SearchQuery::BOOKING_PROFILE, 0, 1, "10/12/2024", 2), 1) == nullptr);
+}
+
+static void revisions() {
+    QueryCache cache(8);
+    cache.insert(cheapest(0, 1), costing(1), false, 2);
+    // A search that ran on an older snapshot: not answered, not kept
+    CHECK(cache.find(cheapest(0, 1), 1) == nullptr);
+    cache.insert(cheapest(0, 2), costing(2), false, 1);
+    CHECK_EQ(cache.getSize(), 1);
+    CHECK(cache.find(cheapest(0, 1), 2) != nullptr);
+
+    // A later revision drops everything
+    CHECK(cache.find(cheapest(0, 1), 3) == nullptr);
+    CHECK_EQ(cache.getSize(), 0);
+    CHECK_EQ(cache.getInvalidations(), 1);
+
+    // Unless the change went through invalidateIf and rebase
+    cache.insert(cheapest(0, 1), costing(1), false, 3);
+    cache.insert(cheapest(0, 2), costing(2), false, 3);
+    cache.invalidateIf([](const SearchQuery& q, const QueryCache::Paths&) { return q.destination == 2; });
+    cache.rebase(3, 4);
+    CHECK(cache.find(cheapest(0, 1), 4) != nullptr);
+    CHECK(cache.find(cheapest(0, 2), 4) == nullptr);
+    CHECK_EQ(cache.getInvalidations(), 2);
+    // rebase from a revision the cache is not on changes nothing
+    cache.rebase(3, 5);
+    CHECK(cache.find(cheapest(0, 1), 5) == nullptr);
+}
+
+static void bookings() {
+    QueryCache cache(8);
+    cache.insert(cheapest(0, 1), costing(1), false, 1);
+    cache.insert(SearchQuery(SearchQuery::BOOKING_DIRECT, 0, 1, "10/12/2024"), costing(2), true, 1);
+    cache.insert(SearchQuery(SearchQuery::BOOKING_CONNECTED, 0, 1, "10/12/2024"), costing(3), true, 1);
+    cache.invalidateBookings();
+    CHECK_EQ(cache.getSize(), 1);
+    CHECK(cache.find(cheapest(0, 1), 1) != nullptr);
+    CHECK_EQ(cache.getInvalidations(), 1);
+    // Nothing left to drop is not counted
+    cache.invalidateBookings();
+    CHECK_EQ(cache.getInvalidations(), 1);
+
+    // Freed slots are reused before any entry is evicted
+    for (int to = 2; to < 9; to++) cache.insert(cheapest(0, to), costing(to), false, 1);
+    CHECK_EQ(cache.getSize(), 8);
+    CHECK_EQ(cache.getEvictions(), 0);
+}
+
+int main() {
+    leastRecentlyUsed();
+    keys();
+    revisions();
+    bookings();
+    return finish("queryCacheTest");
+}
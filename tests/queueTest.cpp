@@ -0,0 +1,126 @@
+// Queue and SpscQueue (headers/queue.h, headers/spscQueue.h): FIFO order
+// across wrap-around and growth, bulk operations, and a two-thread hand-off.
+#include <string>
+#include <thread>
+#include <utility>
+#include "testUtil.h"
+#include "../headers/queue.h"
+#include "../headers/spscQueue.h"
+#include "../headers/vector.h"
+
+static void wrapsAroundAndGrows() {
+    Queue<int> q;
+    for (int i = 0; i < 6; i++) q.enqueue(i);
+    CHECK_EQ(q.getCapacity(), 8);
+    for (int i = 0; i < 5; i++) CHECK_EQ(q.dequeue(), i);
+
+    // The head sits at slot 5, so these wrap past the end of the buffer
+    for (int i = 6; i < 13; i++) q.enqueue(i);
+    CHECK_EQ(q.getCapacity(), 8);
+    CHECK_EQ(q.getSize(), 8);
+
+    // Full while wrapped: growing has to unwrap in order
+    q.enqueue(13);
+    CHECK_EQ(q.getCapacity(), 16);
+    for (int i = 5; i <= 13; i++) CHECK_EQ(q.dequeue(), i);
+    CHECK(q.isEmpty());
+    CHECK_THROWS(q.dequeue(), std::runtime_error);
+    CHECK_THROWS(q.peek(), std::runtime_error);
+}
+
+static void enqueueOwnElementWhileFull() {
+    Queue<std::string> q;
+    for (int i = 0; i < 8; i++) q.enqueue(std::string(20, 'a' + i));
+    CHECK_EQ(q.getSize(), q.getCapacity());
+    q.enqueue(q.front());   // copied before the buffer moves
+    Vector<std::string> out;
+    q.drain(out);
+    CHECK_EQ(out.size(), 9);
+    CHECK_EQ(out.back(), std::string(20, 'a'));
+}
+
+static void bulkOperations() {
+    Queue<int> q;
+    q.enqueue(0);
+    Vector<int> items = { 1, 2, 3, 4, 5, 6, 7, 8, 9 };
+    q.enqueue_range(items);
+    CHECK_EQ(q.getSize(), 10);
+    CHECK_EQ(q.getCapacity(), 16);
+
+    Vector<int> out;
+    CHECK_EQ(q.drain(out, 4), 4);
+    CHECK_EQ(out.size(), 4);
+    CHECK_EQ(out[3], 3);
+    CHECK_EQ(q.peek(), 4);
+    CHECK_EQ(q.drain(out), 6);
+    CHECK_EQ(out.size(), 10);
+    for (int i = 0; i < 10; i++) CHECK_EQ(out[i], i);
+    CHECK(q.isEmpty());
+}
+
+static void copyMoveClear() {
+    Queue<std::string> a;
+    for (int i = 0; i < 5; i++) a.enqueue(std::to_string(i));
+    a.dequeue();
+    a.dequeue();
+    Queue<std::string> b(a);
+    CHECK_EQ(b.getSize(), 3);
+    CHECK_EQ(b.dequeue(), std::string("2"));
+    CHECK_EQ(a.peek(), std::string("2"));
+
+    Queue<std::string> c(std::move(a));
+    CHECK(a.isEmpty());
+    CHECK_EQ(c.getSize(), 3);
+    b = c;
+    CHECK_EQ(b.getSize(), 3);
+
+    int capacity = c.getCapacity();
+    c.clear();
+    CHECK(c.isEmpty());
+    CHECK_EQ(c.getCapacity(), capacity);
+    c.enqueue("x");
+    CHECK_EQ(c.peek(), std::string("x"));
+}
+
+static void spscHandsOffInOrder() {
+    SpscQueue<int> q(16);
+    CHECK_EQ(q.getCapacity(), 16);
+    for (int i = 0; i < 16; i++) CHECK(q.tryEnqueue(i));
+    CHECK(!q.tryEnqueue(16));
+    int value = -1;
+    for (int i = 0; i < 16; i++) {
+        CHECK(q.tryDequeue(value));
+        CHECK_EQ(value, i);
+    }
+    CHECK(!q.tryDequeue(value));
+
+    // One producer, one consumer, far more items than slots
+    const int ITEMS = 200000;
+    std::thread producer([&]() {
+        for (int i = 0; i < ITEMS; i++) {
+            while (!q.tryEnqueue(i)) std::this_thread::yield();
+        }
+    });
+    int expected = 0;
+    bool inOrder = true;
+    while (expected < ITEMS) {
+        if (!q.tryDequeue(value)) {
+            std::this_thread::yield();
+            continue;
+        }
+        if (value != expected) inOrder = false;
+        expected++;
+    }
+    producer.join();
+    CHECK(inOrder);
+    CHECK(q.isEmpty());
+}
+
+int main() {
+    wrapsAroundAndGrows();
+    enqueueOwnElementWhileFull();
+    bulkOperations();
+    copyMoveClear();
+    spscHandsOffInOrder();
+    return finish("queueTest");
+}
@@ -0,0 +1,135 @@
+// Preference queries (headers/routeFilter.hpp) on data/: the itineraries
+// listed first are the cheapest and the fastest of everything listed, for
+// a fresh query and for a CandidateSet answering a tightened filter from
+// the paths it kept.
+#include <string>
+#include "testUtil.h"
+#include "../headers/Graph.hpp"
+#include "../headers/pathFinding.h"
+#include "../headers/routeFilter.hpp"
+#include "../headers/arena.h"
+
+typedef Vector<PathFinding::PathResult*> Paths;
+
+static Vector<std::string> companiesExcept(const Graph& graph, const char* a, const char* b = "") {
+    Vector<std::string> picked;
+    for (const std::string& name : RouteFilter::getAllCompanies(graph)) {
+        if (name != a && name != b) picked.push_back(name);
+    }
+    return picked;
+}
+
+// Nothing listed is cheaper than the first path or quicker than the
+// leaders; the first two differ when the second one leads on time
+static void checkLeaders(const Paths& paths) {
+    CHECK(paths.size() > 0);
+    if (paths.size() == 0) return;
+    int leaderTime = paths[0]->totalTime;
+    if (paths.size() > 1 && paths[1]->totalTime < leaderTime) leaderTime = paths[1]->totalTime;
+    bool noneCheaper = true;
+    bool noneQuicker = true;
+    for (const PathFinding::PathResult* path : paths) {
+        if (path->totalCost < paths[0]->totalCost) noneCheaper = false;
+        if (path->totalTime < leaderTime) noneQuicker = false;
+    }
+    CHECK(noneCheaper);
+    CHECK(noneQuicker);
+}
+
+// Karachi to Istanbul without PIL: the cheapest path the constrained
+// search keeps a label for reaches Jeddah too late for the Jeddah-Istanbul
+// sailing, and it answers via Tokyo for 48899. The enumeration finds
+// Karachi-Jeddah-Istanbul for 13700.
+static void freshQuery(const Graph& graph) {
+    int karachi = graph.findPort("Karachi");
+    int istanbul = graph.findPort("Istanbul");
+    Vector<int> ports;
+    Vector<std::string> companies = companiesExcept(graph, "PIL");
+
+    RouteFilter::CompiledPreferences prefs =
+        RouteFilter::compilePreferences(graph, istanbul, companies, ports);
+    PathFinding::PathResult* search = PathFinding::findCheapestPath(graph, karachi, istanbul, prefs);
+    CHECK(search->found);
+    CHECK(search->totalCost > 13700);   // if this starts failing, the search got exact
+    delete search;
+
+    Arena arena("test");
+    Paths paths = RouteFilter::findFilteredRoutes(graph, karachi, istanbul, ports, companies, arena);
+    checkLeaders(paths);
+    if (paths.size() > 0) {
+        CHECK_EQ(paths[0]->totalCost, 13700);
+        CHECK_EQ(paths[0]->routes.getSize(), 2);
+    }
+}
+
+// Same pair, first without PIL (a complete candidate set) and then also
+// without HapagLloyd, which is answered from the kept paths
+static void tightenedFilter(const Graph& graph) {
+    int karachi = graph.findPort("Karachi");
+    int istanbul = graph.findPort("Istanbul");
+    Vector<int> ports;
+    RouteFilter::CandidateSet set;
+    int keepIndex;
+
+    const Paths& first = set.update(graph, karachi, istanbul, ports,
+                                    companiesExcept(graph, "PIL"), nullptr, keepIndex);
+    checkLeaders(first);
+    CHECK_EQ(keepIndex, -1);
+    CHECK(first.size() > 1);
+    if (first.size() < 2) return;
+    PathFinding::PathResult* kept = first[first.size() - 1];
+    int searches = set.getSearchCount();
+
+    const Paths& second = set.update(graph, karachi, istanbul, ports,
+                                     companiesExcept(graph, "PIL", "HapagLloyd"), kept, keepIndex);
+    CHECK_EQ(set.getSearchCount(), searches);
+    checkLeaders(second);
+    if (second.size() > 0) CHECK_EQ(second[0]->totalCost, 13700);
+
+    // keepIndex follows the kept path through the reordering
+    bool stillListed = false;
+    for (int i = 0; i < second.size(); i++) {
+        if (second[i] == kept) {
+            stillListed = true;
+            CHECK_EQ(keepIndex, i);
+        }
+    }
+    if (!stillListed) CHECK_EQ(keepIndex, -1);
+}
+
+// Every pair of data/ with one company left out
+static void everyPair(const Graph& graph) {
+    Vector<std::string> all = RouteFilter::getAllCompanies(graph);
+    Vector<int> ports;
+    Arena arena("test");
+    int wrong = 0;
+    for (int skip = 0; skip < all.size(); skip++) {
+        Vector<std::string> companies = companiesExcept(graph, all[skip].c_str());
+        for (int a = 0; a < graph.size; a++) {
+            for (int b = 0; b < graph.size; b++) {
+                if (a == b) continue;
+                Paths paths = RouteFilter::findFilteredRoutes(graph, a, b, ports, companies, arena);
+                int leaderTime = paths.size() > 0 ? paths[0]->totalTime : 0;
+                if (paths.size() > 1 && paths[1]->totalTime < leaderTime) leaderTime = paths[1]->totalTime;
+                for (const PathFinding::PathResult* path : paths) {
+                    if (path->totalCost < paths[0]->totalCost || path->totalTime < leaderTime) {
+                        wrong++;
+                        break;
+                    }
+                }
+                arena.reset();
+            }
+        }
+    }
+    CHECK_EQ(wrong, 0);
+}
+
+int main() {
+    Graph graph;
+    graph.addPorts("data/PortCharges.txt");
+    graph.addRoutes("data/Routes.txt");
+    freshQuery(graph);
+    tightenedFilter(graph);
+    everyPair(graph);
+    return finish("routeFilterTest");
+}
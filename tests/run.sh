@@ -0,0 +1,27 @@
+#!/bin/sh
+# Builds and runs the programs in tests/ (all of them, or the ones named)
+# from the repository root, since some read data/. Extra compiler flags
+# come from CXXFLAGS, e.g.
+#   CXXFLAGS="-fsanitize=address,undefined" tests/run.sh
+#   tests/run.sh vectorTest hashMapTest
+cd "$(dirname "$0")/.." || exit 1
+mkdir -p tests/bin
+
+if [ $# -eq 0 ]; then
+    set -- $(ls tests/*Test.cpp | sed 's#tests/##; s#\.cpp$##')
+fi
+
+failed=""
+for name in "$@"; do
+    if ! ${CXX:-g++} -std=c++17 -O1 -g -Wall -pthread $CXXFLAGS -o "tests/bin/$name" "tests/$name.cpp"; then
+        failed="$failed $name"
+        continue
+    fi
+    "tests/bin/$name" || failed="$failed $name"
+done
+
+if [ -n "$failed" ]; then
+    echo "FAILED:$failed"
+    exit 1
+fi
+echo "All tests passed"
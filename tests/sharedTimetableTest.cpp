@@ -0,0 +1,87 @@
+// SharedTimetable (headers/sharedTimetable.h): a timetable published to a
+// shared-memory segment and attached again answers cheapest and fastest
+// for every pair with the same itinerary as PathFinding on the Graph it
+// was written from, on data/ plus two weekly services and on sailings
+// that tie.
+#include <fstream>
+#include <string>
+#include <unistd.h>
+#include "testUtil.h"
+#include "../headers/Graph.hpp"
+#include "../headers/pathFinding.h"
+#include "../headers/sharedTimetable.h"
+
+static bool sameAnswer(const PathFinding::PathResult* a, const PathFinding::PathResult* b) {
+    if (a->found != b->found) return false;
+    if (!a->found) return true;
+    return a->totalCost == b->totalCost && a->totalTime == b->totalTime && PathFinding::sameLegs(a, b);
+}
+
+// Publishes graph, attaches to it and counts the pairs where the shared
+// searches answer differently
+static int differences(const Graph& graph, int expectedServices) {
+    const std::string segment = "/oceanroute_test_" + std::to_string(getpid());
+    CHECK(SharedTimetable::publish(graph, segment));
+    SharedTimetable shared;
+    CHECK(shared.attach(segment));
+    SharedTimetable::unpublish(segment);
+    if (!shared.isAttached()) return -1;
+    CHECK_EQ(shared.getPortCount(), graph.size);
+    CHECK_EQ(shared.getServiceCount(), expectedServices);
+
+    int wrong = 0, found = 0;
+    for (int a = 0; a < graph.size; a++) {
+        if (shared.findPort(graph.vertices[a].port.name) != a) wrong++;
+        for (int b = 0; b < graph.size; b++) {
+            if (a == b) continue;
+            PathFinding::PathResult* expected = PathFinding::findCheapestPath(graph, a, b);
+            PathFinding::PathResult* answer = shared.findCheapestPath(a, b);
+            if (!sameAnswer(expected, answer)) wrong++;
+            if (expected->found) found++;
+            delete expected;
+            delete answer;
+
+            expected = PathFinding::findShortestTimePath(graph, a, b);
+            answer = shared.findShortestTimePath(a, b);
+            if (!sameAnswer(expected, answer)) wrong++;
+            delete expected;
+            delete answer;
+        }
+    }
+    CHECK(found > 0);
+    CHECK_EQ(shared.findPort("Atlantis"), -1);
+    return wrong;
+}
+
+int main() {
+    const std::string services = "tests/bin/shared_services.txt";
+    {
+        std::ofstream out(services);
+        out << "Karachi Istanbul Daily 10/12/2024 25/12/2024 08:00 20:00 3000 PIL\n";
+        out << "Durban Lisbon Mon,Thu 01/12/2024 31/12/2024 22:00 06:00 2500 MSC\n";
+    }
+    Graph data;
+    data.addPorts("data/PortCharges.txt");
+    data.addRoutes("data/Routes.txt");
+    data.addServices(services);
+    CHECK_EQ(data.services.size(), 2);
+    CHECK_EQ(differences(data, 2), 0);
+
+    // Two onward sailings that arrive together: both give the same time,
+    // and the fastest search takes the one that leaves first, whatever
+    // order the timetable lists them in
+    const std::string ports = "tests/bin/shared_ports.txt", routes = "tests/bin/shared_routes.txt";
+    {
+        std::ofstream out(ports);
+        out << "A 100\nX 200\nB 300\n";
+        std::ofstream legs(routes);
+        legs << "A X 1/12/2024 00:00 04:00 1000 Early\n";
+        legs << "X B 1/12/2024 10:00 20:00 1000 Late\n";
+        legs << "X B 1/12/2024 08:00 20:00 1000 Soon\n";
+    }
+    Graph ties;
+    ties.addPorts(ports);
+    ties.addRoutes(routes);
+    CHECK_EQ(differences(ties, 0), 0);
+    return finish("sharedTimetableTest");
+}
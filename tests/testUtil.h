@@ -0,0 +1,50 @@
+#ifndef TESTUTIL_H
+#define TESTUTIL_H
+
+#include <iostream>
+#include <string>
+
+// Checks for the programs in tests/. A failed check prints where it failed
+// and carries on; finish() reports and gives the exit status.
+static int testChecks = 0;
+static int testFailures = 0;
+
+#define CHECK(cond) \
+    do { \
+        testChecks++; \
+        if (!(cond)) { \
+            testFailures++; \
+            std::cerr << __FILE__ << ":" << __LINE__ << ": CHECK(" #cond ") failed\n"; \
+        } \
+    } while (0)
+
+#define CHECK_EQ(a, b) \
+    do { \
+        testChecks++; \
+        auto checkA = (a); \
+        auto checkB = (b); \
+        if (!(checkA == checkB)) { \
+            testFailures++; \
+            std::cerr << __FILE__ << ":" << __LINE__ << ": CHECK_EQ(" #a ", " #b ") failed: " \
+                      << checkA << " != " << checkB << "\n"; \
+        } \
+    } while (0)
+
+// Expects statement to throw exception type E
+#define CHECK_THROWS(statement, E) \
+    do { \
+        testChecks++; \
+        bool thrown = false; \
+        try { statement; } catch (const E&) { thrown = true; } \
+        if (!thrown) { \
+            testFailures++; \
+            std::cerr << __FILE__ << ":" << __LINE__ << ": " #statement " did not throw " #E "\n"; \
+        } \
+    } while (0)
+
+static int finish(const std::string& name) {
+    std::cout << name << ": " << (testChecks - testFailures) << "/" << testChecks << " checks passed\n";
+    return testFailures == 0 ? 0 : 1;
+}
+
+#endif
@@ -0,0 +1,183 @@
+// Live timetable changes (headers/timetableFeed.h) on data/: feed lines
+// parse, a patched graph answers every pair like one loaded from scratch
+// with the same sailings, its static bounds stay admissible, and a search
+// cache keeps only answers that are still right.
+#include <fstream>
+#include <string>
+#include "testUtil.h"
+#include "../headers/Graph.hpp"
+#include "../headers/pathFinding.h"
+#include "../headers/lowerBounds.h"
+#include "../headers/queryCache.h"
+#include "../headers/timetableFeed.h"
+
+static void parsing() {
+    TimetableChange change;
+    CHECK(TimetableChange::parse("DELAY Durban Marseille 11/12/2024 14:00 MSC -90", change));
+    CHECK(change.kind == TimetableChange::DELAY);
+    CHECK_EQ(change.minutes, -90);
+    CHECK(change.sailing.dest.name == "Marseille");
+    CHECK(TimetableChange::parse("CANCEL HongKong Jeddah 22/12/2024 09:00 Evergreen", change));
+    CHECK(change.kind == TimetableChange::CANCEL);
+    CHECK(change.sailing.company == "Evergreen");
+    CHECK(TimetableChange::parse("ADD Karachi Istanbul 20/12/2024 08:00 20:00 3000 PIL", change));
+    CHECK(change.kind == TimetableChange::ADD);
+    CHECK(change.sailing.arrTime == "20:00");
+    CHECK_EQ(change.sailing.cost, 3000);
+
+    CHECK(!TimetableChange::parse("", change));
+    CHECK(!TimetableChange::parse("# DELAY Durban Marseille 11/12/2024 14:00 MSC 5", change));
+    CHECK(!TimetableChange::parse("DELAY Durban Marseille 11/12/2024 14:00 MSC", change));
+    CHECK(!TimetableChange::parse("ADD Karachi Istanbul 20/12/2024 08:00 20:00 cheap PIL", change));
+    CHECK(!TimetableChange::parse("MOVE Karachi Istanbul 20/12/2024 08:00 PIL", change));
+}
+
+static bool sameAnswer(const PathFinding::PathResult& a, const PathFinding::PathResult& b) {
+    if (a.found != b.found) return false;
+    if (!a.found) return true;
+    return a.totalCost == b.totalCost && a.totalTime == b.totalTime && PathFinding::sameLegs(&a, &b);
+}
+
+// The graph's sailings, port by port in timetable order, as a routes file
+static void writeRoutes(const Graph& graph, const std::string& file) {
+    std::ofstream out(file);
+    for (int u = 0; u < graph.size; u++) {
+        for (const Route& r : graph.vertices[u].routes) {
+            out << r.startPoint.name << " " << r.dest.name << " " << r.date << " " << r.deptTime << " "
+                << r.arrTime << " " << r.cost << " " << r.company << "\n";
+        }
+    }
+}
+
+static void fillCache(const Graph& graph, QueryCache& cache) {
+    for (int a = 0; a < graph.size; a++) {
+        for (int b = 0; b < graph.size; b++) {
+            if (a == b) continue;
+            QueryCache::Paths paths;
+            PathFinding::PathResult* r = PathFinding::findCheapestPath(graph, a, b);
+            paths.push_back(*r);
+            delete r;
+            cache.insert(SearchQuery(SearchQuery::CHEAPEST, a, b), std::move(paths), false, graph.getRevision());
+
+            QueryCache::Paths fastest;
+            r = PathFinding::findShortestTimePath(graph, a, b);
+            fastest.push_back(*r);
+            delete r;
+            cache.insert(SearchQuery(SearchQuery::FASTEST, a, b), std::move(fastest), false, graph.getRevision());
+        }
+    }
+}
+
+// Applies line to data/ and compares with a graph loaded with the result
+static void applied(const char* line) {
+    Graph graph;
+    graph.addPorts("data/PortCharges.txt");
+    graph.addRoutes("data/Routes.txt");
+    // Bounds in place, so the cache can keep answers a new leg cannot beat
+    for (int b = 0; b < graph.size; b++) LowerBounds::forDestination(graph, b);
+    QueryCache cache(2 * graph.size * graph.size);
+    fillCache(graph, cache);
+    int cached = cache.getSize();
+
+    TimetableChange change;
+    CHECK(TimetableChange::parse(line, change));
+    unsigned long long version = graph.getVersion();
+    CHECK(TimetableUpdates::apply(graph, change, &cache));
+    CHECK_EQ(graph.getVersion(), version);
+
+    const std::string file = "tests/bin/feed_routes.txt";
+    writeRoutes(graph, file);
+    Graph fresh;
+    fresh.addPorts("data/PortCharges.txt");
+    fresh.addRoutes(file);
+
+    int wrong = 0, staleKept = 0, kept = 0, inadmissible = 0;
+    for (int a = 0; a < graph.size; a++) {
+        for (int b = 0; b < graph.size; b++) {
+            if (a == b) continue;
+            const SearchQuery::Objective objectives[] = { SearchQuery::CHEAPEST, SearchQuery::FASTEST };
+            for (SearchQuery::Objective objective : objectives) {
+                bool cheapest = objective == SearchQuery::CHEAPEST;
+                PathFinding::PathResult* patched = cheapest ? PathFinding::findCheapestPath(graph, a, b)
+                                                            : PathFinding::findShortestTimePath(graph, a, b);
+                PathFinding::PathResult* loaded = cheapest ? PathFinding::findCheapestPath(fresh, a, b)
+                                                           : PathFinding::findShortestTimePath(fresh, a, b);
+                if (!sameAnswer(*patched, *loaded)) wrong++;
+                const QueryCache::Paths* hit = cache.find(SearchQuery(objective, a, b), graph.getRevision());
+                if (hit) {
+                    kept++;
+                    if (!sameAnswer((*hit)[0], *loaded)) staleKept++;
+                }
+                delete patched;
+                delete loaded;
+            }
+        }
+    }
+    for (int b = 0; b < graph.size; b++) {
+        const GoalBounds& patched = LowerBounds::forDestination(graph, b);
+        const GoalBounds& loaded = LowerBounds::forDestination(fresh, b);
+        for (int a = 0; a < graph.size; a++) {
+            if (patched.minCost[a] > loaded.minCost[a] || patched.minTime[a] > loaded.minTime[a]) inadmissible++;
+        }
+    }
+    CHECK_EQ(wrong, 0);
+    CHECK_EQ(staleKept, 0);
+    CHECK_EQ(inadmissible, 0);
+    // Selective: some answers go, some stay
+    CHECK(kept < cached);
+    CHECK(kept > 0);
+}
+
+// A weekly service's run is cancelled by an exception, and delayed by a
+// dated sailing in its place
+static void serviceRuns() {
+    const std::string file = "tests/bin/feed_services.txt";
+    {
+        std::ofstream out(file);
+        out << "Karachi Istanbul Daily 10/12/2024 25/12/2024 08:00 20:00 3000 PIL\n";
+    }
+    Graph graph;
+    graph.addPorts("data/PortCharges.txt");
+    graph.addRoutes("data/Routes.txt");
+    graph.addServices(file);
+    CHECK_EQ(graph.services.size(), 1);
+    if (graph.services.size() != 1) return;
+    int karachi = graph.findPort("Karachi");
+
+    TimetableChange change;
+    CHECK(TimetableChange::parse("CANCEL Karachi Istanbul 15/12/2024 08:00 PIL", change));
+    CHECK(TimetableUpdates::apply(graph, change, nullptr));
+    CHECK(!graph.services[0].runsOn(TimeUtils::civilDay("15/12/2024")));
+    CHECK(graph.services[0].runsOn(TimeUtils::civilDay("16/12/2024")));
+
+    CHECK(TimetableChange::parse("DELAY Karachi Istanbul 16/12/2024 08:00 PIL 90", change));
+    CHECK(TimetableUpdates::apply(graph, change, nullptr));
+    CHECK(!graph.services[0].runsOn(TimeUtils::civilDay("16/12/2024")));
+    CHECK(graph.findSailing(karachi, "Istanbul", "16/12/2024", "09:30", "PIL") != nullptr);
+    // The run is gone, so it cannot be cancelled twice
+    CHECK(TimetableChange::parse("CANCEL Karachi Istanbul 15/12/2024 08:00 PIL", change));
+    CHECK(!TimetableUpdates::apply(graph, change, nullptr));
+}
+
+static void rejected() {
+    Graph graph;
+    graph.addPorts("data/PortCharges.txt");
+    graph.addRoutes("data/Routes.txt");
+    unsigned long long revision = graph.getRevision();
+    TimetableChange change;
+    CHECK(TimetableChange::parse("CANCEL HongKong Jeddah 23/12/2024 09:00 Evergreen", change));
+    CHECK(!TimetableUpdates::apply(graph, change, nullptr));
+    CHECK(TimetableChange::parse("ADD Atlantis Istanbul 20/12/2024 08:00 20:00 3000 PIL", change));
+    CHECK(!TimetableUpdates::apply(graph, change, nullptr));
+    CHECK_EQ(graph.getRevision(), revision);
+}
+
+int main() {
+    parsing();
+    applied("CANCEL HongKong Jeddah 22/12/2024 09:00 Evergreen");
+    applied("DELAY Durban Marseille 11/12/2024 14:00 MSC 300");
+    applied("ADD Karachi Istanbul 20/12/2024 08:00 20:00 3000 PIL");
+    serviceRuns();
+    rejected();
+    return finish("timetableFeedTest");
+}
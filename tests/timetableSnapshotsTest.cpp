@@ -0,0 +1,119 @@
+// Timetable snapshots (headers/timetableSnapshots.h) on data/: an update
+// copies only the sailings of the ports it touches, leaves the snapshot
+// before it as it was, and the new one's sorted sailings point at its own
+// routes, also once the old snapshot is gone.
+#include <memory>
+#include <string>
+#include "testUtil.h"
+#include "../headers/Graph.hpp"
+#include "../headers/pathFinding.h"
+#include "../headers/connections.h"
+#include "../headers/timetableFeed.h"
+#include "../headers/timetableSnapshots.h"
+
+static std::shared_ptr<Graph> loadData() {
+    std::shared_ptr<Graph> graph = std::make_shared<Graph>();
+    graph->addPorts("data/PortCharges.txt");
+    graph->addRoutes("data/Routes.txt");
+    return graph;
+}
+
+static void applyAll(Graph& graph, const char* const* lines, int count) {
+    for (int i = 0; i < count; i++) {
+        TimetableChange change;
+        CHECK(TimetableChange::parse(lines[i], change));
+        CHECK(TimetableUpdates::apply(graph, change, nullptr));
+    }
+}
+
+static const Route* firstRoute(const Graph& graph, int port) {
+    return graph.vertices[port].routes.isEmpty() ? nullptr : &*graph.vertices[port].routes.begin();
+}
+
+// Cheapest and fastest totals for every pair agree
+static int differences(const Graph& a, const Graph& b) {
+    int wrong = 0;
+    for (int s = 0; s < a.size; s++) {
+        for (int t = 0; t < a.size; t++) {
+            if (s == t) continue;
+            PathFinding::PathResult* x = PathFinding::findCheapestPath(a, s, t);
+            PathFinding::PathResult* y = PathFinding::findCheapestPath(b, s, t);
+            if (x->found != y->found || x->totalCost != y->totalCost) wrong++;
+            delete x;
+            delete y;
+            x = PathFinding::findShortestTimePath(a, s, t);
+            y = PathFinding::findShortestTimePath(b, s, t);
+            if (x->found != y->found || x->totalTime != y->totalTime) wrong++;
+            delete x;
+            delete y;
+        }
+    }
+    return wrong;
+}
+
+// Every sorted sailing is one of graph's own routes
+static int foreignEntries(const Graph& graph) {
+    int foreign = 0;
+    for (const Connection& conn : Connections::byDeparture(graph)) {
+        bool own = false;
+        for (const Route& route : graph.vertices[conn.from].routes) {
+            if (&route == conn.route) own = true;
+        }
+        if (!own) foreign++;
+    }
+    return foreign;
+}
+
+int main() {
+    static const char* const changes[] = {
+        "CANCEL HongKong Jeddah 22/12/2024 09:00 Evergreen",
+        "DELAY Durban Marseille 11/12/2024 14:00 MSC 300",
+        "ADD Karachi Istanbul 20/12/2024 08:00 20:00 3000 PIL",
+    };
+    std::shared_ptr<Graph> reference = loadData();
+    std::shared_ptr<Graph> expected = loadData();
+    applyAll(*expected, changes, 3);
+
+    TimetableSnapshots snapshots(loadData());
+    TimetableSnapshots::Snapshot before = snapshots.pin();
+    snapshots.update([&](Graph& next) { applyAll(next, changes, 3); });
+    TimetableSnapshots::Snapshot after = snapshots.pin();
+    CHECK(before != after);
+
+    // Only the three departure ports got lists of their own
+    int touched[] = { after->findPort("HongKong"), after->findPort("Durban"), after->findPort("Karachi") };
+    int copied = 0, wrongSharing = 0;
+    for (int u = 0; u < after->size; u++) {
+        bool isTouched = (u == touched[0] || u == touched[1] || u == touched[2]);
+        bool shares = firstRoute(*before, u) == firstRoute(*after, u);
+        if (!shares) copied++;
+        if (shares == isTouched && !before->vertices[u].routes.isEmpty()) wrongSharing++;
+    }
+    CHECK_EQ(copied, 3);
+    CHECK_EQ(wrongSharing, 0);
+
+    // The old snapshot still answers as before, the new one as if loaded
+    // with the changes made
+    CHECK_EQ(differences(*before, *reference), 0);
+    CHECK_EQ(differences(*after, *expected), 0);
+    CHECK_EQ(foreignEntries(*before), 0);
+    CHECK_EQ(foreignEntries(*after), 0);
+
+    // Without the old snapshot nothing the new one uses goes away
+    before.reset();
+    CHECK_EQ(differences(*after, *expected), 0);
+    CHECK_EQ(foreignEntries(*after), 0);
+
+    // A second batch on a port the first one copied: that port is now
+    // shared again with the snapshot before, and is copied again
+    static const char* const more[] = { "DELAY Karachi Istanbul 20/12/2024 08:00 PIL 60" };
+    applyAll(*expected, more, 1);
+    snapshots.update([&](Graph& next) { applyAll(next, more, 1); });
+    TimetableSnapshots::Snapshot latest = snapshots.pin();
+    CHECK(firstRoute(*after, touched[2]) != firstRoute(*latest, touched[2]));
+    CHECK(firstRoute(*after, touched[0]) == firstRoute(*latest, touched[0]));
+    CHECK_EQ(differences(*latest, *expected), 0);
+    after.reset();
+    CHECK_EQ(foreignEntries(*latest), 0);
+    return finish("timetableSnapshotsTest");
+}
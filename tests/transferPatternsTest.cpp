@@ -0,0 +1,117 @@
+// Transfer patterns (headers/transferPatterns.h) on data/: answers equal
+// PathFinding's for every pair, also where sailings tie, only reachable
+// ports are stored, and the file round-trips and is refused for another
+// timetable.
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include "testUtil.h"
+#include "../headers/Graph.hpp"
+#include "../headers/pathFinding.h"
+#include "../headers/transferPatterns.h"
+
+static bool sameAnswer(const PathFinding::PathResult* a, const PathFinding::PathResult* b) {
+    if (a->found != b->found) return false;
+    if (!a->found) return true;
+    return a->totalCost == b->totalCost && a->totalTime == b->totalTime && PathFinding::sameLegs(a, b);
+}
+
+static void matchesSearches(const Graph& graph, const TransferPatternTables& tables) {
+    int mismatches = 0;
+    for (int a = 0; a < graph.size; a++) {
+        for (int b = 0; b < graph.size; b++) {
+            if (a == b) continue;
+            PathFinding::PathResult* searched = PathFinding::findCheapestPath(graph, a, b);
+            PathFinding::PathResult* patterned = TransferPatterns::findCheapestPath(graph, tables, a, b);
+            if (!sameAnswer(searched, patterned)) mismatches++;
+            delete searched;
+            delete patterned;
+
+            searched = PathFinding::findShortestTimePath(graph, a, b);
+            patterned = TransferPatterns::findShortestTimePath(graph, tables, a, b);
+            if (!sameAnswer(searched, patterned)) mismatches++;
+            delete searched;
+            delete patterned;
+        }
+    }
+    CHECK_EQ(mismatches, 0);
+}
+
+// One node per port some pattern from the origin reaches, none otherwise
+static void storesReachablePortsOnly(const Graph& graph, const TransferPatternTables& tables) {
+    CHECK_EQ(tables.originStart.size(), graph.size + 1);
+    size_t reachable = 0;
+    int wrong = 0;
+    Vector<int> cheapest, fastest;
+    for (int a = 0; a < graph.size; a++) {
+        PathFinding::cheapestTree(graph, a, cheapest);
+        PathFinding::fastestTree(graph, a, fastest);
+        for (int v = 0; v < graph.size; v++) {
+            bool reached = v != a && (cheapest[v] != -1 || fastest[v] != -1);
+            if (reached) reachable++;
+            if ((tables.find(a, v) != nullptr) != reached) wrong++;
+        }
+    }
+    CHECK_EQ(wrong, 0);
+    CHECK_EQ(tables.nodes.size(), (int)reachable);
+    CHECK(tables.getTableBytes() <= (size_t)graph.size * graph.size * 2 * sizeof(int));
+}
+
+static void roundTrip(const Graph& graph, const TransferPatternTables& tables) {
+    const std::string file = "tests/bin/transfer_patterns_test.bin";
+    CHECK(TransferPatterns::save(tables, graph, file));
+
+    TransferPatternTables loaded;
+    CHECK(TransferPatterns::load(loaded, graph, file));
+    CHECK_EQ(loaded.nodes.size(), tables.nodes.size());
+    bool same = loaded.originStart.size() == tables.originStart.size();
+    for (int i = 0; same && i < tables.originStart.size(); i++) {
+        same = loaded.originStart[i] == tables.originStart[i];
+    }
+    for (int i = 0; same && i < tables.nodes.size(); i++) {
+        same = loaded.nodes[i].port == tables.nodes[i].port &&
+               loaded.nodes[i].cheapestParent == tables.nodes[i].cheapestParent &&
+               loaded.nodes[i].fastestParent == tables.nodes[i].fastestParent;
+    }
+    CHECK(same);
+
+    // install() only loads: it leaves a graph it does not match alone
+    Graph other;
+    other.addPorts("data/PortCharges.txt");
+    CHECK(!TransferPatterns::load(loaded, other, file));
+    CHECK(!TransferPatterns::install(other, file));
+    CHECK(TransferPatterns::active(other) == nullptr);
+    CHECK(TransferPatterns::install(graph, file));
+    CHECK(TransferPatterns::active(graph) != nullptr);
+    std::remove(file.c_str());
+    CHECK(!TransferPatterns::install(graph, file));
+}
+
+int main() {
+    Graph graph;
+    graph.addPorts("data/PortCharges.txt");
+    graph.addRoutes("data/Routes.txt");
+    TransferPatternTables tables;
+    TransferPatterns::build(graph, tables);
+    matchesSearches(graph, tables);
+    storesReachablePortsOnly(graph, tables);
+    roundTrip(graph, tables);
+
+    // Onward sailings that tie on cost and on arrival, listed out of
+    // departure order: the pattern takes the one PathFinding takes
+    {
+        std::ofstream ports("tests/bin/patterns_ports.txt");
+        ports << "A 100\nX 200\nB 300\n";
+        std::ofstream routes("tests/bin/patterns_routes.txt");
+        routes << "A X 1/12/2024 00:00 04:00 1000 Early\n";
+        routes << "X B 1/12/2024 10:00 20:00 1000 Late\n";
+        routes << "X B 1/12/2024 08:00 20:00 1000 Soon\n";
+    }
+    Graph ties;
+    ties.addPorts("tests/bin/patterns_ports.txt");
+    ties.addRoutes("tests/bin/patterns_routes.txt");
+    TransferPatternTables tieTables;
+    TransferPatterns::build(ties, tieTables);
+    matchesSearches(ties, tieTables);
+    return finish("transferPatternsTest");
+}
@@ -0,0 +1,121 @@
+// Vector (headers/vector.h): growth, copies, moves and element lifetimes.
+#include <string>
+#include <utility>
+#include "testUtil.h"
+#include "../headers/vector.h"
+
+// Counts live instances and copies; has no default constructor
+struct Tracked {
+    static int live;
+    static int copies;
+    int value;
+
+    explicit Tracked(int v) : value(v) { live++; }
+    Tracked(const Tracked& other) : value(other.value) { live++; copies++; }
+    Tracked(Tracked&& other) noexcept : value(other.value) { other.value = -1; live++; }
+    Tracked& operator=(const Tracked& other) { value = other.value; copies++; return *this; }
+    Tracked& operator=(Tracked&& other) noexcept { value = other.value; other.value = -1; return *this; }
+    ~Tracked() { live--; }
+};
+int Tracked::live = 0;
+int Tracked::copies = 0;
+
+static void growthMovesInsteadOfCopying() {
+    Tracked::copies = 0;
+    {
+        Vector<Tracked> v;
+        for (int i = 0; i < 100; i++) v.emplace_back(i);
+        CHECK_EQ(v.size(), 100);
+        CHECK(v.getCapacity() >= 100);
+        for (int i = 0; i < 100; i++) CHECK_EQ(v[i].value, i);
+        CHECK_EQ(Tracked::live, 100);
+        CHECK_EQ(Tracked::copies, 0);
+    }
+    CHECK_EQ(Tracked::live, 0);
+}
+
+static void pushBackAliasingOwnElement() {
+    Vector<std::string> v;
+    v.push_back("first");
+    // Full at capacity 4, so the next push_back regrows while reading v[0]
+    for (int i = 0; i < 3; i++) v.push_back("x");
+    CHECK_EQ(v.size(), v.getCapacity());
+    v.push_back(v[0]);
+    CHECK_EQ(v.back(), std::string("first"));
+}
+
+static void copyAndMove() {
+    Vector<std::string> a = { "a", "b", "c" };
+    Vector<std::string> b(a);
+    b[0] = "changed";
+    CHECK_EQ(a[0], std::string("a"));
+    CHECK_EQ(b.size(), 3);
+
+    Vector<std::string> c(std::move(a));
+    CHECK_EQ(c.size(), 3);
+    CHECK_EQ(a.size(), 0);
+    CHECK(a.begin() == nullptr);
+
+    b = std::move(c);
+    CHECK_EQ(b[2], std::string("c"));
+    CHECK_EQ(c.size(), 0);
+
+    b = b;  // self-assignment keeps the contents
+    CHECK_EQ(b.size(), 3);
+}
+
+static void clearKeepsBufferShrinkReleases() {
+    Vector<Tracked> v;
+    for (int i = 0; i < 10; i++) v.emplace_back(i);
+    int capacity = v.getCapacity();
+    v.clear();
+    CHECK_EQ(v.size(), 0);
+    CHECK_EQ(v.getCapacity(), capacity);
+    CHECK_EQ(Tracked::live, 0);
+
+    v.emplace_back(7);
+    v.reserve(100);
+    CHECK_EQ(v.getCapacity(), 100);
+    CHECK_EQ(v[0].value, 7);
+    v.shrink_to_fit();
+    CHECK_EQ(v.getCapacity(), 1);
+    v.pop_back();
+    v.shrink_to_fit();
+    CHECK_EQ(v.getCapacity(), 0);
+    CHECK_EQ(Tracked::live, 0);
+}
+
+static void resizeAndErase() {
+    Vector<int> v;
+    v.resize(5);
+    CHECK_EQ(v.size(), 5);
+    for (int i = 0; i < 5; i++) CHECK_EQ(v[i], 0);
+    for (int i = 0; i < 5; i++) v[i] = i;
+    v.erase(1);
+    CHECK_EQ(v.size(), 4);
+    CHECK_EQ(v[1], 2);
+    CHECK_EQ(v.back(), 4);
+    v.resize(2);
+    CHECK_EQ(v.size(), 2);
+    CHECK_EQ(v[1], 2);
+}
+
+static void boundsChecks() {
+    Vector<int> v;
+    CHECK_THROWS(v.pop_back(), std::out_of_range);
+    CHECK_THROWS(v.front(), std::out_of_range);
+    v.push_back(1);
+    CHECK_THROWS(v[1], std::out_of_range);
+    CHECK_THROWS(v.erase(-1), std::out_of_range);
+    CHECK_THROWS(v.resize(-1), std::out_of_range);
+}
+
+int main() {
+    growthMovesInsteadOfCopying();
+    pushBackAliasingOwnElement();
+    copyAndMove();
+    clearKeepsBufferShrinkReleases();
+    resizeAndErase();
+    boundsChecks();
+    return finish("vectorTest");
+}